@@ -427,6 +427,70 @@ class Bindings:
                 return True
         return False
 
+def fnv1a_32(string, seed):
+    """FNV-1a 32 bit hash with a seeded offset basis, must match the
+    known_path_hash function in the generated C code."""
+    h = (2166136261 ^ seed) & 0xffffffff
+    for c in string.encode('utf-8'):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+class KnownPaths:
+    """All paths used by the bindings, with a perfect hash over them so they
+    can be looked up without touching the instance path store.
+
+    Uses hash and displace, strings are first put in buckets by their
+    unseeded hash, then for each bucket (biggest first) a seed is searched
+    for that puts all of the strings in the bucket in free slots.
+    """
+
+    def __init__(self, b):
+        paths = set()
+        for profile in b.profiles:
+            paths.add(profile.name)
+            for component in profile.components:
+                paths.add(component.subaction_path)
+                paths.update(component.get_full_openxr_paths())
+            for identifier in profile.identifiers:
+                if identifier.dpad:
+                    paths.add(identifier.subaction_path)
+                    paths.update(identifier.dpad.paths)
+
+        self.paths = sorted(paths)
+        self.index = {path: i for i, path in enumerate(self.paths)}
+
+        # Power of two sizes so the C code can mask instead of modulo.
+        self.slot_count = 1
+        while self.slot_count < len(self.paths):
+            self.slot_count *= 2
+        self.bucket_count = max(1, self.slot_count // 4)
+
+        buckets = [[] for _ in range(self.bucket_count)]
+        for i, path in enumerate(self.paths):
+            buckets[fnv1a_32(path, 0) & (self.bucket_count - 1)].append(i)
+
+        self.seeds = [0] * self.bucket_count
+        self.slots = [None] * self.slot_count
+        order = sorted(range(self.bucket_count), key=lambda x: len(buckets[x]), reverse=True)
+        for bucket in order:
+            if not buckets[bucket]:
+                break
+            seed = 1
+            while True:
+                slots = [fnv1a_32(self.paths[i], seed) & (self.slot_count - 1) for i in buckets[bucket]]
+                if len(set(slots)) == len(slots) and all(self.slots[x] is None for x in slots):
+                    break
+                seed += 1
+            self.seeds[bucket] = seed
+            for i, slot in zip(buckets[bucket], slots):
+                self.slots[slot] = i
+
+    def indices(self, paths):
+        return [self.index[path] for path in paths]
+
+
 header = '''// Copyright 2020-2022, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -565,6 +629,67 @@ oxr_verify_{profile.validation_func_name}_ext(const struct oxr_extension_status
 ''')
 
 
+def generate_known_paths_c(f, b, known):
+    """Generate the known paths table and its perfect hash lookup."""
+    f.write('const char *const oxr_bindings_known_paths[OXR_BINDINGS_KNOWN_PATH_COUNT] = {\n')
+    for path in known.paths:
+        f.write(f'\t"{path}",\n')
+    f.write('};\n\n')
+
+    f.write('const uint16_t oxr_bindings_known_path_lengths[OXR_BINDINGS_KNOWN_PATH_COUNT] = {\n')
+    for path in known.paths:
+        f.write(f'\t{len(path)},\n')
+    f.write('};\n\n')
+
+    profile_by_path = {profile.name: i for i, profile in enumerate(b.profiles)}
+    f.write('const int16_t oxr_bindings_known_path_profiles[OXR_BINDINGS_KNOWN_PATH_COUNT] = {\n')
+    for path in known.paths:
+        f.write(f'\t{profile_by_path.get(path, -1)},\n')
+    f.write('};\n\n')
+
+    f.write(f'#define KNOWN_PATH_BUCKET_COUNT {known.bucket_count}\n')
+    f.write(f'#define KNOWN_PATH_SLOT_COUNT {known.slot_count}\n\n')
+
+    f.write('static const uint32_t known_path_seeds[KNOWN_PATH_BUCKET_COUNT] = {\n')
+    for seed in known.seeds:
+        f.write(f'\t{seed},\n')
+    f.write('};\n\n')
+
+    f.write('static const uint16_t known_path_slots[KNOWN_PATH_SLOT_COUNT] = {\n')
+    for slot in known.slots:
+        f.write(f'\t{"UINT16_MAX" if slot is None else slot},\n')
+    f.write('};\n\n')
+
+    f.write('''static inline uint32_t
+known_path_hash(const char *str, size_t length, uint32_t seed)
+{
+\tuint32_t h = 2166136261u ^ seed;
+\tfor (size_t i = 0; i < length; i++) {
+\t\th ^= (uint8_t)str[i];
+\t\th *= 16777619u;
+\t}
+\treturn h;
+}
+
+bool
+oxr_bindings_find_known_path(const char *str, size_t length, uint32_t *out_index)
+{
+\tuint32_t bucket = known_path_hash(str, length, 0) & (KNOWN_PATH_BUCKET_COUNT - 1);
+\tuint32_t slot = known_path_hash(str, length, known_path_seeds[bucket]) & (KNOWN_PATH_SLOT_COUNT - 1);
+\tuint16_t index = known_path_slots[slot];
+
+\tif (index == UINT16_MAX || oxr_bindings_known_path_lengths[index] != length ||
+\t    memcmp(oxr_bindings_known_paths[index], str, length) != 0) {
+\t\treturn false;
+\t}
+
+\t*out_index = index;
+\treturn true;
+}
+
+''')
+
+
 def generate_bindings_c(file, b):
     """Generate the file to verify subpaths on a interaction profile."""
     f = open(file, "w")
@@ -577,6 +702,8 @@ def generate_bindings_c(file, b):
 // clang-format off
 ''')
 
+    known = KnownPaths(b)
+
     for profile in b.profiles:
         generate_verify_functions(f, profile)
 
@@ -592,6 +719,7 @@ def generate_bindings_c(file, b):
         f.write(f'\t{{ // profile_template\n')
         f.write(f'\t\t.name = {profile.monado_device_enum},\n')
         f.write(f'\t\t.path = "{profile.name}",\n')
+        f.write(f'\t\t.path_index = {known.index[profile.name]},\n')
         f.write(f'\t\t.localized_name = "{profile.localized_name}",\n')
         f.write(f'\t\t.steamvr_input_profile_path = "{fname}",\n')
         f.write(f'\t\t.steamvr_controller_type = "{controller_type}",\n')
@@ -609,6 +737,7 @@ def generate_bindings_c(file, b):
 
             f.write(f'\t\t\t{{ // binding_template {idx}\n')
             f.write(f'\t\t\t\t.subaction_path = "{component.subaction_path}",\n')
+            f.write(f'\t\t\t\t.subaction_path_index = {known.index[component.subaction_path]},\n')
             f.write(f'\t\t\t\t.steamvr_path = "{steamvr_path}",\n')
             f.write(
                 f'\t\t\t\t.localized_name = "{component.subpath_localized_name}",\n')
@@ -618,6 +747,9 @@ def generate_bindings_c(file, b):
                 f.write(f'\t\t\t\t\t"{path}",\n')
             f.write('\t\t\t\t\tNULL\n')
             f.write('\t\t\t\t}, // /array of paths\n')
+            path_indices = known.indices(component.get_full_openxr_paths())
+            f.write(f'\t\t\t\t.path_indices = {{ {", ".join(str(x) for x in path_indices)} }},\n')
+            f.write(f'\t\t\t\t.path_count = {len(path_indices)},\n')
 
             # print("component", component.__dict__)
 
@@ -668,10 +800,14 @@ def generate_bindings_c(file, b):
             for idx, identifier in enumerate(dpads):
                 f.write('\t\t\t{\n')
                 f.write(f'\t\t\t\t.subaction_path = "{identifier.subaction_path}",\n')
+                f.write(f'\t\t\t\t.subaction_path_index = {known.index[identifier.subaction_path]},\n')
                 f.write('\t\t\t\t.paths = {\n')
                 for path in identifier.dpad.paths:
                     f.write(f'\t\t\t\t\t"{path}",\n')
                 f.write('\t\t\t\t},\n')
+                path_indices = known.indices(identifier.dpad.paths)
+                f.write(f'\t\t\t\t.path_indices = {{ {", ".join(str(x) for x in path_indices)} }},\n')
+                f.write(f'\t\t\t\t.path_count = {len(path_indices)},\n')
                 f.write(f'\t\t\t\t.position = {identifier.dpad.position_component.monado_binding},\n')
                 if identifier.dpad.activate_component:
                     f.write(f'\t\t\t\t.activate = {identifier.dpad.activate_component.monado_binding},\n')
@@ -696,6 +832,8 @@ def generate_bindings_c(file, b):
 
     f.write('}; // /array of profile_template\n\n')
 
+    generate_known_paths_c(f, b, known)
+
     inputs = set()
     outputs = set()
     for profile in b.profiles:
@@ -784,6 +922,8 @@ def generate_bindings_h(file, b):
     f = open(file, "w")
     f.write(header.format(brief='Generated bindings data header',
                           group='oxr_api'))
+
+    known = KnownPaths(b)
     f.write(f'''
 #pragma once
 
@@ -798,6 +938,29 @@ struct oxr_extension_status;
 
 #define OXR_BINDINGS_PROFILE_TEMPLATE_COUNT {len(b.profiles)}
 
+//! Number of unique paths used by all of the profiles, see @ref oxr_bindings_known_paths.
+#define OXR_BINDINGS_KNOWN_PATH_COUNT {len(known.paths)}
+
+/*!
+ * All paths used by the profiles, sorted and unique, they are all created
+ * when the instance is, so the index of a path can be turned into a XrPath
+ * without any lookups.
+ */
+extern const char *const oxr_bindings_known_paths[OXR_BINDINGS_KNOWN_PATH_COUNT];
+
+//! Length of each string in @ref oxr_bindings_known_paths.
+extern const uint16_t oxr_bindings_known_path_lengths[OXR_BINDINGS_KNOWN_PATH_COUNT];
+
+//! Index into @ref profile_templates for known paths that are profiles, -1 otherwise.
+extern const int16_t oxr_bindings_known_path_profiles[OXR_BINDINGS_KNOWN_PATH_COUNT];
+
+/*!
+ * Find the index of @p str in @ref oxr_bindings_known_paths, uses a perfect
+ * hash generated at build time so is O(1) and never allocates.
+ */
+bool
+oxr_bindings_find_known_path(const char *str, size_t length, uint32_t *out_index);
+
 struct oxr_bindings_path_cache_element {{
     //! Pointer to XrPath
     XrPath *path_cache;
@@ -837,7 +1000,10 @@ enum oxr_dpad_binding_point
 struct dpad_emulation
 {{
 \tconst char *subaction_path;
+\tuint32_t subaction_path_index;
 \tconst char *paths[PATHS_PER_BINDING_TEMPLATE];
+\tuint32_t path_indices[PATHS_PER_BINDING_TEMPLATE];
+\tuint32_t path_count;
 \tenum xrt_input_name position;
 \tenum xrt_input_name activate; // Can be zero
 }};
@@ -845,9 +1011,12 @@ struct dpad_emulation
 struct binding_template
 {{
 \tconst char *subaction_path;
+\tuint32_t subaction_path_index;
 \tconst char *steamvr_path;
 \tconst char *localized_name;
 \tconst char *paths[PATHS_PER_BINDING_TEMPLATE];
+\tuint32_t path_indices[PATHS_PER_BINDING_TEMPLATE];
+\tuint32_t path_count;
 \tenum xrt_input_name input;
 \tenum xrt_input_name dpad_activate;
 \tenum xrt_output_name output;
@@ -860,6 +1029,8 @@ struct profile_template
 {{
 \tenum xrt_device_name name;
 \tconst char *path;
+\t//! Index of path in oxr_bindings_known_paths.
+\tuint32_t path_index;
 \tconst char *localized_name;
 \tconst char *steamvr_input_profile_path;
 \tconst char *steamvr_controller_type;
@@ -20,8 +20,8 @@
 #include "util/u_trace_marker.h"
 #include "xrt/xrt_defines.h"
 #include "os/os_threading.h"
-#include "util/u_template_historybuf.hpp"
 
+#include <atomic>
 #include <memory>
 #include <algorithm>
 #include <cstring>
@@ -31,7 +31,6 @@
 #include <assert.h>
 #include <mutex>
 
-using namespace xrt::auxiliary::util;
 namespace os = xrt::auxiliary::os;
 
 struct relation_history_entry
@@ -42,13 +41,243 @@ struct relation_history_entry
 
 static constexpr size_t BufLen = 4096;
 
+/*!
+ * How many times a reader tries to get a consistent view before it falls back
+ * to taking the producer mutex, only hit if the reader keeps getting lapped.
+ */
+static constexpr uint32_t ReadAttempts = 4;
+
+/*!
+ * Single producer, multiple consumer ring of relations.
+ *
+ * Entries are addressed by a logical index that only ever grows, the entry for
+ * index i lives in slot i % BufLen. The producer publishes a new entry by
+ * bumping @p head, before it starts to overwrite a slot it bumps @p writing so
+ * readers can tell if any entry they copied might have been torn, in which
+ * case they simply try again. Readers never take any lock or write to any
+ * shared memory, so they can't stall the producer.
+ */
 struct m_relation_history
 {
-	HistoryBuffer<struct relation_history_entry, BufLen> impl;
-	mutable os::Mutex mutex;
+	//! Storage, only written by the producer with @p producer_mutex held.
+	struct relation_history_entry entries[BufLen];
+
+	//! Logical index one past the newest fully written entry.
+	std::atomic<uint64_t> head{0};
+
+	//! Logical index one past the entry being written, entries below writing - BufLen may be torn.
+	std::atomic<uint64_t> writing{0};
+
+	//! Logical index of the oldest entry, moved up to @p head by clear.
+	std::atomic<uint64_t> start{0};
+
+	//! Serialises push and clear, readers only take it if they keep being lapped.
+	mutable os::Mutex producer_mutex;
 };
 
 
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static inline uint64_t
+get_begin(const struct m_relation_history *rh, uint64_t end)
+{
+	uint64_t begin = rh->start.load(std::memory_order_acquire);
+	if (end > BufLen && begin < end - BufLen) {
+		begin = end - BufLen;
+	}
+	// A clear that happened after we loaded end, treat as empty.
+	return begin > end ? end : begin;
+}
+
+static inline const struct relation_history_entry &
+entry_at(const struct m_relation_history *rh, uint64_t index)
+{
+	return rh->entries[index % BufLen];
+}
+
+/*!
+ * Checks that no entry at or after @p oldest_index has been touched by the
+ * producer while we were reading, must be called after all copies are done.
+ */
+static inline bool
+still_valid(const struct m_relation_history *rh, uint64_t oldest_index)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t writing = rh->writing.load(std::memory_order_relaxed);
+
+	// The producer has started to overwrite the entry at writing - 1 - BufLen.
+	return oldest_index + BufLen >= writing;
+}
+
+static enum m_relation_history_result
+interpolate(const struct relation_history_entry &predecessor,
+            const struct relation_history_entry &successor,
+            int64_t at_timestamp_ns,
+            struct xrt_space_relation *out_relation)
+{
+	// Do the thing.
+	int64_t diff_before = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
+	int64_t diff_after = static_cast<int64_t>(successor.timestamp) - at_timestamp_ns;
+
+	float amount_to_lerp = (float)diff_before / (float)(diff_before + diff_after);
+
+	// Copy intersection of relation flags
+	xrt_space_relation result{};
+	result.relation_flags =
+	    (enum xrt_space_relation_flags)(predecessor.relation.relation_flags & successor.relation.relation_flags);
+	// First-order implementation - lerp between the before and after
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_POSITION_VALID_BIT)) {
+		result.pose.position =
+		    m_vec3_lerp(predecessor.relation.pose.position, successor.relation.pose.position, amount_to_lerp);
+	}
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_ORIENTATION_VALID_BIT)) {
+
+		math_quat_slerp(&predecessor.relation.pose.orientation, &successor.relation.pose.orientation,
+		                amount_to_lerp, &result.pose.orientation);
+	}
+
+	//! @todo Does interpolating the velocities make any sense?
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT)) {
+		result.angular_velocity = m_vec3_lerp(predecessor.relation.angular_velocity,
+		                                      successor.relation.angular_velocity, amount_to_lerp);
+	}
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT)) {
+		result.linear_velocity = m_vec3_lerp(predecessor.relation.linear_velocity,
+		                                     successor.relation.linear_velocity, amount_to_lerp);
+	}
+	*out_relation = result;
+	return M_RELATION_HISTORY_RESULT_INTERPOLATED;
+}
+
+/*!
+ * Does one lock-free attempt at getting the relation, returns false if the
+ * producer overwrote any entry we looked at and the caller needs to retry.
+ * All entries are copied out and validated before any math is done on them.
+ */
+static bool
+try_get(const struct m_relation_history *rh,
+        int64_t at_timestamp_ns,
+        struct xrt_space_relation *out_relation,
+        enum m_relation_history_result *out_result)
+{
+	const uint64_t e = rh->head.load(std::memory_order_acquire);
+	const uint64_t b = get_begin(rh, e);
+
+	if (b == e) {
+		// Do nothing. You push nothing to the buffer you get nothing from the buffer.
+		*out_relation = {};
+		*out_result = M_RELATION_HISTORY_RESULT_INVALID;
+		return true;
+	}
+
+	// Find the first element *not less than* our value, same as std::lower_bound. Torn timestamps can only
+	// make us pick the wrong index, that is caught by the validation below as we track the oldest we touched.
+	uint64_t it = b;
+	uint64_t count = e - b;
+	uint64_t oldest = e;
+	while (count > 0) {
+		uint64_t step = count / 2;
+		uint64_t mid = it + step;
+		oldest = std::min(oldest, mid);
+
+		if (entry_at(rh, mid).timestamp < at_timestamp_ns) {
+			it = mid + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	if (it == e) {
+		// lower bound is at the end:
+		// The desired timestamp is after what our buffer contains.
+		// (pose-prediction)
+		// Output flags match the most recent buffer entry.
+		const struct relation_history_entry back = entry_at(rh, e - 1);
+		if (!still_valid(rh, std::min(oldest, e - 1))) {
+			return false;
+		}
+
+		int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - back.timestamp;
+		double delta_s = time_ns_to_s(diff_prediction_ns);
+
+		U_LOG_T("Extrapolating %f s past the back of the buffer!", delta_s);
+
+		m_predict_relation(&back.relation, delta_s, out_relation);
+		*out_result = M_RELATION_HISTORY_RESULT_PREDICTED;
+		return true;
+	}
+
+	const struct relation_history_entry successor = entry_at(rh, it);
+	if (at_timestamp_ns == successor.timestamp) {
+		if (!still_valid(rh, std::min(oldest, it))) {
+			return false;
+		}
+
+		// exact match:
+		// Flags copied directly along with everything else.
+		U_LOG_T("Exact match in the buffer!");
+		*out_relation = successor.relation;
+		*out_result = M_RELATION_HISTORY_RESULT_EXACT;
+		return true;
+	}
+
+	if (it == b) {
+		if (!still_valid(rh, b)) {
+			return false;
+		}
+
+		// lower bound is at the beginning (and it's not an exact match):
+		// The desired timestamp is before what our buffer contains.
+		// (an edge case where somebody asks for a really old pose and we do our best)
+		// Output flags are the same as the input flags for the history entry we use
+		int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - successor.timestamp;
+		double delta_s = time_ns_to_s(diff_prediction_ns);
+		U_LOG_T("Extrapolating %f s before the front of the buffer!", delta_s);
+		m_predict_relation(&successor.relation, delta_s, out_relation);
+		*out_result = M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED;
+		return true;
+	}
+
+	// We precede it and follow it - 1 (which we know exists because we already handled the it == b case)
+	const struct relation_history_entry predecessor = entry_at(rh, it - 1);
+	if (!still_valid(rh, std::min(oldest, it - 1))) {
+		return false;
+	}
+
+	U_LOG_T("Interpolating within buffer!");
+	*out_result = interpolate(predecessor, successor, at_timestamp_ns, out_relation);
+	return true;
+}
+
+static bool
+try_get_latest(const struct m_relation_history *rh, bool *out_empty, struct relation_history_entry *out_entry)
+{
+	const uint64_t e = rh->head.load(std::memory_order_acquire);
+	const uint64_t b = get_begin(rh, e);
+
+	if (b == e) {
+		*out_empty = true;
+		return true;
+	}
+
+	*out_entry = entry_at(rh, e - 1);
+	*out_empty = false;
+
+	return still_valid(rh, e - 1);
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
 void
 m_relation_history_create(struct m_relation_history **rh_ptr)
 {
@@ -63,21 +292,31 @@ m_relation_history_push(struct m_relation_history *rh, struct xrt_space_relation
 	struct relation_history_entry rhe;
 	rhe.relation = *in_relation;
 	rhe.timestamp = timestamp;
-	bool ret = false;
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	try {
-		// if we aren't empty, we can compare against the latest timestamp.
-		if (rh->impl.empty() || rhe.timestamp > rh->impl.back().timestamp) {
-			// Everything explodes if the timestamps in relation_history aren't monotonically increasing. If
-			// we get a timestamp that's before the most recent timestamp in the buffer, don't put it
-			// in the history.
-			rh->impl.push_back(rhe);
-			ret = true;
-		}
-	} catch (std::exception const &e) {
-		U_LOG_E("Caught exception: %s", e.what());
+
+	std::unique_lock<os::Mutex> lock(rh->producer_mutex);
+
+	// Only the producer writes these, so no need to be careful here.
+	const uint64_t e = rh->head.load(std::memory_order_relaxed);
+	const uint64_t b = get_begin(rh, e);
+
+	// if we aren't empty, we can compare against the latest timestamp.
+	if (b != e && rhe.timestamp <= entry_at(rh, e - 1).timestamp) {
+		// Everything explodes if the timestamps in relation_history aren't monotonically increasing. If
+		// we get a timestamp that's before the most recent timestamp in the buffer, don't put it
+		// in the history.
+		return false;
 	}
-	return ret;
+
+	// Tell readers that the oldest entry is about to be overwritten, before we touch it.
+	rh->writing.store(e + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	rh->entries[e % BufLen] = rhe;
+
+	// Publish the new entry.
+	rh->head.store(e + 1, std::memory_order_release);
+
+	return true;
 }
 
 enum m_relation_history_result
@@ -86,98 +325,26 @@ m_relation_history_get(const struct m_relation_history *rh,
                        struct xrt_space_relation *out_relation)
 {
 	XRT_TRACE_MARKER();
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	try {
-		if (rh->impl.empty() || at_timestamp_ns == 0) {
-			// Do nothing. You push nothing to the buffer you get nothing from the buffer.
-			*out_relation = {};
-			return M_RELATION_HISTORY_RESULT_INVALID;
-		}
-		const auto b = rh->impl.begin();
-		const auto e = rh->impl.end();
-
-		// Find the first element *not less than* our value. the lambda we pass is the comparison
-		// function, to compare against timestamps.
-		const auto it =
-		    std::lower_bound(b, e, at_timestamp_ns, [](const relation_history_entry &rhe, int64_t timestamp) {
-			    return rhe.timestamp < timestamp;
-		    });
-
-		if (it == e) {
-			// lower bound is at the end:
-			// The desired timestamp is after what our buffer contains.
-			// (pose-prediction)
-			// Output flags match the most recent buffer entry.
-			int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - rh->impl.back().timestamp;
-			double delta_s = time_ns_to_s(diff_prediction_ns);
-
-			U_LOG_T("Extrapolating %f s past the back of the buffer!", delta_s);
-
-			m_predict_relation(&rh->impl.back().relation, delta_s, out_relation);
-			return M_RELATION_HISTORY_RESULT_PREDICTED;
-		}
-		if (at_timestamp_ns == it->timestamp) {
-			// exact match:
-			// Flags copied directly along with everything else.
-			U_LOG_T("Exact match in the buffer!");
-			*out_relation = it->relation;
-			return M_RELATION_HISTORY_RESULT_EXACT;
-		}
-		if (it == b) {
-			// lower bound is at the beginning (and it's not an exact match):
-			// The desired timestamp is before what our buffer contains.
-			// (an edge case where somebody asks for a really old pose and we do our best)
-			// Output flags are the same as the input flags for the history entry we use
-			int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - rh->impl.front().timestamp;
-			double delta_s = time_ns_to_s(diff_prediction_ns);
-			U_LOG_T("Extrapolating %f s before the front of the buffer!", delta_s);
-			m_predict_relation(&rh->impl.front().relation, delta_s, out_relation);
-			return M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED;
-		}
-		U_LOG_T("Interpolating within buffer!");
-
-		// We precede *it and follow *(it - 1) (which we know exists because we already handled
-		// the it = begin() case)
-		const auto &predecessor = *(it - 1);
-		const auto &successor = *it;
-
-		// Do the thing.
-		int64_t diff_before = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
-		int64_t diff_after = static_cast<int64_t>(successor.timestamp) - at_timestamp_ns;
-
-		float amount_to_lerp = (float)diff_before / (float)(diff_before + diff_after);
-
-		// Copy intersection of relation flags
-		xrt_space_relation result{};
-		result.relation_flags = (enum xrt_space_relation_flags)(predecessor.relation.relation_flags &
-		                                                        successor.relation.relation_flags);
-		// First-order implementation - lerp between the before and after
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_POSITION_VALID_BIT)) {
-			result.pose.position = m_vec3_lerp(predecessor.relation.pose.position,
-			                                   successor.relation.pose.position, amount_to_lerp);
-		}
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_ORIENTATION_VALID_BIT)) {
 
-			math_quat_slerp(&predecessor.relation.pose.orientation, &successor.relation.pose.orientation,
-			                amount_to_lerp, &result.pose.orientation);
-		}
+	if (at_timestamp_ns == 0) {
+		*out_relation = {};
+		return M_RELATION_HISTORY_RESULT_INVALID;
+	}
 
-		//! @todo Does interpolating the velocities make any sense?
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT)) {
-			result.angular_velocity = m_vec3_lerp(predecessor.relation.angular_velocity,
-			                                      successor.relation.angular_velocity, amount_to_lerp);
-		}
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT)) {
-			result.linear_velocity = m_vec3_lerp(predecessor.relation.linear_velocity,
-			                                     successor.relation.linear_velocity, amount_to_lerp);
+	enum m_relation_history_result result = M_RELATION_HISTORY_RESULT_INVALID;
+	for (uint32_t i = 0; i < ReadAttempts; i++) {
+		if (try_get(rh, at_timestamp_ns, out_relation, &result)) {
+			return result;
 		}
-		*out_relation = result;
-		return M_RELATION_HISTORY_RESULT_INTERPOLATED;
-
-	} catch (std::exception const &e) {
-		U_LOG_E("Caught exception: %s", e.what());
-		return M_RELATION_HISTORY_RESULT_INVALID;
 	}
+
+	// Kept getting lapped by the producer, stop it for a moment.
+	std::unique_lock<os::Mutex> lock(rh->producer_mutex);
+	bool valid = try_get(rh, at_timestamp_ns, out_relation, &result);
+	assert(valid);
+	(void)valid;
+
+	return result;
 }
 
 bool
@@ -232,27 +399,41 @@ m_relation_history_get_latest(const struct m_relation_history *rh,
                               int64_t *out_time_ns,
                               struct xrt_space_relation *out_relation)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	if (rh->impl.empty()) {
+	struct relation_history_entry rhe;
+	bool empty = true;
+
+	bool valid = false;
+	for (uint32_t i = 0; i < ReadAttempts && !valid; i++) {
+		valid = try_get_latest(rh, &empty, &rhe);
+	}
+
+	if (!valid) {
+		std::unique_lock<os::Mutex> lock(rh->producer_mutex);
+		try_get_latest(rh, &empty, &rhe);
+	}
+
+	if (empty) {
 		return false;
 	}
-	*out_relation = rh->impl.back().relation;
-	*out_time_ns = rh->impl.back().timestamp;
+	*out_relation = rhe.relation;
+	*out_time_ns = rhe.timestamp;
 	return true;
 }
 
 uint32_t
 m_relation_history_get_size(const struct m_relation_history *rh)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	return (uint32_t)rh->impl.size();
+	const uint64_t e = rh->head.load(std::memory_order_acquire);
+	return (uint32_t)(e - get_begin(rh, e));
 }
 
 void
 m_relation_history_clear(struct m_relation_history *rh)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	rh->impl.clear();
+	std::unique_lock<os::Mutex> lock(rh->producer_mutex);
+
+	// Nothing is overwritten, the entries before head are simply no longer visible.
+	rh->start.store(rh->head.load(std::memory_order_relaxed), std::memory_order_release);
 }
 
 void
@@ -20,9 +20,10 @@ extern "C" {
 /**
  * @brief Opaque type for storing the history of a space relation in a ring buffer
  *
- * @note Unlike the bare C++ data structure @ref HistoryBuffer this wraps, **this is a thread safe interface**,
- * and is safe for concurrent access from multiple threads.
- * (It is using a simple mutex, not a reader/writer lock, but that is fine until proven to be a bottleneck.)
+ * @note Unlike the bare C++ data structure @ref HistoryBuffer, **this is a thread safe interface**,
+ * and is safe for concurrent access from multiple threads. It is tuned for a single producer pushing
+ * and many readers: readers never take a lock and never block the producer, they copy the entries
+ * they need and retry if the producer overwrote them while they were reading.
  *
  * @ingroup aux_util
  */
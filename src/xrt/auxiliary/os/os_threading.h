@@ -220,6 +220,18 @@ os_cond_signal(struct os_cond *oc)
 	pthread_cond_signal(&oc->cond);
 }
 
+/*!
+ * Signal all waiting threads.
+ *
+ * @public @memberof os_cond
+ */
+static inline void
+os_cond_broadcast(struct os_cond *oc)
+{
+	assert(oc->initialized);
+	pthread_cond_broadcast(&oc->cond);
+}
+
 /*!
  * Wait.
  *
@@ -15,12 +15,19 @@
 #include "util/u_frame.h"
 #include "util/u_format.h"
 #include "util/u_logging.h"
+#include "util/u_worker.h"
 
 #include "tracking/t_tracking.h"
 #include "tracking/t_calibration_opencv.hpp"
 
 #include <opencv2/opencv.hpp>
 #include <sys/stat.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
 #include <utility>
 
 #if CV_MAJOR_VERSION >= 4
@@ -34,6 +41,23 @@
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_filter, "T_DEBUG_HSV_FILTER", false)
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_picker, "T_DEBUG_HSV_PICKER", false)
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_viewer, "T_DEBUG_HSV_VIEWER", false)
+DEBUG_GET_ONCE_BOOL_OPTION(multi_scale, "T_CALIBRATION_MULTI_SCALE", true)
+
+/*!
+ * Images wider than this are first searched at a reduced size, see
+ * @ref get_detect_scale.
+ */
+#define DETECT_MIN_COLS (640)
+
+/*!
+ * Limit of threads used for batch calibration, same as the worker pool.
+ */
+#define BATCH_MAX_THREAD_COUNT (16)
+
+/*!
+ * Number of tasks each thread gets, to even out slow images.
+ */
+#define BATCH_TASKS_PER_THREAD (4)
 
 namespace xrt::auxiliary::tracking {
 /*
@@ -92,6 +116,7 @@ class Calibration
 {
 public:
 	struct xrt_frame_sink base = {};
+	struct xrt_frame_node node = {};
 
 	struct
 	{
@@ -164,6 +189,12 @@ public:
 	//! Should we mirror the rgb images.
 	bool mirror_rgb_image = false;
 
+	//! Search for checker boards on a downscaled image first.
+	bool multi_scale = true;
+
+	//! Finds the boards in both views of stereo frames at the same time.
+	struct u_worker_group *group = nullptr;
+
 	cv::Mat gray = {};
 
 	char text[512] = {};
@@ -292,8 +323,52 @@ do_view_coverage(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv
 	cv::drawChessboardCorners(rgb, c.board.dims, view.current_f32, found);
 }
 
+/*!
+ * How much to shrink @p gray by for the first search, 1 means the image is
+ * small enough to search at full resolution directly.
+ */
+static int
+get_detect_scale(const class Calibration &c, const cv::Mat &gray)
+{
+	if (!c.multi_scale) {
+		return 1;
+	}
+
+	return std::max(gray.cols / DETECT_MIN_COLS, 1);
+}
+
+static void
+downscale(const cv::Mat &gray, int scale, cv::Mat &out_small)
+{
+	cv::Size size(gray.cols / scale, gray.rows / scale);
+
+	cv::resize(gray, out_small, size, 0, 0, cv::INTER_AREA);
+}
+
+static void
+upscale_corners(MeasurementF32 &corners, int scale)
+{
+	// Line up the pixel centers of the two images.
+	float s = (float)scale;
+	float offset = (s - 1.0f) / 2.0f;
+
+	for (cv::Point2f &p : corners) {
+		p.x = p.x * s + offset;
+		p.y = p.y * s + offset;
+	}
+}
+
+static void
+convert_current_to_f64(struct ViewState &view)
+{
+	view.current_f64.clear(); // Doesn't effect capacity.
+	for (const cv::Point2f &p : view.current_f32) {
+		view.current_f64.emplace_back(double(p.x), double(p.y));
+	}
+}
+
 static bool
-do_view_chess(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
+detect_chess(const class Calibration &c, struct ViewState &view, const cv::Mat &gray)
 {
 	/*
 	 * Fisheye requires measurement and model to be double, other functions
@@ -306,10 +381,34 @@ do_view_chess(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::M
 	flags += cv::CALIB_CB_ADAPTIVE_THRESH;
 	flags += cv::CALIB_CB_NORMALIZE_IMAGE;
 
-	bool found = cv::findChessboardCorners(gray,             // Image
-	                                       c.board.dims,     // patternSize
-	                                       view.current_f32, // corners
-	                                       flags);           // flags
+	bool found = false;
+	int scale = get_detect_scale(c, gray);
+
+	if (scale > 1) {
+		cv::Mat small;
+		downscale(gray, scale, small);
+
+		found = cv::findChessboardCorners(small,            // Image
+		                                  c.board.dims,     // patternSize
+		                                  view.current_f32, // corners
+		                                  flags);           // flags
+
+		// Also scale partial hits, they are drawn.
+		upscale_corners(view.current_f32, scale);
+	}
+
+	/*
+	 * Nothing on the small image means no board, skip the expensive full
+	 * resolution search. Otherwise the corners only need refining, unless
+	 * subpixel enhancing is turned off.
+	 */
+	bool full_search = scale <= 1 || (found && !c.subpixel_enable);
+	if (full_search) {
+		found = cv::findChessboardCorners(gray,             // Image
+		                                  c.board.dims,     // patternSize
+		                                  view.current_f32, // corners
+		                                  flags);           // flags
+	}
 
 	// Improve the corner positions.
 	if (found && c.subpixel_enable) {
@@ -325,19 +424,14 @@ do_view_chess(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::M
 	}
 
 	// Do the conversion here.
-	view.current_f64.clear(); // Doesn't effect capacity.
-	for (const cv::Point2f &p : view.current_f32) {
-		view.current_f64.emplace_back(double(p.x), double(p.y));
-	}
-
-	do_view_coverage(c, view, gray, rgb, found);
+	convert_current_to_f64(view);
 
 	return found;
 }
 
 #ifdef SB_CHEESBOARD_CORNERS_SUPPORTED
 static bool
-do_view_sb_checkers(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
+detect_sb_checkers(const class Calibration &c, struct ViewState &view, const cv::Mat &gray)
 {
 	/*
 	 * Fisheye requires measurement and model to be double, other functions
@@ -357,25 +451,41 @@ do_view_sb_checkers(class Calibration &c, struct ViewState &view, cv::Mat &gray,
 	}
 #endif
 
-	bool found = cv::findChessboardCornersSB(gray,             // Image
-	                                         c.board.dims,     // patternSize
-	                                         view.current_f32, // corners
-	                                         flags);           // flags
+	bool found = true;
+	int scale = get_detect_scale(c, gray);
 
-	// Do the conversion here.
-	view.current_f64.clear(); // Doesn't effect capacity.
-	for (const cv::Point2f &p : view.current_f32) {
-		view.current_f64.emplace_back(double(p.x), double(p.y));
+	/*
+	 * The sector based detector can't refine existing corners, so the
+	 * small image is only used to reject frames without a board.
+	 */
+	if (scale > 1) {
+		cv::Mat small;
+		downscale(gray, scale, small);
+
+		found = cv::findChessboardCornersSB(small,            // Image
+		                                    c.board.dims,     // patternSize
+		                                    view.current_f32, // corners
+		                                    flags);           // flags
+
+		upscale_corners(view.current_f32, scale);
 	}
 
-	do_view_coverage(c, view, gray, rgb, found);
+	if (found) {
+		found = cv::findChessboardCornersSB(gray,             // Image
+		                                    c.board.dims,     // patternSize
+		                                    view.current_f32, // corners
+		                                    flags);           // flags
+	}
+
+	// Do the conversion here.
+	convert_current_to_f64(view);
 
 	return found;
 }
 #endif
 
 static bool
-do_view_circles(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
+detect_circles(const class Calibration &c, struct ViewState &view, const cv::Mat &gray)
 {
 	/*
 	 * Fisheye requires measurement and model to be double, other functions
@@ -399,33 +509,37 @@ do_view_circles(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv:
 		view.current_f32.emplace_back(float(p.x), float(p.y));
 	}
 
-	do_view_coverage(c, view, gray, rgb, found);
-
 	return found;
 }
 
+/*!
+ * Finds the board in @p gray, only touches @p view so can be called from
+ * multiple threads at once for different views.
+ */
 static bool
-do_view(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
+detect_view(const class Calibration &c, struct ViewState &view, const cv::Mat &gray)
 {
-	bool found = false;
-
 	switch (c.board.pattern) {
 	case T_BOARD_CHECKERS: //
-		found = do_view_chess(c, view, gray, rgb);
-		break;
+		return detect_chess(c, view, gray);
 #ifdef SB_CHEESBOARD_CORNERS_SUPPORTED
 	case T_BOARD_SB_CHECKERS: //
-		found = do_view_sb_checkers(c, view, gray, rgb);
-		break;
+		return detect_sb_checkers(c, view, gray);
 #endif
 	case T_BOARD_CIRCLES: //
-		found = do_view_circles(c, view, gray, rgb);
-		break;
+		return detect_circles(c, view, gray);
 	case T_BOARD_ASYMMETRIC_CIRCLES: //
-		found = do_view_circles(c, view, gray, rgb);
-		break;
-	default: assert(false);
+		return detect_circles(c, view, gray);
+	default: assert(false); return false;
 	}
+}
+
+static bool
+do_view(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
+{
+	bool found = detect_view(c, view, gray);
+
+	do_view_coverage(c, view, gray, rgb, found);
 
 	if (c.mirror_rgb_image) {
 		cv::flip(rgb, rgb, +1);
@@ -434,6 +548,27 @@ do_view(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rg
 	return found;
 }
 
+/*!
+ * One view of a stereo frame, run on the worker pool.
+ */
+struct ViewTask
+{
+	class Calibration *c;
+	struct ViewState *view;
+	cv::Mat *gray;
+	cv::Mat *rgb;
+
+	bool found;
+};
+
+static void
+view_task_func(void *ptr)
+{
+	struct ViewTask &t = *(struct ViewTask *)ptr;
+
+	t.found = do_view(*t.c, *t.view, *t.gray, *t.rgb);
+}
+
 static void
 remap_view(class Calibration &c, struct ViewState &view, cv::Mat &rgb)
 {
@@ -990,8 +1125,25 @@ make_calibration_frame_sbs(class Calibration &c)
 	cv::Mat l_rgb(rows, cols, CV_8UC3, c.gui.frame->data, c.gui.frame->stride);
 	cv::Mat r_rgb(rows, cols, CV_8UC3, c.gui.frame->data + 3 * cols, c.gui.frame->stride);
 
-	bool found_left = do_view(c, c.state.view[0], l_gray, l_rgb);
-	bool found_right = do_view(c, c.state.view[1], r_gray, r_rgb);
+	struct ViewTask tasks[2] = {
+	    {&c, &c.state.view[0], &l_gray, &l_rgb, false},
+	    {&c, &c.state.view[1], &r_gray, &r_rgb, false},
+	};
+
+	// The views only share the frames, and then disjoint parts of them.
+	if (c.group != nullptr) {
+		u_worker_group_push(c.group, view_task_func, &tasks[0]);
+		u_worker_group_push(c.group, view_task_func, &tasks[1]);
+
+		// Helps out with the tasks.
+		u_worker_group_wait_all(c.group);
+	} else {
+		view_task_func(&tasks[0]);
+		view_task_func(&tasks[1]);
+	}
+
+	bool found_left = tasks[0].found;
+	bool found_right = tasks[1].found;
 
 	do_capture_logic_stereo(c, gray, rgb, found_left, c.state.view[0], l_gray, l_rgb, found_right, c.state.view[1],
 	                        r_gray, r_rgb);
@@ -1194,6 +1346,323 @@ process_load_image(class Calibration &c, struct xrt_frame *xf)
 }
 
 
+/*
+ *
+ * Setup functions.
+ *
+ */
+
+static bool
+check_params(const struct t_calibration_params *params)
+{
+#ifndef SB_CHEESBOARD_CORNERS_SUPPORTED
+	if (params->pattern == T_BOARD_SB_CHECKERS) {
+		U_LOG_E("OpenCV %u.%u doesn't support SB chessboard!", CV_MAJOR_VERSION, CV_MINOR_VERSION);
+		return false;
+	}
+#endif
+#ifndef SB_CHEESBOARD_CORNERS_MARKER_SUPPORTED
+	if (params->pattern == T_BOARD_SB_CHECKERS && params->sb_checkers.marker) {
+		U_LOG_W("OpenCV %u.%u doesn't support SB chessboard marker option!", CV_MAJOR_VERSION,
+		        CV_MINOR_VERSION);
+	}
+#endif
+
+	return true;
+}
+
+static void
+setup_from_params(class Calibration &c, const struct t_calibration_params *params)
+{
+	// Copy the parameters.
+	c.use_fisheye = params->use_fisheye;
+	c.stereo_sbs = params->stereo_sbs;
+	c.board.pattern = params->pattern;
+	switch (params->pattern) {
+	case T_BOARD_CHECKERS:
+		c.board.dims = {
+		    params->checkers.cols - 1,
+		    params->checkers.rows - 1,
+		};
+		c.board.spacing_meters = params->checkers.size_meters;
+		c.subpixel_enable = params->checkers.subpixel_enable;
+		c.subpixel_size = params->checkers.subpixel_size;
+		break;
+	case T_BOARD_SB_CHECKERS:
+		c.board.dims = {
+		    params->sb_checkers.cols,
+		    params->sb_checkers.rows,
+		};
+		c.board.spacing_meters = params->sb_checkers.size_meters;
+		c.board.marker = params->sb_checkers.marker;
+		c.board.normalize_image = params->sb_checkers.normalize_image;
+		break;
+	case T_BOARD_CIRCLES:
+		c.board.dims = {
+		    params->circles.cols,
+		    params->circles.rows,
+		};
+		c.board.spacing_meters = params->circles.distance_meters;
+		break;
+	case T_BOARD_ASYMMETRIC_CIRCLES:
+		c.board.dims = {
+		    params->asymmetric_circles.cols,
+		    params->asymmetric_circles.rows,
+		};
+		c.board.spacing_meters = params->asymmetric_circles.diagonal_distance_meters;
+		break;
+	default: assert(false);
+	}
+	c.num_cooldown_frames = params->num_cooldown_frames;
+	c.num_wait_for = params->num_wait_for;
+	c.num_collect_total = params->num_collect_total;
+	c.num_collect_restart = params->num_collect_restart;
+	c.load.enabled = params->load.enabled;
+	c.load.num_images = params->load.num_images;
+	c.mirror_rgb_image = params->mirror_rgb_image;
+	c.save_images = params->save_images;
+	c.multi_scale = debug_get_bool_option_multi_scale();
+
+	// Build the board model.
+	build_board_position(c);
+
+	// Pre allocate
+	c.state.view[0].current_f32.reserve(c.board.model_f32.size());
+	c.state.view[0].current_f64.reserve(c.board.model_f64.size());
+	c.state.view[1].current_f32.reserve(c.board.model_f32.size());
+	c.state.view[1].current_f64.reserve(c.board.model_f64.size());
+}
+
+
+/*
+ *
+ * Batch calibration.
+ *
+ */
+
+/*!
+ * A stereo pair loaded from disk, either two files or one side by side file.
+ */
+struct BatchSample
+{
+	std::string path[2] = {};
+
+	bool found = false;
+	cv::Size size = {};
+	ViewState view[2] = {};
+};
+
+/*!
+ * A range of samples that is processed by one task on the worker pool.
+ */
+struct BatchTask
+{
+	const class Calibration *c;
+	std::vector<BatchSample> *samples;
+	size_t begin;
+	size_t end;
+};
+
+static bool
+is_image_file(const std::filesystem::path &path)
+{
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+	return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".pgm" || ext == ".bmp";
+}
+
+//! Sorted file names of all images in @p dir.
+static std::vector<std::string>
+list_images(const std::filesystem::path &dir)
+{
+	std::vector<std::string> names;
+	std::error_code ec;
+
+	for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+		if (entry.is_regular_file(ec) && is_image_file(entry.path())) {
+			names.push_back(entry.path().filename().string());
+		}
+	}
+
+	std::sort(names.begin(), names.end());
+
+	return names;
+}
+
+static void
+batch_gather_samples(const char *path, std::vector<BatchSample> &out_samples)
+{
+	std::filesystem::path root(path);
+	std::filesystem::path cam0 = root / "mav0" / "cam0" / "data";
+	std::filesystem::path cam1 = root / "mav0" / "cam1" / "data";
+	std::error_code ec;
+
+	// Not a EuRoC dataset, treat it as a directory of side by side images.
+	if (!std::filesystem::is_directory(cam0, ec) || !std::filesystem::is_directory(cam1, ec)) {
+		for (const std::string &name : list_images(root)) {
+			BatchSample sample = {};
+			sample.path[0] = (root / name).string();
+			out_samples.push_back(std::move(sample));
+		}
+		return;
+	}
+
+	// The file names are timestamps, only use pairs found in both cameras.
+	std::vector<std::string> left = list_images(cam0);
+	std::vector<std::string> right = list_images(cam1);
+	std::vector<std::string> both;
+	std::set_intersection(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(both));
+
+	for (const std::string &name : both) {
+		BatchSample sample = {};
+		sample.path[0] = (cam0 / name).string();
+		sample.path[1] = (cam1 / name).string();
+		out_samples.push_back(std::move(sample));
+	}
+}
+
+static void
+batch_detect_sample(const class Calibration &c, struct BatchSample &s)
+{
+	cv::Mat l_gray;
+	cv::Mat r_gray;
+
+	if (s.path[1].empty()) {
+		cv::Mat gray = cv::imread(s.path[0], cv::IMREAD_GRAYSCALE);
+		if (gray.empty()) {
+			U_LOG_E("Could not load image '%s'!", s.path[0].c_str());
+			return;
+		}
+
+		// Split left and right eyes, don't make any copies.
+		int cols = gray.cols / 2;
+		l_gray = gray(cv::Rect(0, 0, cols, gray.rows));
+		r_gray = gray(cv::Rect(cols, 0, cols, gray.rows));
+	} else {
+		l_gray = cv::imread(s.path[0], cv::IMREAD_GRAYSCALE);
+		r_gray = cv::imread(s.path[1], cv::IMREAD_GRAYSCALE);
+		if (l_gray.empty() || r_gray.empty()) {
+			U_LOG_E("Could not load images '%s' and '%s'!", s.path[0].c_str(), s.path[1].c_str());
+			return;
+		}
+
+		if (l_gray.size() != r_gray.size()) {
+			U_LOG_E("Image sizes of '%s' and '%s' do not match!", s.path[0].c_str(), s.path[1].c_str());
+			return;
+		}
+	}
+
+	s.size = l_gray.size();
+
+	// No need to look at the right image if the left doesn't have the board.
+	s.found = detect_view(c, s.view[0], l_gray) && detect_view(c, s.view[1], r_gray);
+}
+
+static void
+batch_task_func(void *ptr)
+{
+	struct BatchTask &t = *(struct BatchTask *)ptr;
+
+	for (size_t i = t.begin; i < t.end; i++) {
+		batch_detect_sample(*t.c, (*t.samples)[i]);
+	}
+}
+
+static void
+batch_detect_parallel(const class Calibration &c, std::vector<BatchSample> &samples)
+{
+	uint32_t thread_count = std::thread::hardware_concurrency();
+	thread_count = std::clamp(thread_count, 1u, (uint32_t)BATCH_MAX_THREAD_COUNT);
+
+	size_t task_count = std::min(samples.size(), (size_t)thread_count * BATCH_TASKS_PER_THREAD);
+
+	U_LOG_I("Looking for the board in %zu images using %u threads.", samples.size(), thread_count);
+
+	struct u_worker_thread_pool *pool = u_worker_thread_pool_create(thread_count - 1, thread_count, "Calibration");
+	if (pool == NULL) {
+		struct BatchTask task = {&c, &samples, 0, samples.size()};
+		batch_task_func(&task);
+		return;
+	}
+
+	struct u_worker_group *group = u_worker_group_create(pool);
+
+	std::vector<BatchTask> tasks(task_count);
+	for (size_t i = 0; i < task_count; i++) {
+		tasks[i].c = &c;
+		tasks[i].samples = &samples;
+		tasks[i].begin = (samples.size() * i) / task_count;
+		tasks[i].end = (samples.size() * (i + 1)) / task_count;
+
+		u_worker_group_push(group, batch_task_func, &tasks[i]);
+	}
+
+	// Helps out with the tasks.
+	u_worker_group_wait_all(group);
+
+	u_worker_group_reference(&group, NULL);
+	u_worker_thread_pool_reference(&pool, NULL);
+}
+
+/*!
+ * Picks which of the samples to calibrate from and pushes them to the state,
+ * returns the image size of them.
+ */
+static cv::Size
+batch_collect_samples(class Calibration &c, std::vector<BatchSample> &samples)
+{
+	cv::Size image_size = {};
+	std::vector<size_t> usable;
+
+	for (size_t i = 0; i < samples.size(); i++) {
+		BatchSample &s = samples[i];
+		if (!s.found) {
+			continue;
+		}
+
+		if (image_size.empty()) {
+			image_size = s.size;
+		} else if (s.size != image_size) {
+			U_LOG_W("Skipping '%s', size does not match the first image.", s.path[0].c_str());
+			continue;
+		}
+
+		// A board that is standing still adds nothing but solver time.
+		if (!usable.empty() &&
+		    !has_measurement_moved(samples[usable.back()].view[0].current_f64, s.view[0].current_f64)) {
+			continue;
+		}
+
+		usable.push_back(i);
+	}
+
+	U_LOG_I("Found the board in %zu of %zu images.", usable.size(), samples.size());
+
+	// Spread the samples evenly over the whole set.
+	size_t count = usable.size();
+	if (c.num_collect_total > 0) {
+		count = std::min(count, (size_t)c.num_collect_total);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		BatchSample &s = samples[usable[(i * usable.size()) / count]];
+
+		for (int v = 0; v < 2; v++) {
+			ViewState &view = c.state.view[v];
+			view.current_f32 = s.view[v].current_f32;
+			view.current_f64 = s.view[v].current_f64;
+			view.current_bounds = cv::boundingRect(view.current_f32);
+			push_measurement(view);
+		}
+
+		push_model(c);
+	}
+
+	return image_size;
+}
+
+
 /*
  *
  * Interface functions.
@@ -1242,6 +1711,24 @@ t_calibration_frame(struct xrt_frame_sink *xsink, struct xrt_frame *xf)
 }
 
 
+extern "C" void
+t_calibration_node_break_apart(struct xrt_frame_node *node)
+{
+	// Noop
+}
+
+extern "C" void
+t_calibration_node_destroy(struct xrt_frame_node *node)
+{
+	auto *c_ptr = container_of(node, Calibration, node);
+
+	u_worker_group_reference(&c_ptr->group, NULL);
+	xrt_frame_reference(&c_ptr->gui.frame, NULL);
+
+	delete c_ptr;
+}
+
+
 /*
  *
  * Exported functions.
@@ -1255,75 +1742,31 @@ t_calibration_stereo_create(struct xrt_frame_context *xfctx,
                             struct xrt_frame_sink *gui,
                             struct xrt_frame_sink **out_sink)
 {
-#ifndef SB_CHEESBOARD_CORNERS_SUPPORTED
-	if (params->pattern == T_BOARD_SB_CHECKERS) {
-		U_LOG_E("OpenCV %u.%u doesn't support SB chessboard!", CV_MAJOR_VERSION, CV_MINOR_VERSION);
+	if (!check_params(params)) {
 		return -1;
 	}
-#endif
-#ifndef SB_CHEESBOARD_CORNERS_MARKER_SUPPORTED
-	if (params->pattern == T_BOARD_SB_CHECKERS && params->sb_checkers.marker) {
-		U_LOG_W("OpenCV %u.%u doesn't support SB chessboard marker option!", CV_MAJOR_VERSION,
-		        CV_MINOR_VERSION);
-	}
-#endif
 
 	auto &c = *(new Calibration());
 
 	// Basic setup.
 	c.gui.sink = gui;
 	c.base.push_frame = t_calibration_frame;
+	c.node.break_apart = t_calibration_node_break_apart;
+	c.node.destroy = t_calibration_node_destroy;
 	*out_sink = &c.base;
 
-	// Copy the parameters.
-	c.use_fisheye = params->use_fisheye;
-	c.stereo_sbs = params->stereo_sbs;
-	c.board.pattern = params->pattern;
-	switch (params->pattern) {
-	case T_BOARD_CHECKERS:
-		c.board.dims = {
-		    params->checkers.cols - 1,
-		    params->checkers.rows - 1,
-		};
-		c.board.spacing_meters = params->checkers.size_meters;
-		c.subpixel_enable = params->checkers.subpixel_enable;
-		c.subpixel_size = params->checkers.subpixel_size;
-		break;
-	case T_BOARD_SB_CHECKERS:
-		c.board.dims = {
-		    params->sb_checkers.cols,
-		    params->sb_checkers.rows,
-		};
-		c.board.spacing_meters = params->sb_checkers.size_meters;
-		c.board.marker = params->sb_checkers.marker;
-		c.board.normalize_image = params->sb_checkers.normalize_image;
-		break;
-	case T_BOARD_CIRCLES:
-		c.board.dims = {
-		    params->circles.cols,
-		    params->circles.rows,
-		};
-		c.board.spacing_meters = params->circles.distance_meters;
-		break;
-	case T_BOARD_ASYMMETRIC_CIRCLES:
-		c.board.dims = {
-		    params->asymmetric_circles.cols,
-		    params->asymmetric_circles.rows,
-		};
-		c.board.spacing_meters = params->asymmetric_circles.diagonal_distance_meters;
-		break;
-	default: assert(false);
-	}
-	c.num_cooldown_frames = params->num_cooldown_frames;
-	c.num_wait_for = params->num_wait_for;
-	c.num_collect_total = params->num_collect_total;
-	c.num_collect_restart = params->num_collect_restart;
-	c.load.enabled = params->load.enabled;
-	c.load.num_images = params->load.num_images;
-	c.mirror_rgb_image = params->mirror_rgb_image;
-	c.save_images = params->save_images;
+	setup_from_params(c, params);
 	c.status = status;
 
+	// One extra thread, the sink thread helps out with the other view.
+	struct u_worker_thread_pool *pool = u_worker_thread_pool_create(1, 1, "Calibration");
+	if (pool != NULL) {
+		c.group = u_worker_group_create(pool);
+		u_worker_thread_pool_reference(&pool, NULL);
+	}
+
+	xrt_frame_context_add(xfctx, &c.node);
+
 
 	// Setup a initial message.
 	P("Waiting for camera");
@@ -1345,16 +1788,6 @@ t_calibration_stereo_create(struct xrt_frame_context *xfctx,
 	// Ensure we only get rgb, yuv, yuyv, uyvy or l8 frames.
 	u_sink_create_to_rgb_yuv_yuyv_uyvy_or_l8(xfctx, *out_sink, out_sink);
 
-
-	// Build the board model.
-	build_board_position(c);
-
-	// Pre allocate
-	c.state.view[0].current_f32.reserve(c.board.model_f32.size());
-	c.state.view[0].current_f64.reserve(c.board.model_f64.size());
-	c.state.view[1].current_f32.reserve(c.board.model_f32.size());
-	c.state.view[1].current_f64.reserve(c.board.model_f64.size());
-
 #if 0
 	c.state.view[0].measured = (ArrayOfMeasurements){
 	};
@@ -1372,6 +1805,44 @@ t_calibration_stereo_create(struct xrt_frame_context *xfctx,
 	return ret;
 }
 
+extern "C" int
+t_calibration_stereo_batch(const struct t_calibration_params *params,
+                           const char *path,
+                           struct t_stereo_camera_calibration **out_data)
+{
+	if (!check_params(params)) {
+		return -1;
+	}
+
+	Calibration c;
+	struct t_calibration_status status = {};
+
+	setup_from_params(c, params);
+	c.status = &status;
+
+	std::vector<BatchSample> samples;
+	batch_gather_samples(path, samples);
+	if (samples.empty()) {
+		U_LOG_E("No images found in '%s'!", path);
+		return -1;
+	}
+
+	batch_detect_parallel(c, samples);
+
+	cv::Size image_size = batch_collect_samples(c, samples);
+	if (c.state.board_models_f32.size() < 2) {
+		U_LOG_E("Need the board in at least two different positions to calibrate!");
+		return -1;
+	}
+
+	process_stereo_samples(c, image_size.width, image_size.height);
+
+	t_stereo_camera_calibration_reference(out_data, status.stereo_data);
+	t_stereo_camera_calibration_reference(&status.stereo_data, NULL);
+
+	return 0;
+}
+
 //! Helper for NormalizedCoordsCache constructors
 static inline std::vector<cv::Vec2f>
 generateInputCoordsAndReserveOutputCoords(const cv::Size &size, std::vector<cv::Vec2f> &outputCoords)
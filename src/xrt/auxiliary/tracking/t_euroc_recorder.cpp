@@ -9,36 +9,106 @@
 
 #include "t_euroc_recorder.h"
 
+#include "xrt/xrt_config_os.h"
 #include "os/os_time.h"
 #include "util/u_frame.h"
-#include "util/u_sink.h"
+#include "util/u_frame_pool.h"
 #include "util/u_var.h"
 #include "util/u_debug.h"
 #include "xrt/xrt_defines.h"
 #include "xrt/xrt_tracking.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <queue>
 #include <iomanip>
 
+#ifdef XRT_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <opencv2/imgcodecs.hpp>
 
 DEBUG_GET_ONCE_BOOL_OPTION(euroc_recorder_use_jpg, "EUROC_RECORDER_USE_JPG", false)
-
+DEBUG_GET_ONCE_BOOL_OPTION(euroc_recorder_raw, "EUROC_RECORDER_RAW", false)
+DEBUG_GET_ONCE_NUM_OPTION(euroc_recorder_raw_prealloc_mb, "EUROC_RECORDER_RAW_PREALLOC_MB", 1024)
+DEBUG_GET_ONCE_NUM_OPTION(euroc_recorder_threads, "EUROC_RECORDER_THREADS", 2)
+DEBUG_GET_ONCE_NUM_OPTION(euroc_recorder_queue_size, "EUROC_RECORDER_QUEUE_SIZE", 32)
+DEBUG_GET_ONCE_OPTION(euroc_recorder_queue_policy, "EUROC_RECORDER_QUEUE_POLICY", "drop")
+
+using std::condition_variable;
+using std::deque;
 using std::lock_guard;
 using std::mutex;
 using std::ofstream;
 using std::queue;
 using std::string;
 using std::to_string;
+using std::unique_lock;
 using std::vector;
 using std::filesystem::create_directories;
 
+//! What to do with a new frame when the write queue is full
+enum euroc_recorder_queue_policy
+{
+	EUROC_RECORDER_QUEUE_DROP = 0, //!< Drop the new frame, the pushing thread never waits
+	EUROC_RECORDER_QUEUE_BLOCK,    //!< Wait for space, slows down the pushing thread instead of losing frames
+	EUROC_RECORDER_QUEUE_POLICY_COUNT,
+};
+
+//! Magic at the start of each frame record in a raw `data.raw` file
+#define EUROC_RAW_MAGIC 0x57415245 // "ERAW"
+
+/*!
+ * Header in front of each frame in a raw `data.raw` file, the frame data
+ * follows it with `stride * height` bytes.
+ */
+struct euroc_recorder_raw_header
+{
+	uint32_t magic;
+	uint32_t format; //!< An @ref xrt_format
+	uint32_t width;
+	uint32_t height;
+	uint64_t stride;
+	int64_t timestamp;
+};
+
+//! A frame waiting to be written to disk
+struct euroc_recorder_job
+{
+	struct xrt_frame *frame;
+	int cam_index;
+	uint64_t seq; //!< Which @ref euroc_recorder_cam_row this frame belongs to
+};
+
+//! A row of a cams csv file, only written out once its frame has been written
+struct euroc_recorder_cam_row
+{
+	timepoint_ns timestamp;
+	bool done;    //!< The writer is done with the frame
+	bool written; //!< The frame made it to disk, otherwise the row is skipped
+};
+
+//! Raw frame file of a single camera
+struct euroc_recorder_raw_file
+{
+	mutex lock{};
+	FILE *file = nullptr;
+	uint64_t used = 0; //!< Bytes written, the file might be bigger due to preallocation
+};
+
 struct euroc_recorder
 {
 	struct xrt_frame_node node;
@@ -50,44 +120,132 @@ struct euroc_recorder
 	struct u_var_button recording_btn; //!< UI button to start/stop `recording`
 
 	bool use_jpg; //! Whether or not we should save images as .jpg files
+	bool use_raw; //! Dump frames uncompressed into a single file per camera instead, see @ref euroc_recorder_convert_raw
 
-	// Cloner sinks: copy frame to heap for quick release of the original
-	struct xrt_slam_sinks cloner_queues; //!< Queue sinks that write into cloner sinks
-	struct xrt_imu_sink cloner_imu_sink;
-	struct xrt_pose_sink cloner_gt_sink;
-	struct xrt_frame_sink cloner_sinks[XRT_TRACKING_MAX_SLAM_CAMS];
+	// Public sinks: copy frames into the write queue for quick release of the original
+	struct xrt_slam_sinks public_sinks;
+	struct xrt_imu_sink receive_imu_sink;
+	struct xrt_pose_sink receive_gt_sink;
+	struct xrt_frame_sink receive_sinks[XRT_TRACKING_MAX_SLAM_CAMS];
 
-	// Writer sinks: write copied frame to disk
-	struct xrt_slam_sinks writer_queues; //!< Queue sinks that write into writer sinks
-	struct xrt_imu_sink writer_imu_sink;
-	struct xrt_pose_sink writer_gt_sink;
-	struct xrt_frame_sink writer_sinks[XRT_TRACKING_MAX_SLAM_CAMS];
+	//! Copies are taken from here to avoid an allocation per frame
+	struct u_frame_pool *pools[XRT_TRACKING_MAX_SLAM_CAMS];
 
-	queue<xrt_imu_sample> imu_queue{}; //!< IMU pushes get saved here and are delayed until left_frame pushes
+	// Bounded write queue, frames are copied in and written by the writer threads
+	struct
+	{
+		mutex lock{};
+		condition_variable job_cv{};   //!< Signaled when a job is queued or on stop
+		condition_variable space_cv{}; //!< Signaled when a job is taken or finished
+		deque<euroc_recorder_job> jobs{};
+		int in_flight = 0; //!< Jobs taken by writer threads but not yet finished
+		bool stop = false;
+		vector<std::thread> threads{};
+
+		int max_size = 0;                      //!< Max jobs waiting
+		int policy = EUROC_RECORDER_QUEUE_DROP; //!< An @ref euroc_recorder_queue_policy
+		struct u_var_combo policy_combo = {};  //!< UI combo box to select `policy`
+
+		uint64_t queued = 0;     //!< Frames accepted into the queue
+		uint64_t written = 0;    //!< Frames written to disk
+		uint64_t dropped = 0;    //!< Frames dropped due to a full queue
+		uint64_t failed = 0;     //!< Frames that could not be written
+		int32_t depth = 0;       //!< Current jobs waiting
+		int32_t peak_depth = 0;  //!< Max jobs waiting at once
+		uint64_t blocked_ns = 0; //!< Time pushers spent waiting for space
+	} writes;
+
+	queue<xrt_imu_sample> imu_queue{}; //!< IMU pushes get saved here and are delayed until a writer flushes
 	mutex imu_queue_lock{};            //!< Lock for imu_queue
 
-	queue<xrt_pose_sample> gt_queue{}; //!< GT pushes get saved here and are delayed until left_frame pushes
+	queue<xrt_pose_sample> gt_queue{}; //!< GT pushes get saved here and are delayed until a writer flushes
 	mutex gt_queue_lock{};             //!< Lock for gt_queue
 
+	//! Rows of accepted frames per camera in order, written to the cams csv files when a writer flushes
+	deque<euroc_recorder_cam_row> cam_rows[XRT_TRACKING_MAX_SLAM_CAMS]{};
+	uint64_t cam_rows_first_seq[XRT_TRACKING_MAX_SLAM_CAMS]{}; //!< Sequence number of the front of cam_rows
+	mutex cam_rows_lock{};                                     //!< Lock for cam_rows and cam_rows_first_seq
+
+	//! Held by whoever writes to the csv files below, only writer threads and start/stop
+	mutex csv_lock{};
+
 	// CSV file handles, ofstream implementation is already buffered.
 	// Using pointers because of `container_of`
 	ofstream *imu_csv = nullptr;
 	ofstream *gt_csv = nullptr;
 	ofstream *cams_csv[XRT_TRACKING_MAX_SLAM_CAMS] = {};
+
+	//! Only used in raw mode
+	euroc_recorder_raw_file raw_files[XRT_TRACKING_MAX_SLAM_CAMS];
 };
 
 
 /*
  *
- * Writer sinks functionality
+ * Writer functionality
  *
  */
 
+static string
+euroc_recorder_cam_filename(bool use_jpg, timepoint_ns ts)
+{
+	return to_string(ts) + (use_jpg ? ".jpg" : ".png");
+}
+
+static void
+euroc_recorder_close_raw(struct euroc_recorder *er)
+{
+	for (int i = 0; i < er->cam_count; i++) {
+		euroc_recorder_raw_file &raw = er->raw_files[i];
+		if (raw.file == nullptr) {
+			continue;
+		}
+
+#ifdef XRT_OS_LINUX
+		// Give back what was preallocated but not used.
+		(void)fflush(raw.file);
+		(void)!ftruncate(fileno(raw.file), (off_t)raw.used);
+#endif
+		(void)fclose(raw.file);
+		raw.file = nullptr;
+		raw.used = 0;
+	}
+}
+
+static void
+euroc_recorder_open_raw(struct euroc_recorder *er, int cam_index, const string &path)
+{
+	euroc_recorder_raw_file &raw = er->raw_files[cam_index];
+
+	raw.file = fopen(path.c_str(), "wb");
+	raw.used = 0;
+	if (raw.file == nullptr) {
+		U_LOG_E("Unable to open '%s' for writing", path.c_str());
+		return;
+	}
+
+#ifdef XRT_OS_LINUX
+	// Reserve space upfront so the filesystem doesn't need to grow the file for every frame.
+	off_t prealloc = (off_t)debug_get_num_option_euroc_recorder_raw_prealloc_mb() << 20;
+	if (prealloc > 0 && posix_fallocate(fileno(raw.file), 0, prealloc) != 0) {
+		U_LOG_W("Unable to preallocate %" PRId64 " bytes for '%s'", (int64_t)prealloc, path.c_str());
+	}
+#endif
+}
+
 static void
 euroc_recorder_mkfiles(struct euroc_recorder *er)
 {
 	string path = er->path;
 
+	lock_guard csv_lock{er->csv_lock};
+
+	delete er->imu_csv;
+	delete er->gt_csv;
+	for (int i = 0; i < er->cam_count; i++) {
+		delete er->cams_csv[i];
+	}
+
 	create_directories(path + "/mav0/imu0");
 	er->imu_csv = new ofstream{path + "/mav0/imu0/data.csv"};
 	*er->imu_csv << std::fixed << std::setprecision(CSV_PRECISION);
@@ -105,12 +263,45 @@ euroc_recorder_mkfiles(struct euroc_recorder *er)
 		create_directories(data_path);
 		er->cams_csv[i] = new ofstream{data_path + ".csv"};
 		*er->cams_csv[i] << "#timestamp [ns],filename" CSV_EOL;
+
+		if (er->use_raw) {
+			euroc_recorder_open_raw(er, i, data_path + ".raw");
+		}
 	}
 }
 
+static void
+euroc_recorder_save_imu(struct euroc_recorder *er, struct xrt_imu_sample *sample)
+{
+	timepoint_ns ts = sample->timestamp_ns;
+	xrt_vec3_f64 a = sample->accel_m_s2;
+	xrt_vec3_f64 w = sample->gyro_rad_secs;
+
+	*er->imu_csv << ts << ",";
+	*er->imu_csv << w.x << "," << w.y << "," << w.z << ",";
+	*er->imu_csv << a.x << "," << a.y << "," << a.z << CSV_EOL;
+}
+
+static void
+euroc_recorder_save_gt(struct euroc_recorder *er, struct xrt_pose_sample *sample)
+{
+	timepoint_ns ts = sample->timestamp_ns;
+	xrt_vec3 p = sample->pose.position;
+	xrt_quat o = sample->pose.orientation;
+
+	*er->gt_csv << ts << ",";
+	*er->gt_csv << p.x << "," << p.y << "," << p.z << ",";
+	*er->gt_csv << o.w << "," << o.x << "," << o.y << "," << o.z << CSV_EOL;
+}
+
+//! Write out everything queued for the csv files, must hold `csv_lock`
 static void
 euroc_recorder_flush(struct euroc_recorder *er)
 {
+	if (er->imu_csv == nullptr) {
+		return; // Never started
+	}
+
 	// Flush IMU samples
 	vector<xrt_imu_sample> imu_samples;
 
@@ -125,7 +316,7 @@ euroc_recorder_flush(struct euroc_recorder *er)
 
 	// Write queued IMU samples to csv stream.
 	for (xrt_imu_sample &sample : imu_samples) {
-		xrt_sink_push_imu(&er->writer_imu_sink, &sample);
+		euroc_recorder_save_imu(er, &sample);
 	}
 
 	// Flush groundtruth samples
@@ -142,7 +333,32 @@ euroc_recorder_flush(struct euroc_recorder *er)
 
 	// Write queued gt samples to csv stream.
 	for (xrt_pose_sample &sample : gt_samples) {
-		xrt_sink_push_pose(&er->writer_gt_sink, &sample);
+		euroc_recorder_save_gt(er, &sample);
+	}
+
+	// Camera rows are in the order the frames were accepted, not written, so
+	// stop at the first frame still being written. Failed frames get no row.
+	vector<timepoint_ns> cam_ts[XRT_TRACKING_MAX_SLAM_CAMS];
+	{
+		lock_guard lock{er->cam_rows_lock};
+		for (int i = 0; i < er->cam_count; i++) {
+			deque<euroc_recorder_cam_row> &rows = er->cam_rows[i];
+			while (!rows.empty() && rows.front().done) {
+				if (rows.front().written) {
+					cam_ts[i].push_back(rows.front().timestamp);
+				}
+				rows.pop_front();
+				er->cam_rows_first_seq[i]++;
+			}
+		}
+	}
+
+	// Raw frames get converted to png files later.
+	bool use_jpg = er->use_jpg && !er->use_raw;
+	for (int i = 0; i < er->cam_count; i++) {
+		for (timepoint_ns ts : cam_ts[i]) {
+			*er->cams_csv[i] << ts << "," << euroc_recorder_cam_filename(use_jpg, ts) << CSV_EOL;
+		}
 	}
 
 	// Flush csv streams. Not necessary, doing it only to increase flush frequency
@@ -153,82 +369,122 @@ euroc_recorder_flush(struct euroc_recorder *er)
 	}
 }
 
-extern "C" void
-euroc_recorder_save_imu(xrt_imu_sink *sink, struct xrt_imu_sample *sample)
+static bool
+euroc_recorder_save_frame_raw(euroc_recorder *er, struct xrt_frame *frame, int cam_index)
 {
-	euroc_recorder *er = container_of(sink, euroc_recorder, writer_imu_sink);
+	euroc_recorder_raw_file &raw = er->raw_files[cam_index];
 
-	timepoint_ns ts = sample->timestamp_ns;
-	xrt_vec3_f64 a = sample->accel_m_s2;
-	xrt_vec3_f64 w = sample->gyro_rad_secs;
+	euroc_recorder_raw_header header = {};
+	header.magic = EUROC_RAW_MAGIC;
+	header.format = frame->format;
+	header.width = frame->width;
+	header.height = frame->height;
+	header.stride = frame->stride;
+	header.timestamp = frame->timestamp;
 
-	*er->imu_csv << ts << ",";
-	*er->imu_csv << w.x << "," << w.y << "," << w.z << ",";
-	*er->imu_csv << a.x << "," << a.y << "," << a.z << CSV_EOL;
-}
+	size_t size = frame->stride * frame->height;
 
-extern "C" void
-euroc_recorder_save_gt(xrt_pose_sink *sink, struct xrt_pose_sample *sample)
-{
-	euroc_recorder *er = container_of(sink, euroc_recorder, writer_gt_sink);
+	lock_guard lock{raw.lock};
+	if (raw.file == nullptr) {
+		return false;
+	}
 
-	timepoint_ns ts = sample->timestamp_ns;
-	xrt_vec3 p = sample->pose.position;
-	xrt_quat o = sample->pose.orientation;
+	bool ok = fwrite(&header, sizeof(header), 1, raw.file) == 1;
+	ok = ok && fwrite(frame->data, 1, size, raw.file) == size;
+	if (ok) {
+		raw.used += sizeof(header) + size;
+	}
 
-	*er->gt_csv << ts << ",";
-	*er->gt_csv << p.x << "," << p.y << "," << p.z << ",";
-	*er->gt_csv << o.w << "," << o.x << "," << o.y << "," << o.z << CSV_EOL;
+	return ok;
 }
 
-static void
-euroc_recorder_save_frame(euroc_recorder *er, struct xrt_frame *frame, int cam_index)
+static bool
+euroc_recorder_save_frame(euroc_recorder *er, struct xrt_frame *frame, int cam_index, const string &path)
 {
-	string cam_name = "cam" + to_string(cam_index);
-	uint64_t ts = frame->timestamp;
+	if (er->use_raw) {
+		return euroc_recorder_save_frame_raw(er, frame, cam_index);
+	}
 
-	assert(frame->format == XRT_FORMAT_L8 || frame->format == XRT_FORMAT_R8G8B8); // Only formats supported
 	auto img_type = frame->format == XRT_FORMAT_L8 ? CV_8UC1 : CV_8UC3;
-	string file_extension = er->use_jpg ? ".jpg" : ".png";
-	string filename = std::to_string(ts) + file_extension;
-	string img_path = er->path + "/mav0/" + cam_name + "/data/" + filename;
+	string filename = euroc_recorder_cam_filename(er->use_jpg, frame->timestamp);
+	string img_path = path + "/mav0/cam" + to_string(cam_index) + "/data/" + filename;
 	cv::Mat img{(int)frame->height, (int)frame->width, img_type, frame->data, frame->stride};
-	cv::imwrite(img_path, img);
 
-	*er->cams_csv[cam_index] << ts << "," << filename << CSV_EOL;
+	return cv::imwrite(img_path, img);
 }
 
-#define DEFINE_SAVE_CAM(cam_id)                                                                                        \
-	extern "C" void euroc_recorder_save_cam##cam_id(struct xrt_frame_sink *sink, struct xrt_frame *frame)          \
-	{                                                                                                              \
-		euroc_recorder *er = container_of(sink, euroc_recorder, writer_sinks[cam_id]);                         \
-		if (cam_id == 0) {                                                                                     \
-			euroc_recorder_flush(er);                                                                      \
-		}                                                                                                      \
-		euroc_recorder_save_frame(er, frame, cam_id);                                                          \
+static void
+euroc_recorder_writer_run(struct euroc_recorder *er)
+{
+	unique_lock lock{er->writes.lock};
+
+	while (true) {
+		er->writes.job_cv.wait(lock, [er] { return er->writes.stop || !er->writes.jobs.empty(); });
+
+		if (er->writes.jobs.empty()) {
+			break; // Stopping and everything has been written
+		}
+
+		euroc_recorder_job job = er->writes.jobs.front();
+		er->writes.jobs.pop_front();
+		er->writes.depth = (int32_t)er->writes.jobs.size();
+		er->writes.in_flight++;
+
+		// The path only changes while the queue is drained.
+		string path = er->path;
+		lock.unlock();
+
+		er->writes.space_cv.notify_all();
+
+		bool ok = euroc_recorder_save_frame(er, job.frame, job.cam_index, path);
+		xrt_frame_reference(&job.frame, NULL);
+
+		{
+			lock_guard rows_lock{er->cam_rows_lock};
+			euroc_recorder_cam_row &row =
+			    er->cam_rows[job.cam_index][job.seq - er->cam_rows_first_seq[job.cam_index]];
+			row.done = true;
+			row.written = ok;
+		}
+
+		// Whoever is not busy writing csv files picks them up, the rest move on to the next frame.
+		{
+			unique_lock csv_lock{er->csv_lock, std::try_to_lock};
+			if (csv_lock.owns_lock()) {
+				euroc_recorder_flush(er);
+			}
+		}
+
+		lock.lock();
+		er->writes.in_flight--;
+		if (ok) {
+			er->writes.written++;
+		} else {
+			er->writes.failed++;
+		}
+		er->writes.space_cv.notify_all();
 	}
+}
 
-DEFINE_SAVE_CAM(0)
-DEFINE_SAVE_CAM(1)
-DEFINE_SAVE_CAM(2)
-DEFINE_SAVE_CAM(3)
-DEFINE_SAVE_CAM(4)
+//! Wait for all queued frames to be written, new frames must not be coming in anymore
+static void
+euroc_recorder_drain(struct euroc_recorder *er)
+{
+	{
+		unique_lock lock{er->writes.lock};
+		er->writes.space_cv.wait(lock, [er] {
+			return er->writes.threads.empty() || (er->writes.jobs.empty() && er->writes.in_flight == 0);
+		});
+	}
 
-//! Be sure to define the same number of defined functions as
-//! XRT_TRACKING_MAX_SLAM_CAMS and to add them to to euroc_recorder_save_cam
-static void (*euroc_recorder_save_cam[XRT_TRACKING_MAX_SLAM_CAMS])(struct xrt_frame_sink *sink,
-                                                                   struct xrt_frame *frame) = {
-    euroc_recorder_save_cam0, //
-    euroc_recorder_save_cam1, //
-    euroc_recorder_save_cam2, //
-    euroc_recorder_save_cam3, //
-    euroc_recorder_save_cam4, //
-};
+	lock_guard csv_lock{er->csv_lock};
+	euroc_recorder_flush(er);
+}
 
 
 /*
  *
- * Cloner sinks functionality
+ * Receiver sinks functionality
  *
  */
 
@@ -237,8 +493,8 @@ euroc_recorder_receive_imu(xrt_imu_sink *sink, struct xrt_imu_sample *sample)
 {
 	// Contrary to frame sinks, we don't have separately threaded queues for IMU
 	// sinks so we use an std::queue to temporarily store IMU samples, later we
-	// write them to disk when writing left frames.
-	euroc_recorder *er = container_of(sink, euroc_recorder, cloner_imu_sink);
+	// write them to disk when a writer thread flushes.
+	euroc_recorder *er = container_of(sink, euroc_recorder, receive_imu_sink);
 
 	if (!er->recording) {
 		return;
@@ -254,7 +510,7 @@ extern "C" void
 euroc_recorder_receive_gt(xrt_pose_sink *sink, struct xrt_pose_sample *sample)
 {
 	// This works similarly to euroc_recorder_receive_imu, read its comments
-	euroc_recorder *er = container_of(sink, euroc_recorder, cloner_gt_sink);
+	euroc_recorder *er = container_of(sink, euroc_recorder, receive_gt_sink);
 
 	if (!er->recording) {
 		return;
@@ -266,6 +522,29 @@ euroc_recorder_receive_gt(xrt_pose_sink *sink, struct xrt_pose_sample *sample)
 	}
 }
 
+//! Waits for space in the queue if needed, returns false if the frame should be dropped
+static bool
+euroc_recorder_wait_for_space(euroc_recorder *er, unique_lock<mutex> &lock)
+{
+	auto has_space = [er] { return (int)er->writes.jobs.size() < er->writes.max_size; };
+
+	if (has_space()) {
+		return true;
+	}
+
+	if (er->writes.policy != EUROC_RECORDER_QUEUE_BLOCK) {
+		return false;
+	}
+
+	timepoint_ns start_ns = os_monotonic_get_ns();
+	er->writes.space_cv.wait(lock, [er, &has_space] {
+		return er->writes.stop || !er->recording || er->writes.policy != EUROC_RECORDER_QUEUE_BLOCK ||
+		       has_space();
+	});
+	er->writes.blocked_ns += os_monotonic_get_ns() - start_ns;
+
+	return !er->writes.stop && er->recording && has_space();
+}
 
 static void
 euroc_recorder_receive_frame(euroc_recorder *er, struct xrt_frame *src_frame, int cam_index)
@@ -274,19 +553,77 @@ euroc_recorder_receive_frame(euroc_recorder *er, struct xrt_frame *src_frame, in
 		return;
 	}
 
-	// Let's clone the frame so that we can release the src_frame quickly
+	assert(src_frame->format == XRT_FORMAT_L8 || src_frame->format == XRT_FORMAT_R8G8B8); // Only formats supported
+
+	// Check before copying, the copy would be wasted work. No pool means
+	// creating it failed, so there is nowhere to copy to.
+	{
+		unique_lock lock{er->writes.lock};
+		if (er->pools[cam_index] == nullptr || !euroc_recorder_wait_for_space(er, lock)) {
+			er->writes.dropped++;
+			return;
+		}
+	}
+
+	// Let's copy the frame so that we can release the src_frame quickly
 	xrt_frame *copy = nullptr;
-	u_frame_clone(src_frame, &copy);
+	u_frame_pool_get(er->pools[cam_index], src_frame->format, src_frame->width, src_frame->height, &copy);
+	if (copy == nullptr) {
+		U_LOG_E("Failed to get a frame to copy cam%d into, dropping it!", cam_index);
+		unique_lock lock{er->writes.lock};
+		er->writes.dropped++;
+		return;
+	}
 
-	xrt_sink_push_frame(er->writer_queues.cams[cam_index], copy);
+	copy->stereo_format = src_frame->stereo_format;
+	copy->timestamp = src_frame->timestamp;
+	copy->source_timestamp = src_frame->source_timestamp;
+	copy->source_sequence = src_frame->source_sequence;
+	copy->source_id = src_frame->source_id;
 
-	xrt_frame_reference(&copy, NULL);
+	size_t row_size = std::min(copy->stride, src_frame->stride);
+	for (uint32_t y = 0; y < src_frame->height; y++) {
+		memcpy(copy->data + y * copy->stride, src_frame->data + y * src_frame->stride, row_size);
+	}
+
+	{
+		unique_lock lock{er->writes.lock};
+
+		// Stopped while copying, the frame is not part of the dataset.
+		if (!er->recording) {
+			xrt_frame_reference(&copy, NULL);
+			return;
+		}
+
+		// Other cameras might have filled the queue while copying.
+		if (!euroc_recorder_wait_for_space(er, lock)) {
+			er->writes.dropped++;
+			xrt_frame_reference(&copy, NULL);
+			return;
+		}
+
+		// Keep the csv entries in the same order as the frames are accepted.
+		uint64_t seq = 0;
+		{
+			lock_guard rows_lock{er->cam_rows_lock};
+			seq = er->cam_rows_first_seq[cam_index] + er->cam_rows[cam_index].size();
+			er->cam_rows[cam_index].push_back(euroc_recorder_cam_row{copy->timestamp, false, false});
+		}
+
+		// Ownership of the reference is moved into the job.
+		er->writes.jobs.push_back(euroc_recorder_job{copy, cam_index, seq});
+		er->writes.queued++;
+		er->writes.depth = (int32_t)er->writes.jobs.size();
+		er->writes.peak_depth = std::max(er->writes.peak_depth, er->writes.depth);
+	}
+
+	er->writes.job_cv.notify_one();
 }
 
 #define DEFINE_RECEIVE_CAM(cam_id)                                                                                     \
 	extern "C" void euroc_recorder_receive_cam##cam_id(struct xrt_frame_sink *sink, struct xrt_frame *frame)       \
 	{                                                                                                              \
-		euroc_recorder *er = container_of(sink, euroc_recorder, cloner_sinks[cam_id]);                         \
+		euroc_recorder *er = container_of(sink, euroc_recorder, receive_sinks[cam_id]);                        \
 		euroc_recorder_receive_frame(er, frame, cam_id);                                                       \
 	}
 
@@ -316,16 +653,43 @@ static void (*euroc_recorder_receive_cam[XRT_TRACKING_MAX_SLAM_CAMS])(struct xrt
 
 extern "C" void
 euroc_recorder_node_break_apart(struct xrt_frame_node *node)
-{}
+{
+	struct euroc_recorder *er = container_of(node, struct euroc_recorder, node);
+
+	// Write out what is still queued.
+	if (er->recording) {
+		euroc_recorder_stop(&er->public_sinks);
+	}
+
+	{
+		lock_guard lock{er->writes.lock};
+		er->writes.stop = true;
+	}
+	er->writes.job_cv.notify_all();
+	er->writes.space_cv.notify_all();
+
+	for (std::thread &t : er->writes.threads) {
+		t.join();
+	}
+	er->writes.threads.clear();
+
+	// Only left over if no writer threads could be started.
+	for (euroc_recorder_job &job : er->writes.jobs) {
+		xrt_frame_reference(&job.frame, NULL);
+	}
+	er->writes.jobs.clear();
+}
 
 extern "C" void
 euroc_recorder_node_destroy(struct xrt_frame_node *node)
 {
 	struct euroc_recorder *er = container_of(node, struct euroc_recorder, node);
+	euroc_recorder_close_raw(er);
 	delete er->imu_csv;
 	delete er->gt_csv;
 	for (int i = 0; i < er->cam_count; i++) {
 		delete er->cams_csv[i];
+		u_frame_pool_destroy(&er->pools[i]);
 	}
 	delete er;
 }
@@ -352,41 +716,49 @@ euroc_recorder_create(struct xrt_frame_context *xfctx, const char *record_path,
 	xrt_frame_context_add(xfctx, xfn);
 
 	er->use_jpg = debug_get_bool_option_euroc_recorder_use_jpg();
+	er->use_raw = debug_get_bool_option_euroc_recorder_raw();
+
+	const char *policy = debug_get_option_euroc_recorder_queue_policy();
+	er->writes.policy = strcmp(policy, "block") == 0 ? EUROC_RECORDER_QUEUE_BLOCK : EUROC_RECORDER_QUEUE_DROP;
+	er->writes.policy_combo.count = EUROC_RECORDER_QUEUE_POLICY_COUNT;
+	er->writes.policy_combo.options = "Drop new frames\0Block pushing thread\0\0";
+	er->writes.policy_combo.value = &er->writes.policy;
+	er->writes.max_size = std::max((int)debug_get_num_option_euroc_recorder_queue_size(), 1);
 
 	// Setup sink pipeline
 
-	// We expose a "cloner" sink that will clone frames in memory so that original
-	// frames can be released as soon as possible. Not doing this could result in
-	// frame queues from the user being filled up. After that we write to disk. We
-	// also put queues between these to support sensors streaming on different
-	// threads.
-	// cloner_queue -> cloner_sink (clone ) -> writer_queue -> writer_sink (write to disk)
+	// We expose sinks that copy frames into a bounded queue so that original
+	// frames can be released as soon as possible. Not doing this could result
+	// in frame queues from the user being filled up. A pool of writer threads
+	// then write the frames to disk, what happens when they fall behind is
+	// decided by the queue policy.
+	// receive_sink (copy) -> bounded queue -> writer threads (write to disk)
 
-	er->cloner_queues.cam_count = er->cam_count;
-	er->writer_queues.cam_count = er->cam_count;
+	er->public_sinks.cam_count = er->cam_count;
 	for (int i = 0; i < er->cam_count; i++) {
 
-		// If any of these asserts failed see docs on euroc_recorder_receive/save_cam
+		// If this assert failed see docs on euroc_recorder_receive_cam
 		assert(euroc_recorder_receive_cam[ARRAY_SIZE(euroc_recorder_receive_cam) - 1] != nullptr);
-		assert(euroc_recorder_save_cam[ARRAY_SIZE(euroc_recorder_save_cam) - 1] != nullptr);
 
-		u_sink_queue_create(xfctx, 0, &er->cloner_sinks[i], &er->cloner_queues.cams[i]);
-		er->cloner_sinks[i].push_frame = euroc_recorder_receive_cam[i];
-		u_sink_queue_create(xfctx, 0, &er->writer_sinks[i], &er->writer_queues.cams[i]);
-		er->writer_sinks[i].push_frame = euroc_recorder_save_cam[i];
+		er->receive_sinks[i].push_frame = euroc_recorder_receive_cam[i];
+		er->public_sinks.cams[i] = &er->receive_sinks[i];
+		if (u_frame_pool_create(er->writes.max_size, &er->pools[i]) < 0) {
+			U_LOG_E("Failed to create frame pool for cam%d, its frames will be dropped!", i);
+		}
 	}
 
-	er->cloner_queues.imu = &er->cloner_imu_sink;
-	er->cloner_imu_sink.push_imu = euroc_recorder_receive_imu;
-	er->writer_queues.imu = nullptr; // We use a std::queue instead
-	er->writer_imu_sink.push_imu = euroc_recorder_save_imu;
+	er->public_sinks.imu = &er->receive_imu_sink;
+	er->receive_imu_sink.push_imu = euroc_recorder_receive_imu;
+
+	er->public_sinks.gt = &er->receive_gt_sink;
+	er->receive_gt_sink.push_pose = euroc_recorder_receive_gt;
 
-	er->cloner_queues.gt = &er->cloner_gt_sink;
-	er->cloner_gt_sink.push_pose = euroc_recorder_receive_gt;
-	er->writer_queues.gt = nullptr; // We use a std::queue instead
-	er->writer_gt_sink.push_pose = euroc_recorder_save_gt;
+	int thread_count = std::max((int)debug_get_num_option_euroc_recorder_threads(), 1);
+	for (int i = 0; i < thread_count; i++) {
+		er->writes.threads.emplace_back(euroc_recorder_writer_run, er);
+	}
 
-	xrt_slam_sinks *public_sinks = &er->cloner_queues;
+	xrt_slam_sinks *public_sinks = &er->public_sinks;
 
 	if (record_from_start) {
 		euroc_recorder_start(public_sinks);
@@ -398,7 +770,7 @@ euroc_recorder_create(struct xrt_frame_context *xfctx, const char *record_path,
 extern "C" void
 euroc_recorder_start(struct xrt_slam_sinks *er_sinks)
 {
-	euroc_recorder *er = container_of(er_sinks, euroc_recorder, cloner_queues);
+	euroc_recorder *er = container_of(er_sinks, euroc_recorder, public_sinks);
 
 	if (er->recording) {
 		U_LOG_W("We are already recording; unable to start.");
@@ -411,25 +783,58 @@ euroc_recorder_start(struct xrt_slam_sinks *er_sinks)
 	char datetime[size] = {0};
 	(void)strftime(datetime, size, "%Y%m%d%H%M%S", localtime(&seconds));
 	string default_path = er->path_prefix + "_" + datetime;
-	er->path = default_path;
+
+	{
+		lock_guard lock{er->writes.lock};
+		er->path = default_path;
+	}
 
 	euroc_recorder_mkfiles(er);
-	er->recording = true;
+
+	// Samples that raced with the last stop belong to no dataset.
+	{
+		lock_guard lock{er->imu_queue_lock};
+		er->imu_queue = {};
+	}
+	{
+		lock_guard lock{er->gt_queue_lock};
+		er->gt_queue = {};
+	}
+
+	{
+		lock_guard lock{er->writes.lock};
+		er->writes.peak_depth = 0;
+		er->recording = true;
+	}
 }
 
 extern "C" void
 euroc_recorder_stop(struct xrt_slam_sinks *er_sinks)
 {
-	euroc_recorder *er = container_of(er_sinks, euroc_recorder, cloner_queues);
+	euroc_recorder *er = container_of(er_sinks, euroc_recorder, public_sinks);
 
 	if (!er->recording) {
 		U_LOG_W("We are already not recording; unable to stop.");
 		return;
 	}
 
-	er->path = "";
-	er->recording = false;
-	euroc_recorder_flush(er);
+	// No more frames get queued after this, and blocked pushers give up.
+	{
+		lock_guard lock{er->writes.lock};
+		er->recording = false;
+	}
+	er->writes.space_cv.notify_all();
+
+	euroc_recorder_drain(er);
+	euroc_recorder_close_raw(er);
+
+	{
+		lock_guard lock{er->writes.lock};
+		U_LOG_I("EuRoC recording '%s' done: %" PRIu64 " frames written, %" PRIu64 " dropped, %" PRIu64
+		        " failed",
+		        er->path.c_str(), er->writes.written, er->writes.dropped, er->writes.failed);
+		er->path = "";
+	}
 }
 
 static void
@@ -438,10 +843,10 @@ euroc_recorder_btn_cb(void *ptr)
 	euroc_recorder *er = (euroc_recorder *)ptr;
 
 	if (er->recording) {
-		euroc_recorder_stop(&er->cloner_queues);
+		euroc_recorder_stop(&er->public_sinks);
 		(void)snprintf(er->recording_btn.label, sizeof(er->recording_btn.label), "Record EuRoC dataset");
 	} else {
-		euroc_recorder_start(&er->cloner_queues);
+		euroc_recorder_start(&er->public_sinks);
 		(void)snprintf(er->recording_btn.label, sizeof(er->recording_btn.label), "Stop recording");
 	}
 }
@@ -449,11 +854,78 @@ euroc_recorder_btn_cb(void *ptr)
 extern "C" void
 euroc_recorder_add_ui(struct xrt_slam_sinks *er_sinks, void *root, const char *prefix)
 {
-	euroc_recorder *er = container_of(er_sinks, euroc_recorder, cloner_queues);
+	euroc_recorder *er = container_of(er_sinks, euroc_recorder, public_sinks);
 	er->recording_btn.cb = euroc_recorder_btn_cb;
 	er->recording_btn.ptr = er;
 
 	char tmp[256];
 	(void)snprintf(tmp, sizeof(tmp), "%s%s", prefix, er->recording ? "Stop recording" : "Record EuRoC dataset");
 	u_var_add_button(root, &er->recording_btn, tmp);
+
+#define ADD_UI(SUFFIX, FIELD, NAME)                                                                                    \
+	(void)snprintf(tmp, sizeof(tmp), "%s%s", prefix, NAME);                                                        \
+	u_var_add_##SUFFIX(root, &er->writes.FIELD, tmp);
+
+	ADD_UI(combo, policy_combo, "Full queue policy");
+	ADD_UI(ro_i32, depth, "Queued frames");
+	ADD_UI(ro_i32, peak_depth, "Peak queued frames");
+	ADD_UI(ro_u64, queued, "Accepted frames");
+	ADD_UI(ro_u64, written, "Written frames");
+	ADD_UI(ro_u64, dropped, "Dropped frames");
+	ADD_UI(ro_u64, failed, "Failed frames");
+	ADD_UI(ro_u64, blocked_ns, "Time blocked (ns)");
+
+#undef ADD_UI
+}
+
+extern "C" bool
+euroc_recorder_convert_raw(const char *path)
+{
+	bool ok = true;
+
+	for (int i = 0; i < XRT_TRACKING_MAX_SLAM_CAMS; i++) {
+		string data_path = string{path} + "/mav0/cam" + to_string(i) + "/data";
+		string raw_path = data_path + ".raw";
+
+		FILE *file = fopen(raw_path.c_str(), "rb");
+		if (file == nullptr) {
+			continue;
+		}
+
+		create_directories(data_path);
+
+		int count = 0;
+		vector<uint8_t> data;
+		euroc_recorder_raw_header header;
+		while (fread(&header, sizeof(header), 1, file) == 1) {
+			if (header.magic != EUROC_RAW_MAGIC ||
+			    (header.format != XRT_FORMAT_L8 && header.format != XRT_FORMAT_R8G8B8)) {
+				U_LOG_E("Bad frame header in '%s' after %d frames", raw_path.c_str(), count);
+				ok = false;
+				break;
+			}
+
+			data.resize(header.stride * header.height);
+			if (fread(data.data(), 1, data.size(), file) != data.size()) {
+				U_LOG_E("Truncated frame in '%s' after %d frames", raw_path.c_str(), count);
+				ok = false;
+				break;
+			}
+
+			auto img_type = header.format == XRT_FORMAT_L8 ? CV_8UC1 : CV_8UC3;
+			cv::Mat img{(int)header.height, (int)header.width, img_type, data.data(), header.stride};
+			string img_path = data_path + "/" + euroc_recorder_cam_filename(false, header.timestamp);
+			if (!cv::imwrite(img_path, img)) {
+				U_LOG_E("Unable to write '%s'", img_path.c_str());
+				ok = false;
+				break;
+			}
+			count++;
+		}
+
+		(void)fclose(file);
+		U_LOG_I("Converted %d frames from '%s'", count, raw_path.c_str());
+	}
+
+	return ok;
 }
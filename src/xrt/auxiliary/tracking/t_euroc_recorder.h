@@ -22,6 +22,11 @@ extern "C" {
 /*!
  * Create SLAM sinks to record samples in EuRoC format.
  *
+ * Frames are copied into a bounded queue and written to disk by a pool of
+ * writer threads, so pushing never waits on encoding. When the writers fall
+ * behind, new frames are dropped or the pushing thread waits depending on the
+ * `EUROC_RECORDER_QUEUE_POLICY` option ("drop" or "block").
+ *
  * @param xfctx Frame context for the sinks.
  * @param record_path Directory name to save the dataset or NULL for a default based on the current datetime.
  * @param cam_count Number of cameras to record
@@ -60,6 +65,16 @@ euroc_recorder_stop(struct xrt_slam_sinks *er_sinks);
 void
 euroc_recorder_add_ui(struct xrt_slam_sinks *er_sinks, void *root, const char *prefix);
 
+/*!
+ * Convert the frames of a dataset recorded with `EUROC_RECORDER_RAW` into the
+ * png files its csv files refer to, the `data.raw` files are left in place.
+ *
+ * @param path Path of the recorded dataset
+ * @return true if all frames were converted
+ */
+bool
+euroc_recorder_convert_raw(const char *path);
+
 #ifdef __cplusplus
 }
 #endif
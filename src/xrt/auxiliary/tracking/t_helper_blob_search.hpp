@@ -0,0 +1,156 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Helper for finding bright blobs in undistorted and rectified views.
+ * @ingroup aux_tracking
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "This header is C++-only."
+#endif
+
+#include "util/u_trace_marker.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+
+namespace xrt::auxiliary::tracking {
+
+/*!
+ * Does the nearest neighbour undistort and rectify remap and the binary
+ * threshold in one pass, then runs the blob detector on the result.
+ *
+ * Only the region around the blobs found in the previous frame is processed,
+ * a full frame search is done when nothing was found there, every
+ * @ref full_search_interval frames to pick up new blobs, or when asked to.
+ */
+struct HelperBlobSearch
+{
+public:
+	//! Pixels at or below this value are black.
+	static constexpr int threshold = 32;
+
+	//! Extra pixels around the previous blobs to search.
+	static constexpr int roi_margin = 32;
+
+	//! Do a full frame search at least this often.
+	static constexpr uint32_t full_search_interval = 30;
+
+	//! Nearest neighbour source pixel for each output pixel, CV_16SC2.
+	cv::Mat map_xy;
+
+	//! Where blobs were found last frame, empty if none.
+	cv::Rect roi = {};
+
+	uint32_t frames_since_full = 0;
+
+
+	void
+	init(const cv::Mat &map_x, const cv::Mat &map_y)
+	{
+		// Rounds the same way as cv::remap with cv::INTER_NEAREST.
+		cv::Mat unused;
+		cv::convertMaps(map_x, map_y, map_xy, unused, CV_16SC2, true);
+
+		roi = {};
+		frames_since_full = 0;
+	}
+
+	/*!
+	 * Same as cv::remap with cv::INTER_NEAREST and cv::BORDER_CONSTANT
+	 * followed by cv::threshold, but only for the pixels in @p rect.
+	 */
+	void
+	remap_threshold(const cv::Mat &src, cv::Mat &dst, const cv::Rect &rect)
+	{
+		XRT_TRACE_MARKER();
+
+		const int cols = src.cols;
+		const int rows = src.rows;
+
+		for (int y = rect.y; y < rect.y + rect.height; y++) {
+			const cv::Vec2s *m = map_xy.ptr<cv::Vec2s>(y) + rect.x;
+			uint8_t *d = dst.ptr<uint8_t>(y) + rect.x;
+
+			for (int x = 0; x < rect.width; x++) {
+				int sx = m[x][0];
+				int sy = m[x][1];
+
+				uint8_t v = 0;
+				if ((unsigned)sx < (unsigned)cols && (unsigned)sy < (unsigned)rows) {
+					v = src.ptr<uint8_t>(sy)[sx];
+				}
+
+				d[x] = v > threshold ? 255 : 0;
+			}
+		}
+	}
+
+	/*!
+	 * Find blobs in @p grey, @p dst is only fully written to when
+	 * @p full_frame is true.
+	 */
+	void
+	detect(cv::SimpleBlobDetector &sbd,
+	       const cv::Mat &grey,
+	       cv::Mat &dst,
+	       std::vector<cv::KeyPoint> &keypoints,
+	       bool full_frame)
+	{
+		XRT_TRACE_MARKER();
+
+		dst.create(map_xy.rows, map_xy.cols, CV_8UC1);
+
+		bool full = full_frame || roi.empty() || frames_since_full >= full_search_interval;
+
+		if (!full) {
+			remap_threshold(grey, dst, roi);
+
+			sbd.detect(dst(roi), keypoints, cv::noArray());
+
+			for (cv::KeyPoint &kp : keypoints) {
+				kp.pt.x += (float)roi.x;
+				kp.pt.y += (float)roi.y;
+			}
+
+			// Lost them, fall back to searching everywhere.
+			full = keypoints.empty();
+		}
+
+		if (full) {
+			cv::Rect whole(0, 0, dst.cols, dst.rows);
+			remap_threshold(grey, dst, whole);
+
+			sbd.detect(dst, keypoints, cv::noArray());
+
+			frames_since_full = 0;
+		} else {
+			frames_since_full++;
+		}
+
+		update_roi(keypoints, dst.size());
+	}
+
+
+private:
+	void
+	update_roi(const std::vector<cv::KeyPoint> &keypoints, cv::Size size)
+	{
+		roi = {};
+
+		for (const cv::KeyPoint &kp : keypoints) {
+			int r = (int)kp.size + roi_margin;
+			cv::Rect rect((int)kp.pt.x - r, (int)kp.pt.y - r, r * 2, r * 2);
+			roi = roi.empty() ? rect : (roi | rect);
+		}
+
+		roi &= cv::Rect(cv::Point(0, 0), size);
+	}
+};
+
+} // namespace xrt::auxiliary::tracking
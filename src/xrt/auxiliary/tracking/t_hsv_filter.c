@@ -14,12 +14,29 @@
 #include "util/u_frame.h"
 #include "util/u_format.h"
 #include "util/u_trace_marker.h"
+#include "util/u_pixel_convert.h"
 
 #include "tracking/t_tracking.h"
 
 #include <stdio.h>
 #include <assert.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define T_HSV_HAVE_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define T_HSV_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(T_HSV_HAVE_X86) && defined(__GNUC__)
+#define T_HSV_TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define T_HSV_TARGET_SSE41
+#endif
+
 
 #define MOD_180(v) ((uint32_t)(v) % 180)
 
@@ -116,13 +133,283 @@ t_hsv_build_optimized_table(struct t_hsv_filter_params *params, struct t_hsv_fil
 }
 
 
+#define NUM_CHANNELS 4
+
 /*
  *
- * Sink filter
+ * Row kernels.
+ *
+ * The SIMD variants compute the table indices and expand the bits into the
+ * four masks eight or sixteen pixels at a time, the table lookup itself is a
+ * gather and stays scalar. They produce the exact same output as the scalar
+ * ones, which also handle the end of the rows.
  *
  */
 
-#define NUM_CHANNELS 4
+/*!
+ * Index into the flattened optimized table, same as @ref t_hsv_filter_sample.
+ */
+#define HSV_INDEX(Y, U, V) ((((Y) / T_HSV_STEP) * T_HSV_SIZE + ((U) / T_HSV_STEP)) * T_HSV_SIZE + ((V) / T_HSV_STEP))
+
+static inline void
+write_masks_scalar(uint8_t bits, uint8_t *dst[NUM_CHANNELS], uint32_t x)
+{
+	for (uint32_t i = 0; i < NUM_CHANNELS; i++) {
+		dst[i][x] = (bits & (1 << i)) ? 0xff : 0x00;
+	}
+}
+
+static void
+hsv_row_yuv_scalar(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t x, uint32_t width)
+{
+	for (; x < width; x++) {
+		const uint8_t *s = src + x * 3;
+		write_masks_scalar(lut[HSV_INDEX(s[0], s[1], s[2])], dst, x);
+	}
+}
+
+static void
+hsv_row_yuyv_scalar(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t x, uint32_t width)
+{
+	for (; x < width; x += 2) {
+		const uint8_t *s = src + x * 2;
+		write_masks_scalar(lut[HSV_INDEX(s[0], s[1], s[3])], dst, x + 0);
+		write_masks_scalar(lut[HSV_INDEX(s[2], s[1], s[3])], dst, x + 1);
+	}
+}
+
+#ifdef T_HSV_HAVE_X86
+
+/*!
+ * Table indices from 16 bit Y, U and V values.
+ */
+T_HSV_TARGET_SSE41 static inline __m128i
+hsv_index_sse41(__m128i y, __m128i u, __m128i v)
+{
+	y = _mm_slli_epi16(_mm_srli_epi16(y, 3), 10);
+	u = _mm_slli_epi16(_mm_srli_epi16(u, 3), 5);
+	v = _mm_srli_epi16(v, 3);
+
+	return _mm_or_si128(y, _mm_or_si128(u, v));
+}
+
+/*!
+ * Look up 16 pixels and write out the four masks.
+ */
+T_HSV_TARGET_SSE41 static inline void
+hsv_lookup_and_write_sse41(const uint8_t *lut, __m128i idx_lo, __m128i idx_hi, uint8_t *dst[NUM_CHANNELS], uint32_t x)
+{
+	uint16_t idx[16];
+	_mm_storeu_si128((__m128i *)&idx[0], idx_lo);
+	_mm_storeu_si128((__m128i *)&idx[8], idx_hi);
+
+	uint8_t bits[16];
+	for (uint32_t i = 0; i < 16; i++) {
+		bits[i] = lut[idx[i]];
+	}
+
+	__m128i b = _mm_loadu_si128((const __m128i *)bits);
+	for (uint32_t i = 0; i < NUM_CHANNELS; i++) {
+		__m128i m = _mm_set1_epi8((char)(1 << i));
+		_mm_storeu_si128((__m128i *)(dst[i] + x), _mm_cmpeq_epi8(_mm_and_si128(b, m), m));
+	}
+}
+
+T_HSV_TARGET_SSE41 static uint32_t
+hsv_row_yuv_sse41(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t width)
+{
+	// Gather each channel from the 48 bytes, -1 zeroes the byte.
+	const __m128i y0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i y1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i y2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	const __m128i u0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i u1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i u2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+	const __m128i v0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i v1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i v2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8_t *s = src + x * 3;
+		__m128i a = _mm_loadu_si128((const __m128i *)(s + 0));
+		__m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+		__m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+
+		__m128i y = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, y0), _mm_shuffle_epi8(b, y1)),
+		                         _mm_shuffle_epi8(c, y2));
+		__m128i u = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, u0), _mm_shuffle_epi8(b, u1)),
+		                         _mm_shuffle_epi8(c, u2));
+		__m128i v = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, v0), _mm_shuffle_epi8(b, v1)),
+		                         _mm_shuffle_epi8(c, v2));
+
+		__m128i idx_lo = hsv_index_sse41(_mm_cvtepu8_epi16(y), _mm_cvtepu8_epi16(u), _mm_cvtepu8_epi16(v));
+		__m128i idx_hi = hsv_index_sse41(_mm_cvtepu8_epi16(_mm_srli_si128(y, 8)),
+		                                 _mm_cvtepu8_epi16(_mm_srli_si128(u, 8)),
+		                                 _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+
+		hsv_lookup_and_write_sse41(lut, idx_lo, idx_hi, dst, x);
+	}
+
+	return x;
+}
+
+T_HSV_TARGET_SSE41 static uint32_t
+hsv_row_yuyv_sse41(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t width)
+{
+	const __m128i lo_mask = _mm_set1_epi16(0x00ff);
+	const __m128i uv_mul = _mm_set1_epi32(0x00010020); // U * 32 + V
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		// Y0 U0 Y1 V0 ..., eight pixels in each.
+		__m128i a = _mm_loadu_si128((const __m128i *)(src + x * 2 + 0));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + x * 2 + 16));
+
+		// U and V part of the index, one per pixel pair.
+		__m128i uv_a = _mm_madd_epi16(_mm_srli_epi16(_mm_srli_epi16(a, 8), 3), uv_mul);
+		__m128i uv_b = _mm_madd_epi16(_mm_srli_epi16(_mm_srli_epi16(b, 8), 3), uv_mul);
+		__m128i uv = _mm_packs_epi32(uv_a, uv_b);
+
+		__m128i y_a = _mm_slli_epi16(_mm_srli_epi16(_mm_and_si128(a, lo_mask), 3), 10);
+		__m128i y_b = _mm_slli_epi16(_mm_srli_epi16(_mm_and_si128(b, lo_mask), 3), 10);
+
+		__m128i idx_lo = _mm_or_si128(y_a, _mm_unpacklo_epi16(uv, uv));
+		__m128i idx_hi = _mm_or_si128(y_b, _mm_unpackhi_epi16(uv, uv));
+
+		hsv_lookup_and_write_sse41(lut, idx_lo, idx_hi, dst, x);
+	}
+
+	return x;
+}
+
+#endif // T_HSV_HAVE_X86
+
+#ifdef T_HSV_HAVE_NEON
+
+static inline uint16x8_t
+hsv_index_neon(uint8x8_t y, uint8x8_t u, uint8x8_t v)
+{
+	uint16x8_t iy = vshlq_n_u16(vmovl_u8(vshr_n_u8(y, 3)), 10);
+	uint16x8_t iu = vshlq_n_u16(vmovl_u8(vshr_n_u8(u, 3)), 5);
+	uint16x8_t iv = vmovl_u8(vshr_n_u8(v, 3));
+
+	return vorrq_u16(iy, vorrq_u16(iu, iv));
+}
+
+static inline void
+hsv_write_neon(const uint8_t bits[16], uint8_t *dst[NUM_CHANNELS], uint32_t x)
+{
+	uint8x16_t b = vld1q_u8(bits);
+	for (uint32_t i = 0; i < NUM_CHANNELS; i++) {
+		vst1q_u8(dst[i] + x, vtstq_u8(b, vdupq_n_u8((uint8_t)(1 << i))));
+	}
+}
+
+static uint32_t
+hsv_row_yuv_neon(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x16x3_t yuv = vld3q_u8(src + x * 3);
+
+		uint16_t idx[16];
+		vst1q_u16(&idx[0], hsv_index_neon(vget_low_u8(yuv.val[0]), vget_low_u8(yuv.val[1]),
+		                                  vget_low_u8(yuv.val[2])));
+		vst1q_u16(&idx[8], hsv_index_neon(vget_high_u8(yuv.val[0]), vget_high_u8(yuv.val[1]),
+		                                  vget_high_u8(yuv.val[2])));
+
+		uint8_t bits[16];
+		for (uint32_t i = 0; i < 16; i++) {
+			bits[i] = lut[idx[i]];
+		}
+
+		hsv_write_neon(bits, dst, x);
+	}
+
+	return x;
+}
+
+static uint32_t
+hsv_row_yuyv_neon(const uint8_t *lut, const uint8_t *src, uint8_t *dst[NUM_CHANNELS], uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		// Even Y, U, odd Y and V, for eight pixel pairs.
+		uint8x8x4_t yuyv = vld4_u8(src + x * 2);
+
+		uint16_t idx_even[8];
+		uint16_t idx_odd[8];
+		vst1q_u16(idx_even, hsv_index_neon(yuyv.val[0], yuyv.val[1], yuyv.val[3]));
+		vst1q_u16(idx_odd, hsv_index_neon(yuyv.val[2], yuyv.val[1], yuyv.val[3]));
+
+		uint8_t bits[16];
+		for (uint32_t i = 0; i < 8; i++) {
+			bits[i * 2 + 0] = lut[idx_even[i]];
+			bits[i * 2 + 1] = lut[idx_odd[i]];
+		}
+
+		hsv_write_neon(bits, dst, x);
+	}
+
+	return x;
+}
+
+#endif // T_HSV_HAVE_NEON
+
+static void
+hsv_row_yuv(enum u_pixel_convert_isa isa,
+            const uint8_t *lut,
+            const uint8_t *src,
+            uint8_t *dst[NUM_CHANNELS],
+            uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef T_HSV_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41:
+	case U_PIXEL_CONVERT_ISA_AVX2: x = hsv_row_yuv_sse41(lut, src, dst, width); break;
+#endif
+#ifdef T_HSV_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = hsv_row_yuv_neon(lut, src, dst, width); break;
+#endif
+	default: break;
+	}
+
+	// The rest of the row, or all of it.
+	hsv_row_yuv_scalar(lut, src, dst, x, width);
+}
+
+static void
+hsv_row_yuyv(enum u_pixel_convert_isa isa,
+             const uint8_t *lut,
+             const uint8_t *src,
+             uint8_t *dst[NUM_CHANNELS],
+             uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef T_HSV_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41:
+	case U_PIXEL_CONVERT_ISA_AVX2: x = hsv_row_yuyv_sse41(lut, src, dst, width); break;
+#endif
+#ifdef T_HSV_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = hsv_row_yuyv_neon(lut, src, dst, width); break;
+#endif
+	default: break;
+	}
+
+	hsv_row_yuyv_scalar(lut, src, dst, x, width);
+}
+
+
+/*
+ *
+ * Sink filter
+ *
+ */
 
 /*!
  * An @ref xrt_frame_sink that splits the input based on hue.
@@ -143,108 +430,30 @@ struct t_hsv_filter
 
 	struct u_sink_debug usds[NUM_CHANNELS];
 
+	//! Which row kernels to use, picked at creation.
+	enum u_pixel_convert_isa isa;
+
 	struct t_hsv_filter_optimized_table table;
 };
 
-static void
-process_sample(struct t_hsv_filter *f,
-               uint8_t y,
-               uint8_t cb,
-               uint8_t cr,
-               uint8_t *dst0,
-               uint8_t *dst1,
-               uint8_t *dst2,
-               uint8_t *dst3)
-{
-	uint8_t bits = t_hsv_filter_sample(&f->table, y, cb, cr);
-	uint8_t v0 = (bits & (1 << 0)) ? 0xff : 0x00;
-	uint8_t v1 = (bits & (1 << 1)) ? 0xff : 0x00;
-	uint8_t v2 = (bits & (1 << 2)) ? 0xff : 0x00;
-	uint8_t v3 = (bits & (1 << 3)) ? 0xff : 0x00;
-
-	*dst0 = v0;
-	*dst1 = v1;
-	*dst2 = v2;
-	*dst3 = v3;
-}
-
 XRT_NO_INLINE static void
-hsv_process_frame_yuv(struct t_hsv_filter *f, struct xrt_frame *xf)
+hsv_process_frame(struct t_hsv_filter *f, struct xrt_frame *xf)
 {
 	SINK_TRACE_MARKER();
 
-	struct xrt_frame *f0 = f->frames[0];
-	struct xrt_frame *f1 = f->frames[1];
-	struct xrt_frame *f2 = f->frames[2];
-	struct xrt_frame *f3 = f->frames[3];
+	const uint8_t *lut = &f->table.v[0][0][0];
 
 	for (uint32_t y = 0; y < xf->height; y++) {
-		uint8_t *src = (uint8_t *)xf->data + y * xf->stride;
-		uint8_t *dst0 = f0->data + y * f0->stride;
-		uint8_t *dst1 = f1->data + y * f1->stride;
-		uint8_t *dst2 = f2->data + y * f2->stride;
-		uint8_t *dst3 = f3->data + y * f3->stride;
-
-		for (uint32_t x = 0; x < xf->width; x += 1) {
-			uint8_t y = src[0];
-			uint8_t cb = src[1];
-			uint8_t cr = src[2];
-			src += 3;
-
-			process_sample(f, y, cb, cr, dst0, dst1, dst2, dst3);
-			dst0 += 1;
-			dst1 += 1;
-			dst2 += 1;
-			dst3 += 1;
+		const uint8_t *src = xf->data + y * xf->stride;
+		uint8_t *dst[NUM_CHANNELS];
+		for (uint32_t i = 0; i < NUM_CHANNELS; i++) {
+			dst[i] = f->frames[i]->data + y * f->frames[i]->stride;
 		}
-	}
-}
-
-XRT_NO_INLINE static void
-hsv_process_frame_yuyv(struct t_hsv_filter *f, struct xrt_frame *xf)
-{
-	SINK_TRACE_MARKER();
-
-	struct xrt_frame *f0 = f->frames[0];
-	struct xrt_frame *f1 = f->frames[1];
-	struct xrt_frame *f2 = f->frames[2];
-	struct xrt_frame *f3 = f->frames[3];
 
-	for (uint32_t y = 0; y < xf->height; y++) {
-		uint8_t *src = (uint8_t *)xf->data + y * xf->stride;
-		uint8_t *dst0 = f0->data + y * f0->stride;
-		uint8_t *dst1 = f1->data + y * f1->stride;
-		uint8_t *dst2 = f2->data + y * f2->stride;
-		uint8_t *dst3 = f3->data + y * f3->stride;
-
-		for (uint32_t x = 0; x < xf->width; x += 2) {
-			uint8_t y1 = src[0];
-			uint8_t cb = src[1];
-			uint8_t y2 = src[2];
-			uint8_t cr = src[3];
-			src += 4;
-
-			uint8_t bits0 = t_hsv_filter_sample(&f->table, y1, cb, cr);
-			uint8_t bits1 = t_hsv_filter_sample(&f->table, y2, cb, cr);
-
-			uint8_t v0 = (bits0 & (1 << 0)) ? 0xff : 0x00;
-			uint8_t v1 = (bits0 & (1 << 1)) ? 0xff : 0x00;
-			uint8_t v2 = (bits0 & (1 << 2)) ? 0xff : 0x00;
-			uint8_t v3 = (bits0 & (1 << 3)) ? 0xff : 0x00;
-			uint8_t v4 = (bits1 & (1 << 0)) ? 0xff : 0x00;
-			uint8_t v5 = (bits1 & (1 << 1)) ? 0xff : 0x00;
-			uint8_t v6 = (bits1 & (1 << 2)) ? 0xff : 0x00;
-			uint8_t v7 = (bits1 & (1 << 3)) ? 0xff : 0x00;
-
-			*(uint16_t *)dst0 = v0 | v4 << 8;
-			*(uint16_t *)dst1 = v1 | v5 << 8;
-			*(uint16_t *)dst2 = v2 | v6 << 8;
-			*(uint16_t *)dst3 = v3 | v7 << 8;
-
-			dst0 += 2;
-			dst1 += 2;
-			dst2 += 2;
-			dst3 += 2;
+		if (xf->format == XRT_FORMAT_YUYV422) {
+			hsv_row_yuyv(f->isa, lut, src, dst, xf->width);
+		} else {
+			hsv_row_yuv(f->isa, lut, src, dst, xf->width);
 		}
 	}
 }
@@ -290,12 +499,9 @@ hsv_frame(struct xrt_frame_sink *xsink, struct xrt_frame *xf)
 
 	switch (xf->format) {
 	case XRT_FORMAT_YUV888:
-		ensure_buf_allocated(f, xf);
-		hsv_process_frame_yuv(f, xf);
-		break;
 	case XRT_FORMAT_YUYV422:
 		ensure_buf_allocated(f, xf);
-		hsv_process_frame_yuyv(f, xf);
+		hsv_process_frame(f, xf);
 		break;
 	default: U_LOG_E("Bad format '%s'", u_format_str(xf->format)); return;
 	}
@@ -339,6 +545,7 @@ t_hsv_filter_create(struct xrt_frame_context *xfctx,
 	f->sinks[1] = sinks[1];
 	f->sinks[2] = sinks[2];
 	f->sinks[3] = sinks[3];
+	f->isa = u_pixel_convert_best_isa();
 
 	t_hsv_build_optimized_table(&f->params, &f->table);
 
@@ -15,6 +15,7 @@
 #include "tracking/t_calibration_opencv.hpp"
 #include "tracking/t_tracker_psmv_fusion.hpp"
 #include "tracking/t_helper_debug_sink.hpp"
+#include "tracking/t_helper_blob_search.hpp"
 
 #include "util/u_var.h"
 #include "util/u_misc.h"
@@ -57,6 +58,8 @@ public:
 
 	cv::Mat frame_undist_rectified;
 
+	HelperBlobSearch search;
+
 	void
 	populate_from_calib(t_camera_calibration &calib, const RemapPair &rectification)
 	{
@@ -67,6 +70,8 @@ public:
 
 		undistort_rectify_map_x = rectification.remap_x;
 		undistort_rectify_map_y = rectification.remap_y;
+
+		search.init(undistort_rectify_map_x, undistort_rectify_map_y);
 	}
 };
 
@@ -116,6 +121,9 @@ public:
 
 	cv::Ptr<cv::SimpleBlobDetector> sbd;
 
+	//! Only search around the previous blobs, see @ref HelperBlobSearch.
+	bool roi_search = true;
+
 	std::shared_ptr<PSMVFusionInterface> filter;
 
 	xrt_vec3 tracked_object_position;
@@ -135,39 +143,12 @@ do_view(TrackerPSMV &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 {
 	XRT_TRACE_MARKER();
 
-	{
-		XRT_TRACE_IDENT(remap);
-
-		// Undistort and rectify the whole image.
-		cv::remap(grey,                         // src
-		          view.frame_undist_rectified,  // dst
-		          view.undistort_rectify_map_x, // map1
-		          view.undistort_rectify_map_y, // map2
-		          cv::INTER_NEAREST,            // interpolation
-		          cv::BORDER_CONSTANT,          // borderMode
-		          cv::Scalar(0, 0, 0));         // borderValue
-	}
-
-	{
-		XRT_TRACE_IDENT(threshold);
-
-		cv::threshold(view.frame_undist_rectified, // src
-		              view.frame_undist_rectified, // dst
-		              32.0,                        // thresh
-		              255.0,                       // maxval
-		              0);                          // type
-	}
-
-	{
-		XRT_TRACE_IDENT(detect);
-
-		// Do blob detection with our masks.
-		//! @todo Re-enable masks.
-		t.sbd->detect(view.frame_undist_rectified, // image
-		              view.keypoints,              // keypoints
-		              cv::noArray());              // mask
-	}
+	// The debug output wants the whole image.
+	bool full_frame = !t.roi_search || rgb.cols > 0;
 
+	// Undistort, rectify, threshold and detect blobs.
+	//! @todo Re-enable masks.
+	view.search.detect(*t.sbd, grey, view.frame_undist_rectified, view.keypoints, full_frame);
 
 	// Debug is wanted, draw the keypoints.
 	if (rgb.cols > 0) {
@@ -641,6 +622,7 @@ t_psmv_create(struct xrt_frame_context *xfctx,
 	// Everything is safe, now setup the variable tracking.
 	u_var_add_root(&t, "PSMV Tracker", true);
 	u_var_add_vec3_f32(&t, &t.tracked_object_position, "last.ball.pos");
+	u_var_add_bool(&t, &t.roi_search, "ROI search");
 	u_var_add_sink_debug(&t, &t.debug.usd, "Debug");
 
 	*out_sink = &t.sink;
@@ -13,6 +13,7 @@
 #include "tracking/t_tracking.h"
 #include "tracking/t_calibration_opencv.hpp"
 #include "tracking/t_helper_debug_sink.hpp"
+#include "tracking/t_helper_blob_search.hpp"
 
 #include "util/u_misc.h"
 #include "util/u_debug.h"
@@ -143,6 +144,8 @@ struct View
 
 	cv::Mat frame_undist_rectified;
 
+	HelperBlobSearch search;
+
 	void
 	populate_from_calib(t_camera_calibration &calib, const RemapPair &rectification)
 	{
@@ -153,6 +156,8 @@ struct View
 
 		undistort_rectify_map_x = rectification.remap_x;
 		undistort_rectify_map_y = rectification.remap_y;
+
+		search.init(undistort_rectify_map_x, undistort_rectify_map_y);
 	}
 };
 
@@ -273,6 +278,9 @@ public:
 
 	cv::Ptr<cv::SimpleBlobDetector> sbd;
 	std::vector<cv::KeyPoint> l_blobs, r_blobs;
+
+	//! Only search around the previous blobs, see @ref HelperBlobSearch.
+	bool roi_search = true;
 	std::vector<match_model_t> matches;
 
 	// we refine our measurement by rejecting outliers and merging 'too
@@ -1227,24 +1235,11 @@ create_match_list(TrackerPSVR &t)
 static void
 do_view(TrackerPSVR &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 {
-	// Undistort and rectify the whole image.
-	cv::remap(grey,                         // src
-	          view.frame_undist_rectified,  // dst
-	          view.undistort_rectify_map_x, // map1
-	          view.undistort_rectify_map_y, // map2
-	          cv::INTER_NEAREST,            // interpolation - LINEAR seems
-	                                        // very slow on my setup
-	          cv::BORDER_CONSTANT,          // borderMode
-	          cv::Scalar(0, 0, 0));         // borderValue
-
-	cv::threshold(view.frame_undist_rectified, // src
-	              view.frame_undist_rectified, // dst
-	              32.0,                        // thresh
-	              255.0,                       // maxval
-	              0);
-	t.sbd->detect(view.frame_undist_rectified, // image
-	              view.keypoints,              // keypoints
-	              cv::noArray());              // mask
+	// The debug output wants the whole image.
+	bool full_frame = !t.roi_search || rgb.cols > 0;
+
+	// Undistort, rectify, threshold and detect blobs.
+	view.search.detect(*t.sbd, grey, view.frame_undist_rectified, view.keypoints, full_frame);
 
 	// Debug is wanted, draw the keypoints.
 	if (rgb.cols > 0) {
@@ -2140,6 +2135,7 @@ t_psvr_create(struct xrt_frame_context *xfctx,
 	u_var_add_root(&t, "PSVR Tracker", true);
 	u_var_add_log_level(&t, &t.log_level, "Log level");
 	u_var_add_sink_debug(&t, &t.debug.usd, "Debug");
+	u_var_add_bool(&t, &t.roi_search, "ROI search");
 
 	*out_sink = &t.sink;
 	*out_xtvr = &t.base;
@@ -295,6 +295,15 @@ struct TrackerSlam
 	struct m_ff_vec3_f32 *accel_ff; //!< Last accelerometer samples
 	vector<u_sink_debug> ui_sink;   //!< Sink to display frames in UI of each camera
 
+	//! IMU samples integrated on top of the latest SLAM pose, protected by @ref lock_ff.
+	struct
+	{
+		bool valid = false;       //!< False until the first prediction
+		timepoint_ns base_ts = 0; //!< Timestamp of the SLAM pose the integration started from
+		timepoint_ns ts = 0;      //!< Timestamp of the last integrated IMU sample
+		xrt_space_relation rel{}; //!< SLAM pose with all IMU samples up to @ref ts integrated
+	} imu_preint;
+
 	//! Used to correct accelerometer measurements when integrating into the prediction.
 	//! @todo Should be automatically computed instead of required to be filled manually through the UI.
 	xrt_vec3 gravity_correction{0, 0, -MATH_GRAVITY_M_S2};
@@ -805,40 +814,69 @@ flush_poses(TrackerSlam &t)
 	return true;
 }
 
-//! Integrates IMU samples on top of a base pose and predicts from that
+//! Integrate one IMU sample at @p ts into @p rel, which was at @p rel_ts
 static void
-predict_pose_from_imu(TrackerSlam &t,
-                      timepoint_ns when_ns,
-                      xrt_space_relation base_rel, // Pose to integrate IMUs on top of
-                      timepoint_ns base_rel_ts,
-                      struct xrt_space_relation *out_relation)
+integrate_imu_sample(const TrackerSlam &t,
+                     xrt_space_relation &rel,
+                     timepoint_ns &rel_ts,
+                     const xrt_vec3 &g,
+                     const xrt_vec3 &a,
+                     timepoint_ns ts)
 {
-	os_mutex_lock(&t.lock_ff);
+	xrt_quat &o = rel.pose.orientation;
+	xrt_vec3 &p = rel.pose.position;
+	xrt_vec3 &w = rel.angular_velocity;
+	xrt_vec3 &v = rel.linear_velocity;
+
+	// Update time
+	float dt = (float)time_ns_to_s(ts - rel_ts);
+	rel_ts = ts;
+
+	// Integrate gyroscope
+	xrt_quat angvel_delta{};
+	xrt_vec3 scaled_half_g = g * dt * 0.5f;
+	math_quat_exp(&scaled_half_g, &angvel_delta); // Same as using math_quat_from_angle_vector(g/dt)
+	math_quat_rotate(&o, &angvel_delta, &o);      // Orientation
+	math_quat_rotate_derivative(&o, &g, &w);      // Angular velocity
+
+	// Integrate accelerometer
+	xrt_vec3 world_accel{};
+	math_quat_rotate_vec3(&o, &a, &world_accel);
+	world_accel += t.gravity_correction;
+	v += world_accel * dt;                        // Linear velocity
+	p += v * dt + world_accel * (dt * dt * 0.5f); // Position
+}
 
-	// Find oldest imu index i that is newer than latest SLAM pose (or -1)
-	int i = 0;
-	uint64_t imu_ts = UINT64_MAX;
-	xrt_vec3 _;
-	while (m_ff_vec3_f32_get(t.gyro_ff, i, &_, &imu_ts)) {
-		if ((int64_t)imu_ts < base_rel_ts) {
-			i--; // Back to the oldest newer-than-SLAM IMU index (or -1)
-			break;
+/*!
+ * Index of the oldest IMU sample not older than @p ts, or -1 if there are
+ * none. Samples are stored newest first so this is a binary search for the
+ * end of the newer-than-@p ts prefix. Must hold @ref TrackerSlam::lock_ff.
+ */
+static int
+find_oldest_imu_index_since(TrackerSlam &t, timepoint_ns ts)
+{
+	int lo = 0;                                     // Samples before lo are not older than ts
+	int hi = (int)m_ff_vec3_f32_get_num(t.gyro_ff); // Samples from hi on are older than ts
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		xrt_vec3 _;
+		uint64_t imu_ts = 0;
+		if (m_ff_vec3_f32_get(t.gyro_ff, mid, &_, &imu_ts) && (int64_t)imu_ts >= ts) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
-		i++;
-	}
-
-	if (i == -1) {
-		SLAM_WARN("No IMU samples received after latest SLAM pose (and frame)");
 	}
+	return lo - 1;
+}
 
-	xrt_space_relation integ_rel = base_rel;
-	timepoint_ns integ_rel_ts = base_rel_ts;
-	xrt_quat &o = integ_rel.pose.orientation;
-	xrt_vec3 &p = integ_rel.pose.position;
-	xrt_vec3 &w = integ_rel.angular_velocity;
-	xrt_vec3 &v = integ_rel.linear_velocity;
-	bool clamped = false; // If when_ns is older than the latest IMU ts
-
+/*!
+ * Integrate IMU samples from index @p i down to the newest one on top of
+ * @p rel, stopping at @p when_ns. Must hold @ref TrackerSlam::lock_ff.
+ */
+static void
+integrate_imu_samples(TrackerSlam &t, int i, timepoint_ns when_ns, xrt_space_relation &rel, timepoint_ns &rel_ts)
+{
 	while (i >= 0) { // Decreasing i increases timestamp
 		// Get samples
 		xrt_vec3 g{};
@@ -850,8 +888,8 @@ predict_pose_from_imu(TrackerSlam &t,
 		got &= m_ff_vec3_f32_get(t.accel_ff, i, &a, &a_ts);
 		timepoint_ns ts = g_ts;
 
-
 		// Checks
+		bool clamped = false; // If when_ns is older than the latest IMU ts
 		if (ts > when_ns) {
 			clamped = true;
 			//! @todo Instead of using same a and g values, do an interpolated sample like this:
@@ -860,31 +898,62 @@ predict_pose_from_imu(TrackerSlam &t,
 			ts = when_ns; // clamp ts to when_ns
 		}
 		SLAM_DASSERT(got && g_ts == a_ts, "Failure getting synced gyro and accel samples");
-		SLAM_DASSERT(ts >= base_rel_ts, "Accessing imu sample that is older than latest SLAM pose");
+		SLAM_DASSERT(ts >= rel_ts, "Accessing imu sample that is older than latest SLAM pose");
 
-		// Update time
-		float dt = (float)time_ns_to_s(ts - integ_rel_ts);
-		integ_rel_ts = ts;
-
-		// Integrate gyroscope
-		xrt_quat angvel_delta{};
-		xrt_vec3 scaled_half_g = g * dt * 0.5f;
-		math_quat_exp(&scaled_half_g, &angvel_delta); // Same as using math_quat_from_angle_vector(g/dt)
-		math_quat_rotate(&o, &angvel_delta, &o);      // Orientation
-		math_quat_rotate_derivative(&o, &g, &w);      // Angular velocity
-
-		// Integrate accelerometer
-		xrt_vec3 world_accel{};
-		math_quat_rotate_vec3(&o, &a, &world_accel);
-		world_accel += t.gravity_correction;
-		v += world_accel * dt;                        // Linear velocity
-		p += v * dt + world_accel * (dt * dt * 0.5f); // Position
+		integrate_imu_sample(t, rel, rel_ts, g, a, ts);
 
 		if (clamped) {
 			break;
 		}
 		i--;
 	}
+}
+
+//! Integrate a newly received IMU sample into the preintegrated state, must hold @ref TrackerSlam::lock_ff.
+static void
+update_imu_preint(TrackerSlam &t, const xrt_vec3 &g, const xrt_vec3 &a, timepoint_ns ts)
+{
+	if (!t.imu_preint.valid || ts < t.imu_preint.ts) {
+		return;
+	}
+
+	integrate_imu_sample(t, t.imu_preint.rel, t.imu_preint.ts, g, a, ts);
+}
+
+//! Integrates IMU samples on top of a base pose and predicts from that
+static void
+predict_pose_from_imu(TrackerSlam &t,
+                      timepoint_ns when_ns,
+                      xrt_space_relation base_rel, // Pose to integrate IMUs on top of
+                      timepoint_ns base_rel_ts,
+                      struct xrt_space_relation *out_relation)
+{
+	os_mutex_lock(&t.lock_ff);
+
+	// A new SLAM pose landed, integrate the samples since then once, later samples are added as they arrive
+	if (!t.imu_preint.valid || t.imu_preint.base_ts != base_rel_ts) {
+		int i = find_oldest_imu_index_since(t, base_rel_ts);
+		if (i == -1) {
+			SLAM_WARN("No IMU samples received after latest SLAM pose (and frame)");
+		}
+
+		t.imu_preint.valid = true;
+		t.imu_preint.base_ts = base_rel_ts;
+		t.imu_preint.ts = base_rel_ts;
+		t.imu_preint.rel = base_rel;
+		integrate_imu_samples(t, i, INT64_MAX, t.imu_preint.rel, t.imu_preint.ts);
+	}
+
+	xrt_space_relation integ_rel = t.imu_preint.rel;
+	timepoint_ns integ_rel_ts = t.imu_preint.ts;
+
+	// Asking for a time before the newest IMU sample, integrate from the SLAM pose up to it
+	if (when_ns < integ_rel_ts) {
+		integ_rel = base_rel;
+		integ_rel_ts = base_rel_ts;
+		int i = find_oldest_imu_index_since(t, base_rel_ts);
+		integrate_imu_samples(t, i, when_ns, integ_rel, integ_rel_ts);
+	}
 
 	os_mutex_unlock(&t.lock_ff);
 
@@ -1322,6 +1391,7 @@ t_slam_receive_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
 	os_mutex_lock(&t.lock_ff);
 	m_ff_vec3_f32_push(t.gyro_ff, &gyro, ts);
 	m_ff_vec3_f32_push(t.accel_ff, &accel, ts);
+	update_imu_preint(t, gyro, accel, ts);
 	os_mutex_unlock(&t.lock_ff);
 }
 
@@ -820,6 +820,27 @@ t_calibration_stereo_create(struct xrt_frame_context *xfctx,
                             struct xrt_frame_sink *gui,
                             struct xrt_frame_sink **out_sink);
 
+/*!
+ * @brief Stereo calibrate from images on disk, the boards are searched for
+ * in all images at the same time using all cores.
+ *
+ * @p path is either a EuRoC dataset, with the image pairs in
+ * `mav0/cam0/data` and `mav0/cam1/data`, or a directory of side by side
+ * images like the ones written by @ref t_calibration_params::save_images.
+ * Of the images where the board is found at most
+ * @ref t_calibration_params::num_collect_total, spread over the whole set,
+ * are used.
+ *
+ * @param params Parameters to use during calibration, the frame capture
+ * settings are ignored. Values copied, pointer not retained.
+ * @param path Directory to load the images from.
+ * @param[out] out_data The calibration that was produced.
+ */
+int
+t_calibration_stereo_batch(const struct t_calibration_params *params,
+                           const char *path,
+                           struct t_stereo_camera_calibration **out_data);
+
 
 /*
  *
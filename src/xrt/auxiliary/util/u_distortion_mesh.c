@@ -8,10 +8,15 @@
  * @ingroup aux_distortion
  */
 
+#include "xrt/xrt_config_os.h"
+
 #include "util/u_misc.h"
+#include "util/u_file.h"
 #include "util/u_frame.h"
 #include "util/u_debug.h"
 #include "util/u_format.h"
+#include "util/u_worker.h"
+#include "util/u_logging.h"
 #include "util/u_distortion_mesh.h"
 
 #include "math/m_vec2.h"
@@ -19,10 +24,32 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
 #include <assert.h>
 
 
 DEBUG_GET_ONCE_NUM_OPTION(mesh_size, "XRT_MESH_SIZE", 64)
+// Relies on xrt_device::compute_distortion being thread safe.
+DEBUG_GET_ONCE_NUM_OPTION(mesh_threads, "XRT_MESH_THREADS", 4)
+DEBUG_GET_ONCE_BOOL_OPTION(mesh_cache, "XRT_MESH_CACHE", true)
+
+/*!
+ * Below this many rows in total the grid is computed on the calling thread,
+ * starting the thread pool would cost more than it saves.
+ */
+#define MIN_PARALLEL_ROW_COUNT (32)
+
+//! Number of tasks pushed per thread, evens out rows that differ in cost.
+#define TASKS_PER_THREAD (4)
+
+//! Number of points along each axis used to fingerprint the distortion.
+#define CACHE_PROBE_SIZE (5)
+
+//! Bump when the layout of the cache file or the mesh changes.
+#define CACHE_VERSION (1)
+
+#define CACHE_SUBPATH "mesh_cache"
 
 
 typedef bool (*func_calc)(struct xrt_device *xdev, uint32_t view, float u, float v, struct xrt_uv_triplet *result);
@@ -33,11 +60,339 @@ index_for(int row, int col, uint32_t stride, uint32_t offset)
 	return row * stride + col + offset;
 }
 
+
+/*
+ *
+ * Grid computation.
+ *
+ */
+
+/*!
+ * A range of rows over all views, row @p begin of view zero is zero and the
+ * first row of view one is @p grid_size and so on.
+ */
+struct grid_task
+{
+	struct xrt_device *xdev;
+	func_calc calc;
+	uint32_t first_view;
+	uint32_t grid_size;
+	struct xrt_uv_triplet *out;
+
+	uint32_t begin;
+	uint32_t end;
+
+	bool ok;
+};
+
+static bool
+compute_rows(struct xrt_device *xdev,
+             func_calc calc,
+             uint32_t first_view,
+             uint32_t grid_size,
+             uint32_t begin,
+             uint32_t end,
+             struct xrt_uv_triplet *out)
+{
+	uint32_t cells = grid_size - 1;
+
+	for (uint32_t i = begin; i < end; i++) {
+		uint32_t view = first_view + i / grid_size;
+		uint32_t r = i % grid_size;
+
+		// This goes from 0 to 1.0 inclusive.
+		float v = (float)r / (float)cells;
+
+		for (uint32_t c = 0; c < grid_size; c++) {
+			// This goes from 0 to 1.0 inclusive.
+			float u = (float)c / (float)cells;
+
+			if (!calc(xdev, view, u, v, &out[i * grid_size + c])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 static void
-run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target, uint32_t num)
+grid_task_func(void *ptr)
+{
+	struct grid_task *t = (struct grid_task *)ptr;
+
+	t->ok = compute_rows(t->xdev, t->calc, t->first_view, t->grid_size, t->begin, t->end, t->out);
+}
+
+static bool
+compute_rows_parallel(struct xrt_device *xdev,
+                      func_calc calc,
+                      uint32_t first_view,
+                      uint32_t grid_size,
+                      uint32_t row_count,
+                      uint32_t thread_count,
+                      struct xrt_uv_triplet *out)
+{
+	struct u_worker_thread_pool *pool = u_worker_thread_pool_create(thread_count - 1, thread_count, "Mesh");
+	if (pool == NULL) {
+		return compute_rows(xdev, calc, first_view, grid_size, 0, row_count, out);
+	}
+
+	struct u_worker_group *group = u_worker_group_create(pool);
+
+	uint32_t task_count = MIN(thread_count * TASKS_PER_THREAD, row_count);
+	struct grid_task *tasks = U_TYPED_ARRAY_CALLOC(struct grid_task, task_count);
+
+	for (uint32_t i = 0; i < task_count; i++) {
+		tasks[i].xdev = xdev;
+		tasks[i].calc = calc;
+		tasks[i].first_view = first_view;
+		tasks[i].grid_size = grid_size;
+		tasks[i].out = out;
+		tasks[i].begin = (uint32_t)(((uint64_t)row_count * i) / task_count);
+		tasks[i].end = (uint32_t)(((uint64_t)row_count * (i + 1)) / task_count);
+
+		u_worker_group_push(group, grid_task_func, &tasks[i]);
+	}
+
+	// Helps out with the tasks.
+	u_worker_group_wait_all(group);
+
+	bool ok = true;
+	for (uint32_t i = 0; i < task_count; i++) {
+		ok = ok && tasks[i].ok;
+	}
+
+	free(tasks);
+	u_worker_group_reference(&group, NULL);
+	u_worker_thread_pool_reference(&pool, NULL);
+
+	return ok;
+}
+
+/*!
+ * Compute @p view_count grids starting at @p first_view, each view is
+ * @p grid_size squared triplets packed one after another in @p out.
+ */
+static bool
+compute_grids(struct xrt_device *xdev,
+              func_calc calc,
+              uint32_t first_view,
+              uint32_t view_count,
+              uint32_t grid_size,
+              struct xrt_uv_triplet *out)
 {
 	assert(calc != NULL);
+	assert(grid_size >= 2);
+
+	/*
+	 * The bulk function is only a faster path for the device's own function,
+	 * if it fails (like over IPC for large grids) do it point by point.
+	 */
+	if (calc == xdev->compute_distortion && xdev->compute_distortion_grid != NULL) {
+		bool bulk_ok = true;
+		for (uint32_t i = 0; i < view_count && bulk_ok; i++) {
+			struct xrt_uv_triplet *view_out = &out[i * grid_size * grid_size];
+			bulk_ok = xrt_device_compute_distortion_grid(xdev, first_view + i, grid_size, view_out);
+		}
+
+		if (bulk_ok) {
+			return true;
+		}
+
+		U_LOG_D("Bulk distortion grid failed for grid size %u, computing it point by point", grid_size);
+	}
+
+	uint32_t row_count = grid_size * view_count;
+	int64_t thread_count = debug_get_num_option_mesh_threads();
+
+	if (thread_count <= 1 || row_count < MIN_PARALLEL_ROW_COUNT) {
+		return compute_rows(xdev, calc, first_view, grid_size, 0, row_count, out);
+	}
+
+	// Same limit as the worker pool.
+	thread_count = MIN(thread_count, 16);
+
+	return compute_rows_parallel(xdev, calc, first_view, grid_size, row_count, (uint32_t)thread_count, out);
+}
+
 
+/*
+ *
+ * Mesh cache.
+ *
+ */
+
+/*!
+ * Everything the mesh depends on. The distortion values are private to each
+ * driver so the distortion function is sampled at a few points instead, any
+ * change to them should show up there. Stored first in the file and compared
+ * in full on load, the hash is only used for the file name.
+ */
+struct mesh_cache_key
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t view_count;
+	uint32_t num;
+	uint32_t probe_size;
+	char str[XRT_DEVICE_NAME_LEN];
+	char serial[XRT_DEVICE_NAME_LEN];
+	struct xrt_uv_triplet probes[XRT_MAX_VIEWS][CACHE_PROBE_SIZE * CACHE_PROBE_SIZE];
+};
+
+static bool
+cache_make_key(struct xrt_device *xdev, func_calc calc, uint32_t view_count, uint32_t num, struct mesh_cache_key *key)
+{
+	// Zero the padding and unused probes, the key is compared as bytes.
+	memset(key, 0, sizeof(*key));
+
+	memcpy(key->magic, "XRTMESH", 8);
+	key->version = CACHE_VERSION;
+	key->view_count = view_count;
+	key->num = num;
+	key->probe_size = CACHE_PROBE_SIZE;
+	snprintf(key->str, sizeof(key->str), "%s", xdev->str);
+	snprintf(key->serial, sizeof(key->serial), "%s", xdev->serial);
+
+	for (uint32_t view = 0; view < view_count; view++) {
+		struct xrt_uv_triplet *probes = key->probes[view];
+		if (!compute_rows(xdev, calc, view, CACHE_PROBE_SIZE, 0, CACHE_PROBE_SIZE, probes)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//! Stable between builds and platforms, unlike @ref math_hash_string.
+static uint64_t
+cache_hash_key(const struct mesh_cache_key *key)
+{
+	const uint8_t *bytes = (const uint8_t *)key;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (size_t i = 0; i < sizeof(*key); i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+#ifdef XRT_OS_LINUX
+
+#include <linux/limits.h>
+#include <unistd.h>
+
+//! Full path of the cache file for @p key, in the cache directory.
+static bool
+cache_path(const struct mesh_cache_key *key, char *out, size_t out_size)
+{
+	char dir[PATH_MAX];
+	ssize_t ret = u_file_make_path_in_cache_dir(CACHE_SUBPATH, dir, sizeof(dir));
+	if (ret <= 0) {
+		return false;
+	}
+
+	ret = snprintf(out, out_size, "%s/%016" PRIx64 ".bin", dir, cache_hash_key(key));
+
+	return ret > 0 && ret < (ssize_t)out_size;
+}
+
+static bool
+cache_load(const struct mesh_cache_key *key, struct xrt_uv_triplet *triplets, size_t triplet_count)
+{
+	char path[PATH_MAX];
+	if (!cache_path(key, path, sizeof(path))) {
+		return false;
+	}
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return false;
+	}
+
+	struct mesh_cache_key file_key;
+	bool ok = fread(&file_key, sizeof(file_key), 1, file) == 1 &&                         //
+	          memcmp(&file_key, key, sizeof(file_key)) == 0 &&                            //
+	          fread(triplets, sizeof(*triplets), triplet_count, file) == triplet_count && //
+	          fgetc(file) == EOF;                                                         //
+
+	fclose(file);
+
+	if (ok) {
+		U_LOG_D("Loaded distortion mesh from '%s'", path);
+	}
+
+	return ok;
+}
+
+static void
+cache_save(const struct mesh_cache_key *key, const struct xrt_uv_triplet *triplets, size_t triplet_count)
+{
+	char path[PATH_MAX];
+	if (!cache_path(key, path, sizeof(path))) {
+		return;
+	}
+
+	// Per process so services starting at the same time don't write into the same file.
+	char tmp_path[PATH_MAX + 32];
+	int ret = snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int)getpid());
+	if (ret <= 0 || ret >= (int)sizeof(tmp_path)) {
+		return;
+	}
+
+	// Written to a temporary file first so a partial file is never loaded.
+	FILE *file = fopen(tmp_path, "wb");
+	if (file == NULL) {
+		U_LOG_D("Could not open '%s' for writing", tmp_path);
+		return;
+	}
+
+	bool ok = fwrite(key, sizeof(*key), 1, file) == 1 && //
+	          fwrite(triplets, sizeof(*triplets), triplet_count, file) == triplet_count;
+	ok = (fclose(file) == 0) && ok;
+
+	if (!ok || rename(tmp_path, path) != 0) {
+		U_LOG_W("Failed to write distortion mesh cache '%s'", path);
+		remove(tmp_path);
+		return;
+	}
+
+	U_LOG_D("Saved distortion mesh to '%s'", path);
+}
+
+#else
+
+static bool
+cache_load(const struct mesh_cache_key *key, struct xrt_uv_triplet *triplets, size_t triplet_count)
+{
+	return false;
+}
+
+static void
+cache_save(const struct mesh_cache_key *key, const struct xrt_uv_triplet *triplets, size_t triplet_count)
+{
+	// Not supported.
+}
+
+#endif
+
+
+/*
+ *
+ * Mesh building.
+ *
+ */
+
+/*!
+ * Build the mesh from @p triplets, as returned by @ref compute_grids with a
+ * grid size of @p num plus one for all views of @p target.
+ */
+static void
+build_mesh(struct xrt_hmd_parts *target, uint32_t num, const struct xrt_uv_triplet *triplets)
+{
 	uint32_t view_count = target->view_count;
 
 	uint32_t vertex_offsets[XRT_MAX_VIEWS] = {0};
@@ -59,6 +414,7 @@ run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target,
 
 	// Setup the vertices for all views.
 	uint32_t i = 0;
+	uint32_t t = 0;
 	for (uint32_t view = 0; view < view_count; view++) {
 		vertex_offsets[view] = i / stride_in_floats;
 
@@ -74,11 +430,7 @@ run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target,
 				verts[i + 0] = u * 2.0f - 1.0f;
 				verts[i + 1] = v * 2.0f - 1.0f;
 
-				if (!calc(xdev, view, u, v, (struct xrt_uv_triplet *)&verts[i + 2])) {
-					// bail on error, without updating
-					// distortion.preferred
-					return;
-				}
+				memcpy(&verts[i + 2], &triplets[t++], sizeof(struct xrt_uv_triplet));
 
 				i += stride_in_floats;
 			}
@@ -124,6 +476,24 @@ run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target,
 	}
 }
 
+static void
+run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target, uint32_t num)
+{
+	uint32_t view_count = target->view_count;
+	uint32_t grid_size = num + 1;
+
+	struct xrt_uv_triplet *triplets = U_TYPED_ARRAY_CALLOC(struct xrt_uv_triplet, grid_size * grid_size * view_count);
+
+	if (!compute_grids(xdev, calc, 0, view_count, grid_size, triplets)) {
+		// bail on error, without updating distortion.preferred
+		free(triplets);
+		return;
+	}
+
+	build_mesh(target, num, triplets);
+	free(triplets);
+}
+
 bool
 u_compute_distortion_vive(struct u_vive_values *values, float u, float v, struct xrt_uv_triplet *result)
 {
@@ -458,6 +828,7 @@ u_distortion_mesh_set_none(struct xrt_device *xdev)
 
 	// Make sure that the xdev implements the compute_distortion function.
 	xdev->compute_distortion = u_distortion_mesh_none;
+	xdev->compute_distortion_grid = NULL;
 
 	// Make the target completely usable.
 	target->distortion.models |= XRT_DISTORTION_MODEL_COMPUTE;
@@ -470,6 +841,19 @@ u_distortion_mesh_set_none(struct xrt_device *xdev)
  *
  */
 
+bool
+u_distortion_mesh_compute_grid(struct xrt_device *xdev,
+                               uint32_t view,
+                               uint32_t grid_size,
+                               struct xrt_uv_triplet *out_results)
+{
+	if (xdev->compute_distortion == NULL || grid_size < 2) {
+		return false;
+	}
+
+	return compute_grids(xdev, xdev->compute_distortion, view, 1, grid_size, out_results);
+}
+
 void
 u_distortion_mesh_fill_in_compute(struct xrt_device *xdev)
 {
@@ -482,6 +866,27 @@ u_distortion_mesh_fill_in_compute(struct xrt_device *xdev)
 	struct xrt_hmd_parts *target = xdev->hmd;
 
 	uint32_t num = (uint32_t)debug_get_num_option_mesh_size();
+	uint32_t view_count = target->view_count;
+	uint32_t grid_size = num + 1;
+	size_t triplet_count = (size_t)grid_size * grid_size * view_count;
+
+	struct xrt_uv_triplet *triplets = U_TYPED_ARRAY_CALLOC(struct xrt_uv_triplet, triplet_count);
+
+	struct mesh_cache_key key;
+	bool use_cache = debug_get_bool_option_mesh_cache() && cache_make_key(xdev, calc, view_count, num, &key);
+
+	if (!use_cache || !cache_load(&key, triplets, triplet_count)) {
+		if (!compute_grids(xdev, calc, 0, view_count, grid_size, triplets)) {
+			// bail on error, without updating distortion.preferred
+			free(triplets);
+			return;
+		}
+
+		if (use_cache) {
+			cache_save(&key, triplets, triplet_count);
+		}
+	}
 
-	run_func(xdev, calc, target, num);
+	build_mesh(target, num, triplets);
+	free(triplets);
 }
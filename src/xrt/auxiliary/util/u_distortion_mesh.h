@@ -187,11 +187,32 @@ u_distortion_mesh_none(struct xrt_device *xdev, uint32_t view, float u, float v,
  *
  */
 
+/*!
+ * Compute the distortion for a grid of points, see
+ * @ref xrt_device::compute_distortion_grid for the layout. Uses
+ * xdev->compute_distortion_grid() if the device has it, otherwise calls
+ * xdev->compute_distortion() from a few threads, `XRT_MESH_THREADS` sets how
+ * many. Used by the IPC server to implement the bulk call for clients.
+ *
+ * @relatesalso xrt_device
+ * @ingroup aux_distortion
+ */
+bool
+u_distortion_mesh_compute_grid(struct xrt_device *xdev,
+                               uint32_t view,
+                               uint32_t grid_size,
+                               struct xrt_uv_triplet *out_results);
+
 /*!
  * Given a @ref xrt_device generates meshes by calling
  * xdev->compute_distortion(), populates `xdev->hmd_parts.distortion.mesh` &
  * `xdev->hmd_parts.distortion.models`.
  *
+ * The generated mesh is cached in the `mesh_cache` directory of the cache
+ * dir (see @ref u_file_get_cache_dir), keyed on the device serial and samples
+ * of the distortion function, so later runs can skip generating it. Set
+ * `XRT_MESH_CACHE=false` to disable.
+ *
  * @relatesalso xrt_device
  * @ingroup aux_distortion
  */
@@ -152,6 +152,41 @@ u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename
 	return fopen(file_str, mode);
 }
 
+ssize_t
+u_file_get_cache_dir(char *out_path, size_t out_path_size)
+{
+	const char *xdg_cache = getenv("XDG_CACHE_HOME");
+	const char *home = getenv("HOME");
+	if (xdg_cache != NULL) {
+		return snprintf(out_path, out_path_size, "%s/monado", xdg_cache);
+	}
+	if (home != NULL) {
+		return snprintf(out_path, out_path_size, "%s/.cache/monado", home);
+	}
+	return -1;
+}
+
+ssize_t
+u_file_make_path_in_cache_dir(const char *subpath, char *out_path, size_t out_path_size)
+{
+	char tmp[PATH_MAX];
+	ssize_t i = u_file_get_cache_dir(tmp, sizeof(tmp));
+	if (i <= 0 || i >= (ssize_t)sizeof(tmp)) {
+		return -1;
+	}
+
+	i = snprintf(out_path, out_path_size, "%s/%s", tmp, subpath);
+	if (i <= 0 || i >= (ssize_t)out_path_size) {
+		return -1;
+	}
+
+	if (mkpath(out_path) != 0) {
+		return -1;
+	}
+
+	return i;
+}
+
 ssize_t
 u_file_get_hand_tracking_models_dir(char *out_path, size_t out_path_size)
 {
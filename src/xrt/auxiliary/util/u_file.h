@@ -31,6 +31,20 @@ u_file_open_file_in_config_dir(const char *filename, const char *mode);
 FILE *
 u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename, const char *mode);
 
+/*!
+ * Get the per-user cache directory, `$XDG_CACHE_HOME/monado` or
+ * `$HOME/.cache/monado`, data in it may be removed at any time.
+ */
+ssize_t
+u_file_get_cache_dir(char *out_path, size_t out_path_size);
+
+/*!
+ * Get the path to the @p subpath directory in the cache directory, creating
+ * it and any missing parents if needed.
+ */
+ssize_t
+u_file_make_path_in_cache_dir(const char *subpath, char *out_path, size_t out_path_size);
+
 ssize_t
 u_file_get_hand_tracking_models_dir(char *out_path, size_t out_path_size);
 
@@ -87,7 +87,7 @@ free_roi(struct xrt_frame *xf)
 }
 
 void
-u_frame_create_roi(struct xrt_frame *original, struct xrt_rect roi, struct xrt_frame **out_frame)
+u_frame_init_roi(struct xrt_frame *xf, struct xrt_frame *original, struct xrt_rect roi)
 {
 	assert(roi.offset.w >= 0 && roi.offset.h >= 0 && roi.extent.w > 0 && roi.extent.h > 0);
 	uint32_t x = roi.offset.w;
@@ -120,11 +120,8 @@ u_frame_create_roi(struct xrt_frame *original, struct xrt_rect roi, struct xrt_f
 	size_t end_margin = original->stride - ((xb + wb) * bsz);
 	size_t size = hb * original->stride - start_margin - end_margin;
 
-	// Create and fill in ROI frame
-
-	struct xrt_frame *xf = U_TYPED_CALLOC(struct xrt_frame);
+	// Fill in ROI frame
 
-	xf->destroy = free_roi;
 	xrt_frame_reference((struct xrt_frame **)&xf->owner, original);
 
 	xf->width = w;
@@ -140,6 +137,15 @@ u_frame_create_roi(struct xrt_frame *original, struct xrt_rect roi, struct xrt_f
 	xf->source_timestamp = original->source_timestamp;
 	xf->source_sequence = original->source_sequence;
 	xf->source_id = original->source_id;
+}
+
+void
+u_frame_create_roi(struct xrt_frame *original, struct xrt_rect roi, struct xrt_frame **out_frame)
+{
+	struct xrt_frame *xf = U_TYPED_CALLOC(struct xrt_frame);
+
+	xf->destroy = free_roi;
+	u_frame_init_roi(xf, original, roi);
 
 	xrt_frame_reference(out_frame, xf);
 }
@@ -37,6 +37,14 @@ u_frame_clone(struct xrt_frame *to_copy, struct xrt_frame **out_frame);
 void
 u_frame_create_roi(struct xrt_frame *original, struct xrt_rect roi, struct xrt_frame **out_frame);
 
+/*!
+ * Fills in the fields of @p xf to be a region of interest of @p original,
+ * taking a reference to @p original in @p xf owner. Doesn't touch the
+ * reference or destroy fields, for use by code with its own frame allocation.
+ */
+void
+u_frame_init_roi(struct xrt_frame *xf, struct xrt_frame *original, struct xrt_rect roi);
+
 #ifdef __cplusplus
 }
 #endif
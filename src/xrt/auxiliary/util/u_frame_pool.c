@@ -0,0 +1,296 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Pool of recycled @ref xrt_frame objects.
+ * @ingroup aux_util
+ */
+
+#include "os/os_threading.h"
+
+#include "util/u_misc.h"
+#include "util/u_frame.h"
+#include "util/u_format.h"
+#include "util/u_frame_pool.h"
+
+#include <assert.h>
+
+
+/*!
+ * A frame allocated by a @ref u_frame_pool.
+ *
+ * @implements xrt_frame
+ */
+struct u_pool_frame
+{
+	struct xrt_frame base;
+
+	//! Pool this frame returns to, holds a reference on it.
+	struct u_frame_pool *pool;
+
+	//! Next free frame when in a free list.
+	struct u_pool_frame *next;
+
+	//! Region of interest frames have no data of their own.
+	bool is_roi;
+};
+
+struct u_frame_pool
+{
+	//! One for the owner and one for each frame out of the pool.
+	struct xrt_reference reference;
+
+	//! Protects all of the fields below.
+	struct os_mutex mutex;
+
+	//! The owner has called destroy, return frames are freed.
+	bool destroyed;
+
+	//! Max number of frames to keep in each of the free lists.
+	uint32_t max_free;
+
+	//! Format and size of the frames in @ref free_frames.
+	enum xrt_format format;
+	uint32_t width;
+	uint32_t height;
+
+	struct u_pool_frame *free_frames;
+	uint32_t free_frame_count;
+
+	struct u_pool_frame *free_rois;
+	uint32_t free_roi_count;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static void
+free_list(struct u_pool_frame *pf)
+{
+	while (pf != NULL) {
+		struct u_pool_frame *next = pf->next;
+		if (!pf->is_roi) {
+			free(pf->base.data);
+		}
+		free(pf);
+		pf = next;
+	}
+}
+
+static void
+pool_unref(struct u_frame_pool *pool)
+{
+	if (!xrt_reference_dec_and_is_zero(&pool->reference)) {
+		return;
+	}
+
+	// Both the owner and all frames are gone, no need to lock.
+	free_list(pool->free_frames);
+	free_list(pool->free_rois);
+	os_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+static void
+pool_frame_destroy(struct xrt_frame *xf)
+{
+	struct u_pool_frame *pf = container_of(xf, struct u_pool_frame, base);
+	struct u_frame_pool *pool = pf->pool;
+
+	assert(xf->reference.count == 0);
+
+	if (pf->is_roi) {
+		xrt_frame_reference((struct xrt_frame **)&xf->owner, NULL);
+	}
+
+	os_mutex_lock(&pool->mutex);
+
+	bool keep = false;
+	if (pool->destroyed) {
+		keep = false;
+	} else if (pf->is_roi) {
+		keep = pool->free_roi_count < pool->max_free;
+		if (keep) {
+			pf->next = pool->free_rois;
+			pool->free_rois = pf;
+			pool->free_roi_count++;
+		}
+	} else {
+		// Only keep frames that match what is currently being asked for.
+		keep = pool->free_frame_count < pool->max_free && //
+		       xf->format == pool->format &&               //
+		       xf->width == pool->width &&                 //
+		       xf->height == pool->height;                 //
+		if (keep) {
+			pf->next = pool->free_frames;
+			pool->free_frames = pf;
+			pool->free_frame_count++;
+		}
+	}
+
+	os_mutex_unlock(&pool->mutex);
+
+	if (!keep) {
+		pf->next = NULL;
+		free_list(pf);
+	}
+
+	pool_unref(pool);
+}
+
+/*!
+ * Reset all fields but the ones describing the data of the frame.
+ */
+static void
+reset_frame(struct u_pool_frame *pf)
+{
+	uint8_t *data = pf->base.data;
+	size_t stride = pf->base.stride;
+	size_t size = pf->base.size;
+
+	U_ZERO(&pf->base);
+
+	pf->base.data = data;
+	pf->base.stride = stride;
+	pf->base.size = size;
+	pf->base.destroy = pool_frame_destroy;
+	pf->next = NULL;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+int
+u_frame_pool_create(uint32_t max_free, struct u_frame_pool **out_pool)
+{
+	struct u_frame_pool *pool = U_TYPED_CALLOC(struct u_frame_pool);
+
+	int ret = os_mutex_init(&pool->mutex);
+	if (ret != 0) {
+		free(pool);
+		return -1;
+	}
+
+	pool->reference.count = 1;
+	pool->max_free = max_free;
+
+	*out_pool = pool;
+
+	return 0;
+}
+
+void
+u_frame_pool_get(
+    struct u_frame_pool *pool, enum xrt_format f, uint32_t width, uint32_t height, struct xrt_frame **out_frame)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(u_format_is_blocks(f));
+
+	struct u_pool_frame *stale = NULL;
+	struct u_pool_frame *pf = NULL;
+
+	os_mutex_lock(&pool->mutex);
+
+	if (pool->format != f || pool->width != width || pool->height != height) {
+		// Free outside of the lock.
+		stale = pool->free_frames;
+		pool->free_frames = NULL;
+		pool->free_frame_count = 0;
+
+		pool->format = f;
+		pool->width = width;
+		pool->height = height;
+	}
+
+	if (pool->free_frames != NULL) {
+		pf = pool->free_frames;
+		pool->free_frames = pf->next;
+		pool->free_frame_count--;
+	}
+
+	os_mutex_unlock(&pool->mutex);
+
+	free_list(stale);
+
+	if (pf == NULL) {
+		pf = U_TYPED_CALLOC(struct u_pool_frame);
+		pf->pool = pool;
+		u_format_size_for_dimensions(f, width, height, &pf->base.stride, &pf->base.size);
+		pf->base.data = (uint8_t *)malloc(pf->base.size);
+	}
+
+	reset_frame(pf);
+	pf->base.format = f;
+	pf->base.width = width;
+	pf->base.height = height;
+
+	xrt_reference_inc(&pool->reference);
+	xrt_frame_reference(out_frame, &pf->base);
+}
+
+void
+u_frame_pool_create_roi(struct u_frame_pool *pool,
+                        struct xrt_frame *original,
+                        struct xrt_rect roi,
+                        struct xrt_frame **out_frame)
+{
+	struct u_pool_frame *pf = NULL;
+
+	os_mutex_lock(&pool->mutex);
+	if (pool->free_rois != NULL) {
+		pf = pool->free_rois;
+		pool->free_rois = pf->next;
+		pool->free_roi_count--;
+	}
+	os_mutex_unlock(&pool->mutex);
+
+	if (pf == NULL) {
+		pf = U_TYPED_CALLOC(struct u_pool_frame);
+		pf->pool = pool;
+		pf->is_roi = true;
+	}
+
+	reset_frame(pf);
+	u_frame_init_roi(&pf->base, original, roi);
+
+	xrt_reference_inc(&pool->reference);
+	xrt_frame_reference(out_frame, &pf->base);
+}
+
+void
+u_frame_pool_destroy(struct u_frame_pool **pool_ptr)
+{
+	struct u_frame_pool *pool = *pool_ptr;
+	if (pool == NULL) {
+		return;
+	}
+
+	os_mutex_lock(&pool->mutex);
+
+	pool->destroyed = true;
+
+	struct u_pool_frame *frames = pool->free_frames;
+	struct u_pool_frame *rois = pool->free_rois;
+	pool->free_frames = NULL;
+	pool->free_frame_count = 0;
+	pool->free_rois = NULL;
+	pool->free_roi_count = 0;
+
+	os_mutex_unlock(&pool->mutex);
+
+	free_list(frames);
+	free_list(rois);
+
+	pool_unref(pool);
+
+	*pool_ptr = NULL;
+}
@@ -0,0 +1,84 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Pool of recycled @ref xrt_frame objects.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Default number of unused frames a pool keeps around, enough to cover a
+ * frame being processed, one being queued and one in flight.
+ *
+ * @ingroup aux_util
+ */
+#define U_FRAME_POOL_DEFAULT_MAX_FREE 4
+
+/*!
+ * A pool of frames of one format and size, frames return to the pool when
+ * their reference count reaches zero instead of being freed. If a frame of
+ * a different format or size is asked for all cached frames are dropped, so
+ * pools work best when each producer has its own.
+ *
+ * The pool is thread safe and is kept alive until both the owner has called
+ * @ref u_frame_pool_destroy and all frames from it have been released.
+ *
+ * @ingroup aux_util
+ */
+struct u_frame_pool;
+
+/*!
+ * Create a pool that keeps at most @p max_free unused frames around.
+ *
+ * @return Zero on success, negative if the pool could not be created, then
+ *         @p out_pool is not touched.
+ *
+ * @public @memberof u_frame_pool
+ */
+int
+u_frame_pool_create(uint32_t max_free, struct u_frame_pool **out_pool);
+
+/*!
+ * Get a frame, works like @ref u_frame_create_one_off but reuses a frame from
+ * the pool if one of the same format and size is free. The contents of the
+ * frame data are undefined and all other fields are reset.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_get(
+    struct u_frame_pool *pool, enum xrt_format f, uint32_t width, uint32_t height, struct xrt_frame **out_frame);
+
+/*!
+ * Works like @ref u_frame_create_roi but reuses the frame struct from the pool.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_create_roi(struct u_frame_pool *pool,
+                        struct xrt_frame *original,
+                        struct xrt_rect roi,
+                        struct xrt_frame **out_frame);
+
+/*!
+ * Release the owners reference and free all unused frames, frames still in
+ * use are freed when they are released.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_destroy(struct u_frame_pool **pool_ptr);
+
+
+#ifdef __cplusplus
+}
+#endif
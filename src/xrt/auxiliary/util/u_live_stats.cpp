@@ -61,6 +61,17 @@ print_as_ms(u_pp_delegate_t dg, uint64_t value_ns)
 	u_pp(dg, ".%03" PRIu64 "ms", in_us % 1000);
 }
 
+/*!
+ * Nearest rank percentile, @p values must be sorted and @p count non-zero.
+ */
+static uint64_t
+get_percentile(const uint64_t *values, uint32_t count, uint32_t percent)
+{
+	uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+
+	return values[rank > 0 ? rank - 1 : 0];
+}
+
 
 /*
  *
@@ -96,6 +107,29 @@ u_ls_ns_get_and_reset(struct u_live_stats_ns *uls, uint64_t *out_median, uint64_
 	*out_worst = worst;
 }
 
+extern "C" void
+u_ls_ns_get_percentiles_and_reset(struct u_live_stats_ns *uls,
+                                  uint64_t *out_p50,
+                                  uint64_t *out_p99,
+                                  uint64_t *out_worst)
+{
+	uint32_t count = uls->value_count;
+
+	if (count == 0) {
+		*out_p50 = 0;
+		*out_p99 = 0;
+		*out_worst = 0;
+		return;
+	}
+
+	std::sort(&uls->values[0], &uls->values[count]);
+
+	uls->value_count = 0;
+	*out_p50 = get_percentile(uls->values, count, 50);
+	*out_p99 = get_percentile(uls->values, count, 99);
+	*out_worst = uls->values[count - 1];
+}
+
 extern "C" void
 u_ls_ns_print_header(u_pp_delegate_t dg)
 {
@@ -114,3 +148,22 @@ u_ls_ns_print_and_reset(struct u_live_stats_ns *uls, u_pp_delegate_t dg)
 	print_as_ms(dg, mean);
 	print_as_ms(dg, worst);
 }
+
+extern "C" void
+u_ls_ns_print_percentiles_header(u_pp_delegate_t dg)
+{
+	//       "xxxxYYYYzzzzWWWW M'TTT'###.FFFms M'TTT'###.FFFms M'TTT'###.FFFms"
+	u_pp(dg, "            name             p50             p99           worst");
+}
+
+extern "C" void
+u_ls_ns_print_percentiles_and_reset(struct u_live_stats_ns *uls, u_pp_delegate_t dg)
+{
+	uint64_t p50, p99, worst;
+	u_ls_ns_get_percentiles_and_reset(uls, &p50, &p99, &worst);
+
+	u_pp(dg, "%16s", uls->name);
+	print_as_ms(dg, p50);
+	print_as_ms(dg, p99);
+	print_as_ms(dg, worst);
+}
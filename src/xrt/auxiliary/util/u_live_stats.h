@@ -81,6 +81,18 @@ u_ls_ns_add(struct u_live_stats_ns *uls, uint64_t value)
 void
 u_ls_ns_get_and_reset(struct u_live_stats_ns *uls, uint64_t *out_median, uint64_t *out_mean, uint64_t *out_worst);
 
+/*!
+ * Get the median, 99th percentile and worst of the current set of values,
+ * then reset the struct.
+ *
+ * @public @memberof u_live_stats_ns
+ */
+void
+u_ls_ns_get_percentiles_and_reset(struct u_live_stats_ns *uls,
+                                  uint64_t *out_p50,
+                                  uint64_t *out_p99,
+                                  uint64_t *out_worst);
+
 /*!
  * Prints a header that looks nice before @ref u_ls_ns_print_and_reset,
  * adding details about columns. Doesn't include any newlines.
@@ -100,6 +112,25 @@ u_ls_ns_print_header(u_pp_delegate_t dg);
 void
 u_ls_ns_print_and_reset(struct u_live_stats_ns *uls, u_pp_delegate_t dg);
 
+/*!
+ * Like @ref u_ls_ns_print_header but for
+ * @ref u_ls_ns_print_percentiles_and_reset.
+ *
+ * @public @memberof u_live_stats_ns
+ */
+void
+u_ls_ns_print_percentiles_header(u_pp_delegate_t dg);
+
+/*!
+ * Prints the median, 99th percentile and worst values then resets the
+ * struct, see @ref u_ls_ns_get_percentiles_and_reset. Doesn't include any
+ * newlines.
+ *
+ * @public @memberof u_live_stats_ns
+ */
+void
+u_ls_ns_print_percentiles_and_reset(struct u_live_stats_ns *uls, u_pp_delegate_t dg);
+
 
 #ifdef __cplusplus
 }
@@ -11,14 +11,20 @@
 #include "xrt/xrt_config_os.h"
 #include "xrt/xrt_config_build.h"
 
+#include "util/u_misc.h"
 #include "util/u_debug.h"
 #include "u_json.h"
 #include "util/u_truncate_printf.h"
 
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
 #include <assert.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 /*
@@ -51,6 +57,18 @@
 #define LOG_HEX_LINE_BUF_SIZE (128)
 
 
+/*
+ * Number of messages that can be queued in async mode, must be a power of two.
+ */
+#define LOG_ASYNC_SLOT_COUNT (128)
+#define LOG_ASYNC_SLOT_MASK (LOG_ASYNC_SLOT_COUNT - 1)
+
+/*
+ * How often the async writer reports repeated and dropped messages.
+ */
+#define LOG_ASYNC_REPORT_INTERVAL_NS (U_TIME_1S_IN_NS)
+
+
 #ifndef LOG_ANDROID_TAG_PREFIX
 #define LOG_ANDROID_TAG_PREFIX "monado"
 #endif
@@ -63,6 +81,8 @@
 
 DEBUG_GET_ONCE_LOG_OPTION(global_log, "XRT_LOG", U_LOGGING_WARN)
 DEBUG_GET_ONCE_BOOL_OPTION(json_log, "XRT_JSON_LOG", false)
+DEBUG_GET_ONCE_BOOL_OPTION(async_log, "XRT_LOG_ASYNC", false)
+DEBUG_GET_ONCE_NUM_OPTION(async_log_rate, "XRT_LOG_ASYNC_RATE", 200)
 
 enum u_logging_level
 u_log_get_global_level(void)
@@ -415,6 +435,489 @@ do_print(const char *file, int line, const char *func, enum u_logging_level leve
 	return printed;
 }
 
+/*
+ *
+ * Asynchronous output.
+ *
+ */
+
+/*!
+ * A queued message, the message is formatted by the caller but the prefix is
+ * added by the writer thread.
+ */
+struct log_slot
+{
+	//! Who owns the slot, see async_push and async_drain.
+	xrt_atomic_s32_t sequence;
+
+	const char *file;
+	int line;
+	const char *func;
+	enum u_logging_level level;
+
+	char text[LOG_BUFFER_SIZE];
+};
+
+enum log_async_state
+{
+	LOG_ASYNC_UNINITIALIZED = 0,
+	LOG_ASYNC_STARTING,
+	LOG_ASYNC_RUNNING,
+	LOG_ASYNC_OFF,
+};
+
+/*!
+ * State only touched by the writer thread.
+ */
+struct log_async_writer
+{
+	//! Last printed message, for duplicate suppression.
+	struct log_slot last;
+	bool has_last;
+	uint32_t repeats;
+
+	//! Token bucket for rate limiting, in messages.
+	double tokens;
+	int64_t last_refill_ns;
+	uint32_t dropped_rate;
+
+	int32_t reported_full;
+	int64_t last_report_ns;
+};
+
+/*!
+ * Bounded lock-free multiple producer single consumer queue, the writer thread
+ * is the only consumer.
+ */
+static struct
+{
+	xrt_atomic_s32_t state;
+
+	//! Next slot to be claimed by a producer.
+	xrt_atomic_s32_t enqueue_pos;
+
+	//! Next slot to be read, only written by the writer thread.
+	xrt_atomic_s32_t dequeue_pos;
+
+	//! Messages dropped because the queue was full.
+	xrt_atomic_s32_t dropped_full;
+
+	//! Producers inside async_push, the writer waits for them when stopping.
+	xrt_atomic_s32_t producers;
+
+	struct log_slot *slots;
+	struct os_semaphore sem;
+	struct os_thread_helper oth;
+
+	//! Broadcast by the writer thread after every drain, see async_wait_drained.
+	struct os_mutex drained_mutex;
+	struct os_cond drained_cond;
+} g_async;
+
+static void
+print_formatted(const char *file, int line, const char *func, enum u_logging_level level, const char *format, ...)
+    XRT_PRINTF_FORMAT(5, 6);
+
+static void
+print_formatted(const char *file, int line, const char *func, enum u_logging_level level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	DISPATCH_SINK(file, line, func, level, format, args);
+	do_print(file, line, func, level, format, args);
+	va_end(args);
+}
+
+static bool
+is_same_message(const struct log_slot *a, const struct log_slot *b)
+{
+	return a->line == b->line &&   //
+	       a->level == b->level && //
+	       a->file == b->file &&   //
+	       strcmp(a->text, b->text) == 0;
+}
+
+static void
+writer_flush_repeats(struct log_async_writer *w)
+{
+	if (w->repeats == 0) {
+		return;
+	}
+
+	const struct log_slot *l = &w->last;
+	print_formatted(l->file, l->line, l->func, l->level, "Previous message repeated %u times", w->repeats);
+	w->repeats = 0;
+}
+
+static bool
+writer_take_token(struct log_async_writer *w, int64_t now_ns)
+{
+	int64_t rate = debug_get_num_option_async_log_rate();
+	if (rate <= 0) {
+		return true;
+	}
+
+	// Refill, allow bursts of up to one second worth of messages.
+	double seconds = time_ns_to_s(now_ns - w->last_refill_ns);
+	w->tokens += seconds * (double)rate;
+	if (w->tokens > (double)rate) {
+		w->tokens = (double)rate;
+	}
+	w->last_refill_ns = now_ns;
+
+	if (w->tokens < 1.0) {
+		return false;
+	}
+
+	w->tokens -= 1.0;
+
+	return true;
+}
+
+static void
+writer_handle(struct log_async_writer *w, const struct log_slot *slot, int64_t now_ns)
+{
+	// Raw output is printed as is, it is not noise.
+	bool raw = slot->level == U_LOGGING_RAW;
+
+	if (!raw && w->has_last && is_same_message(&w->last, slot)) {
+		w->repeats++;
+		return;
+	}
+
+	writer_flush_repeats(w);
+
+	// Errors always get through.
+	if (!raw && slot->level < U_LOGGING_ERROR && !writer_take_token(w, now_ns)) {
+		w->dropped_rate++;
+		return;
+	}
+
+	print_formatted(slot->file, slot->line, slot->func, slot->level, "%s", slot->text);
+
+	w->has_last = !raw;
+	if (w->has_last) {
+		w->last.file = slot->file;
+		w->last.line = slot->line;
+		w->last.func = slot->func;
+		w->last.level = slot->level;
+		memcpy(w->last.text, slot->text, sizeof(w->last.text));
+	}
+}
+
+static void
+writer_report(struct log_async_writer *w, int64_t now_ns, bool force)
+{
+	if (!force && now_ns - w->last_report_ns < LOG_ASYNC_REPORT_INTERVAL_NS) {
+		return;
+	}
+	w->last_report_ns = now_ns;
+
+	writer_flush_repeats(w);
+
+	int32_t full = g_async.dropped_full;
+	uint32_t new_full = (uint32_t)full - (uint32_t)w->reported_full;
+	if (new_full == 0 && w->dropped_rate == 0) {
+		return;
+	}
+
+	print_formatted(__FILE__, __LINE__, __func__, U_LOGGING_WARN,
+	                "Dropped log messages, %u because the queue was full and %u due to rate limiting", new_full,
+	                w->dropped_rate);
+
+	w->reported_full = full;
+	w->dropped_rate = 0;
+}
+
+static void
+async_drain(struct log_async_writer *w)
+{
+	int64_t now_ns = os_monotonic_get_ns();
+
+	while (true) {
+		uint32_t pos = (uint32_t)g_async.dequeue_pos;
+		struct log_slot *slot = &g_async.slots[pos & LOG_ASYNC_SLOT_MASK];
+
+		// Not yet written or still being formatted.
+		if ((uint32_t)slot->sequence != pos + 1) {
+			break;
+		}
+
+		// Make sure the message is read after the sequence.
+		xrt_atomic_full_barrier();
+
+		writer_handle(w, slot, now_ns);
+
+		// Make sure the message has been read before handing the slot back.
+		xrt_atomic_full_barrier();
+		slot->sequence = (int32_t)(pos + LOG_ASYNC_SLOT_COUNT);
+		g_async.dequeue_pos = (int32_t)(pos + 1);
+	}
+
+	os_mutex_lock(&g_async.drained_mutex);
+	os_cond_broadcast(&g_async.drained_cond);
+	os_mutex_unlock(&g_async.drained_mutex);
+}
+
+/*!
+ * Wake the writer thread and wait until it has read past @p pos, or until
+ * async mode is stopped.
+ */
+static void
+async_wait_drained(uint32_t pos)
+{
+	os_semaphore_release(&g_async.sem);
+
+	os_mutex_lock(&g_async.drained_mutex);
+	while ((int32_t)((uint32_t)g_async.dequeue_pos - pos) <= 0 && g_async.state == LOG_ASYNC_RUNNING) {
+		os_cond_wait(&g_async.drained_cond, &g_async.drained_mutex);
+	}
+	os_mutex_unlock(&g_async.drained_mutex);
+}
+
+static void *
+async_run(void *ptr)
+{
+	struct log_async_writer *w = (struct log_async_writer *)ptr;
+
+	w->last_refill_ns = os_monotonic_get_ns();
+	w->last_report_ns = w->last_refill_ns;
+	w->tokens = (double)debug_get_num_option_async_log_rate();
+
+	// Started before the state is set to running, keeps going until no producer can queue anything.
+	while (g_async.state != LOG_ASYNC_OFF || g_async.producers != 0) {
+		os_semaphore_wait(&g_async.sem, LOG_ASYNC_REPORT_INTERVAL_NS);
+
+		async_drain(w);
+		writer_report(w, os_monotonic_get_ns(), false);
+	}
+
+	// Everything queued before stopping.
+	async_drain(w);
+	writer_report(w, os_monotonic_get_ns(), true);
+
+	free(w);
+
+	return NULL;
+}
+
+static void
+async_stop(void)
+{
+	if (g_async.state != LOG_ASYNC_RUNNING) {
+		return;
+	}
+
+	// New messages are printed directly from here on.
+	g_async.state = LOG_ASYNC_OFF;
+	xrt_atomic_full_barrier();
+
+	// Wake up the writer, it waits for producers and drains the queue before exiting.
+	os_semaphore_release(&g_async.sem);
+	os_thread_helper_destroy(&g_async.oth);
+
+	/*
+	 * The slots, semaphore, mutex and condition variable are left for the
+	 * process exit, producers that saw the state as running still release
+	 * the semaphore after they are done.
+	 */
+}
+
+static bool
+async_start(void)
+{
+	if (!debug_get_bool_option_async_log()) {
+		goto err_off;
+	}
+
+	g_async.slots = U_TYPED_ARRAY_CALLOC(struct log_slot, LOG_ASYNC_SLOT_COUNT);
+	struct log_async_writer *w = U_TYPED_CALLOC(struct log_async_writer);
+	if (g_async.slots == NULL || w == NULL) {
+		free(w);
+		goto err_free;
+	}
+
+	for (uint32_t i = 0; i < LOG_ASYNC_SLOT_COUNT; i++) {
+		g_async.slots[i].sequence = (int32_t)i;
+	}
+
+	if (os_semaphore_init(&g_async.sem, 0) != 0) {
+		free(w);
+		goto err_free;
+	}
+
+	if (os_mutex_init(&g_async.drained_mutex) != 0) {
+		free(w);
+		goto err_sem;
+	}
+
+	if (os_cond_init(&g_async.drained_cond) != 0) {
+		free(w);
+		goto err_mutex;
+	}
+
+	if (os_thread_helper_init(&g_async.oth) != 0) {
+		free(w);
+		goto err_cond;
+	}
+
+	// Make sure the thread sees the slots.
+	xrt_atomic_full_barrier();
+
+	if (os_thread_helper_start(&g_async.oth, async_run, w) != 0) {
+		free(w);
+		goto err_oth;
+	}
+
+	os_thread_helper_name(&g_async.oth, "Log Writer");
+
+	atexit(async_stop);
+
+	xrt_atomic_full_barrier();
+	g_async.state = LOG_ASYNC_RUNNING;
+
+	return true;
+
+err_oth:
+	os_thread_helper_destroy(&g_async.oth);
+err_cond:
+	os_cond_destroy(&g_async.drained_cond);
+err_mutex:
+	os_mutex_destroy(&g_async.drained_mutex);
+err_sem:
+	os_semaphore_destroy(&g_async.sem);
+err_free:
+	free(g_async.slots);
+	g_async.slots = NULL;
+err_off:
+	g_async.state = LOG_ASYNC_OFF;
+
+	return false;
+}
+
+static bool
+async_is_running(void)
+{
+	int32_t state = g_async.state;
+	if (state == LOG_ASYNC_RUNNING) {
+		// Pairs with the barrier in async_start.
+		xrt_atomic_full_barrier();
+		return true;
+	}
+
+	if (state != LOG_ASYNC_UNINITIALIZED) {
+		return false;
+	}
+
+	// Messages printed while starting, like the option itself, go out directly.
+	if (xrt_atomic_s32_cmpxchg(&g_async.state, LOG_ASYNC_UNINITIALIZED, LOG_ASYNC_STARTING) !=
+	    LOG_ASYNC_UNINITIALIZED) {
+		return false;
+	}
+
+	return async_start();
+}
+
+/*!
+ * Claim a slot and write the message into it, returns false if async mode was
+ * stopped while waiting for a slot.
+ */
+static bool
+async_enqueue(const char *file,
+              int line,
+              const char *func,
+              enum u_logging_level level,
+              const char *format,
+              va_list args)
+{
+	struct log_slot *slot = NULL;
+	uint32_t pos = (uint32_t)g_async.enqueue_pos;
+
+	while (true) {
+		slot = &g_async.slots[pos & LOG_ASYNC_SLOT_MASK];
+		int32_t diff = (int32_t)((uint32_t)slot->sequence - pos);
+
+		if (diff == 0) {
+			// Free slot, try to claim it.
+			uint32_t old = (uint32_t)xrt_atomic_s32_cmpxchg(&g_async.enqueue_pos, (int32_t)pos, (int32_t)(pos + 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// Full, errors and raw output are waited for, everything else is dropped.
+			if (level < U_LOGGING_ERROR) {
+				xrt_atomic_s32_inc_return(&g_async.dropped_full);
+				return true;
+			}
+
+			if (g_async.state != LOG_ASYNC_RUNNING) {
+				return false;
+			}
+
+			// The slot is handed back when the writer reads past the previous lap.
+			async_wait_drained(pos - LOG_ASYNC_SLOT_COUNT);
+			pos = (uint32_t)g_async.enqueue_pos;
+		} else {
+			// Some other producer claimed it.
+			pos = (uint32_t)g_async.enqueue_pos;
+		}
+	}
+
+	slot->file = file;
+	slot->line = line;
+	slot->func = func;
+	slot->level = level;
+
+	if (u_truncate_vsnprintf(slot->text, sizeof(slot->text), format, args) < 0) {
+		slot->text[0] = '\0';
+	}
+
+	// Make sure the message is written before the sequence.
+	xrt_atomic_full_barrier();
+	slot->sequence = (int32_t)(pos + 1);
+
+	return true;
+}
+
+/*!
+ * Queue the message for the writer thread, returns false if async mode is off
+ * and the message should be printed directly.
+ */
+static bool
+async_push(const char *file, int line, const char *func, enum u_logging_level level, const char *format, va_list args)
+{
+	if (!async_is_running()) {
+		return false;
+	}
+
+	// Counted before checking the state again, so async_stop can't miss us.
+	xrt_atomic_s32_inc_return(&g_async.producers);
+
+	bool queued = false;
+	if (g_async.state == LOG_ASYNC_RUNNING) {
+		queued = async_enqueue(file, line, func, level, format, args);
+	}
+
+	xrt_atomic_s32_dec_return(&g_async.producers);
+
+	// Wakes the writer for the new message, or to see that we are done.
+	os_semaphore_release(&g_async.sem);
+
+	return queued;
+}
+
+static void
+log_dispatch(const char *file, int line, const char *func, enum u_logging_level level, const char *format, va_list args)
+{
+	if (async_push(file, line, func, level, format, args)) {
+		return;
+	}
+
+	DISPATCH_SINK(file, line, func, level, format, args);
+	do_print(file, line, func, level, format, args);
+}
+
 
 /*
  *
@@ -427,8 +930,7 @@ u_log(const char *file, int line, const char *func, enum u_logging_level level,
 {
 	va_list args;
 	va_start(args, format);
-	DISPATCH_SINK(file, line, func, level, format, args);
-	do_print(file, line, func, level, format, args);
+	log_dispatch(file, line, func, level, format, args);
 	va_end(args);
 }
 
@@ -443,7 +945,22 @@ u_log_xdev(const char *file,
 {
 	va_list args;
 	va_start(args, format);
-	DISPATCH_SINK(file, line, func, level, format, args);
-	do_print(file, line, func, level, format, args);
+	log_dispatch(file, line, func, level, format, args);
 	va_end(args);
 }
+
+void
+u_log_flush(void)
+{
+	if (g_async.state != LOG_ASYNC_RUNNING) {
+		return;
+	}
+
+	uint32_t target = (uint32_t)g_async.enqueue_pos;
+	if (target == (uint32_t)g_async.dequeue_pos) {
+		return;
+	}
+
+	// Everything claimed before this call, up to and including target - 1.
+	async_wait_drained(target - 1);
+}
@@ -263,12 +263,30 @@ u_log_xdev_hex(const char *file,
  * Sets the logging sink, log is still passed on to the platform defined output
  * as well as the sink.
  *
+ * When asynchronous logging is enabled with the `XRT_LOG_ASYNC` environment
+ * variable, the sink is called from the log writer thread. It then gets the
+ * already formatted message with a `"%s"` format string, and repeated or rate
+ * limited messages are not passed on.
+ *
  * @param func Logging function for the calls to be sent to.
  * @param data User data to be passed into @p func.
  */
 void
 u_log_set_sink(u_log_sink_func_t func, void *data);
 
+/*!
+ * Waits until all messages logged before this call have been printed and
+ * passed to the sink. Does nothing unless asynchronous logging is enabled.
+ *
+ * In asynchronous mode messages are formatted on the calling thread and put in
+ * a lock-free queue, a writer thread prints them and suppresses repeated
+ * messages. Messages are dropped when the queue is full, and messages below
+ * @ref U_LOGGING_ERROR are rate limited by `XRT_LOG_ASYNC_RATE` messages per
+ * second, zero disables the limit. Errors and raw messages are never dropped.
+ */
+void
+u_log_flush(void);
+
 /*!
  * @}
  */
@@ -7,21 +7,70 @@
  * @ingroup aux_util
  */
 
+#include "os/os_time.h"
 #include "os/os_threading.h"
 
 #include "util/u_metrics.h"
+#include "util/u_time.h"
 #include "util/u_debug.h"
 
 #include "monado_metrics.pb.h"
 #include "pb_encode.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #define VERSION_MAJOR 1
 #define VERSION_MINOR 1
 
+//! Largest encoded record, including the submessage header.
+#define RECORD_MAX_SIZE (monado_metrics_Record_size + 10)
+
+//! Number of records that can be queued, must be a power of two.
+#define RING_SIZE (2048)
+
+//! How long the writer thread sleeps between draining the ring.
+#define WRITER_PERIOD_NS (10 * U_TIME_1MS_IN_NS)
+
+//! Size of the buffer records are gathered in before being written.
+#define BATCH_SIZE (64 * 1024)
+
+/*!
+ * One encoded record in the ring.
+ *
+ * The sequence number tells who owns the slot, it is equal to the position
+ * when free for a producer at that position and position plus one once the
+ * record is written and the writer may consume it.
+ */
+struct record_slot
+{
+	xrt_atomic_s32_t seq;
+	uint32_t size;
+	uint8_t data[RECORD_MAX_SIZE];
+};
+
+/*!
+ * Bounded lock-free multi producer single consumer ring of encoded records,
+ * producers never block and if the ring is full the record is dropped.
+ */
+struct record_ring
+{
+	//! Next position for producers, claimed with compare and swap.
+	xrt_atomic_s32_t enqueue_pos;
+
+	//! Number of records dropped because the ring was full.
+	xrt_atomic_s32_t dropped;
+
+	//! Next position to be consumed, only touched by the writer thread.
+	int32_t dequeue_pos;
+
+	struct record_slot slots[RING_SIZE];
+};
+
 static FILE *g_file = NULL;
-static struct os_mutex g_file_mutex;
+static struct record_ring g_ring;
+static struct os_thread_helper g_writer;
+static uint8_t g_batch[BATCH_SIZE];
 static bool g_metrics_initialized = false;
 static bool g_metrics_early_flush = false;
 
@@ -30,16 +79,178 @@ DEBUG_GET_ONCE_BOOL_OPTION(metrics_early_flush, "XRT_METRICS_EARLY_FLUSH", false
 
 
 
+/*
+ *
+ * Ring functions.
+ *
+ */
+
+static inline int32_t
+pos_add(int32_t pos, uint32_t value)
+{
+	// Wrapping without signed overflow.
+	return (int32_t)((uint32_t)pos + value);
+}
+
+static inline int32_t
+pos_diff(int32_t a, int32_t b)
+{
+	return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static void
+ring_init(struct record_ring *ring)
+{
+	ring->enqueue_pos = 0;
+	ring->dequeue_pos = 0;
+	ring->dropped = 0;
+
+	for (int32_t i = 0; i < RING_SIZE; i++) {
+		ring->slots[i].seq = i;
+	}
+
+	xrt_atomic_full_barrier();
+}
+
+static bool
+ring_push(struct record_ring *ring, const uint8_t *data, uint32_t size)
+{
+	struct record_slot *slot = NULL;
+	int32_t pos = ring->enqueue_pos;
+
+	while (true) {
+		slot = &ring->slots[(uint32_t)pos & (RING_SIZE - 1)];
+		int32_t seq = slot->seq;
+		xrt_atomic_full_barrier();
+
+		int32_t diff = pos_diff(seq, pos);
+		if (diff == 0) {
+			// Slot is free, try to claim the position.
+			int32_t old = xrt_atomic_s32_cmpxchg(&ring->enqueue_pos, pos, pos_add(pos, 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// The writer has not gotten to this slot yet, ring is full.
+			xrt_atomic_s32_inc_return(&ring->dropped);
+			return false;
+		} else {
+			// Another producer claimed it, try again.
+			pos = ring->enqueue_pos;
+		}
+	}
+
+	memcpy(slot->data, data, size);
+	slot->size = size;
+
+	// Publish the record to the writer.
+	xrt_atomic_full_barrier();
+	slot->seq = pos_add(pos, 1);
+
+	return true;
+}
+
+/*!
+ * Returns the next record or NULL if the ring is empty, the slot must be given
+ * back with @ref ring_release before calling this again.
+ */
+static struct record_slot *
+ring_peek(struct record_ring *ring)
+{
+	struct record_slot *slot = &ring->slots[(uint32_t)ring->dequeue_pos & (RING_SIZE - 1)];
+	int32_t seq = slot->seq;
+	xrt_atomic_full_barrier();
+
+	if (pos_diff(seq, pos_add(ring->dequeue_pos, 1)) != 0) {
+		return NULL;
+	}
+
+	return slot;
+}
+
+static void
+ring_release(struct record_ring *ring, struct record_slot *slot)
+{
+	// Make sure the data has been read before the slot is reused.
+	xrt_atomic_full_barrier();
+	slot->seq = pos_add(ring->dequeue_pos, RING_SIZE);
+	ring->dequeue_pos = pos_add(ring->dequeue_pos, 1);
+}
+
+
+/*
+ *
+ * Writer thread.
+ *
+ */
+
+static void
+drain_ring(int32_t *last_dropped)
+{
+	struct record_slot *slot = NULL;
+	size_t batch_size = 0;
+
+	while ((slot = ring_peek(&g_ring)) != NULL) {
+		if (batch_size + slot->size > sizeof(g_batch)) {
+			fwrite(g_batch, batch_size, 1, g_file);
+			batch_size = 0;
+		}
+
+		memcpy(g_batch + batch_size, slot->data, slot->size);
+		batch_size += slot->size;
+
+		ring_release(&g_ring, slot);
+	}
+
+	if (batch_size > 0) {
+		fwrite(g_batch, batch_size, 1, g_file);
+
+		if (g_metrics_early_flush) {
+			fflush(g_file);
+		}
+	}
+
+	int32_t dropped = g_ring.dropped;
+	if (dropped != *last_dropped) {
+		U_LOG_W("Dropped %i metrics records in total, writer can not keep up!", dropped);
+		*last_dropped = dropped;
+	}
+}
+
+static void *
+run_writer(void *ptr)
+{
+	int32_t last_dropped = 0;
+
+	os_thread_helper_name(&g_writer, "Metrics Writer");
+
+	while (os_thread_helper_is_running(&g_writer)) {
+		drain_ring(&last_dropped);
+
+		os_nanosleep(WRITER_PERIOD_NS);
+	}
+
+	// Get any records written before we were stopped.
+	drain_ring(&last_dropped);
+
+	return NULL;
+}
+
+
 /*
  *
  * Helper functions.
  *
  */
 
+/*!
+ * Encode and queue the record for the writer thread, never blocks.
+ */
 static void
 write_record(monado_metrics_Record *r)
 {
-	uint8_t buffer[monado_metrics_Record_size + 10]; // Including submessage
+	uint8_t buffer[RECORD_MAX_SIZE]; // Including submessage
 
 
 	pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
@@ -49,15 +260,7 @@ write_record(monado_metrics_Record *r)
 		return;
 	}
 
-	os_mutex_lock(&g_file_mutex);
-
-	fwrite(buffer, stream.bytes_written, 1, g_file);
-
-	if (g_metrics_early_flush) {
-		fflush(g_file);
-	}
-
-	os_mutex_unlock(&g_file_mutex);
+	ring_push(&g_ring, buffer, (uint32_t)stream.bytes_written);
 }
 
 static void
@@ -99,13 +302,24 @@ u_metrics_init(void)
 		return;
 	}
 
-	os_mutex_init(&g_file_mutex);
+	ring_init(&g_ring);
 
 	g_metrics_initialized = true;
 	g_metrics_early_flush = debug_get_bool_option_metrics_early_flush();
 
 	write_version(VERSION_MAJOR, VERSION_MINOR);
 
+	os_thread_helper_init(&g_writer);
+	int ret = os_thread_helper_start(&g_writer, run_writer, NULL);
+	if (ret != 0) {
+		U_LOG_E("Failed to start metrics writer thread!");
+		g_metrics_initialized = false;
+		os_thread_helper_destroy(&g_writer);
+		fclose(g_file);
+		g_file = NULL;
+		return;
+	}
+
 	U_LOG_I("Opened metrics file: '%s'", str);
 }
 
@@ -118,16 +332,13 @@ u_metrics_close(void)
 
 	U_LOG_I("Closing metrics file: '%s'", debug_get_option_metrics_file());
 
-	// At least try to avoid races.
-	os_mutex_lock(&g_file_mutex);
+	// Stop new records, then let the writer drain what is queued.
+	g_metrics_initialized = false;
+	os_thread_helper_destroy(&g_writer);
+
 	fflush(g_file);
 	fclose(g_file);
 	g_file = NULL;
-	os_mutex_unlock(&g_file_mutex);
-
-	os_mutex_destroy(&g_file_mutex);
-
-	g_metrics_initialized = false;
 }
 
 bool
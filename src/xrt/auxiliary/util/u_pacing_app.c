@@ -368,27 +368,27 @@ do_tracing(struct pacing_app *pa, struct u_pa_frame *f)
 		return;
 	}
 
-#ifdef U_TRACE_TRACY // Uses Tracy specific things.
+#if defined(U_TRACE_TRACY) || defined(U_TRACE_BUILTIN) // Uses counters.
 	int64_t cpu_ns = f->when.begin_ns - f->when.wait_woke_ns;
-	TracyCPlot("App CPU(ms)", time_ns_to_ms_f(cpu_ns));
+	U_TRACE_COUNTER(timing, "App CPU(ms)", time_ns_to_ms_f(cpu_ns));
 
 	int64_t draw_ns = f->when.delivered_ns - f->when.begin_ns;
-	TracyCPlot("App Draw(ms)", time_ns_to_ms_f(draw_ns));
+	U_TRACE_COUNTER(timing, "App Draw(ms)", time_ns_to_ms_f(draw_ns));
 
 	int64_t gpu_ns = f->when.gpu_done_ns - f->when.delivered_ns;
-	TracyCPlot("App GPU(ms)", time_ns_to_ms_f(gpu_ns));
+	U_TRACE_COUNTER(timing, "App GPU(ms)", time_ns_to_ms_f(gpu_ns));
 
 	int64_t frame_ns = f->when.gpu_done_ns - f->when.wait_woke_ns;
-	TracyCPlot("App Frame(ms)", time_ns_to_ms_f(frame_ns));
+	U_TRACE_COUNTER(timing, "App Frame(ms)", time_ns_to_ms_f(frame_ns));
 
 	int64_t wake_diff_ns = (int64_t)f->when.wait_woke_ns - (int64_t)f->predicted_wake_up_time_ns;
-	TracyCPlot("App Wake Diff(ms)", time_ns_to_ms_f(wake_diff_ns));
+	U_TRACE_COUNTER(timing, "App Wake Diff(ms)", time_ns_to_ms_f(wake_diff_ns));
 
 	int64_t gpu_diff_ns = (int64_t)f->when.gpu_done_ns - (int64_t)f->predicted_gpu_done_time_ns;
-	TracyCPlot("App Frame Diff(ms)", time_ns_to_ms_f(gpu_diff_ns));
+	U_TRACE_COUNTER(timing, "App Frame Diff(ms)", time_ns_to_ms_f(gpu_diff_ns));
 #endif
 
-#ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
+#if defined(U_TRACE_PERCETTO) || defined(U_TRACE_BUILTIN) // Uses track events.
 #define TE_BEG(TRACK, TIME, NAME) U_TRACE_EVENT_BEGIN_ON_TRACK_DATA(timing, TRACK, TIME, NAME, PERCETTO_I(f->frame_id))
 #define TE_END(TRACK, TIME) U_TRACE_EVENT_END_ON_TRACK(timing, TRACK, TIME)
 
@@ -500,8 +500,8 @@ pa_predict(struct u_pacing_app *upa,
 	f->predicted_display_period_ns = period_ns;
 	f->when.predicted_ns = now_ns;
 
-#ifdef U_TRACE_TRACY // Uses Tracy specific things.
-	TracyCPlot("App time(ms)", time_ns_to_ms_f(total_app_time_ns(pa)));
+#if defined(U_TRACE_TRACY) || defined(U_TRACE_BUILTIN) // Uses counters.
+	U_TRACE_COUNTER(timing, "App time(ms)", time_ns_to_ms_f(total_app_time_ns(pa)));
 #endif
 }
 
@@ -430,7 +430,7 @@ do_metrics(struct pacing_compositor *pc, struct frame *f)
 static void
 do_tracing(struct pacing_compositor *pc, struct frame *f)
 {
-#ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
+#if defined(U_TRACE_PERCETTO) || defined(U_TRACE_BUILTIN) // Uses track events.
 	if (!U_TRACE_CATEGORY_IS_ENABLED(timing)) {
 		return;
 	}
@@ -382,7 +382,7 @@ pc_info_gpu(
 		u_metrics_write_system_gpu_info(&umgi);
 	}
 
-#ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
+#if defined(U_TRACE_PERCETTO) || defined(U_TRACE_BUILTIN) // Uses track events.
 	if (U_TRACE_CATEGORY_IS_ENABLED(timing)) {
 #define TE_BEG(TRACK, TIME, NAME) U_TRACE_EVENT_BEGIN_ON_TRACK_DATA(timing, TRACK, TIME, NAME, PERCETTO_I(frame_id))
 #define TE_END(TRACK, TIME) U_TRACE_EVENT_END_ON_TRACK(timing, TRACK, TIME)
@@ -395,9 +395,9 @@ pc_info_gpu(
 	}
 #endif
 
-#ifdef U_TRACE_TRACY
+#if defined(U_TRACE_TRACY) || defined(U_TRACE_BUILTIN)
 	int64_t diff_ns = gpu_end_ns - gpu_start_ns;
-	TracyCPlot("Compositor GPU(ms)", time_ns_to_ms_f(diff_ns));
+	U_TRACE_COUNTER(timing, "Compositor GPU(ms)", time_ns_to_ms_f(diff_ns));
 #endif
 }
 
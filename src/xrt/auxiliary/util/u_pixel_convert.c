@@ -0,0 +1,738 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Row based pixel format conversion kernels with SIMD variants.
+ *
+ * All of the SIMD kernels use the exact same fixed point math as the scalar
+ * ones, 16 bit inputs with 32 bit accumulation, so they are bit-exact.
+ *
+ * @ingroup aux_util
+ */
+
+#include "xrt/xrt_compiler.h"
+
+#include "util/u_pixel_convert.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define U_PC_HAVE_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define U_PC_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(U_PC_HAVE_X86) && defined(__GNUC__)
+#define U_PC_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define U_PC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define U_PC_TARGET_SSE41
+#define U_PC_TARGET_AVX2
+#endif
+
+
+/*
+ *
+ * Scalar, the reference.
+ *
+ */
+
+static inline uint8_t
+clamp_to_byte(int v)
+{
+	if (v < 0) {
+		return 0;
+	}
+	if (v >= 255) {
+		return 255;
+	}
+	return (uint8_t)v;
+}
+
+static inline void
+yuv_to_rgb_scalar(int y, int u, int v, uint8_t *dst)
+{
+	int C = y - 16;
+	int D = u - 128;
+	int E = v - 128;
+
+	dst[0] = clamp_to_byte((298 * C + 409 * E + 128) >> 8);
+	dst[1] = clamp_to_byte((298 * C - 100 * D - 209 * E + 128) >> 8);
+	dst[2] = clamp_to_byte((298 * C + 516 * D + 128) >> 8);
+}
+
+static void
+yuyv422_to_r8g8b8_scalar(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	for (uint32_t x = 0; x < width; x += 2) {
+		yuv_to_rgb_scalar(src[0], src[1], src[3], dst + 0);
+		yuv_to_rgb_scalar(src[2], src[1], src[3], dst + 3);
+		src += 4;
+		dst += 6;
+	}
+}
+
+static void
+uyvy422_to_r8g8b8_scalar(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	for (uint32_t x = 0; x < width; x += 2) {
+		yuv_to_rgb_scalar(src[1], src[0], src[2], dst + 0);
+		yuv_to_rgb_scalar(src[3], src[0], src[2], dst + 3);
+		src += 4;
+		dst += 6;
+	}
+}
+
+static void
+yuv888_to_r8g8b8_scalar(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	for (uint32_t x = 0; x < width; x++) {
+		yuv_to_rgb_scalar(src[0], src[1], src[2], dst);
+		src += 3;
+		dst += 3;
+	}
+}
+
+static void
+bayer_gr8_to_r8g8b8_scalar(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t width)
+{
+	for (uint32_t x = 0; x < width; x++) {
+		uint8_t g0 = src0[0];
+		uint8_t r = src0[1];
+		uint8_t b = src1[0];
+		uint8_t g1 = src1[1];
+
+		dst[0] = r;
+		dst[1] = (g0 + g1) / 2;
+		dst[2] = b;
+
+		src0 += 2;
+		src1 += 2;
+		dst += 3;
+	}
+}
+
+
+/*
+ *
+ * SSE4.1 and AVX2.
+ *
+ */
+
+#ifdef U_PC_HAVE_X86
+
+static bool
+cpu_has_sse41(void)
+{
+#if defined(__GNUC__)
+	return __builtin_cpu_supports("sse4.1");
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	return false;
+#endif
+}
+
+static bool
+cpu_has_avx2(void)
+{
+#if defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+/*!
+ * Interleaves 16 pixels worth of R, G and B into 48 bytes of R8G8B8.
+ */
+U_PC_TARGET_SSE41 static inline void
+sse41_store_rgb_16(__m128i r, __m128i g, __m128i b, uint8_t *dst)
+{
+	// clang-format off
+	const __m128i r0 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+	const __m128i r1 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+	const __m128i g0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+	const __m128i g1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+	const __m128i b0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+	const __m128i b1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+	const __m128i b2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+	// clang-format on
+
+	__m128i out0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)),
+	                            _mm_shuffle_epi8(b, b0));
+	__m128i out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)),
+	                            _mm_shuffle_epi8(b, b1));
+	__m128i out2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)),
+	                            _mm_shuffle_epi8(b, b2));
+
+	_mm_storeu_si128((__m128i *)(dst + 0), out0);
+	_mm_storeu_si128((__m128i *)(dst + 16), out1);
+	_mm_storeu_si128((__m128i *)(dst + 32), out2);
+}
+
+/*!
+ * Gathers the bytes picked by @p mask from two 16 byte blocks, each mask only
+ * picks 8 bytes so the two results fit in one register.
+ */
+U_PC_TARGET_SSE41 static inline __m128i
+sse41_gather_2x8(__m128i a, __m128i b, __m128i mask)
+{
+	return _mm_unpacklo_epi64(_mm_shuffle_epi8(a, mask), _mm_shuffle_epi8(b, mask));
+}
+
+/*!
+ * The fixed point math for 8 pixels, c, d and e are the 16 bit offset Y, U
+ * and V values, results are 16 bit and not yet clamped.
+ */
+U_PC_TARGET_SSE41 static inline void
+sse41_yuv_to_rgb_8(__m128i c, __m128i d, __m128i e, __m128i *out_r, __m128i *out_g, __m128i *out_b)
+{
+	// Coefficient pairs for _mm_madd_epi16, the last pair folds in the rounding for G.
+	const __m128i k_ce_r = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+	const __m128i k_cd_g = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+	const __m128i k_e1_g = _mm_setr_epi16(-209, 128, -209, 128, -209, 128, -209, 128);
+	const __m128i k_cd_b = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i round = _mm_set1_epi32(128);
+
+	__m128i ce_lo = _mm_unpacklo_epi16(c, e);
+	__m128i ce_hi = _mm_unpackhi_epi16(c, e);
+	__m128i cd_lo = _mm_unpacklo_epi16(c, d);
+	__m128i cd_hi = _mm_unpackhi_epi16(c, d);
+	__m128i e1_lo = _mm_unpacklo_epi16(e, one);
+	__m128i e1_hi = _mm_unpackhi_epi16(e, one);
+
+	__m128i r_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_lo, k_ce_r), round), 8);
+	__m128i r_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_hi, k_ce_r), round), 8);
+	__m128i g_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, k_cd_g), _mm_madd_epi16(e1_lo, k_e1_g)), 8);
+	__m128i g_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, k_cd_g), _mm_madd_epi16(e1_hi, k_e1_g)), 8);
+	__m128i b_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, k_cd_b), round), 8);
+	__m128i b_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, k_cd_b), round), 8);
+
+	*out_r = _mm_packs_epi32(r_lo, r_hi);
+	*out_g = _mm_packs_epi32(g_lo, g_hi);
+	*out_b = _mm_packs_epi32(b_lo, b_hi);
+}
+
+U_PC_TARGET_SSE41 static inline void
+sse41_yuv_to_rgb_16(__m128i y, __m128i u, __m128i v, uint8_t *dst)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i k16 = _mm_set1_epi16(16);
+	const __m128i k128 = _mm_set1_epi16(128);
+
+	__m128i c_lo = _mm_sub_epi16(_mm_unpacklo_epi8(y, zero), k16);
+	__m128i c_hi = _mm_sub_epi16(_mm_unpackhi_epi8(y, zero), k16);
+	__m128i d_lo = _mm_sub_epi16(_mm_unpacklo_epi8(u, zero), k128);
+	__m128i d_hi = _mm_sub_epi16(_mm_unpackhi_epi8(u, zero), k128);
+	__m128i e_lo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), k128);
+	__m128i e_hi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), k128);
+
+	__m128i r_lo, g_lo, b_lo;
+	__m128i r_hi, g_hi, b_hi;
+	sse41_yuv_to_rgb_8(c_lo, d_lo, e_lo, &r_lo, &g_lo, &b_lo);
+	sse41_yuv_to_rgb_8(c_hi, d_hi, e_hi, &r_hi, &g_hi, &b_hi);
+
+	// Saturating pack is the same as clamp_to_byte.
+	__m128i r = _mm_packus_epi16(r_lo, r_hi);
+	__m128i g = _mm_packus_epi16(g_lo, g_hi);
+	__m128i b = _mm_packus_epi16(b_lo, b_hi);
+
+	sse41_store_rgb_16(r, g, b, dst);
+}
+
+/*!
+ * Same math as @ref sse41_yuv_to_rgb_16 but does all 16 pixels at once.
+ */
+U_PC_TARGET_AVX2 static inline void
+avx2_yuv_to_rgb_16(__m128i y, __m128i u, __m128i v, uint8_t *dst)
+{
+	const __m256i k16 = _mm256_set1_epi16(16);
+	const __m256i k128 = _mm256_set1_epi16(128);
+	const __m256i k_ce_r = _mm256_set1_epi32((409 << 16) | 298);
+	const __m256i k_cd_g = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)-100 << 16) | 298));
+	const __m256i k_e1_g = _mm256_set1_epi32((128 << 16) | (uint16_t)-209);
+	const __m256i k_cd_b = _mm256_set1_epi32((516 << 16) | 298);
+	const __m256i one = _mm256_set1_epi16(1);
+	const __m256i round = _mm256_set1_epi32(128);
+
+	__m256i c = _mm256_sub_epi16(_mm256_cvtepu8_epi16(y), k16);
+	__m256i d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(u), k128);
+	__m256i e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(v), k128);
+
+	// Unpacks work within 128 bit lanes, lo gets pixels 0-3 & 8-11 and hi 4-7 & 12-15.
+	__m256i ce_lo = _mm256_unpacklo_epi16(c, e);
+	__m256i ce_hi = _mm256_unpackhi_epi16(c, e);
+	__m256i cd_lo = _mm256_unpacklo_epi16(c, d);
+	__m256i cd_hi = _mm256_unpackhi_epi16(c, d);
+	__m256i e1_lo = _mm256_unpacklo_epi16(e, one);
+	__m256i e1_hi = _mm256_unpackhi_epi16(e, one);
+
+	__m256i r_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ce_lo, k_ce_r), round), 8);
+	__m256i r_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ce_hi, k_ce_r), round), 8);
+	__m256i g_lo = _mm256_srai_epi32(
+	    _mm256_add_epi32(_mm256_madd_epi16(cd_lo, k_cd_g), _mm256_madd_epi16(e1_lo, k_e1_g)), 8);
+	__m256i g_hi = _mm256_srai_epi32(
+	    _mm256_add_epi32(_mm256_madd_epi16(cd_hi, k_cd_g), _mm256_madd_epi16(e1_hi, k_e1_g)), 8);
+	__m256i b_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_lo, k_cd_b), round), 8);
+	__m256i b_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_hi, k_cd_b), round), 8);
+
+	// The lane wise pack undoes the lane wise unpack, pixels are back in order.
+	__m256i r16 = _mm256_packs_epi32(r_lo, r_hi);
+	__m256i g16 = _mm256_packs_epi32(g_lo, g_hi);
+	__m256i b16 = _mm256_packs_epi32(b_lo, b_hi);
+
+	__m128i r = _mm_packus_epi16(_mm256_castsi256_si128(r16), _mm256_extracti128_si256(r16, 1));
+	__m128i g = _mm_packus_epi16(_mm256_castsi256_si128(g16), _mm256_extracti128_si256(g16, 1));
+	__m128i b = _mm_packus_epi16(_mm256_castsi256_si128(b16), _mm256_extracti128_si256(b16, 1));
+
+	sse41_store_rgb_16(r, g, b, dst);
+}
+
+/*!
+ * Loads 16 pixels of packed 4:2:2 data, the masks pick out which bytes of an
+ * 8 pixel block are Y, U and V for each pixel.
+ */
+#define X86_LOAD_422_16(SRC, Y_MASK, U_MASK, V_MASK, Y, U, V)                                                          \
+	do {                                                                                                           \
+		__m128i _in0 = _mm_loadu_si128((const __m128i *)(SRC));                                                \
+		__m128i _in1 = _mm_loadu_si128((const __m128i *)((SRC) + 16));                                         \
+		Y = sse41_gather_2x8(_in0, _in1, Y_MASK);                                                              \
+		U = sse41_gather_2x8(_in0, _in1, U_MASK);                                                              \
+		V = sse41_gather_2x8(_in0, _in1, V_MASK);                                                              \
+	} while (false)
+
+#define X86_YUYV_MASKS                                                                                                 \
+	const __m128i y_mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);               \
+	const __m128i u_mask = _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, -1, -1, -1, -1, -1, -1, -1, -1);                \
+	const __m128i v_mask = _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, -1, -1, -1, -1, -1, -1, -1, -1)
+
+#define X86_UYVY_MASKS                                                                                                 \
+	const __m128i y_mask = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1);               \
+	const __m128i u_mask = _mm_setr_epi8(0, 0, 4, 4, 8, 8, 12, 12, -1, -1, -1, -1, -1, -1, -1, -1);                \
+	const __m128i v_mask = _mm_setr_epi8(2, 2, 6, 6, 10, 10, 14, 14, -1, -1, -1, -1, -1, -1, -1, -1)
+
+U_PC_TARGET_SSE41 static inline void
+sse41_load_yuv888_16(const uint8_t *src, __m128i *out_y, __m128i *out_u, __m128i *out_v)
+{
+	// clang-format off
+	const __m128i y0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i y1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i y2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	const __m128i u0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i u1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i u2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+	const __m128i v0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i v1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i v2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+	// clang-format on
+
+	__m128i in0 = _mm_loadu_si128((const __m128i *)(src + 0));
+	__m128i in1 = _mm_loadu_si128((const __m128i *)(src + 16));
+	__m128i in2 = _mm_loadu_si128((const __m128i *)(src + 32));
+
+	*out_y = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, y0), _mm_shuffle_epi8(in1, y1)),
+	                      _mm_shuffle_epi8(in2, y2));
+	*out_u = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, u0), _mm_shuffle_epi8(in1, u1)),
+	                      _mm_shuffle_epi8(in2, u2));
+	*out_v = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, v0), _mm_shuffle_epi8(in1, v1)),
+	                      _mm_shuffle_epi8(in2, v2));
+}
+
+U_PC_TARGET_SSE41 static uint32_t
+yuyv422_to_r8g8b8_sse41(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	X86_YUYV_MASKS;
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		X86_LOAD_422_16(src + x * 2, y_mask, u_mask, v_mask, y, u, v);
+		sse41_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+U_PC_TARGET_AVX2 static uint32_t
+yuyv422_to_r8g8b8_avx2(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	X86_YUYV_MASKS;
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		X86_LOAD_422_16(src + x * 2, y_mask, u_mask, v_mask, y, u, v);
+		avx2_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+U_PC_TARGET_SSE41 static uint32_t
+uyvy422_to_r8g8b8_sse41(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	X86_UYVY_MASKS;
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		X86_LOAD_422_16(src + x * 2, y_mask, u_mask, v_mask, y, u, v);
+		sse41_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+U_PC_TARGET_AVX2 static uint32_t
+uyvy422_to_r8g8b8_avx2(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	X86_UYVY_MASKS;
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		X86_LOAD_422_16(src + x * 2, y_mask, u_mask, v_mask, y, u, v);
+		avx2_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+U_PC_TARGET_SSE41 static uint32_t
+yuv888_to_r8g8b8_sse41(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		sse41_load_yuv888_16(src + x * 3, &y, &u, &v);
+		sse41_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+U_PC_TARGET_AVX2 static uint32_t
+yuv888_to_r8g8b8_avx2(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i y, u, v;
+		sse41_load_yuv888_16(src + x * 3, &y, &u, &v);
+		avx2_yuv_to_rgb_16(y, u, v, dst + x * 3);
+	}
+	return x;
+}
+
+/*!
+ * Only shuffles and averages, nothing for AVX2 to improve on.
+ */
+U_PC_TARGET_SSE41 static uint32_t
+bayer_gr8_to_r8g8b8_sse41(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t width)
+{
+	const __m128i even = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i odd = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i low_bits = _mm_set1_epi8(0x7f);
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i s0a = _mm_loadu_si128((const __m128i *)(src0 + x * 2));
+		__m128i s0b = _mm_loadu_si128((const __m128i *)(src0 + x * 2 + 16));
+		__m128i s1a = _mm_loadu_si128((const __m128i *)(src1 + x * 2));
+		__m128i s1b = _mm_loadu_si128((const __m128i *)(src1 + x * 2 + 16));
+
+		__m128i g0 = sse41_gather_2x8(s0a, s0b, even);
+		__m128i r = sse41_gather_2x8(s0a, s0b, odd);
+		__m128i b = sse41_gather_2x8(s1a, s1b, even);
+		__m128i g1 = sse41_gather_2x8(s1a, s1b, odd);
+
+		// Truncating average, _mm_avg_epu8 rounds up.
+		__m128i g = _mm_add_epi8(_mm_and_si128(g0, g1),
+		                         _mm_and_si128(_mm_srli_epi16(_mm_xor_si128(g0, g1), 1), low_bits));
+
+		sse41_store_rgb_16(r, g, b, dst + x * 3);
+	}
+	return x;
+}
+
+#endif // U_PC_HAVE_X86
+
+
+/*
+ *
+ * NEON.
+ *
+ */
+
+#ifdef U_PC_HAVE_NEON
+
+static inline uint8x8_t
+neon_combine_8(int16x8_t c, int16x8_t d, int16x8_t e, int16_t kc, int16_t kd, int16_t ke)
+{
+	int32x4_t lo = vmull_n_s16(vget_low_s16(c), kc);
+	lo = vmlal_n_s16(lo, vget_low_s16(d), kd);
+	lo = vmlal_n_s16(lo, vget_low_s16(e), ke);
+
+	int32x4_t hi = vmull_n_s16(vget_high_s16(c), kc);
+	hi = vmlal_n_s16(hi, vget_high_s16(d), kd);
+	hi = vmlal_n_s16(hi, vget_high_s16(e), ke);
+
+	// Rounding shift is the same as (x + 128) >> 8, saturating narrow the same as clamp_to_byte.
+	int16x8_t v = vcombine_s16(vrshrn_n_s32(lo, 8), vrshrn_n_s32(hi, 8));
+	return vqmovun_s16(v);
+}
+
+static inline uint8x16x3_t
+neon_yuv_to_rgb_16(uint8x16_t y, uint8x16_t u, uint8x16_t v)
+{
+	const uint8x8_t k16 = vdup_n_u8(16);
+	const uint8x8_t k128 = vdup_n_u8(128);
+
+	// Wrapping subtract then reinterpret gives the signed result.
+	int16x8_t c_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), k16));
+	int16x8_t c_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), k16));
+	int16x8_t d_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(u), k128));
+	int16x8_t d_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(u), k128));
+	int16x8_t e_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(v), k128));
+	int16x8_t e_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(v), k128));
+
+	uint8x16x3_t rgb;
+	rgb.val[0] = vcombine_u8(neon_combine_8(c_lo, d_lo, e_lo, 298, 0, 409), //
+	                         neon_combine_8(c_hi, d_hi, e_hi, 298, 0, 409));
+	rgb.val[1] = vcombine_u8(neon_combine_8(c_lo, d_lo, e_lo, 298, -100, -209),
+	                         neon_combine_8(c_hi, d_hi, e_hi, 298, -100, -209));
+	rgb.val[2] = vcombine_u8(neon_combine_8(c_lo, d_lo, e_lo, 298, 516, 0), //
+	                         neon_combine_8(c_hi, d_hi, e_hi, 298, 516, 0));
+	return rgb;
+}
+
+/*!
+ * Converts 32 pixels of 4:2:2, the two Y vectors hold the even and odd pixels.
+ */
+static inline void
+neon_422_to_rgb_32(uint8x16_t y_even, uint8x16_t y_odd, uint8x16_t u, uint8x16_t v, uint8_t *dst)
+{
+	uint8x16x3_t even = neon_yuv_to_rgb_16(y_even, u, v);
+	uint8x16x3_t odd = neon_yuv_to_rgb_16(y_odd, u, v);
+
+	uint8x16x3_t first;
+	uint8x16x3_t second;
+	for (int i = 0; i < 3; i++) {
+		uint8x16x2_t zipped = vzipq_u8(even.val[i], odd.val[i]);
+		first.val[i] = zipped.val[0];
+		second.val[i] = zipped.val[1];
+	}
+
+	vst3q_u8(dst, first);
+	vst3q_u8(dst + 48, second);
+}
+
+static uint32_t
+yuyv422_to_r8g8b8_neon(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 32 <= width; x += 32) {
+		uint8x16x4_t in = vld4q_u8(src + x * 2);
+		neon_422_to_rgb_32(in.val[0], in.val[2], in.val[1], in.val[3], dst + x * 3);
+	}
+	return x;
+}
+
+static uint32_t
+uyvy422_to_r8g8b8_neon(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 32 <= width; x += 32) {
+		uint8x16x4_t in = vld4q_u8(src + x * 2);
+		neon_422_to_rgb_32(in.val[1], in.val[3], in.val[0], in.val[2], dst + x * 3);
+	}
+	return x;
+}
+
+static uint32_t
+yuv888_to_r8g8b8_neon(const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x16x3_t in = vld3q_u8(src + x * 3);
+		vst3q_u8(dst + x * 3, neon_yuv_to_rgb_16(in.val[0], in.val[1], in.val[2]));
+	}
+	return x;
+}
+
+static uint32_t
+bayer_gr8_to_r8g8b8_neon(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x16x2_t gr = vld2q_u8(src0 + x * 2);
+		uint8x16x2_t bg = vld2q_u8(src1 + x * 2);
+
+		uint8x16x3_t rgb;
+		rgb.val[0] = gr.val[1];
+		rgb.val[1] = vhaddq_u8(gr.val[0], bg.val[1]); // Truncating, like the scalar code.
+		rgb.val[2] = bg.val[0];
+		vst3q_u8(dst + x * 3, rgb);
+	}
+	return x;
+}
+
+#endif // U_PC_HAVE_NEON
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+u_pixel_convert_isa_supported(enum u_pixel_convert_isa isa)
+{
+	switch (isa) {
+	case U_PIXEL_CONVERT_ISA_SCALAR: return true;
+#ifdef U_PC_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41: return cpu_has_sse41();
+	case U_PIXEL_CONVERT_ISA_AVX2: return cpu_has_avx2();
+#endif
+#ifdef U_PC_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: return true;
+#endif
+	default: return false;
+	}
+}
+
+static enum u_pixel_convert_isa
+find_best_isa(void)
+{
+	if (u_pixel_convert_isa_supported(U_PIXEL_CONVERT_ISA_AVX2)) {
+		return U_PIXEL_CONVERT_ISA_AVX2;
+	}
+	if (u_pixel_convert_isa_supported(U_PIXEL_CONVERT_ISA_SSE41)) {
+		return U_PIXEL_CONVERT_ISA_SSE41;
+	}
+	if (u_pixel_convert_isa_supported(U_PIXEL_CONVERT_ISA_NEON)) {
+		return U_PIXEL_CONVERT_ISA_NEON;
+	}
+	return U_PIXEL_CONVERT_ISA_SCALAR;
+}
+
+enum u_pixel_convert_isa
+u_pixel_convert_best_isa(void)
+{
+	// The CPU doesn't change, so only query its features once.
+	static xrt_atomic_s32_t cached = -1;
+
+	int32_t isa = cached;
+	if (isa < 0) {
+		isa = (int32_t)find_best_isa();
+		xrt_atomic_s32_cmpxchg(&cached, -1, isa);
+	}
+
+	return (enum u_pixel_convert_isa)isa;
+}
+
+const char *
+u_pixel_convert_isa_str(enum u_pixel_convert_isa isa)
+{
+	switch (isa) {
+	case U_PIXEL_CONVERT_ISA_SCALAR: return "SCALAR";
+	case U_PIXEL_CONVERT_ISA_SSE41: return "SSE41";
+	case U_PIXEL_CONVERT_ISA_AVX2: return "AVX2";
+	case U_PIXEL_CONVERT_ISA_NEON: return "NEON";
+	default: return "UNKNOWN";
+	}
+}
+
+void
+u_pixel_convert_yuyv422_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef U_PC_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41: x = yuyv422_to_r8g8b8_sse41(src, dst, width); break;
+	case U_PIXEL_CONVERT_ISA_AVX2: x = yuyv422_to_r8g8b8_avx2(src, dst, width); break;
+#endif
+#ifdef U_PC_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = yuyv422_to_r8g8b8_neon(src, dst, width); break;
+#endif
+	default: break;
+	}
+
+	// The rest of the row, or all of it.
+	yuyv422_to_r8g8b8_scalar(src + x * 2, dst + x * 3, width - x);
+}
+
+void
+u_pixel_convert_uyvy422_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef U_PC_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41: x = uyvy422_to_r8g8b8_sse41(src, dst, width); break;
+	case U_PIXEL_CONVERT_ISA_AVX2: x = uyvy422_to_r8g8b8_avx2(src, dst, width); break;
+#endif
+#ifdef U_PC_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = uyvy422_to_r8g8b8_neon(src, dst, width); break;
+#endif
+	default: break;
+	}
+
+	uyvy422_to_r8g8b8_scalar(src + x * 2, dst + x * 3, width - x);
+}
+
+void
+u_pixel_convert_yuv888_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef U_PC_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41: x = yuv888_to_r8g8b8_sse41(src, dst, width); break;
+	case U_PIXEL_CONVERT_ISA_AVX2: x = yuv888_to_r8g8b8_avx2(src, dst, width); break;
+#endif
+#ifdef U_PC_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = yuv888_to_r8g8b8_neon(src, dst, width); break;
+#endif
+	default: break;
+	}
+
+	yuv888_to_r8g8b8_scalar(src + x * 3, dst + x * 3, width - x);
+}
+
+void
+u_pixel_convert_bayer_gr8_to_r8g8b8(enum u_pixel_convert_isa isa,
+                                    const uint8_t *src0,
+                                    const uint8_t *src1,
+                                    uint8_t *dst,
+                                    uint32_t width)
+{
+	uint32_t x = 0;
+
+	switch (isa) {
+#ifdef U_PC_HAVE_X86
+	case U_PIXEL_CONVERT_ISA_SSE41:
+	case U_PIXEL_CONVERT_ISA_AVX2: x = bayer_gr8_to_r8g8b8_sse41(src0, src1, dst, width); break;
+#endif
+#ifdef U_PC_HAVE_NEON
+	case U_PIXEL_CONVERT_ISA_NEON: x = bayer_gr8_to_r8g8b8_neon(src0, src1, dst, width); break;
+#endif
+	default: break;
+	}
+
+	bayer_gr8_to_r8g8b8_scalar(src0 + x * 2, src1 + x * 2, dst + x * 3, width - x);
+}
@@ -0,0 +1,105 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Row based pixel format conversion kernels with SIMD variants.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Which set of kernels to use, the scalar kernels are the reference that all
+ * other variants must produce bit-exact results against.
+ *
+ * @ingroup aux_util
+ */
+enum u_pixel_convert_isa
+{
+	U_PIXEL_CONVERT_ISA_SCALAR,
+	U_PIXEL_CONVERT_ISA_SSE41,
+	U_PIXEL_CONVERT_ISA_AVX2,
+	U_PIXEL_CONVERT_ISA_NEON,
+};
+
+/*!
+ * Is the given kernel set compiled in and supported by the CPU we are running on.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_pixel_convert_isa_supported(enum u_pixel_convert_isa isa);
+
+/*!
+ * Returns the fastest kernel set supported by the CPU, checked at runtime on
+ * the first call and cached after that, so it is cheap to call per frame.
+ *
+ * @ingroup aux_util
+ */
+enum u_pixel_convert_isa
+u_pixel_convert_best_isa(void);
+
+/*!
+ * Returns a printable name for the kernel set.
+ *
+ * @ingroup aux_util
+ */
+const char *
+u_pixel_convert_isa_str(enum u_pixel_convert_isa isa);
+
+/*
+ *
+ * Row converters, isa must be one that u_pixel_convert_isa_supported
+ * returns true for. The source and destination don't need to be aligned.
+ *
+ */
+
+/*!
+ * Convert one row of @p width YUYV 4:2:2 pixels to R8G8B8, @p width must be even.
+ *
+ * @ingroup aux_util
+ */
+void
+u_pixel_convert_yuyv422_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width);
+
+/*!
+ * Convert one row of @p width UYVY 4:2:2 pixels to R8G8B8, @p width must be even.
+ *
+ * @ingroup aux_util
+ */
+void
+u_pixel_convert_uyvy422_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width);
+
+/*!
+ * Convert one row of @p width YUV 4:4:4 pixels to R8G8B8.
+ *
+ * @ingroup aux_util
+ */
+void
+u_pixel_convert_yuv888_to_r8g8b8(enum u_pixel_convert_isa isa, const uint8_t *src, uint8_t *dst, uint32_t width);
+
+/*!
+ * Convert two rows of GRBG Bayer pixels to one row of @p width R8G8B8
+ * pixels, each output pixel is made from one 2x2 block of the input.
+ *
+ * @ingroup aux_util
+ */
+void
+u_pixel_convert_bayer_gr8_to_r8g8b8(enum u_pixel_convert_isa isa,
+                                    const uint8_t *src0,
+                                    const uint8_t *src1,
+                                    uint8_t *dst,
+                                    uint32_t width);
+
+
+#ifdef __cplusplus
+}
+#endif
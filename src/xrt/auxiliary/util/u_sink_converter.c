@@ -13,7 +13,9 @@
 #include "util/u_misc.h"
 #include "util/u_sink.h"
 #include "util/u_frame.h"
+#include "util/u_frame_pool.h"
 #include "util/u_format.h"
+#include "util/u_pixel_convert.h"
 #include "util/u_trace_marker.h"
 
 #include <stdio.h>
@@ -42,6 +44,9 @@ struct u_sink_converter
 	struct xrt_frame_sink *downstream;
 
 	enum xrt_format format;
+
+	//! Converted frames are allocated from here.
+	struct u_frame_pool *pool;
 };
 
 
@@ -75,159 +80,17 @@ from_L8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size_t st
  *
  */
 
-static inline int
-clamp_to_byte(int v)
-{
-	if (v < 0) {
-		return 0;
-	}
-	if (v >= 255) {
-		return 255;
-	}
-	return v;
-}
-
-static inline uint32_t
-YUV444_to_RGBX8888(int y, int u, int v)
-{
-	int C = y - 16;
-	int D = u - 128;
-	int E = v - 128;
-
-	int R = clamp_to_byte((298 * C + 409 * E + 128) >> 8);
-	int G = clamp_to_byte((298 * C - 100 * D - 209 * E + 128) >> 8);
-	int B = clamp_to_byte((298 * C + 516 * D + 128) >> 8);
-
-	return B << 16 | G << 8 | R;
-}
-
-#undef USE_TABLE
-#ifdef USE_TABLE
-static uint32_t lookup_YUV_to_RGBX[256][256][256] = {0};
-
-static void
-generate_lookup_YUV_to_RGBX()
-{
-	if (lookup_YUV_to_RGBX[255][255][255] != 0) {
-		return;
-	}
-
-	int y;
-	int u;
-	int v;
-
-	for (y = 0; y < 256; y++) {
-		for (u = 0; u < 256; u++) {
-			for (v = 0; v < 256; v++) {
-				lookup_YUV_to_RGBX[y][u][v] = YUV444_to_RGBX8888(y, u, v);
-			}
-		}
-	}
-}
-#endif
-
-XRT_MAYBE_UNUSED inline static void
-YUYV422_to_R8G8B8X8(const uint8_t *input, uint32_t *rgb1, uint32_t *rgb2)
-{
-	uint8_t y0 = input[0];
-	uint8_t u = input[1];
-	uint8_t y1 = input[2];
-	uint8_t v = input[3];
-
-#ifdef USE_TABLE
-	*rgb1 = lookup_YUV_to_RGBX[y0][u][v];
-	*rgb2 = lookup_YUV_to_RGBX[y1][u][v];
-#else
-	*rgb1 = YUV444_to_RGBX8888(y0, u, v);
-	*rgb2 = YUV444_to_RGBX8888(y1, u, v);
-#endif
-}
-
-inline static void
-YUYV422_to_R8G8B8(const uint8_t *input, uint8_t *dst)
-{
-	uint8_t y0 = input[0];
-	uint8_t u = input[1];
-	uint8_t y1 = input[2];
-	uint8_t v = input[3];
-
-#ifdef USE_TABLE
-	uint8_t *rgb1 = (uint8_t *)&lookup_YUV_to_RGBX[y0][u][v];
-	uint8_t *rgb2 = (uint8_t *)&lookup_YUV_to_RGBX[y1][u][v];
-#else
-	uint32_t rgb1v = YUV444_to_RGBX8888(y0, u, v);
-	uint32_t rgb2v = YUV444_to_RGBX8888(y1, u, v);
-	uint8_t *rgb1 = (uint8_t *)&rgb1v;
-	uint8_t *rgb2 = (uint8_t *)&rgb2v;
-#endif
-
-	dst[0] = rgb1[0];
-	dst[1] = rgb1[1];
-	dst[2] = rgb1[2];
-	dst[3] = rgb2[0];
-	dst[4] = rgb2[1];
-	dst[5] = rgb2[2];
-}
-
-inline static void
-UYVY422_to_R8G8B8(const uint8_t *input, uint8_t *dst)
-{
-	uint8_t u = input[0];
-	uint8_t y0 = input[1];
-	uint8_t v = input[2];
-	uint8_t y1 = input[3];
-
-#ifdef USE_TABLE
-	uint8_t *rgb1 = (uint8_t *)&lookup_YUV_to_RGBX[y0][u][v];
-	uint8_t *rgb2 = (uint8_t *)&lookup_YUV_to_RGBX[y1][u][v];
-#else
-	uint32_t rgb1v = YUV444_to_RGBX8888(y0, u, v);
-	uint32_t rgb2v = YUV444_to_RGBX8888(y1, u, v);
-	uint8_t *rgb1 = (uint8_t *)&rgb1v;
-	uint8_t *rgb2 = (uint8_t *)&rgb2v;
-#endif
-
-	dst[0] = rgb1[0];
-	dst[1] = rgb1[1];
-	dst[2] = rgb1[2];
-	dst[3] = rgb2[0];
-	dst[4] = rgb2[1];
-	dst[5] = rgb2[2];
-}
-
-inline static void
-YUV444_to_R8G8B8(const uint8_t *input, uint8_t *dst)
-{
-	uint8_t y = input[0];
-	uint8_t u = input[1];
-	uint8_t v = input[2];
-
-#ifdef USE_TABLE
-	uint8_t *rgb = (uint8_t *)&lookup_YUV_to_RGBX[y][u][v];
-#else
-	uint32_t rgbv = YUV444_to_RGBX8888(y, u, v);
-	uint8_t *rgb = (uint8_t *)&rgbv;
-#endif
-
-	dst[0] = rgb[0];
-	dst[1] = rgb[1];
-	dst[2] = rgb[2];
-}
-
 static void
 from_YUYV422_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size_t stride, const uint8_t *data)
 {
 	SINK_TRACE_MARKER();
 
-	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x += 2) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+	enum u_pixel_convert_isa isa = u_pixel_convert_best_isa();
 
-			src = src + (y * stride) + (x * 2);
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			YUYV422_to_R8G8B8(src, dst);
-		}
+	for (uint32_t y = 0; y < h; y++) {
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
+		u_pixel_convert_yuyv422_to_r8g8b8(isa, src, dst, w);
 	}
 }
 
@@ -251,33 +114,26 @@ from_UYVY422_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size
 {
 	SINK_TRACE_MARKER();
 
-	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x += 2) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+	enum u_pixel_convert_isa isa = u_pixel_convert_best_isa();
 
-			src = src + (y * stride) + (x * 2);
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			UYVY422_to_R8G8B8(src, dst);
-		}
+	for (uint32_t y = 0; y < h; y++) {
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
+		u_pixel_convert_uyvy422_to_r8g8b8(isa, src, dst, w);
 	}
 }
 
-
 static void
 from_YUV888_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size_t stride, const uint8_t *data)
 {
 	SINK_TRACE_MARKER();
 
-	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x++) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+	enum u_pixel_convert_isa isa = u_pixel_convert_best_isa();
 
-			src = src + (y * stride) + (x * 3);
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			YUV444_to_R8G8B8(src, dst);
-		}
+	for (uint32_t y = 0; y < h; y++) {
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
+		u_pixel_convert_yuv888_to_r8g8b8(isa, src, dst, w);
 	}
 }
 
@@ -402,31 +258,13 @@ from_BAYER_GR8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, si
 {
 	SINK_TRACE_MARKER();
 
-	const uint8_t *src_data = data;
-	size_t src_stride = stride;
-
-	uint8_t *dst_data = dst_frame->data;
-	size_t dst_stride = dst_frame->stride;
+	enum u_pixel_convert_isa isa = u_pixel_convert_best_isa();
 
 	for (uint32_t y = 0; y < h; y++) {
-		const uint8_t *src0 = src_data + (y * 2) * src_stride;
-		const uint8_t *src1 = src_data + (y * 2 + 1) * src_stride;
-		uint8_t *dst = dst_data + (y * dst_stride);
-
-		for (uint32_t x = 0; x < w; x++) {
-			uint8_t g0 = src0[0];
-			uint8_t r = src0[1];
-			uint8_t b = src1[0];
-			uint8_t g1 = src1[1];
-
-			dst[0] = r;
-			dst[1] = (g0 + g1) / 2;
-			dst[2] = b;
-
-			src0 += 2;
-			src1 += 2;
-			dst += 3;
-		}
+		const uint8_t *src0 = data + (y * 2) * stride;
+		const uint8_t *src1 = data + (y * 2 + 1) * stride;
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
+		u_pixel_convert_bayer_gr8_to_r8g8b8(isa, src0, src1, dst, w);
 	}
 }
 
@@ -440,15 +278,17 @@ from_BAYER_GR8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, si
 
 /*!
  * Creates a frame that the conversion should happen to, allows to set the size.
- *
- * @todo Allocate from a pool of frames.
  */
 static bool
-create_frame_with_format_of_size(
-    struct xrt_frame *xf, uint32_t w, uint32_t h, enum xrt_format format, struct xrt_frame **out_frame)
+create_frame_with_format_of_size(struct u_sink_converter *s,
+                                 struct xrt_frame *xf,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 enum xrt_format format,
+                                 struct xrt_frame **out_frame)
 {
 	struct xrt_frame *frame = NULL;
-	u_frame_create_one_off(format, w, h, &frame);
+	u_frame_pool_get(s->pool, format, w, h, &frame);
 	if (frame == NULL) {
 		U_LOG_E("Failed to create target frame!");
 		*out_frame = NULL;
@@ -470,9 +310,12 @@ create_frame_with_format_of_size(
  * Creates a frame that the conversion should happen to.
  */
 static bool
-create_frame_with_format(struct xrt_frame *xf, enum xrt_format format, struct xrt_frame **out_frame)
+create_frame_with_format(struct u_sink_converter *s,
+                         struct xrt_frame *xf,
+                         enum xrt_format format,
+                         struct xrt_frame **out_frame)
 {
-	return create_frame_with_format_of_size(xf, xf->width, xf->height, format, out_frame);
+	return create_frame_with_format_of_size(s, xf, xf->width, xf->height, format, out_frame);
 }
 
 static void
@@ -487,7 +330,7 @@ convert_frame_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	switch (xf->format) {
 	case XRT_FORMAT_L8: s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_L8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_L8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_L8(converted, xf->width, xf->height, xf->stride, xf->data);
@@ -516,32 +359,32 @@ convert_frame_r8g8b8_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_BAYER_GR8:;
 		uint32_t w = xf->width / 2;
 		uint32_t h = xf->height / 2;
-		if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_BAYER_GR8_to_R8G8B8(converted, w, h, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_R8G8B8(converted, xf->size, xf->data)) {
@@ -590,26 +433,26 @@ convert_frame_r8g8b8_bayer_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf
 	case XRT_FORMAT_R8G8B8:
 	case XRT_FORMAT_BAYER_GR8:; s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_R8G8B8(converted, xf->size, xf->data)) {
@@ -640,7 +483,7 @@ convert_frame_r8g8b8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	switch (xf->format) {
 	case XRT_FORMAT_R8G8B8: s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_L8:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_L8_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
@@ -648,32 +491,32 @@ convert_frame_r8g8b8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_BAYER_GR8:;
 		uint32_t w = xf->width / 2;
 		uint32_t h = xf->height / 2;
-		if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_BAYER_GR8_to_R8G8B8(converted, w, h, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_R8G8B8(converted, xf->size, xf->data)) {
@@ -709,10 +552,12 @@ convert_frame_rgb_yuv_yuyv_uyvy_or_l8(struct xrt_frame_sink *xs, struct xrt_fram
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_YUV888(converted, xf->size, xf->data)) {
+			// Make sure to free frame when we fail to decode.
+			xrt_frame_reference(&converted, NULL);
 			return;
 		}
 		break;
@@ -744,10 +589,12 @@ convert_frame_yuv_yuyv_uyvy_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *x
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_YUV888(converted, xf->size, xf->data)) {
+			// Make sure to free frame when we fail to decode.
+			xrt_frame_reference(&converted, NULL);
 			return;
 		}
 		break;
@@ -780,10 +627,12 @@ convert_frame_yuv_or_yuyv(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_YUV888(converted, xf->size, xf->data)) {
+			// Make sure to free frame when we fail to decode.
+			xrt_frame_reference(&converted, NULL);
 			return;
 		}
 		break;
@@ -808,7 +657,7 @@ convert_frame_bayer(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	uint32_t h = xf->height / 2;
 	struct xrt_frame *converted = NULL;
 
-	if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+	if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 		return;
 	}
 
@@ -829,6 +678,9 @@ destroy(struct xrt_frame_node *node)
 {
 	struct u_sink_converter *s = container_of(node, struct u_sink_converter, node);
 
+	// Frames still held downstream keep the pool alive.
+	u_frame_pool_destroy(&s->pool);
+
 	free(s);
 }
 
@@ -855,16 +707,18 @@ u_sink_create_format_converter(struct xrt_frame_context *xfctx,
 	default: U_LOG_E("Format '%s' not supported", u_format_str(format)); return;
 	}
 
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
-
 	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
 	s->base.push_frame = func;
 	s->node.break_apart = break_apart;
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
@@ -883,9 +737,11 @@ u_sink_create_to_r8g8b8_or_l8(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
 
 	xrt_frame_context_add(xfctx, &s->node);
 
@@ -905,9 +761,11 @@ u_sink_create_to_r8g8b8_r8g8b8a8_r8g8b8x8_or_l8(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
 
 	xrt_frame_context_add(xfctx, &s->node);
 
@@ -927,6 +785,12 @@ u_sink_create_to_r8g8b8_bayer_or_l8(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
@@ -945,6 +809,12 @@ u_sink_create_to_rgb_yuv_yuyv_uyvy_or_l8(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
@@ -963,6 +833,12 @@ u_sink_create_to_yuv_yuyv_uyvy_or_l8(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
@@ -981,6 +857,12 @@ u_sink_create_to_yuv_or_yuyv(struct xrt_frame_context *xfctx,
 	s->node.destroy = destroy;
 	s->downstream = downstream;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
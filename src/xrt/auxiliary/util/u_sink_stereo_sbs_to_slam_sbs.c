@@ -8,9 +8,11 @@
  */
 
 #include "util/u_misc.h"
+#include "util/u_logging.h"
 #include "util/u_sink.h"
 #include "util/u_trace_marker.h"
 #include "util/u_frame.h"
+#include "util/u_frame_pool.h"
 #include "xrt/xrt_frame.h"
 
 //!@todo Extend this to over-and-under frames!
@@ -27,6 +29,9 @@ struct u_sink_stereo_sbs_to_slam_sbs
 
 	struct xrt_frame_sink *downstream_left;
 	struct xrt_frame_sink *downstream_right;
+
+	//! The left and right frames are allocated from here.
+	struct u_frame_pool *pool;
 };
 
 static void
@@ -54,8 +59,8 @@ split_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
 	right.extent.w = one_frame_width;
 	struct xrt_frame *xf_left = NULL;
 	struct xrt_frame *xf_right = NULL;
-	u_frame_create_roi(xf, left, &xf_left);
-	u_frame_create_roi(xf, right, &xf_right);
+	u_frame_pool_create_roi(s->pool, xf, left, &xf_left);
+	u_frame_pool_create_roi(s->pool, xf, right, &xf_right);
 
 	xrt_sink_push_frame(s->downstream_left, xf_left);
 	xrt_sink_push_frame(s->downstream_right, xf_right);
@@ -75,6 +80,8 @@ split_destroy(struct xrt_frame_node *node)
 {
 	struct u_sink_stereo_sbs_to_slam_sbs *s = container_of(node, struct u_sink_stereo_sbs_to_slam_sbs, node);
 
+	u_frame_pool_destroy(&s->pool);
+
 	free(s);
 }
 
@@ -99,6 +106,12 @@ u_sink_stereo_sbs_to_slam_sbs_create(struct xrt_frame_context *xfctx,
 	s->downstream_left = downstream_left;
 	s->downstream_right = downstream_right;
 
+	if (u_frame_pool_create(U_FRAME_POOL_DEFAULT_MAX_FREE, &s->pool) < 0) {
+		U_LOG_E("Failed to create frame pool!");
+		free(s);
+		return;
+	}
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_xfs = &s->base;
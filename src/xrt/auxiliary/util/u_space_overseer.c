@@ -76,6 +76,28 @@ struct u_space
 	};
 };
 
+/*!
+ * Number of device poses remembered by a @ref u_space_pose_cache.
+ */
+#define U_SPACE_POSE_CACHE_SIZE 16
+
+/*!
+ * Remembers the device poses fetched during a single locate call, all at the
+ * same timestamp, so each pose input is only asked for once even when many
+ * spaces share it, like the base space's chain does. Lives on the stack.
+ */
+struct u_space_pose_cache
+{
+	uint32_t count;
+
+	struct
+	{
+		struct xrt_device *xdev;
+		enum xrt_input_name xname;
+		struct xrt_space_relation relation;
+	} entries[U_SPACE_POSE_CACHE_SIZE];
+};
+
 /*!
  * Default implementation of the xrt_space_overseer object.
  */
@@ -305,6 +327,45 @@ notify_ref_space_usage_device(struct u_space_overseer *uso, enum xrt_reference_s
  *
  */
 
+/*!
+ * Get the pose of a pose space, using and filling in the cache if given. The
+ * cache is only valid for a single timestamp, the caller makes sure of that.
+ */
+static void
+get_pose_space_relation(struct u_space_pose_cache *cache,
+                        struct u_space *space,
+                        int64_t at_timestamp_ns,
+                        struct xrt_space_relation *out_relation)
+{
+	struct xrt_device *xdev = space->pose.xdev;
+	enum xrt_input_name xname = space->pose.xname;
+
+	assert(xdev != NULL);
+	assert(xname != 0);
+
+	if (cache == NULL) {
+		xrt_device_get_tracked_pose(xdev, xname, at_timestamp_ns, out_relation);
+		return;
+	}
+
+	for (uint32_t i = 0; i < cache->count; i++) {
+		if (cache->entries[i].xdev == xdev && cache->entries[i].xname == xname) {
+			*out_relation = cache->entries[i].relation;
+			return;
+		}
+	}
+
+	xrt_device_get_tracked_pose(xdev, xname, at_timestamp_ns, out_relation);
+
+	// If full just don't remember it.
+	if (cache->count < ARRAY_SIZE(cache->entries)) {
+		cache->entries[cache->count].xdev = xdev;
+		cache->entries[cache->count].xname = xname;
+		cache->entries[cache->count].relation = *out_relation;
+		cache->count++;
+	}
+}
+
 /*!
  * For each space, push the relation of that space and then traverse by calling
  * @p push_then_traverse again with the parent space. That means traverse goes
@@ -312,16 +373,16 @@ notify_ref_space_usage_device(struct u_space_overseer *uso, enum xrt_reference_s
  * order.
  */
 static void
-push_then_traverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_t at_timestamp_ns)
+push_then_traverse(struct xrt_relation_chain *xrc,
+                   struct u_space_pose_cache *cache,
+                   struct u_space *space,
+                   int64_t at_timestamp_ns)
 {
 	switch (space->type) {
 	case U_SPACE_TYPE_NULL: break; // No-op
 	case U_SPACE_TYPE_POSE: {
-		assert(space->pose.xdev != NULL);
-		assert(space->pose.xname != 0);
-
 		struct xrt_space_relation xsr;
-		xrt_device_get_tracked_pose(space->pose.xdev, space->pose.xname, at_timestamp_ns, &xsr);
+		get_pose_space_relation(cache, space, at_timestamp_ns, &xsr);
 		m_relation_chain_push_relation(xrc, &xsr);
 	} break;
 	case U_SPACE_TYPE_OFFSET: m_relation_chain_push_pose_if_not_identity(xrc, &space->offset.pose); break;
@@ -330,7 +391,7 @@ push_then_traverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_
 
 	// Please tail-call optimise this miss compiler.
 	assert(space->next != NULL);
-	push_then_traverse(xrc, space->next, at_timestamp_ns);
+	push_then_traverse(xrc, cache, space->next, at_timestamp_ns);
 }
 
 /*!
@@ -340,7 +401,10 @@ push_then_traverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_
  * the reversed order.
  */
 static void
-traverse_then_push_inverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_t at_timestamp_ns)
+traverse_then_push_inverse(struct xrt_relation_chain *xrc,
+                           struct u_space_pose_cache *cache,
+                           struct u_space *space,
+                           int64_t at_timestamp_ns)
 {
 	// Done traversing.
 	switch (space->type) {
@@ -352,16 +416,13 @@ traverse_then_push_inverse(struct xrt_relation_chain *xrc, struct u_space *space
 
 	// Can't tail-call optimise this one :(
 	assert(space->next != NULL);
-	traverse_then_push_inverse(xrc, space->next, at_timestamp_ns);
+	traverse_then_push_inverse(xrc, cache, space->next, at_timestamp_ns);
 
 	switch (space->type) {
 	case U_SPACE_TYPE_NULL: break; // No-op
 	case U_SPACE_TYPE_POSE: {
-		assert(space->pose.xdev != NULL);
-		assert(space->pose.xname != 0);
-
 		struct xrt_space_relation xsr;
-		xrt_device_get_tracked_pose(space->pose.xdev, space->pose.xname, at_timestamp_ns, &xsr);
+		get_pose_space_relation(cache, space, at_timestamp_ns, &xsr);
 		m_relation_chain_push_inverted_relation(xrc, &xsr);
 	} break;
 	case U_SPACE_TYPE_OFFSET: m_relation_chain_push_inverted_pose_if_not_identity(xrc, &space->offset.pose); break;
@@ -369,9 +430,14 @@ traverse_then_push_inverse(struct xrt_relation_chain *xrc, struct u_space *space
 	}
 }
 
+/*!
+ * The @p cache is optional, if given it must only have been used with the same
+ * @p at_timestamp_ns.
+ */
 static void
 build_relation_chain_read_locked(struct u_space_overseer *uso,
                                  struct xrt_relation_chain *xrc,
+                                 struct u_space_pose_cache *cache,
                                  struct u_space *base,
                                  struct u_space *target,
                                  int64_t at_timestamp_ns)
@@ -380,8 +446,8 @@ build_relation_chain_read_locked(struct u_space_overseer *uso,
 	assert(base != NULL);
 	assert(target != NULL);
 
-	push_then_traverse(xrc, target, at_timestamp_ns);
-	traverse_then_push_inverse(xrc, base, at_timestamp_ns);
+	push_then_traverse(xrc, cache, target, at_timestamp_ns);
+	traverse_then_push_inverse(xrc, cache, base, at_timestamp_ns);
 }
 
 static void
@@ -392,7 +458,7 @@ build_relation_chain(struct u_space_overseer *uso,
                      int64_t at_timestamp_ns)
 {
 	pthread_rwlock_rdlock(&uso->lock);
-	build_relation_chain_read_locked(uso, xrc, base, target, at_timestamp_ns);
+	build_relation_chain_read_locked(uso, xrc, NULL, base, target, at_timestamp_ns);
 	pthread_rwlock_unlock(&uso->lock);
 }
 
@@ -597,10 +663,17 @@ locate_spaces(struct xrt_space_overseer *xso,
 
 	struct u_space *ubase_space = u_space(base_space);
 
+	// All spaces are located at the same time, so device poses can be shared.
+	struct u_space_pose_cache cache;
+	cache.count = 0;
+
+	// Only need the read lock, taken once for all spaces.
+	pthread_rwlock_rdlock(&uso->lock);
+
 	for (uint32_t i = 0; i < space_count; i++) {
 		// spaces are allowed to be NULL
 		if (spaces[i] == NULL) {
-			out_relations->relation_flags = XRT_SPACE_RELATION_BITMASK_NONE;
+			out_relations[i].relation_flags = XRT_SPACE_RELATION_BITMASK_NONE;
 			continue;
 		}
 
@@ -621,7 +694,7 @@ locate_spaces(struct xrt_space_overseer *xso,
 		// crude optimization: If locating a space in itself, we don't actually need to locate the space itself.
 		// only the offsets need to be applied.
 		if (spaces[i] != base_space) {
-			build_relation_chain(uso, &xrc, ubase_space, uspace, at_timestamp_ns);
+			build_relation_chain_read_locked(uso, &xrc, &cache, ubase_space, uspace, at_timestamp_ns);
 		}
 
 		m_relation_chain_push_inverted_pose_if_not_identity(&xrc, base_offset);
@@ -630,6 +703,8 @@ locate_spaces(struct xrt_space_overseer *xso,
 		special_resolve(&xrc, &out_relations[i]);
 	}
 
+	pthread_rwlock_unlock(&uso->lock);
+
 	return XRT_SUCCESS;
 }
 
@@ -651,7 +726,7 @@ locate_device(struct xrt_space_overseer *xso,
 	pthread_rwlock_rdlock(&uso->lock);
 
 	struct u_space *uspace = find_xdev_space_read_locked(uso, xdev);
-	build_relation_chain_read_locked(uso, &xrc, ubase_space, uspace, at_timestamp_ns);
+	build_relation_chain_read_locked(uso, &xrc, NULL, ubase_space, uspace, at_timestamp_ns);
 
 	// Safe to unlock now.
 	pthread_rwlock_unlock(&uso->lock);
@@ -753,7 +828,7 @@ recenter_local_spaces(struct xrt_space_overseer *xso)
 	 */
 
 	struct xrt_relation_chain xrc = {0};
-	build_relation_chain_read_locked(uso, &xrc, uparent, uview, new_ns);
+	build_relation_chain_read_locked(uso, &xrc, NULL, uparent, uview, new_ns);
 
 	struct xrt_space_relation rel;
 	special_resolve(&xrc, &rel);
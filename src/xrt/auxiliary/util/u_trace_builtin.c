@@ -0,0 +1,600 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Built-in tracing backend writing Chrome trace event JSON files, see @ref tracing-builtin.
+ * @ingroup aux_util
+ */
+
+#include "xrt/xrt_compiler.h"
+#include "xrt/xrt_config_os.h"
+
+#include "util/u_trace_marker.h"
+
+#ifdef U_TRACE_BUILTIN
+
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
+#include "util/u_misc.h"
+#include "util/u_debug.h"
+#include "util/u_logging.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+
+/*!
+ * Number of events each thread can have waiting to be written, must be a
+ * power of two. Events are dropped when the buffer is full.
+ */
+#define BUFFER_EVENT_COUNT (8 * 1024)
+#define BUFFER_EVENT_MASK (BUFFER_EVENT_COUNT - 1)
+
+/*!
+ * Space kept free for end events when beginning, so that events that have
+ * begun can always be ended as long as nesting is not deeper than this.
+ */
+#define BUFFER_END_RESERVE (256)
+
+//! How often the writer thread empties the thread buffers.
+#define FLUSH_INTERVAL_NS (50 * U_TIME_1MS_IN_NS)
+
+//! Timing tracks are shown as threads with these ids.
+#define TRACK_TID_BASE (1000000)
+
+DEBUG_GET_ONCE_BOOL_OPTION(tracing, "XRT_TRACING", false)
+DEBUG_GET_ONCE_OPTION(tracing_file, "XRT_TRACING_FILE", NULL)
+
+enum event_type
+{
+	EVENT_BEGIN,
+	EVENT_END,
+	EVENT_INSTANT,
+	EVENT_COUNTER,
+};
+
+struct event
+{
+	int64_t time_ns;
+	const char *name;
+	double value;
+	uint8_t type;
+	uint8_t category;
+	int16_t track; //!< Negative for events on the thread itself
+};
+
+/*!
+ * Single producer single consumer ring of events, the owning thread only
+ * writes @p head and the writer thread only writes @p tail.
+ */
+struct thread_buffer
+{
+	//! Next in the list of all buffers, protected by the global mutex.
+	struct thread_buffer *next;
+
+	int32_t tid;
+
+	xrt_atomic_s32_t head;
+	xrt_atomic_s32_t tail;
+	xrt_atomic_s32_t dropped;
+
+	//! Set when the thread has exited, freed once all events are written.
+	xrt_atomic_s32_t exited;
+
+	//! Protected by the global mutex.
+	char name[64];
+	bool name_written;
+
+	struct event events[BUFFER_EVENT_COUNT];
+};
+
+static const char *category_names[U_TRACE_CATEGORY_COUNT] = {
+#define CATEGORY_NAME(NAME, STRING) STRING,
+    U_TRACE_CATEGORIES(CATEGORY_NAME, _)
+#undef CATEGORY_NAME
+};
+
+static const char *track_names[U_TRACE_TRACK_COUNT] = {
+    [U_TRACE_TRACK_pc_cpu] = "PC 1 Sleep",         //
+    [U_TRACE_TRACK_pc_allotted] = "PC 2 Allotted time", //
+    [U_TRACE_TRACK_pc_gpu] = "PC 3 GPU",           //
+    [U_TRACE_TRACK_pc_margin] = "PC 4 Margin",     //
+    [U_TRACE_TRACK_pc_error] = "PC 5 Error",       //
+    [U_TRACE_TRACK_pc_info] = "PC 6 Info",         //
+    [U_TRACE_TRACK_pc_present] = "PC 7 Present",   //
+    [U_TRACE_TRACK_pa_cpu] = "PA 1 App",           //
+    [U_TRACE_TRACK_pa_draw] = "PA 2 Draw",         //
+    [U_TRACE_TRACK_pa_wait] = "PA 3 Wait",         //
+};
+
+static struct
+{
+	//! Checked on every event, only set while the file is open.
+	xrt_atomic_s32_t enabled;
+
+	enum u_trace_which which;
+	bool inited;
+
+	//! Protects the buffer list, thread names and the file.
+	pthread_mutex_t mutex;
+	struct thread_buffer *buffers;
+	int32_t next_tid;
+
+	//! Dropped events from buffers of threads that have exited.
+	int64_t dropped;
+
+	//! Used to find out when threads exit.
+	pthread_key_t key;
+
+	struct os_thread_helper oth;
+
+	FILE *file;
+	bool first_event;
+	int pid;
+} g = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static _Thread_local struct thread_buffer *tls_buffer;
+
+
+/*
+ *
+ * Writing.
+ *
+ */
+
+static void
+write_separator(void)
+{
+	if (g.first_event) {
+		g.first_event = false;
+	} else {
+		fputs(",\n", g.file);
+	}
+}
+
+static void
+write_string(const char *str)
+{
+	fputc('"', g.file);
+	for (const char *c = str; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', g.file);
+			fputc(*c, g.file);
+		} else if ((unsigned char)*c < 0x20) {
+			fputc(' ', g.file);
+		} else {
+			fputc(*c, g.file);
+		}
+	}
+	fputc('"', g.file);
+}
+
+static void
+write_thread_name(int32_t tid, const char *name)
+{
+	write_separator();
+	fprintf(g.file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", g.pid,
+	        tid);
+	write_string(name);
+	fputs("}}", g.file);
+}
+
+static void
+write_event(int32_t tid, const struct event *e)
+{
+	if (e->track >= 0) {
+		tid = TRACK_TID_BASE + e->track;
+	}
+
+	// Timestamps are in microseconds, keep the nanoseconds as decimals.
+	int64_t us = e->time_ns / 1000;
+	int32_t ns = (int32_t)(e->time_ns % 1000);
+	if (ns < 0) {
+		us -= 1;
+		ns += 1000;
+	}
+
+	write_separator();
+
+	switch (e->type) {
+	case EVENT_BEGIN: fputs("{\"ph\":\"B\"", g.file); break;
+	case EVENT_END: fputs("{\"ph\":\"E\"", g.file); break;
+	case EVENT_INSTANT: fputs("{\"ph\":\"i\",\"s\":\"t\"", g.file); break;
+	case EVENT_COUNTER: fputs("{\"ph\":\"C\"", g.file); break;
+	default: assert(false);
+	}
+
+	if (e->type != EVENT_END) {
+		fputs(",\"name\":", g.file);
+		write_string(e->name);
+		fprintf(g.file, ",\"cat\":\"%s\"", category_names[e->category]);
+	}
+
+	if (e->type == EVENT_COUNTER) {
+		// JSON has no NaN or infinity.
+		double value = isfinite(e->value) ? e->value : 0.0;
+		fprintf(g.file, ",\"args\":{\"value\":%g}", value);
+	}
+
+	fprintf(g.file, ",\"ts\":%" PRId64 ".%03d,\"pid\":%d,\"tid\":%d}", us, ns, g.pid, tid);
+}
+
+/*!
+ * Writes out all waiting events, and frees the buffers of threads that have
+ * exited. Must be called with the mutex held.
+ */
+static void
+flush_locked(void)
+{
+	struct thread_buffer **ptr = &g.buffers;
+
+	while (*ptr != NULL) {
+		struct thread_buffer *tb = *ptr;
+
+		// Read before draining, no new events come in after this is set.
+		bool exited = tb->exited != 0;
+
+		if (!tb->name_written && tb->name[0] != '\0') {
+			write_thread_name(tb->tid, tb->name);
+			tb->name_written = true;
+		}
+
+		uint32_t head = (uint32_t)tb->head;
+		uint32_t tail = (uint32_t)tb->tail;
+
+		// Make sure the events are read after the head.
+		xrt_atomic_full_barrier();
+
+		for (uint32_t i = tail; i != head; i++) {
+			write_event(tb->tid, &tb->events[i & BUFFER_EVENT_MASK]);
+		}
+
+		// Make sure the events have been read before giving back the space.
+		xrt_atomic_full_barrier();
+		tb->tail = (int32_t)head;
+
+		if (exited) {
+			g.dropped += tb->dropped;
+			*ptr = tb->next;
+			free(tb);
+		} else {
+			ptr = &tb->next;
+		}
+	}
+
+	fflush(g.file);
+}
+
+
+/*
+ *
+ * Thread buffers.
+ *
+ */
+
+static void
+thread_exit_destructor(void *ptr)
+{
+	struct thread_buffer *tb = (struct thread_buffer *)ptr;
+
+	// Runs on the exiting thread, later events get a new buffer.
+	tls_buffer = NULL;
+
+	// Make sure all events are visible before the flag.
+	xrt_atomic_full_barrier();
+	tb->exited = 1;
+}
+
+static struct thread_buffer *
+get_thread_buffer(void)
+{
+	if (tls_buffer != NULL) {
+		return tls_buffer;
+	}
+
+	struct thread_buffer *tb = U_TYPED_CALLOC(struct thread_buffer);
+	if (tb == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g.mutex);
+	tb->tid = ++g.next_tid;
+	tb->next = g.buffers;
+	g.buffers = tb;
+	pthread_mutex_unlock(&g.mutex);
+
+	pthread_setspecific(g.key, tb);
+	tls_buffer = tb;
+
+	return tb;
+}
+
+static bool
+push_event(const struct event *e, uint32_t reserve)
+{
+	struct thread_buffer *tb = get_thread_buffer();
+	if (tb == NULL) {
+		return false;
+	}
+
+	uint32_t head = (uint32_t)tb->head;
+	uint32_t tail = (uint32_t)tb->tail;
+
+	if (head - tail >= BUFFER_EVENT_COUNT - reserve) {
+		xrt_atomic_s32_inc_return(&tb->dropped);
+		return false;
+	}
+
+	tb->events[head & BUFFER_EVENT_MASK] = *e;
+
+	// Make sure the event is visible before the head.
+	xrt_atomic_full_barrier();
+	tb->head = (int32_t)(head + 1);
+
+	return true;
+}
+
+static inline bool
+push(enum event_type type, enum u_trace_category category, int track, int64_t time_ns, const char *name, double value)
+{
+	struct event e = {
+	    .time_ns = time_ns,
+	    .name = name,
+	    .value = value,
+	    .type = (uint8_t)type,
+	    .category = (uint8_t)category,
+	    .track = (int16_t)track,
+	};
+
+	// Only end events may use the reserved space.
+	uint32_t reserve = type == EVENT_END ? 0 : BUFFER_END_RESERVE;
+
+	return push_event(&e, reserve);
+}
+
+
+/*
+ *
+ * Writer thread.
+ *
+ */
+
+static void *
+run_writer(void *ptr)
+{
+	(void)ptr;
+
+	os_thread_helper_name(&g.oth, "Trace Writer");
+
+	while (os_thread_helper_is_running(&g.oth)) {
+		os_nanosleep(FLUSH_INTERVAL_NS);
+
+		pthread_mutex_lock(&g.mutex);
+		flush_locked();
+		pthread_mutex_unlock(&g.mutex);
+	}
+
+	return NULL;
+}
+
+static void
+shutdown_at_exit(void)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	g.enabled = 0;
+	os_thread_helper_destroy(&g.oth);
+
+	pthread_mutex_lock(&g.mutex);
+
+	flush_locked();
+
+	int64_t dropped = g.dropped;
+	for (struct thread_buffer *tb = g.buffers; tb != NULL; tb = tb->next) {
+		dropped += tb->dropped;
+	}
+
+	fputs("\n]\n", g.file);
+	fclose(g.file);
+	g.file = NULL;
+
+	pthread_mutex_unlock(&g.mutex);
+
+	if (dropped > 0) {
+		U_LOG_W("Dropped %" PRId64 " trace events, buffers were full", dropped);
+	}
+}
+
+static bool
+open_file(void)
+{
+	char default_path[64];
+	const char *path = debug_get_option_tracing_file();
+	if (path == NULL) {
+		(void)snprintf(default_path, sizeof(default_path), "monado-%s-%d.json",
+		               g.which == U_TRACE_WHICH_SERVICE ? "service" : "openxr", g.pid);
+		path = default_path;
+	}
+
+	g.file = fopen(path, "w");
+	if (g.file == NULL) {
+		U_LOG_E("Could not open trace file '%s'", path);
+		return false;
+	}
+
+	U_LOG_I("Writing trace events to '%s'", path);
+
+	// Readers accept the file without the closing bracket, so it's usable after a crash.
+	fputs("[\n", g.file);
+	g.first_event = true;
+
+	write_separator();
+	fprintf(g.file, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"args\":{\"name\":", g.pid);
+	write_string(g.which == U_TRACE_WHICH_SERVICE ? "Monado service" : "Monado OpenXR client");
+	fputs("}}", g.file);
+
+	for (int i = 0; i < U_TRACE_TRACK_COUNT; i++) {
+		write_thread_name(TRACK_TID_BASE + i, track_names[i]);
+	}
+
+	return true;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+u_trace_builtin_is_enabled(void)
+{
+	return g.enabled != 0;
+}
+
+bool
+u_trace_builtin_begin(enum u_trace_category category, const char *name)
+{
+	if (g.enabled == 0) {
+		return false;
+	}
+
+	return push(EVENT_BEGIN, category, -1, os_monotonic_get_ns(), name, 0.0);
+}
+
+void
+u_trace_builtin_end(enum u_trace_category category, const char *name)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	push(EVENT_END, category, -1, os_monotonic_get_ns(), name, 0.0);
+}
+
+void
+u_trace_builtin_begin_on_track(enum u_trace_category category,
+                               enum u_trace_track track,
+                               int64_t time_ns,
+                               const char *name)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	push(EVENT_BEGIN, category, track, time_ns, name, 0.0);
+}
+
+void
+u_trace_builtin_end_on_track(enum u_trace_category category, enum u_trace_track track, int64_t time_ns)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	push(EVENT_END, category, track, time_ns, NULL, 0.0);
+}
+
+void
+u_trace_builtin_instant_on_track(enum u_trace_category category,
+                                 enum u_trace_track track,
+                                 int64_t time_ns,
+                                 const char *name)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	push(EVENT_INSTANT, category, track, time_ns, name, 0.0);
+}
+
+void
+u_trace_builtin_counter(enum u_trace_category category, const char *name, double value)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	push(EVENT_COUNTER, category, -1, os_monotonic_get_ns(), name, value);
+}
+
+void
+u_trace_builtin_set_thread_name(const char *name)
+{
+	if (g.enabled == 0) {
+		return;
+	}
+
+	struct thread_buffer *tb = get_thread_buffer();
+	if (tb == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&g.mutex);
+	(void)snprintf(tb->name, sizeof(tb->name), "%s", name);
+	tb->name_written = false;
+	pthread_mutex_unlock(&g.mutex);
+}
+
+void
+u_trace_marker_setup(enum u_trace_which which)
+{
+	g.which = which;
+}
+
+void
+u_trace_marker_init(void)
+{
+	if (!debug_get_bool_option_tracing()) {
+		return;
+	}
+
+	if (g.inited) {
+		return;
+	}
+	g.inited = true;
+
+	g.pid = (int)getpid();
+
+	if (pthread_key_create(&g.key, thread_exit_destructor) != 0) {
+		U_LOG_E("Failed to create thread key for tracing");
+		return;
+	}
+
+	if (os_thread_helper_init(&g.oth) != 0) {
+		U_LOG_E("Failed to init trace writer thread");
+		return;
+	}
+
+	if (!open_file()) {
+		os_thread_helper_destroy(&g.oth);
+		return;
+	}
+
+	if (os_thread_helper_start(&g.oth, run_writer, NULL) != 0) {
+		U_LOG_E("Failed to start trace writer thread");
+		fclose(g.file);
+		g.file = NULL;
+		os_thread_helper_destroy(&g.oth);
+		return;
+	}
+
+	atexit(shutdown_at_exit);
+
+	xrt_atomic_full_barrier();
+	g.enabled = 1;
+}
+
+#endif // U_TRACE_BUILTIN
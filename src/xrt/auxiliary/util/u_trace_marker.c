@@ -89,7 +89,7 @@ u_trace_marker_init(void)
 	}
 }
 
-#else // !U_TRACE_PERCETTO
+#elif !defined(U_TRACE_BUILTIN) // !U_TRACE_PERCETTO
 
 void
 u_trace_marker_setup(enum u_trace_which which)
@@ -105,4 +105,4 @@ u_trace_marker_init(void)
 	// Noop
 }
 
-#endif // !U_TRACE_PERCETTO
+#endif // !U_TRACE_PERCETTO && !U_TRACE_BUILTIN
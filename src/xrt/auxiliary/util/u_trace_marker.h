@@ -21,6 +21,12 @@
 #include <percetto.h>
 #endif
 
+#if defined(XRT_FEATURE_TRACING) && !defined(XRT_HAVE_PERCETTO) && !defined(XRT_HAVE_TRACY)
+#define U_TRACE_BUILTIN
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
 #if !defined(XRT_FEATURE_TRACING) || !defined(XRT_HAVE_TRACY)
 #define U_TRACE_FUNC_COLOR(CATEGORY, COLOR)                                                                            \
 	(void)COLOR;                                                                                                   \
@@ -78,6 +84,23 @@ u_trace_marker_setup(enum u_trace_which which);
 void
 u_trace_marker_init(void);
 
+/*!
+ * The categories used by the backends that have them, see @ref tracing.
+ *
+ * @ingroup aux_util
+ */
+#define U_TRACE_CATEGORIES(C, G)                                                                                       \
+	C(vk, "vk")         /* Vulkan calls */                                                                         \
+	C(xrt, "xrt")       /* Misc XRT calls */                                                                       \
+	C(drv, "drv")       /* Driver calls */                                                                         \
+	C(ipc, "ipc")       /* IPC calls */                                                                            \
+	C(oxr, "st/oxr")    /* OpenXR State Tracker calls */                                                           \
+	C(sink, "sink")     /* Sink/frameserver calls */                                                               \
+	C(comp, "comp")     /* Compositor calls  */                                                                    \
+	C(sc, "sc")         /* Swapchain calls  */                                                                     \
+	C(track, "track")   /* Tracking calls  */                                                                      \
+	C(timing, "timing") /* Timing calls */
+
 #define COLOR_TRACE_MARKER(COLOR) U_TRACE_FUNC_COLOR(color, COLOR)
 #define COLOR_TRACE_IDENT(IDENT, COLOR) U_TRACE_IDENT_COLOR(color, IDENT, COLOR)
 #define COLOR_TRACE_BEGIN(IDENT, COLOR) U_TRACE_BEGIN_COLOR(color, IDENT, COLOR)
@@ -172,6 +195,10 @@ u_trace_marker_init(void);
 	do {                                                                                                           \
 	} while (false)
 
+#define U_TRACE_COUNTER(CATEGORY, NAME, VALUE)                                                                         \
+	do {                                                                                                           \
+	} while (false)
+
 #define U_TRACE_CATEGORY_IS_ENABLED(_) (false)
 
 #define U_TRACE_SET_THREAD_NAME(STRING)                                                                                \
@@ -286,6 +313,8 @@ u_trace_scope_cleanup(TracyCZoneCtx *ctx_ptr)
 	do {                                                                                                           \
 	} while (false)
 
+#define U_TRACE_COUNTER(CATEGORY, NAME, VALUE) TracyCPlot(NAME, VALUE)
+
 #define U_TRACE_CATEGORY_IS_ENABLED(_) (true) // All categories are always enabled with Tracy.
 
 #define U_TRACE_SET_THREAD_NAME(STRING)                                                                                \
@@ -312,18 +341,6 @@ u_trace_scope_cleanup(TracyCZoneCtx *ctx_ptr)
 #endif
 
 
-#define U_TRACE_CATEGORIES(C, G)                                                                                       \
-	C(vk, "vk")         /* Vulkan calls */                                                                         \
-	C(xrt, "xrt")       /* Misc XRT calls */                                                                       \
-	C(drv, "drv")       /* Driver calls */                                                                         \
-	C(ipc, "ipc")       /* IPC calls */                                                                            \
-	C(oxr, "st/oxr")    /* OpenXR State Tracker calls */                                                           \
-	C(sink, "sink")     /* Sink/frameserver calls */                                                               \
-	C(comp, "comp")     /* Compositor calls  */                                                                    \
-	C(sc, "sc")         /* Swapchain calls  */                                                                     \
-	C(track, "track")   /* Tracking calls  */                                                                      \
-	C(timing, "timing") /* Timing calls */
-
 PERCETTO_CATEGORY_DECLARE(U_TRACE_CATEGORIES)
 
 PERCETTO_TRACK_DECLARE(pc_cpu);
@@ -347,6 +364,9 @@ PERCETTO_TRACK_DECLARE(pa_wait);
 	TRACE_EVENT_BEGIN_ON_TRACK_DATA(CATEGORY, TRACK, TIME, NAME, __VA_ARGS__)
 #define U_TRACE_EVENT_END_ON_TRACK(CATEGORY, TRACK, TIME) TRACE_EVENT_END_ON_TRACK(CATEGORY, TRACK, TIME)
 #define U_TRACE_CATEGORY_IS_ENABLED(CATEGORY) PERCETTO_CATEGORY_IS_ENABLED(CATEGORY)
+#define U_TRACE_COUNTER(CATEGORY, NAME, VALUE)                                                                         \
+	do {                                                                                                           \
+	} while (false)
 #define U_TRACE_INSTANT_ON_TRACK(CATEGORY, TRACK, TIME, NAME)                                                          \
 	TRACE_ANY_WITH_ARGS(PERCETTO_EVENT_INSTANT, CATEGORY, &g_percetto_track_##TRACK, TIME, NAME, 0)
 #define U_TRACE_DATA(fd, type, data) u_trace_data(fd, type, (void *)&(data), sizeof(data))
@@ -356,6 +376,199 @@ PERCETTO_TRACK_DECLARE(pa_wait);
 		(void)STRING;                                                                                          \
 	} while (false)
 
+#define U_TRACE_TARGET_SETUP(WHICH)                                                                                    \
+	void __attribute__((constructor(101))) u_trace_marker_constructor(void);                                       \
+                                                                                                                       \
+	void u_trace_marker_constructor(void)                                                                          \
+	{                                                                                                              \
+		u_trace_marker_setup(WHICH);                                                                           \
+	}
+
+/*
+ *
+ * Built-in support.
+ *
+ */
+
+#elif defined(U_TRACE_BUILTIN) // && XRT_FEATURE_TRACING && !XRT_HAVE_PERCETTO && !XRT_HAVE_TRACY
+
+#ifndef XRT_OS_UNIX
+#error "Built-in tracing only supported on Unix like platforms"
+#endif
+
+#define U_TRACE_BUILTIN_CATEGORY_ENUM(NAME, STRING) U_TRACE_CATEGORY_##NAME,
+
+/*!
+ * Categories of the built-in backend, see @ref U_TRACE_CATEGORIES.
+ *
+ * @ingroup aux_util
+ */
+enum u_trace_category
+{
+	U_TRACE_CATEGORIES(U_TRACE_BUILTIN_CATEGORY_ENUM, _) //
+	U_TRACE_CATEGORY_COUNT,
+};
+
+#undef U_TRACE_BUILTIN_CATEGORY_ENUM
+
+/*!
+ * The timing tracks that events with explicit times are put on, these are
+ * shown as their own threads in the trace.
+ *
+ * @ingroup aux_util
+ */
+enum u_trace_track
+{
+	U_TRACE_TRACK_pc_cpu,
+	U_TRACE_TRACK_pc_allotted,
+	U_TRACE_TRACK_pc_gpu,
+	U_TRACE_TRACK_pc_margin,
+	U_TRACE_TRACK_pc_error,
+	U_TRACE_TRACK_pc_info,
+	U_TRACE_TRACK_pc_present,
+	U_TRACE_TRACK_pa_cpu,
+	U_TRACE_TRACK_pa_draw,
+	U_TRACE_TRACK_pa_wait,
+	U_TRACE_TRACK_COUNT,
+};
+
+/*!
+ * A scoped event, ended when the variable goes out of scope.
+ *
+ * @ingroup aux_util
+ */
+struct u_trace_builtin_scope
+{
+	const char *name;
+	enum u_trace_category category;
+	bool began;
+};
+
+/*!
+ * Is the built-in backend recording, set by @ref u_trace_marker_init.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_trace_builtin_is_enabled(void);
+
+/*!
+ * Begin an event on the calling thread, @p name must outlive the process and
+ * is usually a string literal. Returns true if the event was recorded.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_trace_builtin_begin(enum u_trace_category category, const char *name);
+
+/*!
+ * End the last event begun on the calling thread.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_end(enum u_trace_category category, const char *name);
+
+/*!
+ * Begin an event on a timing track at the given time.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_begin_on_track(enum u_trace_category category,
+                               enum u_trace_track track,
+                               int64_t time_ns,
+                               const char *name);
+
+/*!
+ * End the last event begun on the timing track at the given time.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_end_on_track(enum u_trace_category category, enum u_trace_track track, int64_t time_ns);
+
+/*!
+ * An instant event on a timing track at the given time.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_instant_on_track(enum u_trace_category category,
+                                 enum u_trace_track track,
+                                 int64_t time_ns,
+                                 const char *name);
+
+/*!
+ * Record the value of a counter, shown as a graph.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_counter(enum u_trace_category category, const char *name, double value);
+
+/*!
+ * Name the calling thread in the trace, the string is copied.
+ *
+ * @ingroup aux_util
+ */
+void
+u_trace_builtin_set_thread_name(const char *name);
+
+static inline struct u_trace_builtin_scope
+u_trace_builtin_scope_begin(enum u_trace_category category, const char *name)
+{
+	struct u_trace_builtin_scope scope = {name, category, false};
+	scope.began = u_trace_builtin_begin(category, name);
+	return scope;
+}
+
+static inline void
+u_trace_builtin_scope_cleanup(struct u_trace_builtin_scope *scope)
+{
+	if (scope->began) {
+		u_trace_builtin_end(scope->category, scope->name);
+	}
+}
+
+#define U_TRACE_BUILTIN_SCOPE(CATEGORY, VAR, NAME)                                                                     \
+	struct u_trace_builtin_scope __attribute__((cleanup(u_trace_builtin_scope_cleanup))) VAR =                     \
+	    u_trace_builtin_scope_begin(U_TRACE_CATEGORY_##CATEGORY, NAME);                                            \
+	(void)VAR
+
+#define U_TRACE_FUNC(CATEGORY) U_TRACE_BUILTIN_SCOPE(CATEGORY, __trace_func, __func__)
+#define U_TRACE_IDENT(CATEGORY, IDENT) U_TRACE_BUILTIN_SCOPE(CATEGORY, __trace_ident_##IDENT, #IDENT)
+
+#define U_TRACE_BEGIN(CATEGORY, IDENT)                                                                                 \
+	bool __trace_##IDENT = u_trace_builtin_begin(U_TRACE_CATEGORY_##CATEGORY, #IDENT)
+
+#define U_TRACE_END(CATEGORY, IDENT)                                                                                   \
+	do {                                                                                                           \
+		if (__trace_##IDENT) {                                                                                 \
+			u_trace_builtin_end(U_TRACE_CATEGORY_##CATEGORY, #IDENT);                                      \
+		}                                                                                                      \
+	} while (false)
+
+#define U_TRACE_EVENT_BEGIN_ON_TRACK(CATEGORY, TRACK, TIME, NAME)                                                      \
+	u_trace_builtin_begin_on_track(U_TRACE_CATEGORY_##CATEGORY, U_TRACE_TRACK_##TRACK, TIME, NAME)
+
+// The extra data is Percetto specific and dropped.
+#define U_TRACE_EVENT_BEGIN_ON_TRACK_DATA(CATEGORY, TRACK, TIME, NAME, ...)                                            \
+	u_trace_builtin_begin_on_track(U_TRACE_CATEGORY_##CATEGORY, U_TRACE_TRACK_##TRACK, TIME, NAME)
+
+#define U_TRACE_EVENT_END_ON_TRACK(CATEGORY, TRACK, TIME)                                                              \
+	u_trace_builtin_end_on_track(U_TRACE_CATEGORY_##CATEGORY, U_TRACE_TRACK_##TRACK, TIME)
+
+#define U_TRACE_INSTANT_ON_TRACK(CATEGORY, TRACK, TIME, NAME)                                                          \
+	u_trace_builtin_instant_on_track(U_TRACE_CATEGORY_##CATEGORY, U_TRACE_TRACK_##TRACK, TIME, NAME)
+
+#define U_TRACE_COUNTER(CATEGORY, NAME, VALUE) u_trace_builtin_counter(U_TRACE_CATEGORY_##CATEGORY, NAME, VALUE)
+
+// Recording is either on or off for all categories.
+#define U_TRACE_CATEGORY_IS_ENABLED(_) (u_trace_builtin_is_enabled())
+
+#define U_TRACE_SET_THREAD_NAME(STRING) u_trace_builtin_set_thread_name(STRING)
+
 #define U_TRACE_TARGET_SETUP(WHICH)                                                                                    \
 	void __attribute__((constructor(101))) u_trace_marker_constructor(void);                                       \
                                                                                                                        \
@@ -1,21 +1,38 @@
-// Copyright 2022, Collabora, Ltd.
+// Copyright 2022-2024, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
- * @brief  Simple worker pool.
+ * @brief  Simple work stealing worker pool.
  * @author Jakob Bornecrantz <jakob@collabora.com>
  *
+ * Tasks are submitted to a lock-free bounded queue shared by the pool. A
+ * worker thread that takes a task from it moves a few more to its own deque,
+ * idle workers steal from the other ends of those deques. Mutexes are only
+ * used to put threads to sleep and to wake them up, never to submit or pick
+ * up work.
+ *
  * @ingroup aux_util
  */
 
 #include "os/os_threading.h"
 
+#include "util/u_misc.h"
 #include "util/u_logging.h"
 #include "util/u_worker.h"
 #include "util/u_trace_marker.h"
 
+#include <assert.h>
+
+
+//! Size of the submit queue, must be a power of two.
+#define QUEUE_SIZE (256)
+
+//! Size of each worker deque, must be a power of two.
+#define DEQUE_SIZE (64)
+
+//! Max number of tasks a worker takes from the submit queue in one go.
+#define GRAB_COUNT (4)
 
-#define MAX_TASK_COUNT (64)
 #define MAX_THREAD_COUNT (16)
 
 struct group;
@@ -33,6 +50,35 @@ struct task
 	void *data;
 };
 
+/*!
+ * Bounded multi producer multi consumer queue, every slot has a sequence
+ * number that tells if it is free for the producer at that position or
+ * holds a task for the consumer at that position.
+ */
+struct queue
+{
+	xrt_atomic_s32_t enqueue_pos;
+	xrt_atomic_s32_t dequeue_pos;
+
+	struct
+	{
+		xrt_atomic_s32_t seq;
+		struct task task;
+	} slots[QUEUE_SIZE];
+};
+
+/*!
+ * Chase-Lev deque, the owning thread pushes and pops at the bottom and
+ * other threads steal from the top.
+ */
+struct deque
+{
+	xrt_atomic_s32_t top;
+	xrt_atomic_s32_t bottom;
+
+	struct task tasks[DEQUE_SIZE];
+};
+
 struct thread
 {
 	//! Pool this thread belongs to.
@@ -41,6 +87,12 @@ struct thread
 	// Native thread.
 	struct os_thread thread;
 
+	//! Index in the pool's thread array.
+	uint32_t index;
+
+	//! Tasks taken by this thread, other threads may steal from it.
+	struct deque deque;
+
 	//! Thread name.
 	char name[64];
 };
@@ -49,30 +101,30 @@ struct pool
 {
 	struct u_worker_thread_pool base;
 
-	//! Big contenious mutex.
-	struct os_mutex mutex;
+	//! Tasks submitted to the pool.
+	struct queue queue;
+
+	//! Currently the number of works that can work, waiting increases this.
+	xrt_atomic_s32_t worker_limit;
 
-	//! Array of tasks.
-	struct task tasks[MAX_TASK_COUNT];
+	//! Number of threads allowed to work on tasks, bounded by worker_limit.
+	xrt_atomic_s32_t working_count;
 
-	//! Number of tasks in array.
-	size_t tasks_in_array_count;
+	//! Number of threads sleeping or about to sleep.
+	xrt_atomic_s32_t sleeping_count;
 
 	struct
 	{
-		size_t count;
+		struct os_mutex mutex;
 		struct os_cond cond;
-	} available; //!< For worker threads.
+
+		//! Bumped for every wake up, sleepers wait for it to change.
+		int32_t epoch;
+	} sleep; //!< For worker threads.
 
 	//! Given at creation.
 	uint32_t initial_worker_limit;
 
-	//! Currently the number of works that can work, waiting increases this.
-	uint32_t worker_limit;
-
-	//! Number of threads working on tasks.
-	size_t working_count;
-
 	//! Number of created threads.
 	size_t thread_count;
 
@@ -80,7 +132,7 @@ struct pool
 	struct thread threads[MAX_THREAD_COUNT];
 
 	//! Is the pool up and running?
-	bool running;
+	volatile bool running;
 
 	//! Prefix to use for thread names.
 	char prefix[32];
@@ -94,15 +146,15 @@ struct group
 	//! Pointer to poll of threads.
 	struct u_worker_thread_pool *uwtp;
 
-	//! Number of tasks that is pending or being worked on in this group.
-	size_t current_submitted_tasks_count;
-
-	//! Number of threads that have been released or newly entered wait.
-	size_t released_count;
+	/*!
+	 * Number of tasks that is pending or being worked on in this group, only
+	 * goes from one to zero with waiting.mutex held, see group_task_done.
+	 */
+	xrt_atomic_s32_t current_submitted_tasks_count;
 
 	struct
 	{
-		size_t count;
+		struct os_mutex mutex;
 		struct os_cond cond;
 	} waiting; //!< For wait_all
 };
@@ -126,177 +178,297 @@ pool(struct u_worker_thread_pool *uwtp)
 	return (struct pool *)uwtp;
 }
 
+static inline int32_t
+pos_add(int32_t pos, int32_t value)
+{
+	// Wrapping without signed overflow.
+	return (int32_t)((uint32_t)pos + (uint32_t)value);
+}
+
+static inline int32_t
+pos_diff(int32_t a, int32_t b)
+{
+	return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
 
 /*
  *
- * Internal pool functions.
+ * Queue functions.
  *
  */
 
 static void
-locked_pool_pop_task(struct pool *p, struct task *out_task)
+queue_init(struct queue *q)
 {
-	assert(p->tasks_in_array_count > 0);
-
-	for (size_t i = 0; i < MAX_TASK_COUNT; i++) {
-		if (p->tasks[i].func == NULL) {
-			continue;
-		}
+	q->enqueue_pos = 0;
+	q->dequeue_pos = 0;
 
-		*out_task = p->tasks[i];
-		p->tasks[i] = (struct task){NULL, NULL, NULL};
-		p->tasks_in_array_count--;
-		return;
+	for (int32_t i = 0; i < QUEUE_SIZE; i++) {
+		q->slots[i].seq = i;
 	}
-
-	assert(false);
 }
 
-static void
-locked_pool_push_task(struct pool *p, struct group *g, u_worker_group_func_t func, void *data)
+static bool
+queue_push(struct queue *q, const struct task *task)
 {
-	assert(p->tasks_in_array_count < MAX_TASK_COUNT);
-
-	for (size_t i = 0; i < MAX_TASK_COUNT; i++) {
-		if (p->tasks[i].func != NULL) {
-			continue;
+	int32_t pos = q->enqueue_pos;
+	int32_t index;
+
+	while (true) {
+		index = pos & (QUEUE_SIZE - 1);
+		int32_t seq = q->slots[index].seq;
+		xrt_atomic_full_barrier();
+
+		int32_t diff = pos_diff(seq, pos);
+		if (diff == 0) {
+			int32_t old = xrt_atomic_s32_cmpxchg(&q->enqueue_pos, pos, pos_add(pos, 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// Full.
+			return false;
+		} else {
+			pos = q->enqueue_pos;
 		}
-
-		p->tasks[i] = (struct task){g, func, data};
-		p->tasks_in_array_count++;
-		g->current_submitted_tasks_count++;
-		return;
 	}
 
-	assert(false);
+	q->slots[index].task = *task;
+
+	// Publish the task.
+	xrt_atomic_full_barrier();
+	q->slots[index].seq = pos_add(pos, 1);
+
+	return true;
 }
 
-static void
-locked_pool_wake_worker_if_allowed(struct pool *p)
+static bool
+queue_pop(struct queue *q, struct task *out_task)
 {
-	// No tasks in array, don't wake any thread.
-	if (p->tasks_in_array_count == 0) {
-		return;
+	int32_t pos = q->dequeue_pos;
+	int32_t index;
+
+	while (true) {
+		index = pos & (QUEUE_SIZE - 1);
+		int32_t seq = q->slots[index].seq;
+		xrt_atomic_full_barrier();
+
+		int32_t diff = pos_diff(seq, pos_add(pos, 1));
+		if (diff == 0) {
+			int32_t old = xrt_atomic_s32_cmpxchg(&q->dequeue_pos, pos, pos_add(pos, 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// Empty.
+			return false;
+		} else {
+			pos = q->dequeue_pos;
+		}
 	}
 
-	// The number of working threads is at the limit.
-	if (p->working_count >= p->worker_limit) {
-		return;
-	}
+	*out_task = q->slots[index].task;
 
-	// No waiting thread.
-	if (p->available.count == 0) {
-		//! @todo Is this a error?
-		return;
-	}
+	// Make sure the task has been read before the slot is reused.
+	xrt_atomic_full_barrier();
+	q->slots[index].seq = pos_add(pos, QUEUE_SIZE);
 
-	os_cond_signal(&p->available.cond);
+	return true;
+}
+
+static bool
+queue_maybe_has_tasks(struct queue *q)
+{
+	return pos_diff(q->enqueue_pos, q->dequeue_pos) > 0;
 }
 
 
 /*
  *
- * Thread group functions.
+ * Deque functions.
  *
  */
 
+//! Only called by the owning thread.
 static bool
-locked_group_should_enter_wait_loop(struct pool *p, struct group *g)
+deque_push(struct deque *d, const struct task *task)
 {
-	if (g->current_submitted_tasks_count == 0) {
+	int32_t b = d->bottom;
+	int32_t t = d->top;
+
+	// Top only ever grows so this might think it is fuller than it is.
+	if (pos_diff(b, t) >= DEQUE_SIZE) {
 		return false;
 	}
 
-	// Enter the loop as a released thread.
-	g->released_count++;
+	d->tasks[b & (DEQUE_SIZE - 1)] = *task;
+
+	// Publish the task.
+	xrt_atomic_full_barrier();
+	d->bottom = pos_add(b, 1);
 
 	return true;
 }
 
+//! Only called by the owning thread.
 static bool
-locked_group_should_wait(struct pool *p, struct group *g)
+deque_pop(struct deque *d, struct task *out_task)
 {
-	/*
-	 * There are several cases that needs to be covered by this function.
-	 *
-	 * A thread is entering the wait_all function for the first time, and
-	 * work is outstanding what we should do then is increase the worker
-	 * limit and wait on the conditional.
-	 *
-	 * Similar to preceding, we were woken up, there are more work outstanding
-	 * on the group and we had been released, remove one released and up the
-	 * worker limit, then wait on the conditional.
-	 *
-	 * A thread (or more) has been woken up and no new tasks has been
-	 * submitted, then break out of the loop and decrement the released
-	 * count.
-	 *
-	 * As preceding, but we were one of many woken up but only one thread had
-	 * been released and that released count had been taken, then we should
-	 * do nothing and wait again.
-	 */
+	int32_t b = pos_add(d->bottom, -1);
+	d->bottom = b;
+	xrt_atomic_full_barrier();
+	int32_t t = d->top;
+
+	int32_t size = pos_diff(b, t);
+	if (size < 0) {
+		// Empty, restore.
+		d->bottom = pos_add(b, 1);
+		return false;
+	}
 
-	// Tasks available.
-	if (g->current_submitted_tasks_count > 0) {
+	*out_task = d->tasks[b & (DEQUE_SIZE - 1)];
+	if (size > 0) {
+		return true;
+	}
 
-		// We have been released or newly entered the loop.
-		if (g->released_count > 0) {
-			g->released_count--;
-			p->worker_limit++;
+	// Last task, race any thieves for it.
+	bool won = xrt_atomic_s32_cmpxchg(&d->top, t, pos_add(t, 1)) == t;
+	d->bottom = pos_add(b, 1);
 
-			// Wake a worker with the new worker limit.
-			locked_pool_wake_worker_if_allowed(p);
-		}
+	return won;
+}
 
-		return true;
+static bool
+deque_steal(struct deque *d, struct task *out_task)
+{
+	int32_t t = d->top;
+	xrt_atomic_full_barrier();
+	int32_t b = d->bottom;
+
+	if (pos_diff(b, t) <= 0) {
+		return false;
 	}
 
-	// No tasks, and we have been released, party!
-	if (g->released_count > 0) {
-		g->released_count--;
+	// The slot can only be reused by the owner once top has moved past it.
+	struct task task = d->tasks[t & (DEQUE_SIZE - 1)];
+	if (xrt_atomic_s32_cmpxchg(&d->top, t, pos_add(t, 1)) != t) {
 		return false;
 	}
 
-	// We where woken up, but nothing had been released, loop again.
+	*out_task = task;
+
 	return true;
 }
 
-static void
-locked_group_wake_waiter_if_allowed(struct pool *p, struct group *g)
+static bool
+deque_maybe_has_tasks(struct deque *d)
 {
-	// Are there still outstanding tasks?
-	if (g->current_submitted_tasks_count > 0) {
-		return;
+	return pos_diff(d->bottom, d->top) > 0;
+}
+
+
+/*
+ *
+ * Internal pool functions.
+ *
+ */
+
+static bool
+pool_maybe_has_tasks(struct pool *p)
+{
+	if (queue_maybe_has_tasks(&p->queue)) {
+		return true;
 	}
 
-	// Is there a thread waiting or not?
-	if (g->waiting.count == 0) {
-		return;
+	for (size_t i = 0; i < p->thread_count; i++) {
+		if (deque_maybe_has_tasks(&p->threads[i].deque)) {
+			return true;
+		}
 	}
 
-	// Wake one waiting thread.
-	os_cond_signal(&g->waiting.cond);
+	return false;
+}
 
-	assert(p->worker_limit > p->initial_worker_limit);
+static bool
+pool_has_free_worker_slot(struct pool *p)
+{
+	return p->working_count < p->worker_limit;
+}
 
-	// Remove one waiting threads.
-	p->worker_limit--;
+static bool
+pool_try_acquire_worker_slot(struct pool *p)
+{
+	int32_t count = p->working_count;
+
+	while (count < p->worker_limit) {
+		int32_t old = xrt_atomic_s32_cmpxchg(&p->working_count, count, count + 1);
+		if (old == count) {
+			return true;
+		}
+		count = old;
+	}
 
-	// We have released one thread.
-	g->released_count++;
+	return false;
 }
 
+/*!
+ * Wake one sleeping worker if it could do any work, the callers have made
+ * their changes visible with a barrier before calling this.
+ */
 static void
-locked_group_wait(struct pool *p, struct group *g)
+pool_wake_worker_if_allowed(struct pool *p)
 {
-	// Update tracking.
-	g->waiting.count++;
+	xrt_atomic_full_barrier();
 
-	// The wait, also unlocks the mutex.
-	os_cond_wait(&g->waiting.cond, &p->mutex);
+	// No waiting thread.
+	if (p->sleeping_count == 0) {
+		return;
+	}
 
-	// Update tracking.
-	g->waiting.count--;
+	// The number of working threads is at the limit.
+	if (!pool_has_free_worker_slot(p)) {
+		return;
+	}
+
+	os_mutex_lock(&p->sleep.mutex);
+	p->sleep.epoch++;
+	os_cond_signal(&p->sleep.cond);
+	os_mutex_unlock(&p->sleep.mutex);
+}
+
+
+/*
+ *
+ * Thread group functions.
+ *
+ */
+
+static void
+group_task_done(struct group *g)
+{
+	// Other tasks are still outstanding, nothing waits on this decrement and the group isn't touched after it.
+	int32_t count = g->current_submitted_tasks_count;
+	while (count > 1) {
+		int32_t old = xrt_atomic_s32_cmpxchg(&g->current_submitted_tasks_count, count, count - 1);
+		if (old == count) {
+			return;
+		}
+		count = old;
+	}
+
+	/*
+	 * Possibly the last task, the waiter can only see the count reach zero
+	 * while we hold the mutex, so it can not destroy the group before we
+	 * have unlocked it, see destroy.
+	 */
+	os_mutex_lock(&g->waiting.mutex);
+	if (xrt_atomic_s32_dec_return(&g->current_submitted_tasks_count) == 0) {
+		os_cond_broadcast(&g->waiting.cond);
+	}
+	os_mutex_unlock(&g->waiting.mutex);
 }
 
 
@@ -307,32 +479,65 @@ locked_group_wait(struct pool *p, struct group *g)
  */
 
 static bool
-locked_thread_allowed_to_work(struct pool *p)
+thread_find_task(struct pool *p, struct thread *t, struct task *out_task)
 {
-	// No work for you!
-	if (p->tasks_in_array_count == 0) {
-		return false;
+	// Our own tasks first, most recently taken.
+	if (deque_pop(&t->deque, out_task)) {
+		return true;
 	}
 
-	// Reached the limit.
-	if (p->working_count >= p->worker_limit) {
-		return false;
+	// Newly submitted tasks, grab a few so other threads can steal them.
+	if (queue_pop(&p->queue, out_task)) {
+		struct task extra;
+		uint32_t moved = 0;
+		while (moved < GRAB_COUNT - 1 && queue_pop(&p->queue, &extra)) {
+			// Can't fail, the deque was empty and only we push to it.
+			bool pushed = deque_push(&t->deque, &extra);
+			assert(pushed);
+			(void)pushed;
+			moved++;
+		}
+
+		if (moved > 0) {
+			pool_wake_worker_if_allowed(p);
+		}
+
+		return true;
 	}
 
-	return true;
+	// Steal from the other threads.
+	for (size_t i = 1; i < p->thread_count; i++) {
+		struct thread *victim = &p->threads[(t->index + i) % p->thread_count];
+		if (deque_steal(&victim->deque, out_task)) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 static void
-locked_thread_wait_for_work(struct pool *p)
+thread_sleep(struct pool *p)
 {
-	// Update tracking.
-	p->available.count++;
+	os_mutex_lock(&p->sleep.mutex);
+	int32_t epoch = p->sleep.epoch;
+	os_mutex_unlock(&p->sleep.mutex);
 
-	// The wait, also unlocks the mutex.
-	os_cond_wait(&p->available.cond, &p->mutex);
+	// Also a full barrier, pairs with the one in pool_wake_worker_if_allowed.
+	xrt_atomic_s32_inc_return(&p->sleeping_count);
 
-	// Update tracking.
-	p->available.count--;
+	// Check again now that any waker will see us.
+	bool work = pool_has_free_worker_slot(p) && pool_maybe_has_tasks(p);
+
+	if (!work) {
+		os_mutex_lock(&p->sleep.mutex);
+		while (p->running && p->sleep.epoch == epoch) {
+			os_cond_wait(&p->sleep.cond, &p->sleep.mutex);
+		}
+		os_mutex_unlock(&p->sleep.mutex);
+	}
+
+	xrt_atomic_s32_dec_return(&p->sleeping_count);
 }
 
 static void *
@@ -344,47 +549,29 @@ run_func(void *ptr)
 	snprintf(t->name, sizeof(t->name), "%s: Worker", p->prefix);
 	U_TRACE_SET_THREAD_NAME(t->name);
 
-	os_mutex_lock(&p->mutex);
-
 	while (p->running) {
-
-		if (!locked_thread_allowed_to_work(p)) {
-			locked_thread_wait_for_work(p);
-
-			// Check running first when woken up.
+		if (!pool_try_acquire_worker_slot(p)) {
+			thread_sleep(p);
 			continue;
 		}
 
-		// Pop a task from the pool.
-		struct task task = {NULL, NULL, NULL};
-		locked_pool_pop_task(p, &task);
-
-		// We are now counting as working, needed for wake below.
-		p->working_count++;
-
-		// Signal another thread if conditions are met.
-		locked_pool_wake_worker_if_allowed(p);
-
-		// Do the actual work here.
-		os_mutex_unlock(&p->mutex);
-		task.func(task.data);
-		os_mutex_lock(&p->mutex);
+		// Keep the slot for as long as there is work.
+		struct task task;
+		while (p->running && thread_find_task(p, t, &task)) {
+			task.func(task.data);
+			group_task_done(task.g);
+		}
 
-		// No longer working.
-		p->working_count--;
+		xrt_atomic_s32_dec_return(&p->working_count);
 
-		// Only now decrement the task count on the owning group.
-		task.g->current_submitted_tasks_count--;
+		// A task might have been pushed after we looked, but before the slot was returned.
+		if (pool_maybe_has_tasks(p)) {
+			pool_wake_worker_if_allowed(p);
+		}
 
-		// Wake up any waiter.
-		locked_group_wake_waiter_if_allowed(p, task.g);
+		thread_sleep(p);
 	}
 
-	// Make sure all threads are woken up.
-	os_cond_signal(&p->available.cond);
-
-	os_mutex_unlock(&p->mutex);
-
 	return NULL;
 }
 
@@ -414,23 +601,29 @@ u_worker_thread_pool_create(uint32_t starting_worker_count, uint32_t thread_coun
 	struct pool *p = U_TYPED_CALLOC(struct pool);
 	p->base.reference.count = 1;
 	p->initial_worker_limit = starting_worker_count;
-	p->worker_limit = starting_worker_count;
+	p->worker_limit = (int32_t)starting_worker_count;
 	p->thread_count = thread_count;
 	p->running = true;
 	snprintf(p->prefix, sizeof(p->prefix), "%s", prefix);
 
-	ret = os_mutex_init(&p->mutex);
+	queue_init(&p->queue);
+
+	ret = os_mutex_init(&p->sleep.mutex);
 	if (ret != 0) {
 		goto err_alloc;
 	}
 
-	ret = os_cond_init(&p->available.cond);
+	ret = os_cond_init(&p->sleep.cond);
 	if (ret != 0) {
 		goto err_mutex;
 	}
 
+	// Everything above must be visible to the threads.
+	xrt_atomic_full_barrier();
+
 	for (size_t i = 0; i < thread_count; i++) {
 		p->threads[i].p = p;
+		p->threads[i].index = (uint32_t)i;
 		os_thread_init(&p->threads[i].thread);
 		os_thread_start(&p->threads[i].thread, run_func, &p->threads[i]);
 	}
@@ -439,7 +632,7 @@ u_worker_thread_pool_create(uint32_t starting_worker_count, uint32_t thread_coun
 
 
 err_mutex:
-	os_mutex_destroy(&p->mutex);
+	os_mutex_destroy(&p->sleep.mutex);
 
 err_alloc:
 	free(p);
@@ -454,11 +647,11 @@ u_worker_thread_pool_destroy(struct u_worker_thread_pool *uwtp)
 
 	struct pool *p = pool(uwtp);
 
-	os_mutex_lock(&p->mutex);
-
+	os_mutex_lock(&p->sleep.mutex);
 	p->running = false;
-	os_cond_signal(&p->available.cond);
-	os_mutex_unlock(&p->mutex);
+	p->sleep.epoch++;
+	os_cond_broadcast(&p->sleep.cond);
+	os_mutex_unlock(&p->sleep.mutex);
 
 	// Wait for all threads.
 	for (size_t i = 0; i < p->thread_count; i++) {
@@ -466,8 +659,8 @@ u_worker_thread_pool_destroy(struct u_worker_thread_pool *uwtp)
 		os_thread_destroy(&p->threads[i].thread);
 	}
 
-	os_mutex_destroy(&p->mutex);
-	os_cond_destroy(&p->available.cond);
+	os_mutex_destroy(&p->sleep.mutex);
+	os_cond_destroy(&p->sleep.cond);
 
 	free(p);
 }
@@ -488,6 +681,7 @@ u_worker_group_create(struct u_worker_thread_pool *uwtp)
 	g->base.reference.count = 1;
 	u_worker_thread_pool_reference(&g->uwtp, uwtp);
 
+	os_mutex_init(&g->waiting.mutex);
 	os_cond_init(&g->waiting.cond);
 
 	return (struct u_worker_group *)g;
@@ -500,25 +694,19 @@ u_worker_group_push(struct u_worker_group *uwg, u_worker_group_func_t f, void *d
 
 	struct group *g = group(uwg);
 	struct pool *p = pool(g->uwtp);
+	struct task task = {g, f, data};
 
-	os_mutex_lock(&p->mutex);
-	while (p->tasks_in_array_count >= MAX_TASK_COUNT) {
-		os_mutex_unlock(&p->mutex);
-
-		//! @todo Don't wait all, wait one.
-		u_worker_group_wait_all(uwg);
+	xrt_atomic_s32_inc_return(&g->current_submitted_tasks_count);
 
-		os_mutex_lock(&p->mutex);
+	if (!queue_push(&p->queue, &task)) {
+		// The pool is swamped, run the task on this thread instead of blocking.
+		f(data);
+		group_task_done(g);
+		return;
 	}
 
-	locked_pool_push_task(p, g, f, data);
-
 	// There are worker threads available, wake one up.
-	if (p->available.count > 0) {
-		os_cond_signal(&p->available.cond);
-	}
-
-	os_mutex_unlock(&p->mutex);
+	pool_wake_worker_if_allowed(p);
 }
 
 void
@@ -529,21 +717,24 @@ u_worker_group_wait_all(struct u_worker_group *uwg)
 	struct group *g = group(uwg);
 	struct pool *p = pool(g->uwtp);
 
-	os_mutex_lock(&p->mutex);
-
 	// Can we early out?
-	if (!locked_group_should_enter_wait_loop(p, g)) {
-		os_mutex_unlock(&p->mutex);
+	xrt_atomic_full_barrier();
+	if (g->current_submitted_tasks_count == 0) {
 		return;
 	}
 
+	// "Donate" this thread to the pool while waiting.
+	xrt_atomic_s32_inc_return(&p->worker_limit);
+	pool_wake_worker_if_allowed(p);
+
 	// Wait here until all work been started and completed.
-	while (locked_group_should_wait(p, g)) {
-		// Do the wait.
-		locked_group_wait(p, g);
+	os_mutex_lock(&g->waiting.mutex);
+	while (g->current_submitted_tasks_count > 0) {
+		os_cond_wait(&g->waiting.cond, &g->waiting.mutex);
 	}
+	os_mutex_unlock(&g->waiting.mutex);
 
-	os_mutex_unlock(&p->mutex);
+	xrt_atomic_s32_dec_return(&p->worker_limit);
 }
 
 void
@@ -556,9 +747,14 @@ u_worker_group_destroy(struct u_worker_group *uwg)
 
 	u_worker_group_wait_all(uwg);
 
+	// The worker that finished the last task might still be holding the mutex.
+	os_mutex_lock(&g->waiting.mutex);
+	os_mutex_unlock(&g->waiting.mutex);
+
 	u_worker_thread_pool_reference(&g->uwtp, NULL);
 
 	os_cond_destroy(&g->waiting.cond);
+	os_mutex_destroy(&g->waiting.mutex);
 
 	free(uwg);
 }
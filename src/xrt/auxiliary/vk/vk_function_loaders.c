@@ -230,6 +230,7 @@ vk_get_device_functions(struct vk_bundle *vk)
 
 	vk->vkCreatePipelineCache                       = GET_DEV_PROC(vk, vkCreatePipelineCache);
 	vk->vkDestroyPipelineCache                      = GET_DEV_PROC(vk, vkDestroyPipelineCache);
+	vk->vkGetPipelineCacheData                      = GET_DEV_PROC(vk, vkGetPipelineCacheData);
 
 	vk->vkResetDescriptorPool                       = GET_DEV_PROC(vk, vkResetDescriptorPool);
 	vk->vkCreateDescriptorPool                      = GET_DEV_PROC(vk, vkCreateDescriptorPool);
@@ -347,6 +347,7 @@ struct vk_bundle
 
 	PFN_vkCreatePipelineCache vkCreatePipelineCache;
 	PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
+	PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
 
 	PFN_vkResetDescriptorPool vkResetDescriptorPool;
 	PFN_vkCreateDescriptorPool vkCreateDescriptorPool;
@@ -1414,6 +1415,45 @@ vk_create_compute_pipeline(struct vk_bundle *vk,
                            VkPipeline *out_compute_pipeline);
 
 
+/*
+ *
+ * Pipeline cache persistence, in the vk_pipeline_cache.c file.
+ *
+ */
+
+/*!
+ * Checks that @p data starts with a @p VkPipelineCacheHeaderVersionOne that
+ * matches the vendor, device and pipeline cache UUID of @p pdp, and that it
+ * is not truncated.
+ */
+bool
+vk_pipeline_cache_data_is_compatible(const VkPhysicalDeviceProperties *pdp, const void *data, size_t size);
+
+/*!
+ * Creates a pipeline cache, seeded with data previously saved with
+ * @ref vk_save_pipeline_cache_to_disk under the same @p name. The file is
+ * keyed on the driver version and pipeline cache UUID of the device, so data
+ * from other devices or drivers is never used. If there is no usable data an
+ * empty pipeline cache is created, same as @ref vk_create_pipeline_cache.
+ *
+ * Set `XRT_PIPELINE_CACHE=false` to disable the on-disk cache.
+ *
+ * Does error logging.
+ */
+VkResult
+vk_create_pipeline_cache_from_disk(struct vk_bundle *vk, const char *name, VkPipelineCache *out_pipeline_cache);
+
+/*!
+ * Saves the contents of @p pipeline_cache to the per-user cache directory,
+ * the file is written to the side and then renamed over the old one so a
+ * reader never sees a partial file.
+ *
+ * Does error logging, failures are not fatal.
+ */
+void
+vk_save_pipeline_cache_to_disk(struct vk_bundle *vk, VkPipelineCache pipeline_cache, const char *name);
+
+
 /*
  *
  * Compositor buffer and swapchain image flags helpers, in the vk_compositor_flags.c file.
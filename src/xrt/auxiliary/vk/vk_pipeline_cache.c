@@ -0,0 +1,297 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Persisting Vulkan pipeline caches to disk.
+ * @ingroup aux_vk
+ */
+
+#include "xrt/xrt_config_os.h"
+
+#include "util/u_misc.h"
+#include "util/u_file.h"
+#include "util/u_debug.h"
+
+#include "vk/vk_helpers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef XRT_OS_LINUX
+#include <unistd.h>
+#include <linux/limits.h>
+#endif
+
+
+/*!
+ * Sub-directory of the cache directory where the files are stored.
+ */
+#define PIPELINE_CACHE_SUBDIR "pipeline_cache"
+
+/*!
+ * Refuse to load anything bigger than this, guards against garbage files.
+ */
+#define PIPELINE_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+DEBUG_GET_ONCE_BOOL_OPTION(pipeline_cache, "XRT_PIPELINE_CACHE", true)
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+#ifdef XRT_OS_LINUX
+
+/*!
+ * The file name contains everything that the header does not, the driver
+ * version, so a driver update starts with a fresh file.
+ */
+static bool
+get_file_path(struct vk_bundle *vk,
+              const VkPhysicalDeviceProperties *pdp,
+              const char *name,
+              char *out_path,
+              size_t out_path_size)
+{
+	char dir[PATH_MAX];
+	ssize_t ret = u_file_make_path_in_cache_dir(PIPELINE_CACHE_SUBDIR, dir, sizeof(dir));
+	if (ret <= 0) {
+		VK_DEBUG(vk, "Could not get or create the pipeline cache directory");
+		return false;
+	}
+
+	char uuid[VK_UUID_SIZE * 2 + 1];
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		snprintf(&uuid[i * 2], 3, "%02x", pdp->pipelineCacheUUID[i]);
+	}
+
+	ret = snprintf(out_path, out_path_size, "%s/%s_%04x_%04x_%08x_%s.bin", dir, name, pdp->vendorID, pdp->deviceID,
+	               pdp->driverVersion, uuid);
+
+	return ret > 0 && ret < (ssize_t)out_path_size;
+}
+
+static void *
+read_file(struct vk_bundle *vk, const char *path, size_t *out_size)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	void *data = NULL;
+	long size = 0;
+
+	if (fseek(file, 0L, SEEK_END) != 0) {
+		goto out;
+	}
+
+	size = ftell(file);
+	if (size <= 0 || size > PIPELINE_CACHE_MAX_SIZE) {
+		VK_WARN(vk, "Ignoring pipeline cache '%s' with size %li", path, size);
+		goto out;
+	}
+
+	if (fseek(file, 0L, SEEK_SET) != 0) {
+		goto out;
+	}
+
+	data = malloc((size_t)size);
+	if (fread(data, 1, (size_t)size, file) != (size_t)size) {
+		free(data);
+		data = NULL;
+		goto out;
+	}
+
+	*out_size = (size_t)size;
+
+out:
+	fclose(file);
+	return data;
+}
+
+static bool
+write_file_atomic(struct vk_bundle *vk, const char *path, const void *data, size_t size)
+{
+	char tmp_path[PATH_MAX + 32];
+	int ret = snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int)getpid());
+	if (ret <= 0 || ret >= (int)sizeof(tmp_path)) {
+		return false;
+	}
+
+	FILE *file = fopen(tmp_path, "wb");
+	if (file == NULL) {
+		VK_WARN(vk, "Could not open '%s' for writing", tmp_path);
+		return false;
+	}
+
+	bool ok = fwrite(data, 1, size, file) == size;
+	ok = fflush(file) == 0 && ok;
+	ok = fsync(fileno(file)) == 0 && ok;
+	ok = fclose(file) == 0 && ok;
+
+	if (ok && rename(tmp_path, path) == 0) {
+		return true;
+	}
+
+	VK_WARN(vk, "Failed to write pipeline cache '%s'", path);
+	remove(tmp_path);
+
+	return false;
+}
+
+#endif // XRT_OS_LINUX
+
+static VkResult
+create_pipeline_cache(struct vk_bundle *vk,
+                      const void *data,
+                      size_t size,
+                      VkPipelineCache *out_pipeline_cache)
+{
+	VkPipelineCacheCreateInfo pipeline_cache_info = {
+	    .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+	    .initialDataSize = size,
+	    .pInitialData = data,
+	};
+
+	return vk->vkCreatePipelineCache( //
+	    vk->device,                   // device
+	    &pipeline_cache_info,         // pCreateInfo
+	    NULL,                         // pAllocator
+	    out_pipeline_cache);          // pPipelineCache
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+vk_pipeline_cache_data_is_compatible(const VkPhysicalDeviceProperties *pdp, const void *data, size_t size)
+{
+	VkPipelineCacheHeaderVersionOne header;
+
+	if (data == NULL || size < sizeof(header)) {
+		return false;
+	}
+
+	// The header is always little endian, like all of our targets.
+	memcpy(&header, data, sizeof(header));
+
+	if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+		return false;
+	}
+	if (header.headerSize < sizeof(header) || header.headerSize > size) {
+		return false;
+	}
+	if (header.vendorID != pdp->vendorID || header.deviceID != pdp->deviceID) {
+		return false;
+	}
+	if (memcmp(header.pipelineCacheUUID, pdp->pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		return false;
+	}
+
+	return true;
+}
+
+VkResult
+vk_create_pipeline_cache_from_disk(struct vk_bundle *vk, const char *name, VkPipelineCache *out_pipeline_cache)
+{
+#ifdef XRT_OS_LINUX
+	if (!debug_get_bool_option_pipeline_cache()) {
+		return vk_create_pipeline_cache(vk, out_pipeline_cache);
+	}
+
+	VkPhysicalDeviceProperties pdp;
+	vk->vkGetPhysicalDeviceProperties(vk->physical_device, &pdp);
+
+	char path[PATH_MAX];
+	if (!get_file_path(vk, &pdp, name, path, sizeof(path))) {
+		return vk_create_pipeline_cache(vk, out_pipeline_cache);
+	}
+
+	size_t size = 0;
+	void *data = read_file(vk, path, &size);
+	if (data == NULL) {
+		VK_DEBUG(vk, "No pipeline cache at '%s'", path);
+		return vk_create_pipeline_cache(vk, out_pipeline_cache);
+	}
+
+	if (!vk_pipeline_cache_data_is_compatible(&pdp, data, size)) {
+		VK_INFO(vk, "Ignoring incompatible pipeline cache '%s'", path);
+		free(data);
+		return vk_create_pipeline_cache(vk, out_pipeline_cache);
+	}
+
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	VkResult ret = create_pipeline_cache(vk, data, size, &pipeline_cache);
+	free(data);
+
+	if (ret != VK_SUCCESS) {
+		// Drivers should ignore bad data, but be careful.
+		VK_WARN(vk, "vkCreatePipelineCache with data from '%s' failed: %s", path, vk_result_string(ret));
+		return vk_create_pipeline_cache(vk, out_pipeline_cache);
+	}
+
+	VK_DEBUG(vk, "Loaded %zu bytes of pipeline cache from '%s'", size, path);
+
+	*out_pipeline_cache = pipeline_cache;
+
+	return VK_SUCCESS;
+#else
+	(void)create_pipeline_cache;
+	return vk_create_pipeline_cache(vk, out_pipeline_cache);
+#endif
+}
+
+void
+vk_save_pipeline_cache_to_disk(struct vk_bundle *vk, VkPipelineCache pipeline_cache, const char *name)
+{
+#ifdef XRT_OS_LINUX
+	if (pipeline_cache == VK_NULL_HANDLE || !debug_get_bool_option_pipeline_cache()) {
+		return;
+	}
+
+	VkResult ret;
+	size_t size = 0;
+
+	ret = vk->vkGetPipelineCacheData(vk->device, pipeline_cache, &size, NULL);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkGetPipelineCacheData failed: %s", vk_result_string(ret));
+		return;
+	}
+	if (size == 0 || size > PIPELINE_CACHE_MAX_SIZE) {
+		return;
+	}
+
+	void *data = malloc(size);
+	ret = vk->vkGetPipelineCacheData(vk->device, pipeline_cache, &size, data);
+	if (ret != VK_SUCCESS) {
+		// VK_INCOMPLETE means the data got truncated, don't save that.
+		VK_ERROR(vk, "vkGetPipelineCacheData failed: %s", vk_result_string(ret));
+		free(data);
+		return;
+	}
+
+	VkPhysicalDeviceProperties pdp;
+	vk->vkGetPhysicalDeviceProperties(vk->physical_device, &pdp);
+
+	char path[PATH_MAX];
+	if (!vk_pipeline_cache_data_is_compatible(&pdp, data, size)) {
+		VK_WARN(vk, "Driver returned pipeline cache data with unexpected header, not saving");
+	} else if (get_file_path(vk, &pdp, name, path, sizeof(path)) && write_file_atomic(vk, path, data, size)) {
+		VK_DEBUG(vk, "Saved %zu bytes of pipeline cache to '%s'", size, path);
+	}
+
+	free(data);
+#else
+	(void)vk;
+	(void)pipeline_cache;
+	(void)name;
+#endif
+}
@@ -91,6 +91,7 @@
 #define WINDOW_TITLE "Monado"
 
 DEBUG_GET_ONCE_BOOL_OPTION(disable_deferred, "XRT_COMPOSITOR_DISABLE_DEFERRED", false)
+DEBUG_GET_ONCE_BOOL_OPTION(disable_layer_cache, "XRT_COMPOSITOR_DISABLE_LAYER_CACHE", false)
 
 
 /*
@@ -748,6 +749,7 @@ const struct comp_target_factory *ctfs[] = {
 #ifdef VK_USE_PLATFORM_DISPLAY_KHR
     &comp_target_factory_vk_display,
 #endif
+    &comp_target_factory_headless,
 };
 
 static void
@@ -1122,6 +1124,8 @@ comp_main_create_system_compositor(struct xrt_device *xdev,
 	}
 	sys_info->supported_blend_mode_count = (uint8_t)xdev->hmd->blend_mode_count;
 
+	c->debug.disable_layer_cache = debug_get_bool_option_disable_layer_cache();
+
 	u_var_add_root(c, "Compositor", true);
 
 	float target_frame_time_ms = (float)ns_to_ms(c->settings.nominal_frame_interval_ns);
@@ -1130,6 +1134,7 @@ comp_main_create_system_compositor(struct xrt_device *xdev,
 	u_var_add_ro_f32(c, &c->compositor_frame_times.fps, "FPS (Compositor)");
 	u_var_add_bool(c, &c->debug.atw_off, "Debug: ATW OFF");
 	u_var_add_bool(c, &c->debug.disable_fast_path, "Debug: Disable fast path");
+	u_var_add_bool(c, &c->debug.disable_layer_cache, "Debug: Disable layer cache");
 	u_var_add_f32_timing(c, c->compositor_frame_times.debug_var, "Frame Times (Compositor)");
 
 	// Only add active views.
@@ -154,6 +154,9 @@ struct comp_compositor
 		//! Should the fast path be disabled.
 		bool disable_fast_path;
 
+		//! Always squash the layers, even if nothing changed since last frame.
+		bool disable_layer_cache;
+
 		struct u_swapchain_debug sc;
 	} debug;
 
@@ -116,6 +116,12 @@ struct comp_renderer
 		} views[XRT_MAX_VIEWS];
 	} scratch;
 
+	//! What the compute layer squasher last did, per layer.
+	struct comp_render_cs_layer_cache cs_layer_cache;
+
+	//! Unchanged layers squashed together by the compute path, allocated on first use.
+	struct render_scratch_images cs_layer_group_images;
+
 	//! @}
 
 	//! @name Image-dependent members
@@ -200,6 +206,35 @@ scratch_get_fini(struct comp_render_scratch_state *crss, struct comp_renderer *r
 	}
 }
 
+/*!
+ * Switch each view to the scratch image it used last frame and patch @p d to
+ * match, returns false and leaves everything untouched if not possible.
+ */
+static bool
+scratch_reuse_last(struct comp_render_scratch_state *crss, struct comp_renderer *r, struct comp_render_dispatch_data *d)
+{
+	struct comp_compositor *c = r->c;
+
+	for (uint32_t i = 0; i < d->view_count; i++) {
+		/*
+		 * All views are done or discarded together, so either all have
+		 * a last image or none of them, fails on the first view then.
+		 */
+		if (!comp_scratch_single_images_reuse_last(&c->scratch.views[i], &crss->views[i].index)) {
+			assert(i == 0);
+			return false;
+		}
+
+		struct render_scratch_color_image *rsci = &c->scratch.views[i].images[crss->views[i].index];
+		d->views[i].image = rsci->image;
+		d->views[i].srgb_view = rsci->srgb_view;
+		d->views[i].cs.unorm_view = rsci->unorm_view;
+	}
+
+	return true;
+}
+
+
 /*
  *
  * Functions.
@@ -580,6 +615,9 @@ renderer_init(struct comp_renderer *r, struct comp_compositor *c, VkExtent2D scr
 			assert(false && "Whelp, can't return an error. But should never really fail.");
 		}
 
+		// Might be new images.
+		comp_render_cs_layer_cache_invalidate(&r->cs_layer_cache);
+
 		for (uint32_t k = 0; k < COMP_SCRATCH_NUM_IMAGES; k++) {
 			struct render_scratch_color_image *rsci = &c->scratch.views[i].images[k];
 
@@ -831,6 +869,9 @@ renderer_fini(struct comp_renderer *r)
 
 	// Do this after the layer renderer and targert resources.
 	render_gfx_render_pass_close(&r->scratch_render_pass);
+
+	// Only allocated by the compute path.
+	render_scratch_images_close(&r->c->nr, &r->cs_layer_group_images);
 }
 
 
@@ -1056,6 +1097,25 @@ dispatch_compute(struct comp_renderer *r,
 		}
 	}
 
+	// Can we skip squashing some or all of the layers?
+	if (c->debug.disable_layer_cache) {
+		comp_render_cs_layer_cache_invalidate(&r->cs_layer_cache);
+	} else if (layer_count > 0 && !fast_path) {
+		VkExtent2D extent = {c->scratch.views[0].info.width, c->scratch.views[0].info.height};
+
+		if (render_scratch_images_ensure(&c->nr, &r->cs_layer_group_images, extent)) {
+			data.cs.group_images = &r->cs_layer_group_images;
+			comp_render_cs_layer_cache_check(&r->cs_layer_cache, layers, layer_count, &data);
+		} else {
+			COMP_ERROR(c, "render_scratch_images_ensure: false");
+			comp_render_cs_layer_cache_invalidate(&r->cs_layer_cache);
+		}
+
+		if (data.cs.layers_cached) {
+			data.cs.layers_cached = scratch_reuse_last(crss, r, &data);
+		}
+	}
+
 	// Start the compute pipeline.
 	render_compute_begin(crc);
 
@@ -1071,6 +1131,10 @@ dispatch_compute(struct comp_renderer *r,
 
 	// Everything is ready, submit to the queue.
 	ret = renderer_submit_queue(r, crc->r->cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	if (ret != VK_SUCCESS) {
+		// Don't know what ended up in the scratch images.
+		comp_render_cs_layer_cache_invalidate(&r->cs_layer_cache);
+	}
 	VK_CHK_AND_RET(ret, "renderer_submit_queue");
 
 	return ret;
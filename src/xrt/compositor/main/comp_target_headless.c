@@ -0,0 +1,731 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Headless target that renders to internal images with simulated vblank.
+ * @ingroup comp_main
+ */
+
+#include "os/os_time.h"
+
+#include "util/u_misc.h"
+#include "util/u_time.h"
+#include "util/u_debug.h"
+#include "util/u_pacing.h"
+
+#include "vk/vk_cmd.h"
+#include "vk/vk_mini_helpers.h"
+
+#include "main/comp_window.h"
+
+#include <assert.h>
+#include <inttypes.h>
+
+
+/*
+ *
+ * Defines and options.
+ *
+ */
+
+/*!
+ * Number of images in the ring, the renderer only ever has one acquired.
+ */
+#define HEADLESS_IMAGE_COUNT (3)
+
+// clang-format off
+DEBUG_GET_ONCE_NUM_OPTION(headless_refresh_rate, "XRT_COMPOSITOR_HEADLESS_REFRESH_RATE", 0)
+DEBUG_GET_ONCE_NUM_OPTION(headless_width, "XRT_COMPOSITOR_HEADLESS_WIDTH", 0)
+DEBUG_GET_ONCE_NUM_OPTION(headless_height, "XRT_COMPOSITOR_HEADLESS_HEIGHT", 0)
+// clang-format on
+
+
+/*
+ *
+ * Structs.
+ *
+ */
+
+/*!
+ * A frame that has been presented but has not yet been flipped to the
+ * simulated display, it is reported to the pacer once it has.
+ */
+struct headless_frame
+{
+	int64_t frame_id;
+	int64_t wake_up_ns;
+	int64_t begin_ns;
+	int64_t desired_present_time_ns;
+	int64_t gpu_done_ns;
+	int64_t earliest_present_time_ns;
+	int64_t actual_present_time_ns;
+};
+
+/*!
+ * Numbers printed when the target is destroyed, used for benchmarking.
+ */
+struct headless_stats
+{
+	uint64_t frames;
+	uint64_t missed;
+
+	//! Wake up to simulated vblank.
+	int64_t latency_total_ns;
+	int64_t latency_max_ns;
+
+	//! Begin of CPU work to the GPU being done.
+	int64_t render_total_ns;
+	int64_t render_max_ns;
+
+	int64_t first_present_ns;
+	int64_t last_present_ns;
+};
+
+/*!
+ * A target that is not backed by any display, it renders into a ring of
+ * images and pretends that a display flips them at a fixed refresh rate.
+ * Allows running the full compositor pipeline without a display, like on
+ * lavapipe in CI, and gives repeatable numbers for benchmarking.
+ *
+ * @implements comp_target
+ */
+struct comp_target_headless
+{
+	struct comp_target base;
+
+	//! Compositor frame pacing helper.
+	struct u_pacing_compositor *upc;
+
+	//! Period of the simulated display.
+	int64_t frame_period_ns;
+
+	//! Simulated vblanks happens at this plus a multiple of the period.
+	int64_t vblank_origin_ns;
+
+	//! The frame id from the last pacing prediction.
+	int64_t current_frame_id;
+
+	//! Timing points of the frame being rendered.
+	int64_t wake_up_ns;
+	int64_t begin_ns;
+
+	//! Next image to hand out.
+	uint32_t next_index;
+
+	//! Used to know when the GPU is done with the rendering.
+	VkFence fence;
+
+	VkDeviceMemory memories[HEADLESS_IMAGE_COUNT];
+
+	//! Frame waiting on its vblank, valid if has_pending is set.
+	struct headless_frame pending;
+	bool has_pending;
+
+	//! When the last presented frame gets flipped.
+	int64_t last_flip_ns;
+
+	struct headless_stats stats;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static inline struct comp_target_headless *
+comp_target_headless(struct comp_target *ct)
+{
+	return (struct comp_target_headless *)ct;
+}
+
+static inline struct vk_bundle *
+get_vk(struct comp_target_headless *cth)
+{
+	return &cth->base.c->base.vk;
+}
+
+static int64_t
+vblank_at_or_after(struct comp_target_headless *cth, int64_t when_ns)
+{
+	int64_t since_ns = when_ns - cth->vblank_origin_ns;
+	if (since_ns <= 0) {
+		return cth->vblank_origin_ns;
+	}
+
+	int64_t count = (since_ns + cth->frame_period_ns - 1) / cth->frame_period_ns;
+
+	return cth->vblank_origin_ns + count * cth->frame_period_ns;
+}
+
+static bool
+format_supports_usage(struct vk_bundle *vk, VkFormat format, VkImageUsageFlags usage)
+{
+	VkFormatProperties prop;
+	vk->vkGetPhysicalDeviceFormatProperties(vk->physical_device, format, &prop);
+
+	VkFormatFeatureFlags features = prop.optimalTilingFeatures;
+
+	if ((usage & VK_IMAGE_USAGE_STORAGE_BIT) != 0 && (features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) == 0) {
+		return false;
+	}
+	if ((usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) != 0 &&
+	    (features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) == 0) {
+		return false;
+	}
+	if ((usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0 && (features & VK_FORMAT_FEATURE_TRANSFER_SRC_BIT) == 0) {
+		return false;
+	}
+
+	return true;
+}
+
+static void
+destroy_images(struct comp_target_headless *cth)
+{
+	struct vk_bundle *vk = get_vk(cth);
+
+	if (cth->base.images == NULL) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < cth->base.image_count; i++) {
+		D(ImageView, cth->base.images[i].view);
+		D(Image, cth->base.images[i].handle);
+		DF(Memory, cth->memories[i]);
+	}
+
+	free(cth->base.images);
+	cth->base.images = NULL;
+	cth->base.image_count = 0;
+}
+
+static void
+report_flipped(struct comp_target_headless *cth, int64_t now_ns)
+{
+	if (!cth->has_pending || now_ns < cth->pending.actual_present_time_ns) {
+		return;
+	}
+
+	struct headless_frame *f = &cth->pending;
+	struct headless_stats *s = &cth->stats;
+
+	u_pc_info(cth->upc,                                   //
+	          f->frame_id,                                // frame_id
+	          f->desired_present_time_ns,                 // desired_present_time_ns
+	          f->actual_present_time_ns,                  // actual_present_time_ns
+	          f->earliest_present_time_ns,                // earliest_present_time_ns
+	          f->actual_present_time_ns - f->gpu_done_ns, // present_margin_ns
+	          now_ns);                                    // when_ns
+
+	int64_t latency_ns = f->actual_present_time_ns - f->wake_up_ns;
+	int64_t render_ns = f->gpu_done_ns - f->begin_ns;
+
+	if (s->frames == 0) {
+		s->first_present_ns = f->actual_present_time_ns;
+	}
+	s->frames++;
+	s->last_present_ns = f->actual_present_time_ns;
+	s->latency_total_ns += latency_ns;
+	s->render_total_ns += render_ns;
+
+	if (latency_ns > s->latency_max_ns) {
+		s->latency_max_ns = latency_ns;
+	}
+	if (render_ns > s->render_max_ns) {
+		s->render_max_ns = render_ns;
+	}
+
+	cth->has_pending = false;
+}
+
+static void
+print_stats(struct comp_target_headless *cth)
+{
+	struct headless_stats *s = &cth->stats;
+
+	if (s->frames == 0) {
+		return;
+	}
+
+	double duration_s = time_ns_to_s(s->last_present_ns - s->first_present_ns);
+	double fps = s->frames > 1 && duration_s > 0.0 ? (double)(s->frames - 1) / duration_s : 0.0;
+
+	COMP_INFO(cth->base.c,
+	          "Headless target stats:"
+	          "\n\textent:  %ux%u @ %.2fHz"
+	          "\n\tframes:  %" PRIu64 " (%.2f fps)"
+	          "\n\tmissed:  %" PRIu64
+	          "\n\tlatency: avg %.2fms max %.2fms (wake up to vblank)"
+	          "\n\trender:  avg %.2fms max %.2fms (begin to GPU done)",
+	          cth->base.width, cth->base.height, 1000.0 / time_ns_to_ms_f(cth->frame_period_ns), //
+	          s->frames, fps,                                                                     //
+	          s->missed,                                                                          //
+	          time_ns_to_ms_f(s->latency_total_ns / (int64_t)s->frames),                          //
+	          time_ns_to_ms_f(s->latency_max_ns),                                                 //
+	          time_ns_to_ms_f(s->render_total_ns / (int64_t)s->frames),                           //
+	          time_ns_to_ms_f(s->render_max_ns));                                                 //
+}
+
+
+/*
+ *
+ * Member functions.
+ *
+ */
+
+static bool
+target_init_pre_vulkan(struct comp_target *ct)
+{
+	return true;
+}
+
+static bool
+target_init_post_vulkan(struct comp_target *ct, uint32_t preferred_width, uint32_t preferred_height)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+	struct vk_bundle *vk = get_vk(cth);
+	VkResult ret;
+
+	int64_t refresh_rate = debug_get_num_option_headless_refresh_rate();
+	if (refresh_rate > 0) {
+		int64_t new_frame_interval = U_TIME_1S_IN_NS / refresh_rate;
+
+		COMP_DEBUG(ct->c, "Updating compositor settings nominal frame interval from %" PRIu64 " to %" PRIi64,
+		           ct->c->settings.nominal_frame_interval_ns, new_frame_interval);
+
+		ct->c->settings.nominal_frame_interval_ns = new_frame_interval;
+	}
+
+	cth->frame_period_ns = (int64_t)ct->c->settings.nominal_frame_interval_ns;
+
+	// The simulated display shows the image at the vblank, no scanout delay.
+	struct u_pc_display_timing_config config = U_PC_DISPLAY_TIMING_CONFIG_DEFAULT;
+	config.present_to_display_offset_ns = 0;
+
+	xrt_result_t xret = u_pc_display_timing_create(cth->frame_period_ns, &config, &cth->upc);
+	if (xret != XRT_SUCCESS) {
+		COMP_ERROR(ct->c, "u_pc_display_timing_create: %d", xret);
+		return false;
+	}
+
+	/*
+	 * Nothing waits on the render complete semaphore, it's consumed by
+	 * a empty submit in present, so no present complete semaphore.
+	 */
+	VkSemaphoreCreateInfo semaphore_info = {
+	    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+	};
+
+	ret = vk->vkCreateSemaphore(vk->device, &semaphore_info, NULL, &ct->semaphores.render_complete);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(ct->c, "vkCreateSemaphore: %s", vk_result_string(ret));
+		return false;
+	}
+
+	VK_NAME_SEMAPHORE(vk, ct->semaphores.render_complete, "comp_target_headless semaphore render complete");
+
+	ct->semaphores.present_complete = VK_NULL_HANDLE;
+	ct->semaphores.render_complete_is_timeline = false;
+
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	ret = vk->vkCreateFence(vk->device, &fence_info, NULL, &cth->fence);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(ct->c, "vkCreateFence: %s", vk_result_string(ret));
+		return false;
+	}
+
+	VK_NAME_FENCE(vk, cth->fence, "comp_target_headless fence");
+
+	// Start the simulated display now.
+	cth->vblank_origin_ns = os_monotonic_get_ns();
+
+	return true;
+}
+
+static bool
+target_check_ready(struct comp_target *ct)
+{
+	return true;
+}
+
+static void
+target_create_images(struct comp_target *ct, const struct comp_target_create_images_info *create_info)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+	struct vk_bundle *vk = get_vk(cth);
+	VkResult ret;
+
+	// The renderer waits for the queue to be idle before recreating.
+	destroy_images(cth);
+
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	for (uint32_t i = 0; i < create_info->format_count; i++) {
+		if (format_supports_usage(vk, create_info->formats[i], create_info->image_usage)) {
+			format = create_info->formats[i];
+			break;
+		}
+	}
+
+	if (format == VK_FORMAT_UNDEFINED) {
+		COMP_ERROR(ct->c, "No format supports the requested image usage!");
+		return;
+	}
+
+	VkExtent2D extent = create_info->extent;
+	if (debug_get_num_option_headless_width() > 0) {
+		extent.width = (uint32_t)debug_get_num_option_headless_width();
+	}
+	if (debug_get_num_option_headless_height() > 0) {
+		extent.height = (uint32_t)debug_get_num_option_headless_height();
+	}
+
+	VkImageSubresourceRange subresource_range = {
+	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	    .baseMipLevel = 0,
+	    .levelCount = 1,
+	    .baseArrayLayer = 0,
+	    .layerCount = 1,
+	};
+
+	ct->images = U_TYPED_ARRAY_CALLOC(struct comp_target_image, HEADLESS_IMAGE_COUNT);
+	ct->image_count = HEADLESS_IMAGE_COUNT;
+
+	for (uint32_t i = 0; i < HEADLESS_IMAGE_COUNT; i++) {
+		ret = vk_create_image_simple( //
+		    vk,                       // vk_bundle
+		    extent,                   // extent
+		    format,                   // format
+		    create_info->image_usage, // usage
+		    &cth->memories[i],        // out_mem
+		    &ct->images[i].handle);   // out_image
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(ct->c, "vk_create_image_simple: %s", vk_result_string(ret));
+			destroy_images(cth);
+			return;
+		}
+
+		VK_NAME_IMAGE(vk, ct->images[i].handle, "comp_target_headless image");
+
+		ret = vk_create_view(         //
+		    vk,                       // vk_bundle
+		    ct->images[i].handle,     // image
+		    VK_IMAGE_VIEW_TYPE_2D,    // type
+		    format,                   // format
+		    subresource_range,        // subresource_range
+		    &ct->images[i].view);     // out_view
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(ct->c, "vk_create_view: %s", vk_result_string(ret));
+			destroy_images(cth);
+			return;
+		}
+
+		VK_NAME_IMAGE_VIEW(vk, ct->images[i].view, "comp_target_headless image view");
+	}
+
+	ct->width = extent.width;
+	ct->height = extent.height;
+	ct->format = format;
+	ct->surface_transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+	cth->next_index = 0;
+
+	COMP_INFO(ct->c, "Created %u headless images %ux%u %s", HEADLESS_IMAGE_COUNT, extent.width, extent.height,
+	          vk_format_string(format));
+}
+
+static bool
+target_has_images(struct comp_target *ct)
+{
+	return ct->images != NULL;
+}
+
+static VkResult
+target_acquire(struct comp_target *ct, uint32_t *out_index)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+
+	if (!target_has_images(ct)) {
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	/*
+	 * Act like a FIFO swapchain: the image that is on the display now is
+	 * released when the last presented image is flipped, wait for that.
+	 */
+	int64_t now_ns = os_monotonic_get_ns();
+	if (cth->last_flip_ns > now_ns) {
+		os_nanosleep(cth->last_flip_ns - now_ns);
+	}
+
+	*out_index = cth->next_index;
+	cth->next_index = (cth->next_index + 1) % ct->image_count;
+
+	return VK_SUCCESS;
+}
+
+static VkResult
+target_present(struct comp_target *ct,
+               VkQueue queue,
+               uint32_t index,
+               uint64_t timeline_semaphore_value,
+               int64_t desired_present_time_ns,
+               int64_t present_slop_ns)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+	struct vk_bundle *vk = get_vk(cth);
+	VkResult ret;
+
+	// Consume the render complete semaphore, the fence tells us when the GPU is done.
+	VkPipelineStageFlags stage_flags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	VkSubmitInfo submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .waitSemaphoreCount = 1,
+	    .pWaitSemaphores = &ct->semaphores.render_complete,
+	    .pWaitDstStageMask = &stage_flags,
+	};
+
+	ret = vk_cmd_submit_locked(vk, 1, &submit_info, cth->fence);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(ct->c, "vk_cmd_submit_locked: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	// The renderer waits for the queue to be idle after present anyway.
+	ret = vk->vkWaitForFences(vk->device, 1, &cth->fence, VK_TRUE, UINT64_MAX);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(ct->c, "vkWaitForFences: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	ret = vk->vkResetFences(vk->device, 1, &cth->fence);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(ct->c, "vkResetFences: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	int64_t gpu_done_ns = os_monotonic_get_ns();
+
+	// Acquire waited for the previous frame to be flipped, report it.
+	report_flipped(cth, gpu_done_ns);
+
+	/*
+	 * Like on a real display the image is shown at the first vblank after
+	 * both the desired time and the GPU being done, one image per vblank.
+	 */
+	int64_t earliest_ns = vblank_at_or_after(cth, gpu_done_ns);
+	int64_t desired_vblank_ns = vblank_at_or_after(cth, desired_present_time_ns - present_slop_ns);
+	int64_t actual_ns = earliest_ns > desired_vblank_ns ? earliest_ns : desired_vblank_ns;
+	if (cth->last_flip_ns > 0 && actual_ns < cth->last_flip_ns + cth->frame_period_ns) {
+		actual_ns = cth->last_flip_ns + cth->frame_period_ns;
+	}
+
+	if (actual_ns > desired_vblank_ns) {
+		cth->stats.missed++;
+	}
+
+	cth->pending = (struct headless_frame){
+	    .frame_id = cth->current_frame_id,
+	    .wake_up_ns = cth->wake_up_ns,
+	    .begin_ns = cth->begin_ns,
+	    .desired_present_time_ns = desired_present_time_ns,
+	    .gpu_done_ns = gpu_done_ns,
+	    .earliest_present_time_ns = earliest_ns,
+	    .actual_present_time_ns = actual_ns,
+	};
+	cth->has_pending = true;
+	cth->last_flip_ns = actual_ns;
+
+	return VK_SUCCESS;
+}
+
+static void
+target_flush(struct comp_target *ct)
+{
+	// No-op
+}
+
+static void
+target_calc_frame_pacing(struct comp_target *ct,
+                         int64_t *out_frame_id,
+                         int64_t *out_wake_up_time_ns,
+                         int64_t *out_desired_present_time_ns,
+                         int64_t *out_present_slop_ns,
+                         int64_t *out_predicted_display_time_ns)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+
+	int64_t frame_id = -1;
+	int64_t wake_up_time_ns = 0;
+	int64_t desired_present_time_ns = 0;
+	int64_t present_slop_ns = 0;
+	int64_t predicted_display_time_ns = 0;
+	int64_t predicted_display_period_ns = 0;
+	int64_t min_display_period_ns = 0;
+	int64_t now_ns = os_monotonic_get_ns();
+
+	u_pc_predict(cth->upc,                     //
+	             now_ns,                       //
+	             &frame_id,                    //
+	             &wake_up_time_ns,             //
+	             &desired_present_time_ns,     //
+	             &present_slop_ns,             //
+	             &predicted_display_time_ns,   //
+	             &predicted_display_period_ns, //
+	             &min_display_period_ns);      //
+
+	cth->current_frame_id = frame_id;
+
+	*out_frame_id = frame_id;
+	*out_wake_up_time_ns = wake_up_time_ns;
+	*out_desired_present_time_ns = desired_present_time_ns;
+	*out_predicted_display_time_ns = predicted_display_time_ns;
+	*out_present_slop_ns = present_slop_ns;
+}
+
+static void
+target_mark_timing_point(struct comp_target *ct, enum comp_target_timing_point point, int64_t frame_id, int64_t when_ns)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+	assert(frame_id == cth->current_frame_id);
+
+	switch (point) {
+	case COMP_TARGET_TIMING_POINT_WAKE_UP:
+		cth->wake_up_ns = when_ns;
+		u_pc_mark_point(cth->upc, U_TIMING_POINT_WAKE_UP, cth->current_frame_id, when_ns);
+		break;
+	case COMP_TARGET_TIMING_POINT_BEGIN:
+		cth->begin_ns = when_ns;
+		u_pc_mark_point(cth->upc, U_TIMING_POINT_BEGIN, cth->current_frame_id, when_ns);
+		break;
+	case COMP_TARGET_TIMING_POINT_SUBMIT_BEGIN:
+		u_pc_mark_point(cth->upc, U_TIMING_POINT_SUBMIT_BEGIN, cth->current_frame_id, when_ns);
+		break;
+	case COMP_TARGET_TIMING_POINT_SUBMIT_END:
+		u_pc_mark_point(cth->upc, U_TIMING_POINT_SUBMIT_END, cth->current_frame_id, when_ns);
+		break;
+	default: assert(false);
+	}
+}
+
+static VkResult
+target_update_timings(struct comp_target *ct)
+{
+	COMP_TRACE_MARKER();
+
+	struct comp_target_headless *cth = comp_target_headless(ct);
+
+	report_flipped(cth, os_monotonic_get_ns());
+
+	return VK_SUCCESS;
+}
+
+static void
+target_info_gpu(struct comp_target *ct, int64_t frame_id, int64_t gpu_start_ns, int64_t gpu_end_ns, int64_t when_ns)
+{
+	COMP_TRACE_MARKER();
+
+	struct comp_target_headless *cth = comp_target_headless(ct);
+
+	u_pc_info_gpu(cth->upc, frame_id, gpu_start_ns, gpu_end_ns, when_ns);
+}
+
+static void
+target_set_title(struct comp_target *ct, const char *title)
+{
+	// No-op
+}
+
+static void
+target_destroy(struct comp_target *ct)
+{
+	struct comp_target_headless *cth = comp_target_headless(ct);
+	struct vk_bundle *vk = get_vk(cth);
+
+	print_stats(cth);
+
+	destroy_images(cth);
+
+	D(Semaphore, ct->semaphores.render_complete);
+	D(Fence, cth->fence);
+
+	u_pc_destroy(&cth->upc);
+
+	free(cth);
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+struct comp_target *
+comp_target_headless_create(struct comp_compositor *c)
+{
+	struct comp_target_headless *cth = U_TYPED_CALLOC(struct comp_target_headless);
+
+	cth->base.name = "headless";
+	cth->base.c = c;
+	cth->base.init_pre_vulkan = target_init_pre_vulkan;
+	cth->base.init_post_vulkan = target_init_post_vulkan;
+	cth->base.check_ready = target_check_ready;
+	cth->base.create_images = target_create_images;
+	cth->base.has_images = target_has_images;
+	cth->base.acquire = target_acquire;
+	cth->base.present = target_present;
+	cth->base.flush = target_flush;
+	cth->base.calc_frame_pacing = target_calc_frame_pacing;
+	cth->base.mark_timing_point = target_mark_timing_point;
+	cth->base.update_timings = target_update_timings;
+	cth->base.info_gpu = target_info_gpu;
+	cth->base.set_title = target_set_title;
+	cth->base.destroy = target_destroy;
+	cth->current_frame_id = -1;
+
+	return &cth->base;
+}
+
+
+/*
+ *
+ * Factory
+ *
+ */
+
+static bool
+detect(const struct comp_target_factory *ctf, struct comp_compositor *c)
+{
+	return false;
+}
+
+static bool
+create_target(const struct comp_target_factory *ctf, struct comp_compositor *c, struct comp_target **out_ct)
+{
+	struct comp_target *ct = comp_target_headless_create(c);
+	if (ct == NULL) {
+		return false;
+	}
+
+	*out_ct = ct;
+
+	return true;
+}
+
+const struct comp_target_factory comp_target_factory_headless = {
+    .name = "Headless",
+    .identifier = "headless",
+    .requires_vulkan_for_create = true,
+    .is_deferred = false,
+    .required_instance_version = 0,
+    .required_instance_extensions = NULL,
+    .required_instance_extension_count = 0,
+    .optional_device_extensions = NULL,
+    .optional_device_extension_count = 0,
+    .detect = detect,
+    .create_target = create_target,
+};
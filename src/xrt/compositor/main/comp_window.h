@@ -130,6 +130,18 @@ comp_window_mswin_create(struct comp_compositor *c);
 extern const struct comp_target_factory comp_target_factory_mswin;
 #endif // XRT_OS_WINDOWS
 
+/*!
+ * Create a headless target that renders to internal images and simulates
+ * the vblank of a display, see @ref comp_target_headless.
+ *
+ * @ingroup comp_main
+ * @public @memberof comp_target_headless
+ */
+struct comp_target *
+comp_target_headless_create(struct comp_compositor *c);
+
+extern const struct comp_target_factory comp_target_factory_headless;
+
 #ifdef __cplusplus
 }
 #endif
@@ -69,10 +69,12 @@ extern "C" {
  * @ref render_compute. Since you run the layer squasher shader once per view
  * this is essentially the same as number of views. But if you you where to do
  * two or more different compositions it's not the maximum number of views per
- * composition (which is this number divided by number of composition).
+ * composition (which is this number divided by number of composition). Room
+ * is made for two, the compute renderer might first squash a group of layers
+ * that it keeps around between frames, see @ref comp_render_cs_layer_cache.
  */
-#define RENDER_MAX_LAYER_RUNS_SIZE (XRT_MAX_VIEWS)
-#define RENDER_MAX_LAYER_RUNS_COUNT (r->view_count)
+#define RENDER_MAX_LAYER_RUNS_SIZE (XRT_MAX_VIEWS * 2)
+#define RENDER_MAX_LAYER_RUNS_COUNT (r->view_count * 2)
 
 //! How large in pixels the distortion image is.
 #define RENDER_DISTORTION_IMAGE_DIMENSIONS (128)
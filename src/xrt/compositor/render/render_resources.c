@@ -22,6 +22,10 @@
 #include <stdio.h>
 
 
+//! Name of the on-disk pipeline cache file, see @ref vk_create_pipeline_cache_from_disk.
+#define RENDER_PIPELINE_CACHE_NAME "render_resources"
+
+
 /*
  *
  * Gfx shared
@@ -670,8 +674,8 @@ render_resources_init(struct render_resources *r,
 	 * Shared
 	 */
 
-	ret = vk_create_pipeline_cache(vk, &r->pipeline_cache);
-	VK_CHK_WITH_RET(ret, "vk_create_pipeline_cache", false);
+	ret = vk_create_pipeline_cache_from_disk(vk, RENDER_PIPELINE_CACHE_NAME, &r->pipeline_cache);
+	VK_CHK_WITH_RET(ret, "vk_create_pipeline_cache_from_disk", false);
 
 	VK_NAME_PIPELINE_CACHE(vk, r->pipeline_cache, "render_resources pipeline cache");
 
@@ -914,7 +918,7 @@ render_resources_init(struct render_resources *r,
 
 	size_t layer_ubo_size = sizeof(struct render_compute_layer_ubo_data);
 
-	for (uint32_t i = 0; i < r->view_count; i++) {
+	for (uint32_t i = 0; i < RENDER_MAX_LAYER_RUNS_COUNT; i++) {
 		ret = render_buffer_init(      //
 		    vk,                        // vk_bundle
 		    &r->compute.layer.ubos[i], // buffer
@@ -1077,6 +1081,9 @@ render_resources_init(struct render_resources *r,
 	 * Done
 	 */
 
+	// Most pipelines have been created by now, save so a crash doesn't lose them.
+	vk_save_pipeline_cache_to_disk(vk, r->pipeline_cache, RENDER_PIPELINE_CACHE_NAME);
+
 	U_LOG_I("New renderer initialized!");
 
 	return true;
@@ -1109,6 +1116,8 @@ render_resources_close(struct render_resources *r)
 
 	D(DescriptorSetLayout, r->mesh.descriptor_set_layout);
 	D(PipelineLayout, r->mesh.pipeline_layout);
+	// Also has the pipelines created by users of the resources.
+	vk_save_pipeline_cache_to_disk(vk, r->pipeline_cache, RENDER_PIPELINE_CACHE_NAME);
 	D(PipelineCache, r->pipeline_cache);
 	D(QueryPool, r->query_pool);
 	render_buffer_close(vk, &r->mesh.vbo);
@@ -1133,7 +1142,7 @@ render_resources_close(struct render_resources *r)
 
 	render_distortion_images_close(r);
 	render_buffer_close(vk, &r->compute.clear.ubo);
-	for (uint32_t i = 0; i < r->view_count; i++) {
+	for (uint32_t i = 0; i < RENDER_MAX_LAYER_RUNS_COUNT; i++) {
 		render_buffer_close(vk, &r->compute.layer.ubos[i]);
 	}
 	render_buffer_close(vk, &r->compute.distortion.ubo);
@@ -15,6 +15,8 @@
 
 #include "render/render_interface.h"
 
+#include "util/comp_layer_accum.h"
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -156,6 +158,28 @@ struct comp_render_dispatch_data
 
 		//! Target image view for distortion.
 		VkImageView target_unorm_view;
+
+		/*!
+		 * The scratch images already hold the squashed layers, only do
+		 * the distortion step, see @ref comp_render_cs_layer_cache.
+		 */
+		bool layers_cached;
+
+		/*!
+		 * Images holding the layers starting at @p group_first squashed
+		 * together, one per view and of the same size as the scratch
+		 * images, only used if @p group_count is not zero.
+		 */
+		const struct render_scratch_images *group_images;
+
+		//! First layer of the run of layers held in @p group_images.
+		uint32_t group_first;
+
+		//! Number of layers held in @p group_images, zero if none.
+		uint32_t group_count;
+
+		//! Squash the layers into @p group_images first, otherwise use them as is.
+		bool group_update;
 	} cs;
 };
 
@@ -513,6 +537,113 @@ comp_render_cs_dispatch(struct render_compute *crc,
                         const uint32_t layer_count,
                         const struct comp_render_dispatch_data *d);
 
+/*!
+ * A copy of a layer as it was squashed, along with the generation of every
+ * swapchain image it sampled and the poses it was squashed with.
+ *
+ * @ingroup comp_render_cs
+ */
+struct comp_render_cs_layer_cache_entry
+{
+	//! The layer, the timestamp is ignored when comparing.
+	struct comp_layer layer;
+
+	//! Generations of the sampled images, same order as @ref comp_layer::sc_array.
+	xrt_limited_unique_id_t generations[XRT_MAX_VIEWS * 2];
+
+	struct xrt_pose world_poses[XRT_MAX_VIEWS];
+
+	struct xrt_pose eye_poses[XRT_MAX_VIEWS];
+};
+
+/*!
+ * Remembers what the layer squasher last did, per layer, so work can be
+ * skipped for layers that haven't changed since then.
+ *
+ * A layer is unchanged if its data, swapchains and the generation of the
+ * swapchain images it samples are the same, and the poses it depends on are
+ * within @ref COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA and
+ * @ref COMP_RENDER_CS_LAYER_CACHE_MAX_ANGLE of the ones it was squashed with.
+ * View space layers depend on the eye poses, other quad, cylinder and
+ * equirect layers on the world poses, projection layers only on the world
+ * poses when doing timewarp.
+ *
+ * If no layer changed the scratch images from last frame are used as is and
+ * only the distortion step is done. Otherwise the longest run of at least
+ * @ref COMP_RENDER_CS_LAYER_CACHE_MIN_GROUP_COUNT unchanged layers, like
+ * several static HUD quads on top of a projection layer, is squashed into the
+ * group images once and then sampled in place of those layers until one of
+ * them changes. All blending done by the squasher is premultiplied
+ * "over" which is associative, so the result only differs from squashing all
+ * layers by the rounding of the group images.
+ *
+ * @ingroup comp_render_cs
+ */
+struct comp_render_cs_layer_cache
+{
+	//! Is anything below valid.
+	bool valid;
+
+	bool do_timewarp;
+
+	uint32_t view_count;
+
+	uint32_t layer_count;
+
+	//! First layer held in the group images.
+	uint32_t group_first;
+
+	//! Number of layers held in the group images, zero if they hold nothing.
+	uint32_t group_count;
+
+	struct comp_render_cs_layer_cache_entry entries[COMP_MAX_LAYERS];
+};
+
+//! Max distance in meters poses may move and still hit the cache.
+#define COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA (0.0001f)
+
+//! Max angle in radians poses may rotate and still hit the cache, about 0.01 degrees.
+#define COMP_RENDER_CS_LAYER_CACHE_MAX_ANGLE (0.0002f)
+
+//! Shortest run of unchanged layers worth squashing into the group images.
+#define COMP_RENDER_CS_LAYER_CACHE_MIN_GROUP_COUNT (2)
+
+/*!
+ * Must be called whenever the scratch or group images are written to outside
+ * of what @ref comp_render_cs_layer_cache_check asked for, or are reallocated.
+ *
+ * @public @memberof comp_render_cs_layer_cache
+ */
+static inline void
+comp_render_cs_layer_cache_invalidate(struct comp_render_cs_layer_cache *cache)
+{
+	cache->valid = false;
+}
+
+/*!
+ * Compares @p layers and the poses in @p d to what was squashed before, and
+ * fills in the `layers_cached` and `group_*` fields of @p d to say what can be
+ * reused, the cache is updated assuming the caller does just that.
+ *
+ * If `layers_cached` is set the caller must use the scratch images of last
+ * time, if it can't it must clear `layers_cached` and squash the layers.
+ *
+ * @note Swapchains in the @p layers must implement @ref comp_swapchain in
+ * addition to just @ref xrt_swapchain, as this function downcasts to @ref comp_swapchain !
+ *
+ * @param cache Cache object.
+ * @param[in] layers Layers to render, see note.
+ * @param[in] layer_count Number of elements in @p layers array.
+ * @param[in,out] d Common render dispatch data, only poses and flags are read.
+ *
+ * @public @memberof comp_render_cs_layer_cache
+ */
+void
+comp_render_cs_layer_cache_check(struct comp_render_cs_layer_cache *cache,
+                                 const struct comp_layer *layers,
+                                 uint32_t layer_count,
+                                 struct comp_render_dispatch_data *d);
+
 /* end of comp_render_cs group */
 /*! @} */
 
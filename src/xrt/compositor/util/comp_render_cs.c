@@ -16,6 +16,7 @@
 #include "os/os_time.h"
 
 #include "math/m_api.h"
+#include "math/m_vec3.h"
 #include "math/m_mathinclude.h"
 
 #include "util/u_misc.h"
@@ -328,6 +329,344 @@ do_cs_cylinder_layer(const struct xrt_layer_data *data,
 }
 
 
+/*!
+ * The group image holds layers that were already squashed for this view, with
+ * the same pre-transform and pose, so it's sampled one to one as if it was a
+ * premultiplied projection layer rendered with the current pose and fov.
+ */
+static inline void
+do_cs_group_layer(const struct render_scratch_images *group_images,
+                  const struct render_viewport_data *layer_view,
+                  const struct xrt_pose *world_pose,
+                  const struct xrt_fov *fov,
+                  uint32_t view_index,
+                  uint32_t cur_layer,
+                  uint32_t cur_image,
+                  VkSampler clamp_to_edge,
+                  VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
+                  VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
+                  struct render_compute_layer_ubo_data *ubo_data,
+                  bool do_timewarp,
+                  uint32_t *out_cur_image)
+{
+	const float w = (float)group_images->extent.width;
+	const float h = (float)group_images->extent.height;
+
+	// Read with gamma curve, the same as the distortion step does.
+	src_samplers[cur_image] = clamp_to_edge;
+	src_image_views[cur_image] = group_images->color[view_index].srgb_view;
+	ubo_data->images_samplers[cur_layer].images[0] = cur_image++;
+
+	// The view was squashed to the same place in the group image.
+	ubo_data->post_transforms[cur_layer] = (struct xrt_normalized_rect){
+	    .x = (float)layer_view->x / w,
+	    .y = (float)layer_view->y / h,
+	    .w = (float)layer_view->w / w,
+	    .h = (float)layer_view->h / h,
+	};
+
+	// unused if timewarp is off
+	if (do_timewarp) {
+		render_calc_time_warp_matrix(          //
+		    world_pose,                        //
+		    fov,                               //
+		    world_pose,                        //
+		    &ubo_data->transforms[cur_layer]); //
+	}
+
+	*out_cur_image = cur_image;
+}
+
+
+/*
+ *
+ * Layer cache helpers.
+ *
+ */
+
+static inline xrt_limited_unique_id_t
+get_image_generation(const struct comp_layer *layer, uint32_t sc_index, uint32_t image_index)
+{
+	/*
+	 * Like get_layer_image above this relies on all swapchains in the
+	 * layers being comp_swapchain, see comp_render_cs_layer_cache_check.
+	 */
+	const struct comp_swapchain *sc = (const struct comp_swapchain *)layer->sc_array[sc_index];
+	assert(sc != NULL);
+	assert(image_index < sc->base.base.image_count);
+
+	return sc->images[image_index].generation;
+}
+
+/*!
+ * Get the generations of the images that the layer samples, in the same order
+ * as @ref comp_layer::sc_array, zero for unused entries.
+ */
+static void
+get_layer_generations(const struct comp_layer *layer,
+                      uint32_t view_count,
+                      xrt_limited_unique_id_t out_generations[XRT_MAX_VIEWS * 2])
+{
+	const struct xrt_layer_data *data = &layer->data;
+	const struct xrt_sub_image *sub = NULL;
+
+	for (uint32_t i = 0; i < XRT_MAX_VIEWS * 2; i++) {
+		out_generations[i].data = 0;
+	}
+
+	switch (data->type) {
+	case XRT_LAYER_PROJECTION:
+		for (uint32_t i = 0; i < view_count; i++) {
+			out_generations[i] = get_image_generation(layer, i, data->proj.v[i].sub.image_index);
+		}
+		return;
+	case XRT_LAYER_PROJECTION_DEPTH:
+		for (uint32_t i = 0; i < view_count; i++) {
+			out_generations[i] = get_image_generation(layer, i, data->depth.v[i].sub.image_index);
+			out_generations[XRT_MAX_VIEWS + i] =
+			    get_image_generation(layer, XRT_MAX_VIEWS + i, data->depth.d[i].sub.image_index);
+		}
+		return;
+	case XRT_LAYER_QUAD: sub = &data->quad.sub; break;
+	case XRT_LAYER_CUBE: sub = &data->cube.sub; break;
+	case XRT_LAYER_CYLINDER: sub = &data->cylinder.sub; break;
+	case XRT_LAYER_EQUIRECT1: sub = &data->equirect1.sub; break;
+	case XRT_LAYER_EQUIRECT2: sub = &data->equirect2.sub; break;
+	default: return;
+	}
+
+	out_generations[0] = get_image_generation(layer, 0, sub->image_index);
+}
+
+static inline bool
+layer_uses_world_pose(const struct xrt_layer_data *data, bool do_timewarp)
+{
+	switch (data->type) {
+	case XRT_LAYER_PROJECTION:
+	case XRT_LAYER_PROJECTION_DEPTH: return do_timewarp; // Only timewarp looks at the pose.
+	default: return !is_layer_view_space(data);
+	}
+}
+
+static inline bool
+layer_uses_eye_pose(const struct xrt_layer_data *data)
+{
+	switch (data->type) {
+	case XRT_LAYER_PROJECTION:
+	case XRT_LAYER_PROJECTION_DEPTH: return false;
+	default: return is_layer_view_space(data);
+	}
+}
+
+static bool
+pose_is_close(const struct xrt_pose *a, const struct xrt_pose *b)
+{
+	struct xrt_vec3 delta = m_vec3_sub(a->position, b->position);
+	if (m_vec3_len_sqrd(delta) > COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA *
+	                                 COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA) {
+		return false;
+	}
+
+	// The vector part of the difference is sin(angle / 2) long.
+	struct xrt_quat a_inv, diff;
+	math_quat_invert(&a->orientation, &a_inv);
+	math_quat_rotate(&a_inv, &b->orientation, &diff);
+
+	struct xrt_vec3 axis = {diff.x, diff.y, diff.z};
+	float max_half = COMP_RENDER_CS_LAYER_CACHE_MAX_ANGLE * 0.5f;
+
+	return m_vec3_len_sqrd(axis) <= max_half * max_half;
+}
+
+static inline bool
+pose_equal(const struct xrt_pose *a, const struct xrt_pose *b)
+{
+	return m_vec3_equal_exact(a->position, b->position) && //
+	       a->orientation.x == b->orientation.x &&         //
+	       a->orientation.y == b->orientation.y &&         //
+	       a->orientation.z == b->orientation.z &&         //
+	       a->orientation.w == b->orientation.w;           //
+}
+
+static inline bool
+fov_equal(const struct xrt_fov *a, const struct xrt_fov *b)
+{
+	return a->angle_left == b->angle_left &&   //
+	       a->angle_right == b->angle_right && //
+	       a->angle_up == b->angle_up &&       //
+	       a->angle_down == b->angle_down;     //
+}
+
+static inline bool
+colour_equal(const struct xrt_colour_rgba_f32 *a, const struct xrt_colour_rgba_f32 *b)
+{
+	return a->r == b->r && a->g == b->g && a->b == b->b && a->a == b->a;
+}
+
+static inline bool
+sub_image_equal(const struct xrt_sub_image *a, const struct xrt_sub_image *b)
+{
+	return a->image_index == b->image_index &&     //
+	       a->array_index == b->array_index &&     //
+	       a->rect.offset.w == b->rect.offset.w && //
+	       a->rect.offset.h == b->rect.offset.h && //
+	       a->rect.extent.w == b->rect.extent.w && //
+	       a->rect.extent.h == b->rect.extent.h && //
+	       a->norm_rect.x == b->norm_rect.x &&     //
+	       a->norm_rect.y == b->norm_rect.y &&     //
+	       a->norm_rect.w == b->norm_rect.w &&     //
+	       a->norm_rect.h == b->norm_rect.h;       //
+}
+
+static inline bool
+projection_view_equal(const struct xrt_layer_projection_view_data *a, const struct xrt_layer_projection_view_data *b)
+{
+	return sub_image_equal(&a->sub, &b->sub) && fov_equal(&a->fov, &b->fov) && pose_equal(&a->pose, &b->pose);
+}
+
+static inline bool
+depth_equal(const struct xrt_layer_depth_data *a, const struct xrt_layer_depth_data *b)
+{
+	return sub_image_equal(&a->sub, &b->sub) && //
+	       a->min_depth == b->min_depth &&      //
+	       a->max_depth == b->max_depth &&      //
+	       a->near_z == b->near_z &&            //
+	       a->far_z == b->far_z;                //
+}
+
+/*!
+ * Compares all fields that go into the squash, one by one so that the padding
+ * and the unused part of the union doesn't matter, the timestamp changes every
+ * frame but doesn't change the result so it's skipped.
+ */
+static bool
+layer_data_equal(const struct xrt_layer_data *a, const struct xrt_layer_data *b, uint32_t view_count)
+{
+	if (a->type != b->type ||                                                       //
+	    a->name != b->name ||                                                       //
+	    a->flags != b->flags ||                                                     //
+	    a->flip_y != b->flip_y ||                                                   //
+	    a->view_count != b->view_count ||                                           //
+	    a->depth_test.depth_mask != b->depth_test.depth_mask ||                     //
+	    a->depth_test.compare_op != b->depth_test.compare_op ||                     //
+	    a->advanced_blend.src_factor_color != b->advanced_blend.src_factor_color || //
+	    a->advanced_blend.dst_factor_color != b->advanced_blend.dst_factor_color || //
+	    a->advanced_blend.src_factor_alpha != b->advanced_blend.src_factor_alpha || //
+	    a->advanced_blend.dst_factor_alpha != b->advanced_blend.dst_factor_alpha || //
+	    !colour_equal(&a->color_scale, &b->color_scale) ||                          //
+	    !colour_equal(&a->color_bias, &b->color_bias)) {
+		return false;
+	}
+
+	switch (a->type) {
+	case XRT_LAYER_PROJECTION:
+		for (uint32_t i = 0; i < view_count; i++) {
+			if (!projection_view_equal(&a->proj.v[i], &b->proj.v[i])) {
+				return false;
+			}
+		}
+		return true;
+	case XRT_LAYER_PROJECTION_DEPTH:
+		for (uint32_t i = 0; i < view_count; i++) {
+			if (!projection_view_equal(&a->depth.v[i], &b->depth.v[i]) ||
+			    !depth_equal(&a->depth.d[i], &b->depth.d[i])) {
+				return false;
+			}
+		}
+		return true;
+	case XRT_LAYER_QUAD:
+		return a->quad.visibility == b->quad.visibility &&    //
+		       sub_image_equal(&a->quad.sub, &b->quad.sub) && //
+		       pose_equal(&a->quad.pose, &b->quad.pose) &&    //
+		       a->quad.size.x == b->quad.size.x &&            //
+		       a->quad.size.y == b->quad.size.y;              //
+	case XRT_LAYER_CUBE:
+		return a->cube.visibility == b->cube.visibility &&    //
+		       sub_image_equal(&a->cube.sub, &b->cube.sub) && //
+		       pose_equal(&a->cube.pose, &b->cube.pose);      //
+	case XRT_LAYER_CYLINDER:
+		return a->cylinder.visibility == b->cylinder.visibility &&       //
+		       sub_image_equal(&a->cylinder.sub, &b->cylinder.sub) &&    //
+		       pose_equal(&a->cylinder.pose, &b->cylinder.pose) &&       //
+		       a->cylinder.radius == b->cylinder.radius &&               //
+		       a->cylinder.central_angle == b->cylinder.central_angle && //
+		       a->cylinder.aspect_ratio == b->cylinder.aspect_ratio;     //
+	case XRT_LAYER_EQUIRECT1:
+		return a->equirect1.visibility == b->equirect1.visibility &&    //
+		       sub_image_equal(&a->equirect1.sub, &b->equirect1.sub) && //
+		       pose_equal(&a->equirect1.pose, &b->equirect1.pose) &&    //
+		       a->equirect1.radius == b->equirect1.radius &&            //
+		       a->equirect1.scale.x == b->equirect1.scale.x &&          //
+		       a->equirect1.scale.y == b->equirect1.scale.y &&          //
+		       a->equirect1.bias.x == b->equirect1.bias.x &&            //
+		       a->equirect1.bias.y == b->equirect1.bias.y;              //
+	case XRT_LAYER_EQUIRECT2:
+		return a->equirect2.visibility == b->equirect2.visibility &&                             //
+		       sub_image_equal(&a->equirect2.sub, &b->equirect2.sub) &&                          //
+		       pose_equal(&a->equirect2.pose, &b->equirect2.pose) &&                             //
+		       a->equirect2.radius == b->equirect2.radius &&                                     //
+		       a->equirect2.central_horizontal_angle == b->equirect2.central_horizontal_angle && //
+		       a->equirect2.upper_vertical_angle == b->equirect2.upper_vertical_angle &&         //
+		       a->equirect2.lower_vertical_angle == b->equirect2.lower_vertical_angle;           //
+	default:
+		// Not squashed, nothing more to compare.
+		return true;
+	}
+}
+
+static bool
+layer_cache_entry_matches(const struct comp_render_cs_layer_cache_entry *entry,
+                          const struct comp_layer *layer,
+                          const xrt_limited_unique_id_t generations[XRT_MAX_VIEWS * 2],
+                          const struct comp_render_dispatch_data *d)
+{
+	for (uint32_t i = 0; i < XRT_MAX_VIEWS * 2; i++) {
+		if (entry->layer.sc_array[i] != layer->sc_array[i]) {
+			return false;
+		}
+		if (entry->generations[i].data != generations[i].data) {
+			return false;
+		}
+	}
+
+	if (!layer_data_equal(&entry->layer.data, &layer->data, d->view_count)) {
+		return false;
+	}
+
+	bool world = layer_uses_world_pose(&layer->data, d->do_timewarp);
+	bool eye = layer_uses_eye_pose(&layer->data);
+
+	for (uint32_t i = 0; i < d->view_count; i++) {
+		if (world && !pose_is_close(&entry->world_poses[i], &d->views[i].world_pose)) {
+			return false;
+		}
+		if (eye && !pose_is_close(&entry->eye_poses[i], &d->views[i].eye_pose)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void
+layer_cache_entry_update(struct comp_render_cs_layer_cache_entry *entry,
+                         const struct comp_layer *layer,
+                         const xrt_limited_unique_id_t generations[XRT_MAX_VIEWS * 2],
+                         const struct comp_render_dispatch_data *d)
+{
+	entry->layer = *layer;
+
+	for (uint32_t i = 0; i < XRT_MAX_VIEWS * 2; i++) {
+		entry->generations[i] = generations[i];
+	}
+
+	for (uint32_t i = 0; i < d->view_count; i++) {
+		entry->world_poses[i] = d->views[i].world_pose;
+		entry->eye_poses[i] = d->views[i].eye_pose;
+	}
+}
+
+
 /*
  *
  * Compute distortion helpers.
@@ -484,24 +823,25 @@ do_cs_distortion_for_layer(struct render_compute *crc,
 }
 
 
-/*
- *
- * 'Exported' compute helpers.
- *
+/*!
+ * Dispatch the layer squasher for one view, @p run_index selects which UBO and
+ * descriptor set to use. If @p d is given and has group images the layers they
+ * hold are skipped and the group image for this view is sampled in their place.
  */
-
-void
-comp_render_cs_layer(struct render_compute *crc,
-                     uint32_t view_index,
-                     const struct comp_layer *layers,
-                     const uint32_t layer_count,
-                     const struct xrt_normalized_rect *pre_transform,
-                     const struct xrt_pose *world_pose,
-                     const struct xrt_pose *eye_pose,
-                     const VkImage target_image,
-                     const VkImageView target_image_view,
-                     const struct render_viewport_data *target_view,
-                     bool do_timewarp)
+static void
+do_cs_layer_run(struct render_compute *crc,
+                uint32_t run_index,
+                uint32_t view_index,
+                const struct comp_layer *layers,
+                const uint32_t layer_count,
+                const struct xrt_normalized_rect *pre_transform,
+                const struct xrt_pose *world_pose,
+                const struct xrt_pose *eye_pose,
+                const struct xrt_fov *fov,
+                const VkImageView target_image_view,
+                const struct render_viewport_data *target_view,
+                bool do_timewarp,
+                const struct comp_render_dispatch_data *d)
 {
 	VkSampler clamp_to_edge = crc->r->samplers.clamp_to_edge;
 	VkSampler clamp_to_border_black = crc->r->samplers.clamp_to_border_black;
@@ -511,7 +851,9 @@ comp_render_cs_layer(struct render_compute *crc,
 	math_matrix_4x4_view_from_pose(world_pose, &world_view_mat);
 	math_matrix_4x4_view_from_pose(eye_pose, &eye_view_mat);
 
-	struct render_buffer *ubo = &crc->r->compute.layer.ubos[view_index];
+	assert(run_index < ARRAY_SIZE(crc->layer_descriptor_sets));
+
+	struct render_buffer *ubo = &crc->r->compute.layer.ubos[run_index];
 	struct render_compute_layer_ubo_data *ubo_data = ubo->mapped;
 
 	// Tightly pack layers in data struct.
@@ -526,6 +868,37 @@ comp_render_cs_layer(struct render_compute *crc,
 	ubo_data->pre_transform = *pre_transform;
 
 	for (uint32_t c_layer_i = 0; c_layer_i < layer_count; c_layer_i++) {
+		if (d != NULL && d->cs.group_count > 0 && c_layer_i == d->cs.group_first) {
+			//! Exit loop if shader cannot receive more image samplers
+			if (cur_image + 1 > crc->r->compute.layer.image_array_size) {
+				break;
+			}
+
+			do_cs_group_layer(      //
+			    d->cs.group_images, // group_images
+			    target_view,        // layer_view
+			    world_pose,         // world_pose
+			    fov,                // fov
+			    view_index,         // view_index
+			    cur_layer,          // cur_layer
+			    cur_image,          // cur_image
+			    clamp_to_edge,      // clamp_to_edge
+			    src_samplers,       // src_samplers
+			    src_image_views,    // src_image_views
+			    ubo_data,           // ubo_data
+			    do_timewarp,        // do_timewarp
+			    &cur_image);        // out_cur_image
+
+			// The group is premultiplied like all squasher output.
+			ubo_data->layer_type[cur_layer].val = XRT_LAYER_PROJECTION;
+			ubo_data->layer_type[cur_layer].unpremultiplied = false;
+			cur_layer++;
+
+			// Skip the layers in the group.
+			c_layer_i += d->cs.group_count - 1;
+			continue;
+		}
+
 		const struct comp_layer *layer = &layers[c_layer_i];
 		const struct xrt_layer_data *data = &layer->data;
 
@@ -651,7 +1024,7 @@ comp_render_cs_layer(struct render_compute *crc,
 		cur_image++;
 	}
 
-	VkDescriptorSet descriptor_set = crc->layer_descriptor_sets[view_index];
+	VkDescriptorSet descriptor_set = crc->layer_descriptor_sets[run_index];
 
 	render_compute_layers( //
 	    crc,               //
@@ -665,6 +1038,131 @@ comp_render_cs_layer(struct render_compute *crc,
 	    do_timewarp);      //
 }
 
+
+
+static void
+cmd_barrier_group_images(struct vk_bundle *vk,
+                         const struct comp_render_dispatch_data *d,
+                         VkCommandBuffer cmd,
+                         VkAccessFlags src_access_mask,
+                         VkAccessFlags dst_access_mask,
+                         VkImageLayout transition_from,
+                         VkImageLayout transition_to,
+                         VkPipelineStageFlags src_stage_mask,
+                         VkPipelineStageFlags dst_stage_mask)
+{
+	VkImageSubresourceRange first_color_level_subresource_range = {
+	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	    .baseMipLevel = 0,
+	    .levelCount = 1,
+	    .baseArrayLayer = 0,
+	    .layerCount = 1,
+	};
+
+	for (uint32_t i = 0; i < d->view_count; i++) {
+		vk_cmd_image_barrier_locked(              //
+		    vk,                                   // vk_bundle
+		    cmd,                                  // cmd_buffer
+		    d->cs.group_images->color[i].image,   // image
+		    src_access_mask,                      // src_access_mask
+		    dst_access_mask,                      // dst_access_mask
+		    transition_from,                      // old_image_layout
+		    transition_to,                        // new_image_layout
+		    src_stage_mask,                       // src_stage_mask
+		    dst_stage_mask,                       // dst_stage_mask
+		    first_color_level_subresource_range); // subresource_range
+	}
+}
+
+/*!
+ * Squash the layers of the group into the group images, using the second half
+ * of the layer runs so it doesn't clash with the main squash of the views.
+ */
+static void
+do_cs_group_update(struct render_compute *crc,
+                   const struct comp_layer *layers,
+                   const struct comp_render_dispatch_data *d)
+{
+	assert(d->cs.group_images != NULL);
+
+	cmd_barrier_group_images(                  //
+	    crc->r->vk,                            //
+	    d,                                     //
+	    crc->r->cmd,                           // cmd
+	    0,                                     // src_access_mask
+	    VK_ACCESS_SHADER_WRITE_BIT,            // dst_access_mask
+	    VK_IMAGE_LAYOUT_UNDEFINED,             // transition_from
+	    VK_IMAGE_LAYOUT_GENERAL,               // transition_to
+	    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,    // src_stage_mask
+	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT); // dst_stage_mask
+
+	for (uint32_t view_index = 0; view_index < d->view_count; view_index++) {
+		const struct comp_render_view_data *view = &d->views[view_index];
+
+		do_cs_layer_run(                                      //
+		    crc,                                              // crc
+		    d->view_count + view_index,                       // run_index
+		    view_index,                                       // view_index
+		    &layers[d->cs.group_first],                       // layers
+		    d->cs.group_count,                                // layer_count
+		    &view->target_pre_transform,                      // pre_transform
+		    &view->world_pose,                                // world_pose
+		    &view->eye_pose,                                  // eye_pose
+		    &view->fov,                                       // fov
+		    d->cs.group_images->color[view_index].unorm_view, // target_image_view
+		    &view->layer_viewport_data,                       // target_view
+		    d->do_timewarp,                                   // do_timewarp
+		    NULL);                                            // d
+	}
+
+	cmd_barrier_group_images(                     //
+	    crc->r->vk,                               //
+	    d,                                        //
+	    crc->r->cmd,                              // cmd
+	    VK_ACCESS_SHADER_WRITE_BIT,               // src_access_mask
+	    VK_ACCESS_SHADER_READ_BIT,                // dst_access_mask
+	    VK_IMAGE_LAYOUT_GENERAL,                  // transition_from
+	    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, // transition_to
+	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,     // src_stage_mask
+	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);    // dst_stage_mask
+}
+
+
+/*
+ *
+ * 'Exported' compute helpers.
+ *
+ */
+
+void
+comp_render_cs_layer(struct render_compute *crc,
+                     uint32_t view_index,
+                     const struct comp_layer *layers,
+                     const uint32_t layer_count,
+                     const struct xrt_normalized_rect *pre_transform,
+                     const struct xrt_pose *world_pose,
+                     const struct xrt_pose *eye_pose,
+                     const VkImage target_image,
+                     const VkImageView target_image_view,
+                     const struct render_viewport_data *target_view,
+                     bool do_timewarp)
+{
+	do_cs_layer_run(       //
+	    crc,               // crc
+	    view_index,        // run_index
+	    view_index,        // view_index
+	    layers,            // layers
+	    layer_count,       // layer_count
+	    pre_transform,     // pre_transform
+	    world_pose,        // world_pose
+	    eye_pose,          // eye_pose
+	    NULL,              // fov
+	    target_image_view, // target_image_view
+	    target_view,       // target_view
+	    do_timewarp,       // do_timewarp
+	    NULL);             // d
+}
+
 void
 comp_render_cs_layers(struct render_compute *crc,
                       const struct comp_layer *layers,
@@ -672,6 +1170,10 @@ comp_render_cs_layers(struct render_compute *crc,
                       const struct comp_render_dispatch_data *d,
                       VkImageLayout transition_to)
 {
+	if (d->cs.group_count > 0 && d->cs.group_update) {
+		do_cs_group_update(crc, layers, d);
+	}
+
 	cmd_barrier_view_images(                   //
 	    crc->r->vk,                            //
 	    d,                                     //
@@ -686,18 +1188,20 @@ comp_render_cs_layers(struct render_compute *crc,
 	for (uint32_t view_index = 0; view_index < d->view_count; view_index++) {
 		const struct comp_render_view_data *view = &d->views[view_index];
 
-		comp_render_cs_layer(            //
-		    crc,                         //
-		    view_index,                  //
-		    layers,                      //
-		    layer_count,                 //
-		    &view->target_pre_transform, //
-		    &view->world_pose,           //
-		    &view->eye_pose,             //
-		    view->image,                 //
-		    view->cs.unorm_view,         //
-		    &view->layer_viewport_data,  //
-		    d->do_timewarp);             //
+		do_cs_layer_run(                 //
+		    crc,                         // crc
+		    view_index,                  // run_index
+		    view_index,                  // view_index
+		    layers,                      // layers
+		    layer_count,                 // layer_count
+		    &view->target_pre_transform, // pre_transform
+		    &view->world_pose,           // world_pose
+		    &view->eye_pose,             // eye_pose
+		    &view->fov,                  // fov
+		    view->cs.unorm_view,         // target_image_view
+		    &view->layer_viewport_data,  // target_view
+		    d->do_timewarp,              // do_timewarp
+		    d);                          // d
 	}
 
 	cmd_barrier_view_images(                   //
@@ -712,6 +1216,100 @@ comp_render_cs_layers(struct render_compute *crc,
 	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT); // dst_stage_mask
 }
 
+void
+comp_render_cs_layer_cache_check(struct comp_render_cs_layer_cache *cache,
+                                 const struct comp_layer *layers,
+                                 uint32_t layer_count,
+                                 struct comp_render_dispatch_data *d)
+{
+	COMP_TRACE_MARKER();
+
+	d->cs.layers_cached = false;
+	d->cs.group_first = 0;
+	d->cs.group_count = 0;
+	d->cs.group_update = false;
+
+	if (layer_count > COMP_MAX_LAYERS) {
+		cache->valid = false;
+		return;
+	}
+
+	if (!cache->valid ||                        //
+	    cache->do_timewarp != d->do_timewarp || //
+	    cache->view_count != d->view_count) {
+		cache->valid = true;
+		cache->do_timewarp = d->do_timewarp;
+		cache->view_count = d->view_count;
+		cache->layer_count = 0;
+		cache->group_first = 0;
+		cache->group_count = 0;
+	}
+
+	// Which layers are the same as they were squashed last.
+	bool unchanged[COMP_MAX_LAYERS];
+	xrt_limited_unique_id_t generations[COMP_MAX_LAYERS][XRT_MAX_VIEWS * 2];
+	bool all_unchanged = cache->layer_count == layer_count;
+
+	for (uint32_t i = 0; i < layer_count; i++) {
+		get_layer_generations(&layers[i], d->view_count, generations[i]);
+
+		unchanged[i] = i < cache->layer_count && //
+		               layer_cache_entry_matches(&cache->entries[i], &layers[i], generations[i], d);
+
+		all_unchanged = all_unchanged && unchanged[i];
+	}
+
+	if (all_unchanged) {
+		// Keep the entries as is, so slow drift can't accumulate.
+		d->cs.layers_cached = true;
+		d->cs.group_first = cache->group_first;
+		d->cs.group_count = cache->group_count;
+		return;
+	}
+
+	// Can the group images be used as they are?
+	bool group_unchanged = cache->group_count > 0 && cache->group_first + cache->group_count <= layer_count;
+	for (uint32_t i = cache->group_first; group_unchanged && i < cache->group_first + cache->group_count; i++) {
+		group_unchanged = unchanged[i];
+	}
+
+	if (!group_unchanged) {
+		// Find the longest run of unchanged layers to squash into the group images.
+		uint32_t best_first = 0, best_count = 0, run_count = 0;
+		for (uint32_t i = 0; i < layer_count; i++) {
+			run_count = unchanged[i] ? run_count + 1 : 0;
+			if (run_count > best_count) {
+				best_count = run_count;
+				best_first = i + 1 - run_count;
+			}
+		}
+
+		if (best_count < COMP_RENDER_CS_LAYER_CACHE_MIN_GROUP_COUNT) {
+			best_first = 0;
+			best_count = 0;
+		}
+
+		cache->group_first = best_first;
+		cache->group_count = best_count;
+		d->cs.group_update = best_count > 0;
+	}
+
+	d->cs.group_first = cache->group_first;
+	d->cs.group_count = cache->group_count;
+
+	// Everything not in an already squashed group gets squashed now.
+	for (uint32_t i = 0; i < layer_count; i++) {
+		bool in_group = i >= cache->group_first && i < cache->group_first + cache->group_count;
+		if (in_group && group_unchanged) {
+			continue;
+		}
+
+		layer_cache_entry_update(&cache->entries[i], &layers[i], generations[i], d);
+	}
+
+	cache->layer_count = layer_count;
+}
+
 void
 comp_render_cs_dispatch(struct render_compute *crc,
                         const struct comp_layer *layers,
@@ -753,12 +1351,15 @@ comp_render_cs_dispatch(struct render_compute *crc,
 		    vds,                    // vds
 		    d);                     // d
 	} else if (layer_count > 0) {
-		comp_render_cs_layers( //
-		    crc,               //
-		    layers,            //
-		    layer_count,       //
-		    d,                 //
-		    transition_to);    //
+		// Scratch images are already in transition_to from last time.
+		if (!d->cs.layers_cached) {
+			comp_render_cs_layers( //
+			    crc,               //
+			    layers,            //
+			    layer_count,       //
+			    d,                 //
+			    transition_to);    //
+		}
 
 		do_cs_distortion_from_scratch( //
 		    crc,                       //
@@ -130,6 +130,18 @@ comp_scratch_single_images_free(struct comp_scratch_single_images *cssi, struct
 void
 comp_scratch_single_images_get(struct comp_scratch_single_images *cssi, uint32_t *out_index);
 
+/*!
+ * Switch from the image given by @p get to the image of the last @p done call,
+ * to use its content again without rendering to it. Must be called between
+ * @p get and @p done or @p discard, returns false if there is no such image.
+ *
+ * @public @memberof comp_scratch_single_images
+ *
+ * @ingroup comp_util
+ */
+bool
+comp_scratch_single_images_reuse_last(struct comp_scratch_single_images *cssi, uint32_t *out_index);
+
 /*!
  * After calling @p get and rendering to the image you call this function to
  * signal that you are done with this function, the GPU work needs to be fully
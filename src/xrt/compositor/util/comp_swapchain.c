@@ -205,6 +205,9 @@ swapchain_release_image(struct xrt_swapchain *xsc, uint32_t index)
 
 	VK_TRACE(sc->vk, "RELEASE_IMAGE");
 
+	// Bump before the push, the index can be acquired again right after.
+	sc->images[index].generation = u_limited_unique_id_get();
+
 	int res = u_index_fifo_push(&sc->fifo, index);
 
 	if (res >= 0) {
@@ -245,6 +248,11 @@ set_common_fields(struct comp_swapchain *sc,
 		sc->base.images[i].handle = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
 	}
 
+	// Not released yet, but must not match any image seen before.
+	for (uint32_t i = 0; i < ARRAY_SIZE(sc->images); i++) {
+		sc->images[i].generation = u_limited_unique_id_get();
+	}
+
 	return sc;
 }
 
@@ -73,6 +73,12 @@ struct comp_swapchain_image
 
 	//! A mutex per swapchain image that is used with @ref use_cond.
 	struct os_mutex use_mutex;
+
+	/*!
+	 * Changes every time the image is released, so the renderer can tell
+	 * if the content might have changed since it last used the image.
+	 */
+	xrt_limited_unique_id_t generation;
 };
 
 /*!
@@ -47,6 +47,9 @@ struct euroc_player_playback_config
 	bool use_source_ts;       //!< If true, use the original timestamps from the dataset
 	bool play_from_start;     //!< If set, the euroc player does not wait for user input to start
 	bool print_progress;      //!< Whether to print progress to stdout (useful for CLI runs)
+	int prefetch_threads;     //!< Threads decoding frames ahead of playback, 0 decodes on the streaming thread
+	int prefetch_budget_mb;   //!< Rough memory budget in MiB for frames decoded ahead of playback
+	bool preload_images;      //!< Decode all frames into memory before starting playback, ignores the budget
 };
 
 /*!
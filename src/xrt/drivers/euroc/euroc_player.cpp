@@ -25,11 +25,14 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <stdint.h>
 #include <stdio.h>
 #include <fstream>
 #include <future>
+#include <map>
+#include <mutex>
 #include <thread>
 
 //! @see euroc_player_playback_config
@@ -47,6 +50,9 @@ DEBUG_GET_ONCE_BOOL_OPTION(send_all_imus_first, "EUROC_SEND_ALL_IMUS_FIRST", fal
 DEBUG_GET_ONCE_BOOL_OPTION(use_source_ts, "EUROC_USE_SOURCE_TS", false)
 DEBUG_GET_ONCE_BOOL_OPTION(play_from_start, "EUROC_PLAY_FROM_START", false)
 DEBUG_GET_ONCE_BOOL_OPTION(print_progress, "EUROC_PRINT_PROGRESS", false)
+DEBUG_GET_ONCE_NUM_OPTION(prefetch_threads, "EUROC_PREFETCH_THREADS", 2)
+DEBUG_GET_ONCE_NUM_OPTION(prefetch_budget_mb, "EUROC_PREFETCH_BUDGET_MB", 512)
+DEBUG_GET_ONCE_BOOL_OPTION(preload_images, "EUROC_PRELOAD_IMAGES", false)
 
 #define EUROC_PLAYER_STR "Euroc Player"
 
@@ -66,11 +72,41 @@ using std::to_string;
 using std::vector;
 
 using img_sample = pair<timepoint_ns, string>;
+using decoded_imgs = vector<cv::Mat>; //!< Decoded images of all cameras for one `img_seq`
 
 using imu_samples = vector<xrt_imu_sample>;
 using img_samples = vector<img_sample>;
 using gt_trajectory = vector<xrt_pose_sample>;
 
+/*!
+ * Decodes frames ahead of playback on its own threads, so that decoding time
+ * does not affect playback timing. Decoded frames are kept keyed by `img_seq`
+ * until the player takes them, and decoding pauses while the frames waiting
+ * use more than the memory budget.
+ */
+struct euroc_prefetcher
+{
+	std::mutex mutex;
+	std::condition_variable decoded_cv; //!< Signaled when a frame has been decoded
+	std::condition_variable space_cv;   //!< Signaled when the player wants a frame or memory is freed
+	std::map<uint64_t, decoded_imgs> imgs;
+
+	uint64_t next_seq = 0; //!< Next `img_seq` to decode
+	uint64_t end_seq = 0;  //!< One past the last `img_seq` to decode
+	uint64_t want_seq = 0; //!< `img_seq` the player needs next, always decoded regardless of budget
+	uint64_t decoded = 0;  //!< Total frames decoded
+	size_t bytes = 0;      //!< Memory used by the frames in `imgs`
+	size_t budget = 0;     //!< Decoding waits while `bytes` is above this
+	bool stop = false;
+
+	// Snapshot of the playback options, taken when starting
+	int cam_count = 0;
+	bool allow_color = false;
+	float scale = 1.0f;
+
+	vector<std::thread> threads;
+};
+
 enum euroc_player_ui_state
 {
 	UNINITIALIZED = 0,
@@ -114,6 +150,9 @@ struct euroc_player
 	vector<img_samples> *imgs; //!< List of all image names to read from the dataset per camera
 	gt_trajectory *gt;         //!< List of all groundtruth poses read from the dataset
 
+	//! Decodes frames ahead of playback, null if decoding on the streaming thread.
+	euroc_prefetcher *prefetch;
+
 	// Timestamp correction fields (can be disabled through `use_source_ts`)
 	timepoint_ns base_ts;   //!< First sample timestamp, stream timestamps are relative to this
 	timepoint_ns start_ts;  //!< When did the dataset started to be played
@@ -421,21 +460,10 @@ euroc_player_mapped_playback_ts(struct euroc_player *ep, timepoint_ns ts)
 	return euroc_player_mapped_ts(ep, ts);
 }
 
-static void
-euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, struct xrt_frame *&xf)
+//! Load image from disk, this is the slow part of playing back a frame
+static cv::Mat
+euroc_player_decode_img(const string &img_name, bool allow_color, float scale)
 {
-	using xrt::auxiliary::tracking::FrameMat;
-	img_sample sample = ep->imgs->at(cam_index).at(ep->img_seq);
-	ep->playback.scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
-
-	// Load will be influenced by these playback options
-	bool allow_color = ep->playback.color;
-	float scale = ep->playback.scale;
-
-	// Load image from disk
-	timepoint_ns timestamp = euroc_player_mapped_playback_ts(ep, sample.first);
-	string img_name = sample.second;
-	EUROC_TRACE(ep, "cam%d img t = %ld filename = %s", cam_index, timestamp, img_name.c_str());
 	cv::ImreadModes read_mode = allow_color ? cv::IMREAD_ANYCOLOR : cv::IMREAD_GRAYSCALE;
 	cv::Mat img = cv::imread(img_name, read_mode); // If colored, reads in BGR order
 
@@ -445,6 +473,45 @@ euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, struct xrt_
 		img = tmp;
 	}
 
+	return img;
+}
+
+static size_t
+euroc_player_decoded_size(const decoded_imgs &imgs)
+{
+	size_t size = 0;
+	for (const cv::Mat &img : imgs) {
+		size += img.total() * img.elemSize();
+	}
+	return size;
+}
+
+//! Decode the frames of all cameras for the current `img_seq` on this thread
+static decoded_imgs
+euroc_player_decode_next_imgs(struct euroc_player *ep)
+{
+	ep->playback.scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
+
+	// Load will be influenced by these playback options
+	bool allow_color = ep->playback.color;
+	float scale = ep->playback.scale;
+
+	decoded_imgs imgs(ep->playback.cam_count);
+	for (int i = 0; i < ep->playback.cam_count; i++) {
+		imgs[i] = euroc_player_decode_img(ep->imgs->at(i).at(ep->img_seq).second, allow_color, scale);
+	}
+	return imgs;
+}
+
+static void
+euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, cv::Mat &img, struct xrt_frame *&xf)
+{
+	using xrt::auxiliary::tracking::FrameMat;
+	img_sample sample = ep->imgs->at(cam_index).at(ep->img_seq);
+
+	timepoint_ns timestamp = euroc_player_mapped_playback_ts(ep, sample.first);
+	EUROC_TRACE(ep, "cam%d img t = %ld filename = %s", cam_index, timestamp, sample.second.c_str());
+
 	// Create xrt_frame, it will be freed by FrameMat destructor
 	EUROC_ASSERT(xf == NULL || xf->reference.count > 0, "Must be given a valid or NULL frame ptr");
 	EUROC_ASSERT(timestamp >= 0, "Unexpected negative timestamp");
@@ -461,14 +528,147 @@ euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, struct xrt_
 	xf->source_id = ep->base.source_id;
 }
 
+
+// Decode ahead functionality
+
+static void
+euroc_prefetcher_run(struct euroc_player *ep, euroc_prefetcher *pf)
+{
+	std::unique_lock<std::mutex> lock(pf->mutex);
+
+	while (true) {
+		pf->space_cv.wait(lock, [pf] {
+			return pf->stop || pf->next_seq >= pf->end_seq || pf->next_seq <= pf->want_seq ||
+			       pf->bytes < pf->budget;
+		});
+
+		if (pf->stop || pf->next_seq >= pf->end_seq) {
+			break;
+		}
+
+		uint64_t seq = pf->next_seq++;
+		lock.unlock();
+
+		decoded_imgs imgs(pf->cam_count);
+		for (int i = 0; i < pf->cam_count; i++) {
+			imgs[i] = euroc_player_decode_img(ep->imgs->at(i).at(seq).second, pf->allow_color, pf->scale);
+		}
+		size_t size = euroc_player_decoded_size(imgs);
+
+		lock.lock();
+		pf->imgs.emplace(seq, std::move(imgs));
+		pf->bytes += size;
+		pf->decoded++;
+		pf->decoded_cv.notify_all();
+	}
+}
+
+//! Start decoding from the current `img_seq`, must be called after the dataset has been loaded
+static void
+euroc_prefetcher_start(struct euroc_player *ep)
+{
+	int thread_count = ep->playback.prefetch_threads;
+	if (ep->playback.preload_images) {
+		thread_count = MAX(thread_count, 1);
+	}
+	if (thread_count <= 0) {
+		return;
+	}
+
+	ep->playback.scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
+
+	euroc_prefetcher *pf = new euroc_prefetcher{};
+	pf->next_seq = ep->img_seq;
+	pf->want_seq = ep->img_seq;
+	pf->end_seq = ep->imgs->at(0).size();
+	pf->budget = ep->playback.preload_images ? SIZE_MAX : (size_t)MAX(ep->playback.prefetch_budget_mb, 1) << 20;
+	pf->cam_count = ep->playback.cam_count;
+	pf->allow_color = ep->playback.color;
+	pf->scale = ep->playback.scale;
+
+	for (int i = 0; i < thread_count; i++) {
+		pf->threads.emplace_back(euroc_prefetcher_run, ep, pf);
+	}
+
+	ep->prefetch = pf;
+}
+
+//! Wait until all frames have been decoded, for preloading
+static void
+euroc_prefetcher_wait_all(struct euroc_player *ep)
+{
+	euroc_prefetcher *pf = ep->prefetch;
+	uint64_t total = pf->end_seq - ep->img_seq;
+
+	std::unique_lock<std::mutex> lock(pf->mutex);
+	while (pf->decoded < total) {
+		(void)snprintf(ep->progress_text, sizeof(ep->progress_text), "Preloading frame %" PRIu64 "/%" PRIu64,
+		               pf->decoded, total);
+		pf->decoded_cv.wait_for(lock, std::chrono::milliseconds(100));
+	}
+
+	EUROC_INFO(ep, "Preloaded %" PRIu64 " frames using %zu MiB", pf->decoded, pf->bytes >> 20);
+}
+
+//! Take the decoded frames for `seq` out of the prefetcher, waits for them to be decoded if needed
+static decoded_imgs
+euroc_prefetcher_take(euroc_prefetcher *pf, uint64_t seq)
+{
+	std::unique_lock<std::mutex> lock(pf->mutex);
+
+	pf->want_seq = seq;
+	pf->space_cv.notify_all();
+	pf->decoded_cv.wait(lock, [pf, seq] { return pf->imgs.count(seq) != 0; });
+
+	auto it = pf->imgs.find(seq);
+	decoded_imgs imgs = std::move(it->second);
+	pf->imgs.erase(it);
+	pf->bytes -= euroc_player_decoded_size(imgs);
+
+	// Make the next frame wanted so it's decoded even if over budget.
+	pf->want_seq = seq + 1;
+	pf->space_cv.notify_all();
+
+	return imgs;
+}
+
+static void
+euroc_prefetcher_stop(struct euroc_player *ep)
+{
+	euroc_prefetcher *pf = ep->prefetch;
+	if (pf == nullptr) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(pf->mutex);
+		pf->stop = true;
+		pf->space_cv.notify_all();
+	}
+
+	for (std::thread &t : pf->threads) {
+		t.join();
+	}
+
+	delete pf;
+	ep->prefetch = nullptr;
+}
+
 static void
 euroc_player_push_next_frame(struct euroc_player *ep)
 {
 	int cam_count = ep->playback.cam_count;
 
+	decoded_imgs imgs;
+	if (ep->prefetch != nullptr) {
+		imgs = euroc_prefetcher_take(ep->prefetch, ep->img_seq);
+	} else {
+		imgs = euroc_player_decode_next_imgs(ep);
+	}
+
 	vector<xrt_frame *> xfs(cam_count, nullptr);
 	for (int i = 0; i < cam_count; i++) {
-		euroc_player_load_next_frame(ep, i, xfs[i]);
+		euroc_player_load_next_frame(ep, i, imgs[i], xfs[i]);
 	}
 
 	// TODO: Some SLAM systems expect synced frames, but that's not an
@@ -606,9 +806,16 @@ euroc_player_stream(void *ptr)
 
 	euroc_player_preload(ep);
 	ep->base_ts = MIN(ep->imgs->at(0).at(0).first, ep->imus->at(0).timestamp_ns);
-	ep->start_ts = os_monotonic_get_ts();
 	euroc_player_user_skip(ep);
 
+	euroc_prefetcher_start(ep);
+	if (ep->prefetch != nullptr && ep->playback.preload_images) {
+		euroc_prefetcher_wait_all(ep);
+	}
+
+	// Start the clock after any preloading so it doesn't eat into playback.
+	ep->start_ts = os_monotonic_get_ts();
+
 	// Push all IMU samples now if requested
 	if (ep->playback.send_all_imus_first) {
 		while (ep->imu_seq < ep->imus->size()) {
@@ -631,6 +838,8 @@ euroc_player_stream(void *ptr)
 	serve_imgs.get();
 	serve_imus.get();
 
+	euroc_prefetcher_stop(ep);
+
 	ep->is_running = false;
 
 	EUROC_INFO(ep, "Euroc dataset playback finished");
@@ -909,6 +1118,9 @@ euroc_player_setup_gui(struct euroc_player *ep)
 	u_var_add_f64(ep, &ep->playback.speed, "Speed");
 	u_var_add_bool(ep, &ep->playback.send_all_imus_first, "Send all IMU samples first");
 	u_var_add_bool(ep, &ep->playback.use_source_ts, "Use original timestamps");
+	u_var_add_i32(ep, &ep->playback.prefetch_threads, "Decode ahead threads");
+	u_var_add_i32(ep, &ep->playback.prefetch_budget_mb, "Decode ahead budget (MiB)");
+	u_var_add_bool(ep, &ep->playback.preload_images, "Preload all frames");
 
 	u_var_add_gui_header(ep, NULL, "Streams");
 	u_var_add_ro_ff_vec3_f32(ep, ep->gyro_ff, "Gyroscope");
@@ -945,6 +1157,9 @@ euroc_player_fill_default_config_for(struct euroc_player_config *config, const c
 	playback.use_source_ts = debug_get_bool_option_use_source_ts();
 	playback.play_from_start = debug_get_bool_option_play_from_start();
 	playback.print_progress = debug_get_bool_option_print_progress();
+	playback.prefetch_threads = (int)debug_get_num_option_prefetch_threads();
+	playback.prefetch_budget_mb = (int)debug_get_num_option_prefetch_budget_mb();
+	playback.preload_images = debug_get_bool_option_preload_images();
 
 	config->log_level = debug_get_log_option_euroc_log();
 	config->dataset = dataset;
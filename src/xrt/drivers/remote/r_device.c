@@ -112,27 +112,7 @@ r_device_get_tracked_pose(struct xrt_device *xdev,
 		return;
 	}
 
-	struct r_remote_controller_data *latest = rd->is_left ? &r->latest.left : &r->latest.right;
-
-	/*
-	 * It's easier to reason about angular velocity if it's controlled in
-	 * body space, but the angular velocity returned in the relation is in
-	 * the base space.
-	 */
-	math_quat_rotate_derivative(&latest->pose.orientation, &latest->angular_velocity,
-	                            &out_relation->angular_velocity);
-
-	out_relation->pose = latest->pose;
-	out_relation->linear_velocity = latest->linear_velocity;
-
-	if (latest->active) {
-		out_relation->relation_flags = (enum xrt_space_relation_flags)(
-		    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_POSITION_VALID_BIT |
-		    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT |
-		    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT | XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT);
-	} else {
-		out_relation->relation_flags = 0;
-	}
+	r_hub_get_controller_relation(r, rd->is_left, at_timestamp_ns, out_relation);
 }
 
 static void
@@ -171,7 +151,7 @@ r_device_get_hand_tracking(struct xrt_device *xdev,
 
 	out_value->is_active = latest->hand_tracking_active;
 
-	// This is a lie
+	// The pose was interpolated or predicted to this time, the curls are the latest.
 	*out_timestamp_ns = requested_timestamp_ns;
 }
 
@@ -9,12 +9,17 @@
 
 #include "r_internal.h"
 
+#include "os/os_time.h"
+
 #include "util/u_var.h"
 #include "util/u_misc.h"
 #include "util/u_debug.h"
 #include "util/u_space_overseer.h"
 
+#include "math/m_api.h"
+
 #include <stdio.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -58,6 +63,12 @@
 
 DEBUG_GET_ONCE_LOG_OPTION(remote_log, "REMOTE_LOG", U_LOGGING_INFO)
 
+/*!
+ * Number of packets the clock skew is estimated over, a few seconds worth
+ * at the rate the remote UI sends.
+ */
+#define R_SKEW_WINDOW_SAMPLES 256
+
 #define R_TRACE(R, ...) U_LOG_IFL_T((R)->rc.log_level, __VA_ARGS__)
 #define R_DEBUG(R, ...) U_LOG_IFL_D((R)->rc.log_level, __VA_ARGS__)
 #define R_INFO(R, ...) U_LOG_IFL_I((R)->rc.log_level, __VA_ARGS__)
@@ -305,6 +316,98 @@ read_one(struct r_hub *r, struct r_remote_data *data)
 	return 0;
 }
 
+static void
+head_data_to_relation(const struct r_head_data *head, struct xrt_space_relation *out_relation)
+{
+	U_ZERO(out_relation);
+	out_relation->pose = head->center;
+	out_relation->relation_flags = (enum xrt_space_relation_flags)(
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_POSITION_VALID_BIT |
+	    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT);
+}
+
+static void
+controller_data_to_relation(const struct r_remote_controller_data *ctrl, struct xrt_space_relation *out_relation)
+{
+	U_ZERO(out_relation);
+
+	/*
+	 * It's easier to reason about angular velocity if it's controlled in
+	 * body space, but the angular velocity returned in the relation is in
+	 * the base space.
+	 */
+	math_quat_rotate_derivative(&ctrl->pose.orientation, &ctrl->angular_velocity, &out_relation->angular_velocity);
+
+	out_relation->pose = ctrl->pose;
+	out_relation->linear_velocity = ctrl->linear_velocity;
+
+	if (ctrl->active) {
+		out_relation->relation_flags = (enum xrt_space_relation_flags)(
+		    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_POSITION_VALID_BIT |
+		    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT |
+		    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT | XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT);
+	}
+}
+
+static void
+push_controller(struct m_relation_history *history, const struct r_remote_controller_data *ctrl, int64_t timestamp_ns)
+{
+	// Don't interpolate across the time the controller was gone.
+	if (!ctrl->active) {
+		m_relation_history_clear(history);
+		return;
+	}
+
+	struct xrt_space_relation relation;
+	controller_data_to_relation(ctrl, &relation);
+	m_relation_history_push(history, &relation, timestamp_ns);
+}
+
+static void
+reset_connection_state(struct r_hub *r)
+{
+	m_clock_windowed_skew_tracker_reset(r->skew);
+	m_relation_history_clear(r->history.head);
+	m_relation_history_clear(r->history.left);
+	m_relation_history_clear(r->history.right);
+	U_ZERO(&r->stats);
+}
+
+static void
+handle_data(struct r_hub *r, const struct r_remote_data *data)
+{
+	int64_t now_ns = (int64_t)os_monotonic_get_ns();
+
+	if (r->stats.received > 0 && data->sequence <= r->stats.last_sequence) {
+		r->stats.out_of_order++;
+		return;
+	}
+	if (r->stats.received > 0 && data->sequence > r->stats.last_sequence + 1) {
+		r->stats.lost += data->sequence - r->stats.last_sequence - 1;
+	}
+	r->stats.last_sequence = data->sequence;
+	r->stats.received++;
+
+	// Fall back to the time of arrival if the sender doesn't tell us.
+	timepoint_ns timestamp_ns = now_ns;
+	if (data->timestamp_ns != 0) {
+		m_clock_windowed_skew_tracker_push(r->skew, now_ns, data->timestamp_ns);
+		if (!m_clock_windowed_skew_tracker_to_local(r->skew, data->timestamp_ns, &timestamp_ns)) {
+			timestamp_ns = now_ns;
+		}
+	}
+	r->stats.delay_ns = now_ns - timestamp_ns;
+
+	r->latest = *data;
+
+	struct xrt_space_relation head;
+	head_data_to_relation(&data->head, &head);
+	m_relation_history_push(r->history.head, &head, timestamp_ns);
+
+	push_controller(r->history.left, &data->left, timestamp_ns);
+	push_controller(r->history.right, &data->right, timestamp_ns);
+}
+
 static void *
 run_thread(void *ptr)
 {
@@ -326,6 +429,8 @@ run_thread(void *ptr)
 			return NULL;
 		}
 
+		reset_connection_state(r);
+
 		r_remote_connection_write_one(&r->rc, &r->reset);
 		r_remote_connection_write_one(&r->rc, &r->latest);
 
@@ -337,7 +442,13 @@ run_thread(void *ptr)
 				break;
 			}
 
-			r->latest = data;
+			if (data.header != R_HEADER_VALUE) {
+				R_ERROR(r, "Unknown header value 0x%016" PRIx64 ", different version of the protocol?",
+				        data.header);
+				break;
+			}
+
+			handle_data(r, &data);
 		}
 	}
 
@@ -387,6 +498,14 @@ r_hub_system_devices_destroy(struct xrt_system_devices *xsysd)
 		r->rc.fd = -1;
 	}
 
+	m_relation_history_destroy(&r->history.head);
+	m_relation_history_destroy(&r->history.left);
+	m_relation_history_destroy(&r->history.right);
+	if (r->skew != NULL) {
+		m_clock_windowed_skew_tracker_destroy(r->skew);
+		r->skew = NULL;
+	}
+
 	free(r);
 
 #if defined(XRT_OS_WINDOWS)
@@ -414,6 +533,7 @@ r_create_devices(uint16_t port,
 
 	r->base.destroy = r_hub_system_devices_destroy;
 	r->base.get_roles = r_hub_system_devices_get_roles;
+	r->reset.header = R_HEADER_VALUE;
 	r->origin.type = XRT_TRACKING_TYPE_RGB;
 	r->origin.initial_offset = (struct xrt_pose)XRT_POSE_IDENTITY;
 	r->reset.head.center = (struct xrt_pose)XRT_POSE_IDENTITY;
@@ -443,6 +563,16 @@ r_create_devices(uint16_t port,
 
 	snprintf(r->origin.name, sizeof(r->origin.name), "Remote Simulator");
 
+	m_relation_history_create(&r->history.head);
+	m_relation_history_create(&r->history.left);
+	m_relation_history_create(&r->history.right);
+	r->skew = m_clock_windowed_skew_tracker_alloc(R_SKEW_WINDOW_SAMPLES);
+	if (r->skew == NULL) {
+		R_ERROR(r, "Failed to allocate clock skew tracker!");
+		r_hub_system_devices_destroy(&r->base);
+		return XRT_ERROR_ALLOCATION;
+	}
+
 	ret = os_thread_helper_init(&r->oth);
 	if (ret != 0) {
 		R_ERROR(r, "Failed to init threading!");
@@ -525,6 +655,10 @@ r_create_devices(uint16_t port,
 	// u_var_add_gui_header(r, &r->gui.right, "Right");
 	u_var_add_bool(r, &r->latest.right.active, "right.active");
 	u_var_add_pose(r, &r->latest.right.pose, "right.pose");
+	u_var_add_ro_u64(r, &r->stats.received, "Packets received");
+	u_var_add_ro_u64(r, &r->stats.lost, "Packets lost");
+	u_var_add_ro_u64(r, &r->stats.out_of_order, "Packets out of order");
+	u_var_add_ro_i64(r, &r->stats.delay_ns, "Packet delay (ns)");
 
 	/*
 	 * Done now.
@@ -537,6 +671,47 @@ r_create_devices(uint16_t port,
 }
 
 
+/*
+ *
+ * 'Exported' hub functions.
+ *
+ */
+
+void
+r_hub_get_head_relation(struct r_hub *r, int64_t at_timestamp_ns, struct xrt_space_relation *out_relation)
+{
+	enum m_relation_history_result res = M_RELATION_HISTORY_RESULT_INVALID;
+	if (at_timestamp_ns > 0) {
+		res = m_relation_history_get(r->history.head, at_timestamp_ns, out_relation);
+	}
+
+	// Nothing received yet, the data might still be edited from the debug UI.
+	if (res == M_RELATION_HISTORY_RESULT_INVALID) {
+		head_data_to_relation(&r->latest.head, out_relation);
+	}
+}
+
+void
+r_hub_get_controller_relation(struct r_hub *r,
+                              bool is_left,
+                              int64_t at_timestamp_ns,
+                              struct xrt_space_relation *out_relation)
+{
+	struct m_relation_history *history = is_left ? r->history.left : r->history.right;
+	struct r_remote_controller_data *latest = is_left ? &r->latest.left : &r->latest.right;
+
+	enum m_relation_history_result res = M_RELATION_HISTORY_RESULT_INVALID;
+	if (at_timestamp_ns > 0 && latest->active) {
+		res = m_relation_history_get(history, at_timestamp_ns, out_relation);
+	}
+
+	// Also covers the controller not being active.
+	if (res == M_RELATION_HISTORY_RESULT_INVALID) {
+		controller_data_to_relation(latest, out_relation);
+	}
+}
+
+
 /*
  *
  * 'Exported' connection functions.
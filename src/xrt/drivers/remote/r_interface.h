@@ -66,7 +66,7 @@ typedef int r_socket_t;
  *
  * @ingroup drv_remote
  */
-#define R_HEADER_VALUE (*(uint64_t *)"mndrmt3\0")
+#define R_HEADER_VALUE (*(uint64_t *)"mndrmt4\0")
 
 /*!
  * Data per controller.
@@ -139,6 +139,16 @@ struct r_remote_data
 {
 	uint64_t header;
 
+	/*!
+	 * When the data was sampled, in the monotonic clock of the sender. The
+	 * hub estimates the offset to its own clock from these, zero means
+	 * unknown and the time of arrival is used instead.
+	 */
+	int64_t timestamp_ns;
+
+	//! Incremented by the sender for each packet, starting at one per connection.
+	uint64_t sequence;
+
 	struct r_head_data head;
 
 	struct r_remote_controller_data left, right;
@@ -17,6 +17,9 @@
 
 #include "os/os_threading.h"
 
+#include "math/m_clock_tracking.h"
+#include "math/m_relation_history.h"
+
 #include "util/u_hand_tracking.h"
 
 
@@ -46,6 +49,27 @@ struct r_hub
 	//! The latest data received.
 	struct r_remote_data latest;
 
+	//! Estimates the clock of the sender in ours, only used by the thread.
+	struct m_clock_windowed_skew_tracker *skew;
+
+	//! Received poses in our clock, used to interpolate and predict.
+	struct
+	{
+		struct m_relation_history *head;
+		struct m_relation_history *left;
+		struct m_relation_history *right;
+	} history;
+
+	//! Packet statistics, reset on each new connection.
+	struct
+	{
+		uint64_t last_sequence;
+		uint64_t received;
+		uint64_t lost;         //!< Sequence numbers skipped over
+		uint64_t out_of_order; //!< Dropped for not being newer than the last one
+		int64_t delay_ns;      //!< Arrival time minus the send time in our clock, of the latest packet
+	} stats;
+
 	//! Incoming connection socket.
 	r_socket_t accept_fd;
 
@@ -95,6 +119,27 @@ struct r_device
 };
 
 
+/*!
+ * Get the head pose at the given time, interpolated or predicted from the
+ * received data.
+ *
+ * @public @memberof r_hub
+ */
+void
+r_hub_get_head_relation(struct r_hub *r, int64_t at_timestamp_ns, struct xrt_space_relation *out_relation);
+
+/*!
+ * Get the pose of a controller at the given time, interpolated or predicted
+ * from the received data.
+ *
+ * @public @memberof r_hub
+ */
+void
+r_hub_get_controller_relation(struct r_hub *r,
+                              bool is_left,
+                              int64_t at_timestamp_ns,
+                              struct xrt_space_relation *out_relation);
+
 struct xrt_device *
 r_hmd_create(struct r_hub *r);
 
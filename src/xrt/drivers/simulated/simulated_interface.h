@@ -10,6 +10,7 @@
 #pragma once
 
 #include "xrt/xrt_compiler.h"
+#include "xrt/xrt_defines.h"
 #include "util/u_logging.h"
 
 
@@ -43,6 +44,24 @@ enum simulated_movement
 	SIMULATED_MOVEMENT_STATIONARY,
 };
 
+/*!
+ * Settings for the load generating devices, see
+ * @ref simulated_create_load_device.
+ *
+ * @ingroup drv_simulated
+ */
+struct simulated_load_config
+{
+	//! How often each device pushes a new pose into its history.
+	uint32_t update_rate_hz;
+
+	//! How often the buttons flip, zero means they never change.
+	uint32_t input_toggle_rate_hz;
+
+	//! Should the devices also produce hand tracking joint sets.
+	bool hand_tracking;
+};
+
 /*!
  * Return the logging level that we want for the simulated related code.
  *
@@ -89,6 +108,23 @@ simulated_create_controller(enum xrt_device_name name,
                             struct xrt_tracking_origin *origin);
 
 
+/*!
+ * Create a load generating device, used to benchmark the service and state
+ * tracker without any hardware. It has the inputs of a simple controller,
+ * each device has its own thread pushing poses into a relation history at
+ * @ref simulated_load_config::update_rate_hz. Everything it produces only
+ * depends on the time since creation and @p index, so runs are repeatable.
+ *
+ * @ingroup drv_simulated
+ */
+struct xrt_device *
+simulated_create_load_device(const struct simulated_load_config *config,
+                             uint32_t index,
+                             enum xrt_hand hand,
+                             const struct xrt_pose *center,
+                             struct xrt_tracking_origin *origin);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,363 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Simulated load generating device.
+ * @ingroup drv_simulated
+ */
+
+#include "xrt/xrt_device.h"
+
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
+#include "math/m_api.h"
+#include "math/m_mathinclude.h"
+#include "math/m_relation_history.h"
+
+#include "util/u_var.h"
+#include "util/u_misc.h"
+#include "util/u_time.h"
+#include "util/u_device.h"
+#include "util/u_logging.h"
+#include "util/u_hand_simulation.h"
+
+#include "simulated_interface.h"
+
+#include <stdio.h>
+#include <assert.h>
+
+
+/*
+ *
+ * Structs and defines.
+ *
+ */
+
+//! Radius of the circle the devices move on.
+#define LOAD_RADIUS_M (0.1)
+
+//! Angular speed of the movement around the circle.
+#define LOAD_SPEED_RAD_S (1.0)
+
+//! How far apart each device is on its circle, to not have them all the same.
+#define LOAD_PHASE_PER_DEVICE_RAD (0.5)
+
+//! Frequency of the fingers curling and uncurling.
+#define LOAD_CURL_HZ (0.5)
+
+enum simulated_load_input_index
+{
+	SIMULATED_LOAD_INPUT_SELECT_CLICK,
+	SIMULATED_LOAD_INPUT_MENU_CLICK,
+	SIMULATED_LOAD_INPUT_GRIP_POSE,
+	SIMULATED_LOAD_INPUT_AIM_POSE,
+	SIMULATED_LOAD_INPUT_HAND_TRACKING,
+};
+
+/*!
+ * A device that pushes poses into a @ref m_relation_history from its own
+ * thread at a fixed rate, everything it does is derived from the time since
+ * it was created and its index so runs can be compared with each other.
+ *
+ * @implements xrt_device
+ */
+struct simulated_load_device
+{
+	struct xrt_device base;
+
+	struct m_relation_history *history;
+
+	//! Producer thread.
+	struct os_thread_helper oth;
+
+	//! Never changes after creation, read by the producer thread without locking.
+	struct xrt_pose center;
+
+	int64_t created_ns;
+	int64_t update_period_ns;
+	//! Zero means the inputs never change.
+	int64_t toggle_period_ns;
+
+	uint32_t index;
+	enum xrt_hand hand;
+};
+
+
+/*
+ *
+ * Helper functions.
+ *
+ */
+
+static inline struct simulated_load_device *
+simulated_load_device(struct xrt_device *xdev)
+{
+	return (struct simulated_load_device *)xdev;
+}
+
+static double
+get_phase(struct simulated_load_device *sld, int64_t timestamp_ns)
+{
+	double time_s = time_ns_to_s(timestamp_ns - sld->created_ns);
+
+	return time_s * LOAD_SPEED_RAD_S + sld->index * LOAD_PHASE_PER_DEVICE_RAD;
+}
+
+/*!
+ * Move on a circle in the horizontal plane while rotating around the up axis
+ * at the same speed, the velocities are exact so prediction has real work.
+ */
+static void
+compute_relation(struct simulated_load_device *sld, int64_t timestamp_ns, struct xrt_space_relation *out_relation)
+{
+	const struct xrt_vec3 up = {0, 1, 0};
+	double phase = get_phase(sld, timestamp_ns);
+	double r = LOAD_RADIUS_M;
+	double w = LOAD_SPEED_RAD_S;
+
+	struct xrt_pose tmp = XRT_POSE_IDENTITY;
+	tmp.position.x = (float)(cos(phase) * r);
+	tmp.position.z = (float)(sin(phase) * r);
+	math_quat_from_angle_vector((float)phase, &up, &tmp.orientation);
+
+	math_pose_transform(&sld->center, &tmp, &out_relation->pose);
+
+	struct xrt_vec3 linear_velocity = {
+	    (float)(-sin(phase) * r * w),
+	    0.0f,
+	    (float)(cos(phase) * r * w),
+	};
+	struct xrt_vec3 angular_velocity = {0.0f, (float)w, 0.0f};
+
+	math_quat_rotate_vec3(&sld->center.orientation, &linear_velocity, &out_relation->linear_velocity);
+	math_quat_rotate_vec3(&sld->center.orientation, &angular_velocity, &out_relation->angular_velocity);
+
+	out_relation->relation_flags = (enum xrt_space_relation_flags)(
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_POSITION_VALID_BIT |
+	    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT |
+	    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT | XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT);
+}
+
+static void *
+simulated_load_run_thread(void *ptr)
+{
+	struct simulated_load_device *sld = (struct simulated_load_device *)ptr;
+
+	int64_t next_ns = os_monotonic_get_ns();
+
+	os_thread_helper_lock(&sld->oth);
+
+	while (os_thread_helper_is_running_locked(&sld->oth)) {
+		os_thread_helper_unlock(&sld->oth);
+
+		int64_t now_ns = os_monotonic_get_ns();
+
+		struct xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+		compute_relation(sld, now_ns, &relation);
+		m_relation_history_push(sld->history, &relation, now_ns);
+
+		// Don't try to catch up if we fell behind, just skip ahead.
+		next_ns += sld->update_period_ns;
+		now_ns = os_monotonic_get_ns();
+		if (next_ns < now_ns) {
+			next_ns = now_ns;
+		} else {
+			os_nanosleep(next_ns - now_ns);
+		}
+
+		// Must lock thread before check in while.
+		os_thread_helper_lock(&sld->oth);
+	}
+
+	os_thread_helper_unlock(&sld->oth);
+
+	return NULL;
+}
+
+
+/*
+ *
+ * Member functions.
+ *
+ */
+
+static void
+simulated_load_destroy(struct xrt_device *xdev)
+{
+	struct simulated_load_device *sld = simulated_load_device(xdev);
+
+	// Also stops the thread.
+	os_thread_helper_destroy(&sld->oth);
+
+	// Remove the variable tracking.
+	u_var_remove_root(sld);
+
+	m_relation_history_destroy(&sld->history);
+
+	u_device_free(&sld->base);
+}
+
+static xrt_result_t
+simulated_load_update_inputs(struct xrt_device *xdev)
+{
+	struct simulated_load_device *sld = simulated_load_device(xdev);
+
+	int64_t now_ns = os_monotonic_get_ns();
+
+	bool on = false;
+	if (sld->toggle_period_ns > 0) {
+		int64_t toggles = (now_ns - sld->created_ns) / sld->toggle_period_ns;
+		on = ((toggles + sld->index) & 1) != 0;
+	}
+
+	for (uint32_t i = 0; i < xdev->input_count; i++) {
+		xdev->inputs[i].timestamp = now_ns;
+	}
+
+	// Flip the buttons opposite of each other.
+	xdev->inputs[SIMULATED_LOAD_INPUT_SELECT_CLICK].value.boolean = on;
+	xdev->inputs[SIMULATED_LOAD_INPUT_MENU_CLICK].value.boolean = !on;
+
+	return XRT_SUCCESS;
+}
+
+static void
+simulated_load_get_tracked_pose(struct xrt_device *xdev,
+                                enum xrt_input_name name,
+                                int64_t at_timestamp_ns,
+                                struct xrt_space_relation *out_relation)
+{
+	struct simulated_load_device *sld = simulated_load_device(xdev);
+
+	if (name != XRT_INPUT_SIMPLE_GRIP_POSE && name != XRT_INPUT_SIMPLE_AIM_POSE) {
+		U_LOG_E("Unknown input name: 0x%0x", name);
+		return;
+	}
+
+	m_relation_history_get(sld->history, at_timestamp_ns, out_relation);
+}
+
+static void
+simulated_load_get_hand_tracking(struct xrt_device *xdev,
+                                 enum xrt_input_name name,
+                                 int64_t requested_timestamp_ns,
+                                 struct xrt_hand_joint_set *out_value,
+                                 int64_t *out_timestamp_ns)
+{
+	struct simulated_load_device *sld = simulated_load_device(xdev);
+
+	if (name != XRT_INPUT_GENERIC_HAND_TRACKING_LEFT && name != XRT_INPUT_GENERIC_HAND_TRACKING_RIGHT) {
+		U_LOG_E("Unknown input name for hand tracker: 0x%0x", name);
+		return;
+	}
+
+	// Curl all fingers together, open to closed and back.
+	double time_s = time_ns_to_s(requested_timestamp_ns - sld->created_ns);
+	float curl = (float)(0.5 + 0.5 * sin(time_s * LOAD_CURL_HZ * 2.0 * M_PI + sld->index));
+
+	struct u_hand_tracking_curl_values values = {
+	    .little = curl,
+	    .ring = curl,
+	    .middle = curl,
+	    .index = curl,
+	    .thumb = curl,
+	};
+
+	struct xrt_space_relation hand_relation = XRT_SPACE_RELATION_ZERO;
+	m_relation_history_get(sld->history, requested_timestamp_ns, &hand_relation);
+
+	u_hand_sim_simulate_for_valve_index_knuckles(&values, sld->hand, &hand_relation, out_value);
+
+	*out_timestamp_ns = requested_timestamp_ns;
+
+	out_value->is_active = true;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+struct xrt_device *
+simulated_create_load_device(const struct simulated_load_config *config,
+                             uint32_t index,
+                             enum xrt_hand hand,
+                             const struct xrt_pose *center,
+                             struct xrt_tracking_origin *origin)
+{
+	const enum u_device_alloc_flags flags = U_DEVICE_ALLOC_TRACKING_NONE;
+	const uint32_t input_count = config->hand_tracking ? 5 : 4;
+	const uint32_t output_count = 0;
+
+	assert(config->update_rate_hz > 0);
+
+	struct simulated_load_device *sld =
+	    U_DEVICE_ALLOCATE(struct simulated_load_device, flags, input_count, output_count);
+	sld->base.update_inputs = simulated_load_update_inputs;
+	sld->base.get_tracked_pose = simulated_load_get_tracked_pose;
+	sld->base.get_hand_tracking = simulated_load_get_hand_tracking;
+	sld->base.get_view_poses = u_device_ni_get_view_poses;
+	sld->base.destroy = simulated_load_destroy;
+	sld->base.tracking_origin = origin;
+	sld->base.orientation_tracking_supported = true;
+	sld->base.position_tracking_supported = true;
+	sld->base.hand_tracking_supported = config->hand_tracking;
+	sld->base.name = XRT_DEVICE_SIMPLE_CONTROLLER;
+	sld->base.device_type = XRT_DEVICE_TYPE_ANY_HAND_CONTROLLER;
+
+	snprintf(sld->base.str, sizeof(sld->base.str), "Load Device %u (Simulated)", index);
+	snprintf(sld->base.serial, sizeof(sld->base.serial), "Load Device %u (Simulated)", index);
+
+	sld->base.inputs[SIMULATED_LOAD_INPUT_SELECT_CLICK].name = XRT_INPUT_SIMPLE_SELECT_CLICK;
+	sld->base.inputs[SIMULATED_LOAD_INPUT_MENU_CLICK].name = XRT_INPUT_SIMPLE_MENU_CLICK;
+	sld->base.inputs[SIMULATED_LOAD_INPUT_GRIP_POSE].name = XRT_INPUT_SIMPLE_GRIP_POSE;
+	sld->base.inputs[SIMULATED_LOAD_INPUT_AIM_POSE].name = XRT_INPUT_SIMPLE_AIM_POSE;
+	if (config->hand_tracking) {
+		sld->base.inputs[SIMULATED_LOAD_INPUT_HAND_TRACKING].name = hand == XRT_HAND_LEFT
+		                                                                ? XRT_INPUT_GENERIC_HAND_TRACKING_LEFT
+		                                                                : XRT_INPUT_GENERIC_HAND_TRACKING_RIGHT;
+	}
+
+	for (uint32_t i = 0; i < input_count; i++) {
+		sld->base.inputs[i].active = true;
+	}
+
+	sld->center = *center;
+	sld->created_ns = os_monotonic_get_ns();
+	sld->update_period_ns = U_TIME_1S_IN_NS / config->update_rate_hz;
+	sld->toggle_period_ns = config->input_toggle_rate_hz > 0 ? U_TIME_1S_IN_NS / config->input_toggle_rate_hz : 0;
+	sld->index = index;
+	sld->hand = hand;
+
+	m_relation_history_create(&sld->history);
+
+	// Have a pose in the history before anybody asks for one.
+	struct xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+	compute_relation(sld, sld->created_ns, &relation);
+	m_relation_history_push(sld->history, &relation, sld->created_ns);
+
+	int ret = os_thread_helper_init(&sld->oth);
+	if (ret != 0) {
+		U_LOG_E("Failed to init thread helper!");
+		m_relation_history_destroy(&sld->history);
+		u_device_free(&sld->base);
+		return NULL;
+	}
+
+	ret = os_thread_helper_start(&sld->oth, simulated_load_run_thread, sld);
+	if (ret != 0) {
+		U_LOG_E("Failed to start thread!");
+		simulated_load_destroy(&sld->base);
+		return NULL;
+	}
+
+	u_var_add_root(sld, sld->base.str, true);
+	// Read only, the producer thread reads it while the UI would write it.
+	u_var_add_ro_vec3_f32(sld, &sld->center.position, "center.position");
+	u_var_add_ro_quat_f32(sld, &sld->center.orientation, "center.orientation");
+
+	return &sld->base;
+}
@@ -135,6 +135,22 @@ xrt_atomic_s32_cmpxchg(xrt_atomic_s32_t *p, int32_t old_, int32_t new_)
 #endif
 }
 
+/*!
+ * Full memory barrier, stops both the compiler and the CPU from reordering
+ * loads and stores across it. Needed for seqlock style sharing of data.
+ */
+static inline void
+xrt_atomic_full_barrier(void)
+{
+#if defined(__GNUC__)
+	__sync_synchronize();
+#elif defined(_MSC_VER)
+	MemoryBarrier();
+#else
+#error "compiler not supported"
+#endif
+}
+
 #ifdef _MSC_VER
 typedef intptr_t ssize_t;
 #define _SSIZE_T_
@@ -464,6 +464,12 @@ struct xrt_device
 	 * the lookup (vertex attribute or distortion texture) used to pre-distort the image as required by the device's
 	 * optics.
 	 *
+	 * Must be thread safe: the mesh is generated on several threads at once
+	 * (see `XRT_MESH_THREADS` in @ref u_distortion_mesh_fill_in_compute),
+	 * so this may be called concurrently for the same device. The result
+	 * must only depend on the arguments and state that does not change
+	 * while the device exists.
+	 *
 	 * @param xdev            the device
 	 * @param view            the view index
 	 * @param u               horizontal texture coordinate
@@ -473,6 +479,23 @@ struct xrt_device
 	bool (*compute_distortion)(
 	    struct xrt_device *xdev, uint32_t view, float u, float v, struct xrt_uv_triplet *out_result);
 
+	/*!
+	 * Compute the distortion for a whole grid of points, optional. Works
+	 * like @ref compute_distortion but for @p grid_size by @p grid_size
+	 * points evenly spaced from 0 to 1.0 inclusive in both u and v, written
+	 * row major into @p out_results. Implemented by devices where a single
+	 * call is much cheaper than many, for instance over IPC.
+	 *
+	 * @param xdev             the device
+	 * @param view             the view index
+	 * @param grid_size        number of points along each axis, at least 2
+	 * @param[out] out_results array of @p grid_size squared triplets.
+	 */
+	bool (*compute_distortion_grid)(struct xrt_device *xdev,
+	                                uint32_t view,
+	                                uint32_t grid_size,
+	                                struct xrt_uv_triplet *out_results);
+
 	/*!
 	 * Get the visibility mask for this device.
 	 *
@@ -699,6 +722,22 @@ xrt_device_compute_distortion(
 	return xdev->compute_distortion(xdev, view, u, v, out_result);
 }
 
+/*!
+ * Helper function for @ref xrt_device::compute_distortion_grid.
+ *
+ * @copydoc xrt_device::compute_distortion_grid
+ *
+ * @public @memberof xrt_device
+ */
+static inline bool
+xrt_device_compute_distortion_grid(struct xrt_device *xdev,
+                                   uint32_t view,
+                                   uint32_t grid_size,
+                                   struct xrt_uv_triplet *out_results)
+{
+	return xdev->compute_distortion_grid(xdev, view, grid_size, out_results);
+}
+
 /*!
  * Helper function for @ref xrt_device::get_visibility_mask.
  *
@@ -302,6 +302,19 @@ struct xrt_system_devices
 	 */
 	xrt_result_t (*get_roles)(struct xrt_system_devices *xsysd, struct xrt_system_roles *out_roles);
 
+	/*!
+	 * Update the inputs of all of the devices in @ref xdevs in one go, this
+	 * lets implementations batch the work, like doing a single round trip
+	 * to the service over IPC instead of one per device.
+	 *
+	 * Optional, code consuming this interface should use
+	 * @ref xrt_system_devices_update_inputs which falls back to calling
+	 * @ref xrt_device_update_inputs on each device.
+	 *
+	 * @param xsysd Pointer to self
+	 */
+	xrt_result_t (*update_inputs)(struct xrt_system_devices *xsysd);
+
 	/*!
 	 * Increment the usage count of a feature.
 	 * When the feature is used for the first time, then the feature will be begun.
@@ -343,6 +356,36 @@ xrt_system_devices_get_roles(struct xrt_system_devices *xsysd, struct xrt_system
 	return xsysd->get_roles(xsysd, out_roles);
 }
 
+/*!
+ * @copydoc xrt_system_devices::update_inputs
+ *
+ * Helper for calling through the function pointer, if the function is not
+ * implemented it calls @ref xrt_device_update_inputs on each of the devices.
+ *
+ * @public @memberof xrt_system_devices
+ */
+static inline xrt_result_t
+xrt_system_devices_update_inputs(struct xrt_system_devices *xsysd)
+{
+	if (xsysd->update_inputs != NULL) {
+		return xsysd->update_inputs(xsysd);
+	}
+
+	for (size_t i = 0; i < xsysd->xdev_count; i++) {
+		struct xrt_device *xdev = xsysd->xdevs[i];
+		if (xdev == NULL) {
+			continue;
+		}
+
+		xrt_result_t xret = xrt_device_update_inputs(xdev);
+		if (xret != XRT_SUCCESS) {
+			return xret;
+		}
+	}
+
+	return XRT_SUCCESS;
+}
+
 /*!
  * @copydoc xrt_system_devices::feature_inc
  *
@@ -159,8 +159,30 @@ struct ipc_connection
 	struct ipc_shared_memory *ism;
 	xrt_shmem_handle_t ism_handle;
 
+	//! Size of the mapping of @ref ism, given by the service.
+	size_t ism_size;
+
+	//! First of the @ref IPC_SLOTS_PER_CLIENT layer slots this client owns.
+	uint32_t first_slot_id;
+
+	//! Index of this client in @ref ipc_shared_memory::client_io_active.
+	uint32_t client_index;
+
 	struct os_mutex mutex;
 
+	/*!
+	 * Second channel to the service used by the pose and input calls, so
+	 * they are not stuck behind a thread blocked in a frame call on the
+	 * main channel. Only valid if @p enabled is true, see
+	 * @ref ipc_dispatch_tracking for which calls use it.
+	 */
+	struct
+	{
+		bool enabled;
+		struct ipc_message_channel imc;
+		struct os_mutex mutex;
+	} tracking;
+
 #ifdef XRT_OS_ANDROID
 	struct ipc_client_android *ica;
 #endif // XRT_OS_ANDROID
@@ -236,6 +258,21 @@ ipc_client_create_native_compositor(struct xrt_system_compositor *xsysc,
                                     const struct xrt_session_info *xsi,
                                     struct xrt_compositor_native **out_xcn);
 
+/*!
+ * Try to get the pose of @p name from the pose rings that the service publishes
+ * in the shared memory, without a round trip to the service. Returns false if
+ * the pose isn't published, the input isn't active, the service has disabled
+ * IO for this client or device, or the timestamp is outside of what the ring
+ * can answer; the caller should then ask the service.
+ *
+ * @ingroup ipc_client
+ */
+bool
+ipc_client_xdev_get_tracked_pose_from_ring(struct ipc_client_xdev *icx,
+                                           enum xrt_input_name name,
+                                           int64_t at_timestamp_ns,
+                                           struct xrt_space_relation *out_relation);
+
 struct xrt_device *
 ipc_client_hmd_create(struct ipc_connection *ipc_c, struct xrt_tracking_origin *xtrack, uint32_t device_id);
 
@@ -137,6 +137,31 @@ ipc_client_compositor_semaphore(struct xrt_compositor_semaphore *xcsem)
 	return (struct ipc_client_compositor_semaphore *)xcsem;
 }
 
+static inline struct ipc_layer_slot *
+get_layer_slot(struct ipc_client_compositor *icc)
+{
+	return ipc_shared_memory_get_slot(icc->ipc_c->ism, icc->layers.slot_id);
+}
+
+/*!
+ * Get the next free layer entry in the current slot, fails if the slot is
+ * full, the state tracker should have stopped the app before that.
+ */
+static inline xrt_result_t
+get_next_layer_entry(struct ipc_client_compositor *icc, struct ipc_layer_entry **out_layer)
+{
+	uint32_t layer_capacity = icc->ipc_c->ism->slots.layer_capacity;
+
+	if (icc->layers.layer_count >= layer_capacity) {
+		IPC_ERROR(icc->ipc_c, "Too many layers, the service supports %u!", layer_capacity);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	*out_layer = &get_layer_slot(icc)->layers[icc->layers.layer_count];
+
+	return XRT_SUCCESS;
+}
+
 
 /*
  *
@@ -572,8 +597,7 @@ ipc_compositor_layer_begin(struct xrt_compositor *xc, const struct xrt_layer_fra
 {
 	struct ipc_client_compositor *icc = ipc_client_compositor(xc);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = get_layer_slot(icc);
 
 	slot->data = *data;
 
@@ -590,9 +614,12 @@ ipc_compositor_layer_projection(struct xrt_compositor *xc,
 
 	assert(data->type == XRT_LAYER_PROJECTION);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
-	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
+	struct ipc_layer_entry *layer = NULL;
+	xrt_result_t xret = get_next_layer_entry(icc, &layer);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
 	layer->xdev_id = 0; //! @todo Real id.
 	layer->data = *data;
 	for (uint32_t i = 0; i < data->view_count; ++i) {
@@ -616,9 +643,12 @@ ipc_compositor_layer_projection_depth(struct xrt_compositor *xc,
 
 	assert(data->type == XRT_LAYER_PROJECTION_DEPTH);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
-	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
+	struct ipc_layer_entry *layer = NULL;
+	xrt_result_t xret = get_next_layer_entry(icc, &layer);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
 	struct ipc_client_swapchain *xscn[XRT_MAX_VIEWS];
 	struct ipc_client_swapchain *d_xscn[XRT_MAX_VIEWS];
 	for (uint32_t i = 0; i < data->view_count; ++i) {
@@ -650,9 +680,12 @@ handle_layer(struct xrt_compositor *xc,
 
 	assert(data->type == type);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
-	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
+	struct ipc_layer_entry *layer = NULL;
+	xrt_result_t xret = get_next_layer_entry(icc, &layer);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
 	struct ipc_client_swapchain *ics = ipc_client_swapchain(xsc);
 
 	layer->xdev_id = 0; //! @todo Real id.
@@ -720,9 +753,11 @@ ipc_compositor_layer_passthrough(struct xrt_compositor *xc, struct xrt_device *x
 
 	assert(data->type == XRT_LAYER_PASSTHROUGH);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
-	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
+	struct ipc_layer_entry *layer = NULL;
+	xrt_result_t xret = get_next_layer_entry(icc, &layer);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
 
 	layer->xdev_id = 0; //! @todo Real id.
 	layer->data = *data;
@@ -741,8 +776,7 @@ ipc_compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_handle_
 
 	bool valid_sync = xrt_graphics_sync_handle_is_valid(sync_handle);
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = get_layer_slot(icc);
 
 	// Last bit of data to put in the shared memory area.
 	slot->layer_count = icc->layers.layer_count;
@@ -780,8 +814,7 @@ ipc_compositor_layer_commit_with_semaphore(struct xrt_compositor *xc,
 	struct ipc_client_compositor_semaphore *iccs = ipc_client_compositor_semaphore(xcsem);
 	xrt_result_t xret;
 
-	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = get_layer_slot(icc);
 
 	// Last bit of data to put in the shared memory area.
 	slot->layer_count = icc->layers.layer_count;
@@ -1112,6 +1145,7 @@ ipc_client_create_system_compositor(struct ipc_connection *ipc_c,
 	c->system.create_native_compositor = ipc_syscomp_create_native_compositor;
 	c->system.destroy = ipc_syscomp_destroy;
 	c->ipc_c = ipc_c;
+	c->layers.slot_id = ipc_c->first_slot_id;
 	c->xina = xina;
 
 
@@ -27,6 +27,7 @@
 #include "util/u_system_helpers.h"
 
 #include "shared/ipc_utils.h"
+#include "shared/ipc_shmem.h"
 #include "shared/ipc_protocol.h"
 #include "client/ipc_client_connection.h"
 
@@ -34,6 +35,7 @@
 
 
 #include <stdio.h>
+#include <inttypes.h>
 #if !defined(XRT_OS_WINDOWS)
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -55,6 +57,7 @@
 #endif // XRT_OS_ANDROID
 
 DEBUG_GET_ONCE_BOOL_OPTION(ipc_ignore_version, "IPC_IGNORE_VERSION", false)
+DEBUG_GET_ONCE_BOOL_OPTION(ipc_tracking_channel, "IPC_TRACKING_CHANNEL", true)
 
 #ifdef XRT_OS_ANDROID
 
@@ -255,27 +258,35 @@ ipc_client_setup_shm(struct ipc_connection *ipc_c)
 	 * Get our shared memory area from the server.
 	 */
 
-	xrt_result_t xret = ipc_call_instance_get_shm_fd(ipc_c, &ipc_c->ism_handle, 1);
+	uint64_t size = 0;
+	uint32_t first_slot_id = 0;
+	uint32_t client_index = 0;
+	xrt_result_t xret =
+	    ipc_call_instance_get_shm_fd(ipc_c, &size, &first_slot_id, &client_index, &ipc_c->ism_handle, 1);
 	if (xret != XRT_SUCCESS) {
 		IPC_ERROR(ipc_c, "Failed to retrieve shm fd!");
 		return xret;
 	}
 
+	if (size < sizeof(struct ipc_shared_memory)) {
+		IPC_ERROR(ipc_c, "Invalid shm size %" PRIu64 "!", size);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
 	/*
 	 * Now map it.
 	 */
 
-	const size_t size = sizeof(struct ipc_shared_memory);
-
 #ifdef XRT_OS_WINDOWS
 	DWORD access = FILE_MAP_READ | FILE_MAP_WRITE;
 
-	ipc_c->ism = MapViewOfFile(ipc_c->ism_handle, access, 0, 0, size);
+	ipc_c->ism = MapViewOfFile(ipc_c->ism_handle, access, 0, 0, (size_t)size);
 #else
 	const int flags = MAP_SHARED;
 	const int access = PROT_READ | PROT_WRITE;
 
-	ipc_c->ism = mmap(NULL, size, access, flags, ipc_c->ism_handle, 0);
+	void *map = mmap(NULL, (size_t)size, access, flags, ipc_c->ism_handle, 0);
+	ipc_c->ism = map == MAP_FAILED ? NULL : map;
 #endif
 
 	if (ipc_c->ism == NULL) {
@@ -283,7 +294,43 @@ ipc_client_setup_shm(struct ipc_connection *ipc_c)
 		return XRT_ERROR_IPC_FAILURE;
 	}
 
+	ipc_c->ism_size = (size_t)size;
+
+	/*
+	 * Check the layout before looking at anything else, this can not be
+	 * ignored like the version check as nothing would be where we expect.
+	 */
+
+	const struct ipc_shared_memory *ism = ipc_c->ism;
+
+	if (ism->layout_version != IPC_SHARED_MEMORY_LAYOUT_VERSION || ism->size != size) {
+		IPC_ERROR(ipc_c, "Shared memory layout version %u does not match ours %u!", ism->layout_version,
+		          IPC_SHARED_MEMORY_LAYOUT_VERSION);
+		goto err_unmap;
+	}
+
+	if (ism->slots.stride < ipc_layer_slot_size(ism->slots.layer_capacity) ||
+	    first_slot_id > ism->slots.count - IPC_SLOTS_PER_CLIENT || ism->slots.count < IPC_SLOTS_PER_CLIENT ||
+	    ism->slots.offset + ism->slots.stride * ism->slots.count > size) {
+		IPC_ERROR(ipc_c, "Invalid layer slots in shared memory!");
+		goto err_unmap;
+	}
+
+	if (client_index >= IPC_MAX_CLIENTS) {
+		IPC_ERROR(ipc_c, "Invalid client index %u!", client_index);
+		goto err_unmap;
+	}
+
+	ipc_c->first_slot_id = first_slot_id;
+	ipc_c->client_index = client_index;
+
 	return XRT_SUCCESS;
+
+err_unmap:
+	ipc_shmem_unmap((void **)&ipc_c->ism, ipc_c->ism_size);
+	ipc_c->ism_size = 0;
+
+	return XRT_ERROR_IPC_FAILURE;
 }
 
 static xrt_result_t
@@ -328,6 +375,50 @@ ipc_client_describe_client(struct ipc_connection *ipc_c, const struct xrt_applic
 	return XRT_SUCCESS;
 }
 
+static void
+ipc_client_attach_tracking_channel(struct ipc_connection *ipc_c)
+{
+#ifdef XRT_OS_WINDOWS
+	//! @todo Needs a second pipe instance, everything goes over the main channel for now.
+	(void)ipc_c;
+#else
+	if (!debug_get_bool_option_ipc_tracking_channel()) {
+		return;
+	}
+
+	int fds[2] = {-1, -1};
+	int ret = socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds);
+	if (ret < 0) {
+		IPC_WARN(ipc_c, "socketpair failed '%i', not using a tracking channel.", errno);
+		return;
+	}
+
+	ret = os_mutex_init(&ipc_c->tracking.mutex);
+	if (ret != 0) {
+		IPC_WARN(ipc_c, "Failed to init tracking channel mutex!");
+		close(fds[0]);
+		close(fds[1]);
+		return;
+	}
+
+	xrt_result_t xret = ipc_call_instance_attach_tracking_channel(ipc_c, &fds[1], 1);
+
+	// The service has its own copy now, or failed.
+	close(fds[1]);
+
+	if (xret != XRT_SUCCESS) {
+		IPC_WARN(ipc_c, "Service did not accept tracking channel, using main channel for all calls.");
+		os_mutex_destroy(&ipc_c->tracking.mutex);
+		close(fds[0]);
+		return;
+	}
+
+	ipc_c->tracking.imc.ipc_handle = fds[0];
+	ipc_c->tracking.imc.log_level = ipc_c->imc.log_level;
+	ipc_c->tracking.enabled = true;
+#endif
+}
+
 
 /*
  *
@@ -346,6 +437,7 @@ ipc_client_connection_init(struct ipc_connection *ipc_c,
 	ipc_c->imc.ipc_handle = XRT_IPC_HANDLE_INVALID;
 	ipc_c->imc.log_level = log_level;
 	ipc_c->ism_handle = XRT_SHMEM_HANDLE_INVALID;
+	ipc_c->tracking.imc.ipc_handle = XRT_IPC_HANDLE_INVALID;
 
 	// Must be done first.
 	int ret = os_mutex_init(&ipc_c->mutex);
@@ -390,12 +482,14 @@ ipc_client_connection_init(struct ipc_connection *ipc_c,
 		goto err_fini; // Already logged.
 	}
 
-	// Do this last.
 	xret = ipc_client_describe_client(ipc_c, &i_info->app_info);
 	if (xret != XRT_SUCCESS) {
 		goto err_fini; // Already logged.
 	}
 
+	// Do this last, optional so failures are only logged.
+	ipc_client_attach_tracking_channel(ipc_c);
+
 	return XRT_SUCCESS;
 
 err_fini:
@@ -410,6 +504,11 @@ ipc_client_connection_fini(struct ipc_connection *ipc_c)
 	if (ipc_c->ism_handle != XRT_SHMEM_HANDLE_INVALID) {
 		/// @todo how to tear down the shared memory?
 	}
+	if (ipc_c->tracking.enabled) {
+		ipc_message_channel_close(&ipc_c->tracking.imc);
+		os_mutex_destroy(&ipc_c->tracking.mutex);
+		ipc_c->tracking.enabled = false;
+	}
 	ipc_message_channel_close(&ipc_c->imc);
 	os_mutex_destroy(&ipc_c->mutex);
 
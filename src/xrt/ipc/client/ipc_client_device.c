@@ -19,6 +19,7 @@
 #include "util/u_debug.h"
 #include "util/u_device.h"
 
+#include "shared/ipc_pose_ring.h"
 #include "client/ipc_client.h"
 #include "ipc_client_generated.h"
 
@@ -90,6 +91,11 @@ ipc_client_device_get_tracked_pose(struct xrt_device *xdev,
 {
 	ipc_client_device_t *icd = ipc_client_device(xdev);
 
+	// Fast path, no round trip to the service.
+	if (ipc_client_xdev_get_tracked_pose_from_ring(icd, name, at_timestamp_ns, out_relation)) {
+		return;
+	}
+
 	xrt_result_t xret = ipc_call_device_get_tracked_pose( //
 	    icd->ipc_c,                                       //
 	    icd->device_id,                                   //
@@ -199,6 +205,45 @@ ipc_client_device_get_visibility_mask(struct xrt_device *xdev,
 	return XRT_ERROR_IPC_FAILURE;
 }
 
+bool
+ipc_client_xdev_get_tracked_pose_from_ring(struct ipc_client_xdev *icx,
+                                           enum xrt_input_name name,
+                                           int64_t at_timestamp_ns,
+                                           struct xrt_space_relation *out_relation)
+{
+	const struct ipc_shared_memory *ism = icx->ipc_c->ism;
+
+	const struct ipc_shared_pose_ring *ring = ipc_pose_ring_find(ism, icx->device_id, name);
+	if (ring == NULL) {
+		return false;
+	}
+
+	/*
+	 * The service suppresses IO per client and per device, with the same
+	 * exception for the head pose as ipc_handle_device_get_tracked_pose.
+	 * Let it answer when suppressed so we get exactly its behaviour.
+	 */
+	bool io_active = ism->client_io_active[icx->ipc_c->client_index] && ism->isdevs[icx->device_id].io_active;
+	if (!io_active && name != XRT_INPUT_GENERIC_HEAD_POSE) {
+		return false;
+	}
+
+	// Let the service deal with inactive inputs too.
+	bool active = false;
+	for (uint32_t i = 0; i < icx->base.input_count; i++) {
+		if (icx->base.inputs[i].name == name) {
+			active = icx->base.inputs[i].active;
+			break;
+		}
+	}
+
+	if (!active) {
+		return false;
+	}
+
+	return ipc_pose_ring_get(ring, ism->pose_ring_max_prediction_ns, at_timestamp_ns, out_relation);
+}
+
 /*!
  * @public @memberof ipc_client_device
  */
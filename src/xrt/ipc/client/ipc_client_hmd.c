@@ -21,6 +21,7 @@
 #include "util/u_device.h"
 #include "util/u_distortion_mesh.h"
 
+#include "shared/ipc_pose_ring.h"
 #include "client/ipc_client.h"
 #include "client/ipc_client_connection.h"
 #include "ipc_client_generated.h"
@@ -158,6 +159,11 @@ ipc_client_hmd_get_tracked_pose(struct xrt_device *xdev,
 	ipc_client_hmd_t *ich = ipc_client_hmd(xdev);
 	xrt_result_t xret;
 
+	// Fast path, no round trip to the service.
+	if (ipc_client_xdev_get_tracked_pose_from_ring(ich, name, at_timestamp_ns, out_relation)) {
+		return;
+	}
+
 	xret = ipc_call_device_get_tracked_pose( //
 	    ich->ipc_c,                          //
 	    ich->device_id,                      //
@@ -254,6 +260,45 @@ ipc_client_hmd_compute_distortion(
 	return ret;
 }
 
+static bool
+ipc_client_hmd_compute_distortion_grid(struct xrt_device *xdev,
+                                       uint32_t view,
+                                       uint32_t grid_size,
+                                       struct xrt_uv_triplet *out_results)
+{
+	ipc_client_hmd_t *ich = ipc_client_hmd(xdev);
+	struct ipc_connection *ipc_c = ich->ipc_c;
+	xrt_result_t xret;
+
+	if (grid_size > IPC_MAX_DISTORTION_GRID_SIZE) {
+		IPC_ERROR(ipc_c, "Grid size %u is larger than the max %u", grid_size, IPC_MAX_DISTORTION_GRID_SIZE);
+		return false;
+	}
+
+	ipc_client_connection_lock(ipc_c);
+
+	xret = ipc_send_device_compute_distortion_grid_locked(ipc_c, ich->device_id, view, grid_size);
+	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_send_device_compute_distortion_grid_locked", err_unlock);
+
+	bool ret = false;
+	xret = ipc_receive_device_compute_distortion_grid_locked(ipc_c, &ret);
+	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_receive_device_compute_distortion_grid_locked", err_unlock);
+
+	// The service sends the grid one row at a time.
+	for (uint32_t r = 0; ret && r < grid_size; r++) {
+		xret = ipc_receive(&ipc_c->imc, &out_results[r * grid_size], sizeof(*out_results) * grid_size);
+		IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_receive", err_unlock);
+	}
+
+	ipc_client_connection_unlock(ipc_c);
+
+	return ret;
+
+err_unlock:
+	ipc_client_connection_unlock(ipc_c);
+	return false;
+}
+
 static bool
 ipc_client_hmd_is_form_factor_available(struct xrt_device *xdev, enum xrt_form_factor form_factor)
 {
@@ -331,7 +376,6 @@ ipc_client_hmd_create(struct ipc_connection *ipc_c, struct xrt_tracking_origin *
 	ich->base.get_tracked_pose = ipc_client_hmd_get_tracked_pose;
 	ich->base.get_face_tracking = ipc_client_hmd_get_face_tracking;
 	ich->base.get_view_poses = ipc_client_hmd_get_view_poses;
-	ich->base.compute_distortion = ipc_client_hmd_compute_distortion;
 	ich->base.destroy = ipc_client_hmd_destroy;
 	ich->base.is_form_factor_available = ipc_client_hmd_is_form_factor_available;
 	ich->base.get_visibility_mask = ipc_client_hmd_get_visibility_mask;
@@ -381,6 +425,10 @@ ipc_client_hmd_create(struct ipc_connection *ipc_c, struct xrt_tracking_origin *
 	// Distortion information, fills in xdev->compute_distortion().
 	u_distortion_mesh_set_none(&ich->base);
 
+	// The mesh is only a placeholder, forward distortion queries to the service.
+	ich->base.compute_distortion = ipc_client_hmd_compute_distortion;
+	ich->base.compute_distortion_grid = ipc_client_hmd_compute_distortion_grid;
+
 	// Setup variable tracker.
 	u_var_add_root(ich, ich->base.str, true);
 	u_var_add_ro_u32(ich, &ich->device_id, "device_id");
@@ -8,13 +8,13 @@
  */
 
 #include "client/ipc_client.h"
-#include "client/ipc_client_connection.h"
-#include "shared/ipc_message_channel.h"
 #include "xrt/xrt_defines.h"
 #include "xrt/xrt_space.h"
 
 #include "ipc_client_generated.h"
 
+#include <string.h>
+
 
 struct ipc_client_space
 {
@@ -170,48 +170,37 @@ locate_spaces(struct xrt_space_overseer *xso,
 
 	struct ipc_client_space *icsp_base_space = ipc_client_space(base_space);
 
-	uint32_t *space_ids = U_TYPED_ARRAY_CALLOC(uint32_t, space_count);
-	if (space_ids == NULL) {
-		IPC_ERROR(ipc_c, "Failed to allocate space_ids");
-		return XRT_ERROR_ALLOCATION;
-	}
-
-	ipc_client_connection_lock(ipc_c);
-
-	xret =
-	    ipc_send_space_locate_spaces_locked(ipc_c, icsp_base_space->id, base_offset, space_count, at_timestamp_ns);
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_send_space_locate_spaces_locked", locate_spaces_out);
-
-	enum xrt_result received_result = XRT_SUCCESS;
-	xret = ipc_receive(&ipc_c->imc, &received_result, sizeof(enum xrt_result));
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_receive: Receive spaces allocation result", locate_spaces_out);
+	// Fixed size, so no allocation, zero to not send stack garbage.
+	struct ipc_space_locate_spaces_info info = {0};
+	struct ipc_space_locate_spaces_relations relations;
 
-	// now check if the service sent a success code or an error code about allocating memory for spaces.
-	xret = received_result;
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_receive: service side spaces allocation failed", locate_spaces_out);
-
-	for (uint32_t i = 0; i < space_count; i++) {
-		if (spaces[i] == NULL) {
-			space_ids[i] = UINT32_MAX;
-		} else {
-			struct ipc_client_space *icsp_space = ipc_client_space(spaces[i]);
-			space_ids[i] = icsp_space->id;
+	// Almost always a single call, split up if there are a lot of spaces.
+	for (uint32_t first = 0; first < space_count; first += IPC_MAX_LOCATE_SPACES) {
+		uint32_t count = space_count - first;
+		if (count > IPC_MAX_LOCATE_SPACES) {
+			count = IPC_MAX_LOCATE_SPACES;
 		}
-	}
 
-	xret = ipc_send(&ipc_c->imc, space_ids, sizeof(uint32_t) * space_count);
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_send: Send spaces ids", locate_spaces_out);
+		info.space_count = count;
+		for (uint32_t i = 0; i < count; i++) {
+			struct xrt_space *xs = spaces[first + i];
+			info.space_ids[i] = xs == NULL ? UINT32_MAX : ipc_client_space(xs)->id;
+			info.offsets[i] = offsets[first + i];
+		}
 
-	xret = ipc_send(&ipc_c->imc, offsets, sizeof(struct xrt_pose) * space_count);
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_send: Send spaces offsets", locate_spaces_out);
+		xret = ipc_call_space_locate_spaces( //
+		    ipc_c,                           //
+		    icsp_base_space->id,             //
+		    base_offset,                     //
+		    at_timestamp_ns,                 //
+		    &info,                           //
+		    &relations);                     //
+		IPC_CHK_AND_RET(ipc_c, xret, "ipc_call_space_locate_spaces");
 
-	xret = ipc_receive(&ipc_c->imc, out_relations, sizeof(struct xrt_space_relation) * space_count);
-	IPC_CHK_WITH_GOTO(ipc_c, xret, "ipc_receive: Receive spaces relations", locate_spaces_out);
+		memcpy(&out_relations[first], relations.relations, sizeof(struct xrt_space_relation) * count);
+	}
 
-locate_spaces_out:
-	free(space_ids);
-	ipc_client_connection_unlock(ipc_c);
-	return xret;
+	return XRT_SUCCESS;
 }
 
 static xrt_result_t
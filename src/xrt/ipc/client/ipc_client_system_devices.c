@@ -13,6 +13,8 @@
 
 #include "util/u_system_helpers.h"
 
+#include <assert.h>
+
 
 struct ipc_client_system_devices
 {
@@ -53,6 +55,34 @@ ipc_client_system_devices_get_roles(struct xrt_system_devices *xsysd, struct xrt
 	return ipc_call_system_devices_get_roles(usysd->ipc_c, out_roles);
 }
 
+static xrt_result_t
+ipc_client_system_devices_update_inputs(struct xrt_system_devices *xsysd)
+{
+	struct ipc_client_system_devices *usysd = ipc_system_devices(xsysd);
+	xrt_result_t xret;
+
+	static_assert(XRT_SYSTEM_MAX_DEVICES <= 32, "Device mask too small");
+
+	// All of the devices are IPC client devices, one bit per device id.
+	uint32_t device_mask = 0;
+	for (size_t i = 0; i < xsysd->xdev_count; i++) {
+		struct xrt_device *xdev = xsysd->xdevs[i];
+		if (xdev == NULL) {
+			continue;
+		}
+
+		device_mask |= 1u << ipc_client_xdev(xdev)->device_id;
+	}
+
+	if (device_mask == 0) {
+		return XRT_SUCCESS;
+	}
+
+	// The service writes the new input state into the shared memory.
+	xret = ipc_call_system_devices_update_inputs(usysd->ipc_c, device_mask);
+	IPC_CHK_ALWAYS_RET(usysd->ipc_c, xret, "ipc_call_system_devices_update_inputs");
+}
+
 static xrt_result_t
 ipc_client_system_devices_feature_inc(struct xrt_system_devices *xsysd, enum xrt_device_feature_type type)
 {
@@ -110,6 +140,7 @@ ipc_client_system_devices_create(struct ipc_connection *ipc_c)
 {
 	struct ipc_client_system_devices *icsd = U_TYPED_CALLOC(struct ipc_client_system_devices);
 	icsd->base.base.get_roles = ipc_client_system_devices_get_roles;
+	icsd->base.base.update_inputs = ipc_client_system_devices_update_inputs;
 	icsd->base.base.destroy = ipc_client_system_devices_destroy;
 	icsd->base.base.feature_inc = ipc_client_system_devices_feature_inc;
 	icsd->base.base.feature_dec = ipc_client_system_devices_feature_dec;
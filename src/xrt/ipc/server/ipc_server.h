@@ -128,6 +128,12 @@ struct ipc_client_state
 	//! Ptrs to the spaces.
 	struct xrt_space *xspcs[IPC_MAX_CLIENT_SPACES];
 
+	/*!
+	 * Protects @ref xspcs, the tracking channel thread looks up spaces while
+	 * the main channel thread creates and destroys them.
+	 */
+	struct os_mutex space_mutex;
+
 	//! Which of the references spaces is the client using.
 	bool ref_space_used[XRT_SPACE_REFERENCE_TYPE_COUNT];
 
@@ -137,6 +143,18 @@ struct ipc_client_state
 	//! Socket fd used for client comms
 	struct ipc_message_channel imc;
 
+	/*!
+	 * Optional second channel from the client that only carries the pose
+	 * and input calls, served by its own thread, see
+	 * @ref ipc_dispatch_tracking.
+	 */
+	struct
+	{
+		struct ipc_message_channel imc;
+		struct os_thread thread;
+		bool thread_started;
+	} tracking;
+
 	struct ipc_app_state client_state;
 
 	int server_thread_index;
@@ -349,6 +367,27 @@ struct ipc_server
 	struct ipc_shared_memory *ism;
 	xrt_shmem_handle_t ism_handle;
 
+	//! Size in bytes of the shared memory, depends on @ref max_clients.
+	size_t ism_size;
+
+	/*!
+	 * Layout of the layer slots, the same as @ref ipc_shared_memory::slots
+	 * but not writable by clients, only these are used to find slots.
+	 */
+	struct
+	{
+		size_t offset;
+		size_t stride;
+		uint32_t count;
+		uint32_t layer_capacity;
+	} slots;
+
+	//! Samples device poses into the shared memory pose rings.
+	struct os_thread_helper pose_publisher;
+
+	//! Period between pose samples, zero if poses are not published.
+	int64_t pose_publish_period_ns;
+
 	struct ipc_server_mainloop ml;
 
 	// Is the mainloop supposed to run.
@@ -359,9 +398,11 @@ struct ipc_server
 
 	enum u_logging_level log_level;
 
-	struct ipc_thread threads[IPC_MAX_CLIENTS];
+	//! Number of clients that can be connected at once, at most @ref IPC_MAX_CLIENTS.
+	uint32_t max_clients;
 
-	volatile uint32_t current_slot_index;
+	//! Array of @ref max_clients threads, also picks each client's layer slots.
+	struct ipc_thread *threads;
 
 	//! Generator for IDs.
 	uint32_t id_generator;
@@ -439,6 +480,15 @@ ipc_server_client_thread(void *_ics);
 void
 ipc_server_client_destroy_session_and_compositor(volatile struct ipc_client_state *ics);
 
+/*!
+ * Take ownership of @p ipc_handle and start serving the tracking channel on
+ * it from a new thread, the thread is stopped when the client disconnects.
+ *
+ * @ingroup ipc_server
+ */
+xrt_result_t
+ipc_server_client_attach_tracking_channel(volatile struct ipc_client_state *ics, xrt_ipc_handle_t ipc_handle);
+
 /*!
  * @defgroup ipc_server_internals Server Internals
  * @brief These are only called by the platform-specific mainloop polling code.
@@ -13,6 +13,7 @@
 #include "util/u_handles.h"
 #include "util/u_pretty_print.h"
 #include "util/u_visibility_mask.h"
+#include "util/u_distortion_mesh.h"
 #include "util/u_trace_marker.h"
 
 #include "server/ipc_server.h"
@@ -22,6 +23,8 @@
 #include <unistd.h>
 #endif
 
+#include <assert.h>
+
 
 /*
  *
@@ -125,6 +128,11 @@ validate_device_feature_type(volatile struct ipc_client_state *ics, enum xrt_dev
 }
 
 
+/*!
+ * Looks up the space and takes a reference to it, the caller must release it.
+ * The space can be destroyed on the main channel while a tracking channel call
+ * is still using it.
+ */
 static xrt_result_t
 validate_space_id(volatile struct ipc_client_state *ics, int64_t space_id, struct xrt_space **out_xspc)
 {
@@ -136,15 +144,38 @@ validate_space_id(volatile struct ipc_client_state *ics, int64_t space_id, struc
 		return XRT_ERROR_IPC_FAILURE;
 	}
 
-	if (ics->xspcs[space_id] == NULL) {
+	// Cast away volatile.
+	os_mutex_lock((struct os_mutex *)&ics->space_mutex);
+	xrt_space_reference(out_xspc, (struct xrt_space *)ics->xspcs[space_id]);
+	os_mutex_unlock((struct os_mutex *)&ics->space_mutex);
+
+	if (*out_xspc == NULL) {
 		return XRT_ERROR_IPC_FAILURE;
 	}
 
-	*out_xspc = (struct xrt_space *)ics->xspcs[space_id];
-
 	return XRT_SUCCESS;
 }
 
+/*!
+ * Replaces the space at @p id, takes @ref ipc_client_state::space_mutex so
+ * the tracking channel thread never sees a space being destroyed.
+ */
+static void
+set_space(volatile struct ipc_client_state *ics, uint32_t id, struct xrt_space *xs)
+{
+	struct xrt_space *old = NULL;
+
+	// Cast away volatile.
+	os_mutex_lock((struct os_mutex *)&ics->space_mutex);
+	old = (struct xrt_space *)ics->xspcs[id];
+	ics->xspcs[id] = NULL;
+	xrt_space_reference((struct xrt_space **)&ics->xspcs[id], xs);
+	os_mutex_unlock((struct os_mutex *)&ics->space_mutex);
+
+	// Release the old one outside of the lock, it might be the last reference.
+	xrt_space_reference(&old, NULL);
+}
+
 static xrt_result_t
 get_new_space_id(volatile struct ipc_client_state *ics, uint32_t *out_id)
 {
@@ -175,9 +206,7 @@ track_space(volatile struct ipc_client_state *ics, struct xrt_space *xs, uint32_
 		return xret;
 	}
 
-	// Remove volatile
-	struct xrt_space **xs_ptr = (struct xrt_space **)&ics->xspcs[id];
-	xrt_space_reference(xs_ptr, xs);
+	set_space(ics, id, xs);
 
 	*out_id = id;
 
@@ -258,16 +287,14 @@ create_localspace(volatile struct ipc_client_state *ics, uint32_t *out_local_id,
 	}
 
 	struct xrt_space_overseer *xso = ics->server->xso;
-	struct xrt_space **xslocal_ptr = (struct xrt_space **)&ics->xspcs[local_id];
-	struct xrt_space **xslocalfloor_ptr = (struct xrt_space **)&ics->xspcs[local_floor_id];
 
 	xret = xrt_space_overseer_create_local_space(xso, &xso->localspace[ics->local_space_overseer_index],
 	                                             &xso->localfloorspace[ics->local_floor_space_overseer_index]);
 	if (xret != XRT_SUCCESS) {
 		return xret;
 	}
-	xrt_space_reference(xslocal_ptr, xso->localspace[ics->local_space_overseer_index]);
-	xrt_space_reference(xslocalfloor_ptr, xso->localfloorspace[ics->local_floor_space_overseer_index]);
+	set_space(ics, local_id, xso->localspace[ics->local_space_overseer_index]);
+	set_space(ics, local_floor_id, xso->localfloorspace[ics->local_floor_space_overseer_index]);
 	*out_local_id = local_id;
 	*out_local_floor_id = local_floor_id;
 
@@ -282,6 +309,9 @@ create_localspace(volatile struct ipc_client_state *ics, uint32_t *out_local_id,
 
 xrt_result_t
 ipc_handle_instance_get_shm_fd(volatile struct ipc_client_state *ics,
+                               uint64_t *out_size,
+                               uint32_t *out_first_slot_id,
+                               uint32_t *out_client_index,
                                uint32_t max_handle_capacity,
                                xrt_shmem_handle_t *out_handles,
                                uint32_t *out_handle_count)
@@ -293,6 +323,11 @@ ipc_handle_instance_get_shm_fd(volatile struct ipc_client_state *ics,
 	out_handles[0] = ics->server->ism_handle;
 	*out_handle_count = 1;
 
+	// Each client gets its own slots, picked by the thread serving it.
+	*out_size = ics->server->ism_size;
+	*out_first_slot_id = (uint32_t)ics->server_thread_index * IPC_SLOTS_PER_CLIENT;
+	*out_client_index = (uint32_t)ics->server_thread_index;
+
 	return XRT_SUCCESS;
 }
 
@@ -341,6 +376,24 @@ ipc_handle_instance_describe_client(volatile struct ipc_client_state *ics,
 	return XRT_SUCCESS;
 }
 
+xrt_result_t
+ipc_handle_instance_attach_tracking_channel(volatile struct ipc_client_state *ics,
+                                            const xrt_ipc_handle_t *handles,
+                                            const uint32_t handle_count)
+{
+	// Close any extra handles, only the first one is used.
+	for (uint32_t i = 1; i < handle_count; i++) {
+		xrt_ipc_handle_close(handles[i]);
+	}
+
+	if (handle_count < 1) {
+		IPC_ERROR(ics->server, "No handle given for tracking channel!");
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	return ipc_server_client_attach_tracking_channel(ics, handles[0]);
+}
+
 xrt_result_t
 ipc_handle_system_compositor_get_info(volatile struct ipc_client_state *ics,
                                       struct xrt_system_compositor_info *out_info)
@@ -516,6 +569,7 @@ ipc_handle_space_create_offset(volatile struct ipc_client_state *ics,
 
 	struct xrt_space *xs = NULL;
 	xret = xrt_space_overseer_create_offset_space(xso, parent, offset, &xs);
+	xrt_space_reference(&parent, NULL);
 	if (xret != XRT_SUCCESS) {
 		return xret;
 	}
@@ -598,10 +652,11 @@ ipc_handle_space_locate_space(volatile struct ipc_client_state *ics,
 	xret = validate_space_id(ics, space_id, &space);
 	if (xret != XRT_SUCCESS) {
 		U_LOG_E("Invalid space_id!");
+		xrt_space_reference(&base_space, NULL);
 		return xret;
 	}
 
-	return xrt_space_overseer_locate_space( //
+	xret = xrt_space_overseer_locate_space( //
 	    xso,                                //
 	    base_space,                         //
 	    base_offset,                        //
@@ -609,85 +664,55 @@ ipc_handle_space_locate_space(volatile struct ipc_client_state *ics,
 	    space,                              //
 	    offset,                             //
 	    out_relation);                      //
+
+	xrt_space_reference(&base_space, NULL);
+	xrt_space_reference(&space, NULL);
+
+	return xret;
 }
 
+// The client loop reads whole messages into a buffer of this size.
+static_assert(sizeof(struct ipc_space_locate_spaces_msg) <= IPC_BUF_SIZE, "IPC_BUF_SIZE too small");
+
 xrt_result_t
 ipc_handle_space_locate_spaces(volatile struct ipc_client_state *ics,
                                uint32_t base_space_id,
                                const struct xrt_pose *base_offset,
-                               uint32_t space_count,
-                               int64_t at_timestamp)
+                               int64_t at_timestamp,
+                               const struct ipc_space_locate_spaces_info *info,
+                               struct ipc_space_locate_spaces_relations *out_relations)
 {
 	IPC_TRACE_MARKER();
-	struct ipc_message_channel *imc = (struct ipc_message_channel *)&ics->imc;
-	struct ipc_server *s = ics->server;
 
 	struct xrt_space_overseer *xso = ics->server->xso;
 	struct xrt_space *base_space = NULL;
-
-	struct xrt_space **xspaces = U_TYPED_ARRAY_CALLOC(struct xrt_space *, space_count);
-	struct xrt_pose *offsets = U_TYPED_ARRAY_CALLOC(struct xrt_pose, space_count);
-	struct xrt_space_relation *out_relations = U_TYPED_ARRAY_CALLOC(struct xrt_space_relation, space_count);
-
+	struct xrt_space *xspaces[IPC_MAX_LOCATE_SPACES] = {0};
+	uint32_t space_count = info->space_count;
 	xrt_result_t xret;
 
-	os_mutex_lock(&ics->server->global_state.lock);
-
-	uint32_t *space_ids = U_TYPED_ARRAY_CALLOC(uint32_t, space_count);
-
-	// we need to send back whether allocation succeeded so the client knows whether to send more data
-	if (space_ids == NULL) {
-		xret = XRT_ERROR_ALLOCATION;
-	} else {
-		xret = XRT_SUCCESS;
-	}
-
-	xret = ipc_send(imc, &xret, sizeof(enum xrt_result));
-	if (xret != XRT_SUCCESS) {
-		IPC_ERROR(ics->server, "Failed to send spaces allocate result");
-		// Nothing else we can do
-		goto out_locate_spaces;
-	}
-
-	// only after sending the allocation result can we skip to the end in the allocation error case
-	if (space_ids == NULL) {
-		IPC_ERROR(s, "Failed to allocate space for receiving spaces ids");
-		goto out_locate_spaces;
-	}
-
-	xret = ipc_receive(imc, space_ids, space_count * sizeof(uint32_t));
-	if (xret != XRT_SUCCESS) {
-		IPC_ERROR(ics->server, "Failed to receive spaces ids");
-		// assume early abort is possible, i.e. client will not send more data for this request
-		goto out_locate_spaces;
-	}
-
-	xret = ipc_receive(imc, offsets, space_count * sizeof(struct xrt_pose));
-	if (xret != XRT_SUCCESS) {
-		IPC_ERROR(ics->server, "Failed to receive spaces offsets");
-		// assume early abort is possible, i.e. client will not send more data for this request
-		goto out_locate_spaces;
+	if (space_count > IPC_MAX_LOCATE_SPACES) {
+		IPC_ERROR(ics->server, "Too many spaces %u > %u!", space_count, IPC_MAX_LOCATE_SPACES);
+		return XRT_ERROR_IPC_FAILURE;
 	}
 
 	xret = validate_space_id(ics, base_space_id, &base_space);
 	if (xret != XRT_SUCCESS) {
 		U_LOG_E("Invalid base_space_id %d!", base_space_id);
-		// Client is receiving out_relations now, it will get xret on this receive.
-		goto out_locate_spaces;
+		return xret;
 	}
 
 	for (uint32_t i = 0; i < space_count; i++) {
-		if (space_ids[i] == UINT32_MAX) {
-			xspaces[i] = NULL;
-		} else {
-			xret = validate_space_id(ics, space_ids[i], &xspaces[i]);
-			if (xret != XRT_SUCCESS) {
-				U_LOG_E("Invalid space_id space_ids[%d] = %d!", i, space_ids[i]);
-				// Client is receiving out_relations now, it will get xret on this receive.
-				goto out_locate_spaces;
-			}
+		if (info->space_ids[i] == UINT32_MAX) {
+			continue;
+		}
+
+		xret = validate_space_id(ics, info->space_ids[i], &xspaces[i]);
+		if (xret != XRT_SUCCESS) {
+			U_LOG_E("Invalid space_id space_ids[%d] = %d!", i, info->space_ids[i]);
+			goto out_release;
 		}
 	}
+
 	xret = xrt_space_overseer_locate_spaces( //
 	    xso,                                 //
 	    base_space,                          //
@@ -695,21 +720,15 @@ ipc_handle_space_locate_spaces(volatile struct ipc_client_state *ics,
 	    at_timestamp,                        //
 	    xspaces,                             //
 	    space_count,                         //
-	    offsets,                             //
-	    out_relations);                      //
+	    info->offsets,                       //
+	    out_relations->relations);           //
 
-	xret = ipc_send(imc, out_relations, sizeof(struct xrt_space_relation) * space_count);
-	if (xret != XRT_SUCCESS) {
-		IPC_ERROR(ics->server, "Failed to send spaces relations");
-		// Nothing else we can do
-		goto out_locate_spaces;
+out_release:
+	for (uint32_t i = 0; i < space_count; i++) {
+		xrt_space_reference(&xspaces[i], NULL);
 	}
+	xrt_space_reference(&base_space, NULL);
 
-out_locate_spaces:
-	free(xspaces);
-	free(offsets);
-	free(out_relations);
-	os_mutex_unlock(&ics->server->global_state.lock);
 	return xret;
 }
 
@@ -737,16 +756,21 @@ ipc_handle_space_locate_device(volatile struct ipc_client_state *ics,
 	xret = validate_device_id(ics, xdev_id, &xdev);
 	if (xret != XRT_SUCCESS) {
 		U_LOG_E("Invalid device_id!");
+		xrt_space_reference(&base_space, NULL);
 		return xret;
 	}
 
-	return xrt_space_overseer_locate_device( //
+	xret = xrt_space_overseer_locate_device( //
 	    xso,                                 //
 	    base_space,                          //
 	    base_offset,                         //
 	    at_timestamp,                        //
 	    xdev,                                //
 	    out_relation);                       //
+
+	xrt_space_reference(&base_space, NULL);
+
+	return xret;
 }
 
 xrt_result_t
@@ -762,11 +786,9 @@ ipc_handle_space_destroy(volatile struct ipc_client_state *ics, uint32_t space_i
 	}
 
 	assert(xs != NULL);
-	xs = NULL;
+	xrt_space_reference(&xs, NULL);
 
-	// Remove volatile
-	struct xrt_space **xs_ptr = (struct xrt_space **)&ics->xspcs[space_id];
-	xrt_space_reference(xs_ptr, NULL);
+	set_space(ics, space_id, NULL);
 
 	if (space_id == ics->local_space_index) {
 		struct xrt_space **xslocal_ptr =
@@ -1016,17 +1038,30 @@ ipc_handle_compositor_set_performance_level(volatile struct ipc_client_state *ic
 	return xrt_comp_set_performance_level(ics->xc, domain, level);
 }
 
+/*!
+ * Get a swapchain used by a layer, the id comes from the client.
+ */
+static struct xrt_swapchain *
+get_layer_swapchain(volatile struct ipc_client_state *ics, uint32_t swapchain_id)
+{
+	if (swapchain_id >= IPC_MAX_CLIENT_SWAPCHAINS) {
+		return NULL;
+	}
+
+	return ics->xscs[swapchain_id];
+}
+
 static bool
 _update_projection_layer(struct xrt_compositor *xc,
                          volatile struct ipc_client_state *ics,
-                         volatile struct ipc_layer_entry *layer,
+                         const struct ipc_layer_entry *layer,
                          uint32_t i)
 {
 	// xdev
 	uint32_t device_id = layer->xdev_id;
-	struct xrt_device *xdev = get_xdev(ics, device_id);
+	struct xrt_device *xdev = NULL;
 
-	if (xdev == NULL) {
+	if (validate_device_id(ics, device_id, &xdev) != XRT_SUCCESS || xdev->hmd == NULL) {
 		U_LOG_E("Invalid xdev for projection layer!");
 		return false;
 	}
@@ -1035,19 +1070,14 @@ _update_projection_layer(struct xrt_compositor *xc,
 
 	struct xrt_swapchain *xcs[XRT_MAX_VIEWS];
 	for (uint32_t k = 0; k < view_count; k++) {
-		const uint32_t xsci = layer->swapchain_ids[k];
-		xcs[k] = ics->xscs[xsci];
+		xcs[k] = get_layer_swapchain(ics, layer->swapchain_ids[k]);
 		if (xcs[k] == NULL) {
 			U_LOG_E("Invalid swap chain for projection layer!");
 			return false;
 		}
 	}
 
-
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
-
-	xrt_comp_layer_projection(xc, xdev, xcs, data);
+	xrt_comp_layer_projection(xc, xdev, xcs, &layer->data);
 
 	return true;
 }
@@ -1055,30 +1085,31 @@ _update_projection_layer(struct xrt_compositor *xc,
 static bool
 _update_projection_layer_depth(struct xrt_compositor *xc,
                                volatile struct ipc_client_state *ics,
-                               volatile struct ipc_layer_entry *layer,
+                               const struct ipc_layer_entry *layer,
                                uint32_t i)
 {
 	// xdev
 	uint32_t xdevi = layer->xdev_id;
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+	const struct xrt_layer_data *data = &layer->data;
 
-	struct xrt_device *xdev = get_xdev(ics, xdevi);
-	if (xdev == NULL) {
+	struct xrt_device *xdev = NULL;
+	if (validate_device_id(ics, xdevi, &xdev) != XRT_SUCCESS) {
 		U_LOG_E("Invalid xdev for projection layer #%u!", i);
 		return false;
 	}
 
+	if (data->view_count > XRT_MAX_VIEWS) {
+		U_LOG_E("Invalid view count %u for projection layer #%u!", data->view_count, i);
+		return false;
+	}
+
 	struct xrt_swapchain *xcs[XRT_MAX_VIEWS];
 	struct xrt_swapchain *d_xcs[XRT_MAX_VIEWS];
 
 	for (uint32_t j = 0; j < data->view_count; j++) {
-		int xsci = layer->swapchain_ids[j];
-		int d_xsci = layer->swapchain_ids[j + data->view_count];
-
-		xcs[j] = ics->xscs[xsci];
-		d_xcs[j] = ics->xscs[d_xsci];
+		xcs[j] = get_layer_swapchain(ics, layer->swapchain_ids[j]);
+		d_xcs[j] = get_layer_swapchain(ics, layer->swapchain_ids[j + data->view_count]);
 		if (xcs[j] == NULL || d_xcs[j] == NULL) {
 			U_LOG_E("Invalid swap chain for projection layer #%u!", i);
 			return false;
@@ -1093,35 +1124,32 @@ _update_projection_layer_depth(struct xrt_compositor *xc,
 static bool
 do_single(struct xrt_compositor *xc,
           volatile struct ipc_client_state *ics,
-          volatile struct ipc_layer_entry *layer,
+          const struct ipc_layer_entry *layer,
           uint32_t i,
           const char *name,
           struct xrt_device **out_xdev,
           struct xrt_swapchain **out_xcs,
-          struct xrt_layer_data **out_data)
+          const struct xrt_layer_data **out_data)
 {
 	uint32_t device_id = layer->xdev_id;
 	uint32_t sci = layer->swapchain_ids[0];
 
-	struct xrt_device *xdev = get_xdev(ics, device_id);
-	struct xrt_swapchain *xcs = ics->xscs[sci];
+	struct xrt_device *xdev = NULL;
+	struct xrt_swapchain *xcs = get_layer_swapchain(ics, sci);
 
 	if (xcs == NULL) {
 		U_LOG_E("Invalid swapchain for layer #%u, '%s'!", i, name);
 		return false;
 	}
 
-	if (xdev == NULL) {
+	if (validate_device_id(ics, device_id, &xdev) != XRT_SUCCESS) {
 		U_LOG_E("Invalid xdev for layer #%u, '%s'!", i, name);
 		return false;
 	}
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
-
 	*out_xdev = xdev;
 	*out_xcs = xcs;
-	*out_data = data;
+	*out_data = &layer->data;
 
 	return true;
 }
@@ -1129,12 +1157,12 @@ do_single(struct xrt_compositor *xc,
 static bool
 _update_quad_layer(struct xrt_compositor *xc,
                    volatile struct ipc_client_state *ics,
-                   volatile struct ipc_layer_entry *layer,
+                   const struct ipc_layer_entry *layer,
                    uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "quad", &xdev, &xcs, &data)) {
 		return false;
@@ -1148,12 +1176,12 @@ _update_quad_layer(struct xrt_compositor *xc,
 static bool
 _update_cube_layer(struct xrt_compositor *xc,
                    volatile struct ipc_client_state *ics,
-                   volatile struct ipc_layer_entry *layer,
+                   const struct ipc_layer_entry *layer,
                    uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "cube", &xdev, &xcs, &data)) {
 		return false;
@@ -1167,12 +1195,12 @@ _update_cube_layer(struct xrt_compositor *xc,
 static bool
 _update_cylinder_layer(struct xrt_compositor *xc,
                        volatile struct ipc_client_state *ics,
-                       volatile struct ipc_layer_entry *layer,
+                       const struct ipc_layer_entry *layer,
                        uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "cylinder", &xdev, &xcs, &data)) {
 		return false;
@@ -1186,12 +1214,12 @@ _update_cylinder_layer(struct xrt_compositor *xc,
 static bool
 _update_equirect1_layer(struct xrt_compositor *xc,
                         volatile struct ipc_client_state *ics,
-                        volatile struct ipc_layer_entry *layer,
+                        const struct ipc_layer_entry *layer,
                         uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "equirect1", &xdev, &xcs, &data)) {
 		return false;
@@ -1205,12 +1233,12 @@ _update_equirect1_layer(struct xrt_compositor *xc,
 static bool
 _update_equirect2_layer(struct xrt_compositor *xc,
                         volatile struct ipc_client_state *ics,
-                        volatile struct ipc_layer_entry *layer,
+                        const struct ipc_layer_entry *layer,
                         uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "equirect2", &xdev, &xcs, &data)) {
 		return false;
@@ -1224,83 +1252,141 @@ _update_equirect2_layer(struct xrt_compositor *xc,
 static bool
 _update_passthrough_layer(struct xrt_compositor *xc,
                           volatile struct ipc_client_state *ics,
-                          volatile struct ipc_layer_entry *layer,
+                          const struct ipc_layer_entry *layer,
                           uint32_t i)
 {
 	// xdev
 	uint32_t xdevi = layer->xdev_id;
 
-	struct xrt_device *xdev = get_xdev(ics, xdevi);
+	struct xrt_device *xdev = NULL;
 
-	if (xdev == NULL) {
+	if (validate_device_id(ics, xdevi, &xdev) != XRT_SUCCESS) {
 		U_LOG_E("Invalid xdev for passthrough layer #%u!", i);
 		return false;
 	}
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
-
-	xrt_comp_layer_passthrough(xc, xdev, data);
+	xrt_comp_layer_passthrough(xc, xdev, &layer->data);
 
 	return true;
 }
 
 static bool
-_update_layers(volatile struct ipc_client_state *ics, struct xrt_compositor *xc, struct ipc_layer_slot *slot)
+_update_layers(volatile struct ipc_client_state *ics,
+               struct xrt_compositor *xc,
+               volatile struct ipc_layer_slot *slot,
+               uint32_t layer_count)
 {
 	IPC_TRACE_MARKER();
 
-	for (uint32_t i = 0; i < slot->layer_count; i++) {
-		volatile struct ipc_layer_entry *layer = &slot->layers[i];
+	for (uint32_t i = 0; i < layer_count; i++) {
+		/*
+		 * The client can still write to the shared memory, copy the
+		 * layer so what is checked below is also what gets used.
+		 * Cast away volatile, the copy is only read once.
+		 */
+		struct ipc_layer_entry layer;
+		memcpy(&layer, (const void *)&slot->layers[i], sizeof(layer));
 
-		switch (layer->data.type) {
+		switch (layer.data.type) {
 		case XRT_LAYER_PROJECTION:
-			if (!_update_projection_layer(xc, ics, layer, i)) {
+			if (!_update_projection_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_PROJECTION_DEPTH:
-			if (!_update_projection_layer_depth(xc, ics, layer, i)) {
+			if (!_update_projection_layer_depth(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_QUAD:
-			if (!_update_quad_layer(xc, ics, layer, i)) {
+			if (!_update_quad_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_CUBE:
-			if (!_update_cube_layer(xc, ics, layer, i)) {
+			if (!_update_cube_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_CYLINDER:
-			if (!_update_cylinder_layer(xc, ics, layer, i)) {
+			if (!_update_cylinder_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_EQUIRECT1:
-			if (!_update_equirect1_layer(xc, ics, layer, i)) {
+			if (!_update_equirect1_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_EQUIRECT2:
-			if (!_update_equirect2_layer(xc, ics, layer, i)) {
+			if (!_update_equirect2_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
 		case XRT_LAYER_PASSTHROUGH:
-			if (!_update_passthrough_layer(xc, ics, layer, i)) {
+			if (!_update_passthrough_layer(xc, ics, &layer, i)) {
 				return false;
 			}
 			break;
-		default: U_LOG_E("Unhandled layer type '%i'!", layer->data.type); break;
+		default: U_LOG_E("Unhandled layer type '%i'!", layer.data.type); break;
 		}
 	}
 
 	return true;
 }
 
+/*!
+ * Get the layer slot the client filled in, it can only use its own slots.
+ * The slot is located with the layout kept in @ref ipc_server, the copy in
+ * the shared memory can be changed by the client. The frame data and layer
+ * count are copied out and the layer count is checked.
+ */
+static xrt_result_t
+_get_layer_slot(volatile struct ipc_client_state *ics,
+                uint32_t slot_id,
+                volatile struct ipc_layer_slot **out_slot,
+                struct xrt_layer_frame_data *out_data,
+                uint32_t *out_layer_count)
+{
+	struct ipc_server *s = ics->server;
+	uint32_t first_slot_id = (uint32_t)ics->server_thread_index * IPC_SLOTS_PER_CLIENT;
+
+	if (slot_id < first_slot_id || slot_id >= first_slot_id + IPC_SLOTS_PER_CLIENT ||
+	    slot_id >= s->slots.count) {
+		IPC_ERROR(s, "Invalid slot_id %u, client owns [%u, %u)", slot_id, first_slot_id,
+		          first_slot_id + IPC_SLOTS_PER_CLIENT);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	volatile struct ipc_layer_slot *slot =
+	    (volatile struct ipc_layer_slot *)((uint8_t *)s->ism + s->slots.offset + s->slots.stride * slot_id);
+
+	uint32_t layer_count = slot->layer_count;
+	if (layer_count > s->slots.layer_capacity) {
+		IPC_ERROR(s, "Layer count %u larger than slot capacity %u", layer_count, s->slots.layer_capacity);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	*out_slot = slot;
+	// Cast away volatile.
+	memcpy(out_data, (const void *)&slot->data, sizeof(*out_data));
+	*out_layer_count = layer_count;
+
+	return XRT_SUCCESS;
+}
+
+/*!
+ * The server is done with @p slot_id once the sync call returns, so the
+ * client only ever needs to alternate between its slots.
+ */
+static uint32_t
+_next_free_slot_id(volatile struct ipc_client_state *ics, uint32_t slot_id)
+{
+	uint32_t first_slot_id = (uint32_t)ics->server_thread_index * IPC_SLOTS_PER_CLIENT;
+
+	return first_slot_id + (slot_id - first_slot_id + 1) % IPC_SLOTS_PER_CLIENT;
+}
+
 xrt_result_t
 ipc_handle_compositor_layer_sync(volatile struct ipc_client_state *ics,
                                  uint32_t slot_id,
@@ -1314,8 +1400,6 @@ ipc_handle_compositor_layer_sync(volatile struct ipc_client_state *ics,
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
-	struct ipc_shared_memory *ism = ics->server->ism;
-	struct ipc_layer_slot *slot = &ism->slots[slot_id];
 	xrt_graphics_sync_handle_t sync_handle = XRT_GRAPHICS_SYNC_HANDLE_INVALID;
 
 	// If we have one or more save the first handle.
@@ -1330,31 +1414,28 @@ ipc_handle_compositor_layer_sync(volatile struct ipc_client_state *ics,
 		u_graphics_sync_unref(&tmp);
 	}
 
-	// Copy current slot data.
-	struct ipc_layer_slot copy = *slot;
+	volatile struct ipc_layer_slot *slot = NULL;
+	struct xrt_layer_frame_data data;
+	uint32_t layer_count = 0;
+
+	xrt_result_t xret = _get_layer_slot(ics, slot_id, &slot, &data, &layer_count);
+	if (xret != XRT_SUCCESS) {
+		u_graphics_sync_unref(&sync_handle);
+		return xret;
+	}
 
 
 	/*
 	 * Transfer data to underlying compositor.
 	 */
 
-	xrt_comp_layer_begin(ics->xc, &copy.data);
+	xrt_comp_layer_begin(ics->xc, &data);
 
-	_update_layers(ics, ics->xc, &copy);
+	_update_layers(ics, ics->xc, slot, layer_count);
 
 	xrt_comp_layer_commit(ics->xc, sync_handle);
 
-
-	/*
-	 * Manage shared state.
-	 */
-
-	os_mutex_lock(&ics->server->global_state.lock);
-
-	*out_free_slot_id = (ics->server->current_slot_index + 1) % IPC_MAX_SLOTS;
-	ics->server->current_slot_index = *out_free_slot_id;
-
-	os_mutex_unlock(&ics->server->global_state.lock);
+	*out_free_slot_id = _next_free_slot_id(ics, slot_id);
 
 	return XRT_SUCCESS;
 }
@@ -1382,35 +1463,27 @@ ipc_handle_compositor_layer_sync_with_semaphore(volatile struct ipc_client_state
 
 	struct xrt_compositor_semaphore *xcsem = ics->xcsems[semaphore_id];
 
-	struct ipc_shared_memory *ism = ics->server->ism;
-	struct ipc_layer_slot *slot = &ism->slots[slot_id];
-
-	// Copy current slot data.
-	struct ipc_layer_slot copy = *slot;
+	volatile struct ipc_layer_slot *slot = NULL;
+	struct xrt_layer_frame_data data;
+	uint32_t layer_count = 0;
 
+	xrt_result_t xret = _get_layer_slot(ics, slot_id, &slot, &data, &layer_count);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
 
 
 	/*
 	 * Transfer data to underlying compositor.
 	 */
 
-	xrt_comp_layer_begin(ics->xc, &copy.data);
+	xrt_comp_layer_begin(ics->xc, &data);
 
-	_update_layers(ics, ics->xc, &copy);
+	_update_layers(ics, ics->xc, slot, layer_count);
 
 	xrt_comp_layer_commit_with_semaphore(ics->xc, xcsem, semaphore_value);
 
-
-	/*
-	 * Manage shared state.
-	 */
-
-	os_mutex_lock(&ics->server->global_state.lock);
-
-	*out_free_slot_id = (ics->server->current_slot_index + 1) % IPC_MAX_SLOTS;
-	ics->server->current_slot_index = *out_free_slot_id;
-
-	os_mutex_unlock(&ics->server->global_state.lock);
+	*out_free_slot_id = _next_free_slot_id(ics, slot_id);
 
 	return XRT_SUCCESS;
 }
@@ -1493,7 +1566,7 @@ ipc_handle_system_get_clients(volatile struct ipc_client_state *_ics, struct ipc
 	os_mutex_lock(&s->global_state.lock);
 
 	uint32_t count = 0;
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
@@ -1570,6 +1643,9 @@ ipc_handle_system_toggle_io_device(volatile struct ipc_client_state *ics, uint32
 
 	idev->io_active = !idev->io_active;
 
+	// Let the clients know so they stop using the pose rings.
+	ics->server->ism->isdevs[device_id].io_active = idev->io_active;
+
 	return XRT_SUCCESS;
 }
 
@@ -1846,11 +1922,9 @@ ipc_handle_compositor_semaphore_destroy(volatile struct ipc_client_state *ics, u
  *
  */
 
-xrt_result_t
-ipc_handle_device_update_input(volatile struct ipc_client_state *ics, uint32_t id)
+static xrt_result_t
+update_input_and_copy_to_shm(volatile struct ipc_client_state *ics, uint32_t device_id)
 {
-	// To make the code a bit more readable.
-	uint32_t device_id = id;
 	struct ipc_shared_memory *ism = ics->server->ism;
 	struct ipc_device *idev = get_idev(ics, device_id);
 	struct xrt_device *xdev = idev->xdev;
@@ -1884,7 +1958,43 @@ ipc_handle_device_update_input(volatile struct ipc_client_state *ics, uint32_t i
 		}
 	}
 
-	// Reply.
+	return XRT_SUCCESS;
+}
+
+xrt_result_t
+ipc_handle_device_update_input(volatile struct ipc_client_state *ics, uint32_t id)
+{
+	// To make the code a bit more readable.
+	uint32_t device_id = id;
+
+	return update_input_and_copy_to_shm(ics, device_id);
+}
+
+xrt_result_t
+ipc_handle_system_devices_update_inputs(volatile struct ipc_client_state *ics, uint32_t device_mask)
+{
+	struct ipc_shared_memory *ism = ics->server->ism;
+	xrt_result_t xret;
+
+	for (uint32_t device_id = 0; device_id < XRT_SYSTEM_MAX_DEVICES && device_mask != 0; device_id++) {
+		uint32_t bit = 1u << device_id;
+		if ((device_mask & bit) == 0) {
+			continue;
+		}
+		device_mask &= ~bit;
+
+		if (device_id >= ism->isdev_count || get_idev(ics, device_id)->xdev == NULL) {
+			IPC_ERROR(ics->server, "Invalid device ID %u in mask!", device_id);
+			return XRT_ERROR_IPC_FAILURE;
+		}
+
+		xret = update_input_and_copy_to_shm(ics, device_id);
+		if (xret != XRT_SUCCESS) {
+			return xret;
+		}
+	}
+
+	// The client reads the results straight from the shared memory.
 	return XRT_SUCCESS;
 }
 
@@ -2082,6 +2192,62 @@ ipc_handle_device_compute_distortion(volatile struct ipc_client_state *ics,
 	return XRT_SUCCESS;
 }
 
+xrt_result_t
+ipc_handle_device_compute_distortion_grid(volatile struct ipc_client_state *ics,
+                                          uint32_t id,
+                                          uint32_t view,
+                                          uint32_t grid_size)
+{
+	struct ipc_message_channel *imc = (struct ipc_message_channel *)&ics->imc;
+	struct ipc_device_compute_distortion_grid_reply reply = XRT_STRUCT_INIT;
+	struct ipc_server *s = ics->server;
+	struct xrt_uv_triplet *triplets = NULL;
+	xrt_result_t xret;
+
+	// To make the code a bit more readable.
+	uint32_t device_id = id;
+	struct xrt_device *xdev = NULL;
+
+	if (validate_device_id(ics, device_id, &xdev) != XRT_SUCCESS) {
+		reply.ret = false;
+	} else if (grid_size >= 2 && grid_size <= IPC_MAX_DISTORTION_GRID_SIZE && xdev->hmd != NULL &&
+	           view < xdev->hmd->view_count) {
+		triplets = U_TYPED_ARRAY_CALLOC(struct xrt_uv_triplet, grid_size * grid_size);
+		if (triplets == NULL) {
+			IPC_ERROR(s, "Failed to allocate distortion grid of size %u", grid_size);
+			reply.ret = false;
+		} else {
+			reply.ret = u_distortion_mesh_compute_grid(xdev, view, grid_size, triplets);
+		}
+	} else {
+		IPC_ERROR(s, "Invalid view %u or grid size %u", view, grid_size);
+		reply.ret = false;
+	}
+
+	xret = ipc_send(imc, &reply, sizeof(reply));
+	if (xret != XRT_SUCCESS) {
+		IPC_ERROR(s, "Failed to send reply");
+		goto out_free;
+	}
+
+	if (!reply.ret) {
+		goto out_free;
+	}
+
+	// One row at a time to keep each message small.
+	for (uint32_t r = 0; r < grid_size; r++) {
+		xret = ipc_send(imc, &triplets[r * grid_size], sizeof(*triplets) * grid_size);
+		if (xret != XRT_SUCCESS) {
+			IPC_ERROR(s, "Failed to send distortion grid");
+			goto out_free;
+		}
+	}
+
+out_free:
+	free(triplets);
+	return xret;
+}
+
 xrt_result_t
 ipc_handle_device_set_output(volatile struct ipc_client_state *ics,
                              uint32_t id,
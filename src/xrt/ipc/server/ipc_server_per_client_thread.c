@@ -35,9 +35,19 @@
  *
  */
 
+static void
+stop_tracking_channel(volatile struct ipc_client_state *ics);
+
 static void
 common_shutdown(volatile struct ipc_client_state *ics)
 {
+	/*
+	 * Stop the tracking channel first, it uses the state we clean up below.
+	 */
+
+	stop_tracking_channel(ics);
+
+
 	/*
 	 * Remove the thread from the server.
 	 */
@@ -119,9 +129,8 @@ common_shutdown(volatile struct ipc_client_state *ics)
 #ifndef XRT_OS_WINDOWS // Linux & Android
 
 static int
-setup_epoll(volatile struct ipc_client_state *ics)
+setup_epoll(volatile struct ipc_client_state *ics, int listen_socket)
 {
-	int listen_socket = ics->imc.ipc_handle;
 	assert(listen_socket >= 0);
 
 	int ret = epoll_create1(EPOLL_CLOEXEC);
@@ -138,21 +147,22 @@ setup_epoll(volatile struct ipc_client_state *ics)
 	ret = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_socket, &ev);
 	if (ret < 0) {
 		IPC_ERROR(ics->server, "Error epoll_ctl(listen_socket) failed '%i'.", ret);
+		close(epoll_fd);
 		return ret;
 	}
 
 	return epoll_fd;
 }
 
+/*!
+ * Reads and dispatches commands from the channel until the client disconnects
+ * or misbehaves, used for both the main and the tracking channel.
+ */
 static void
-client_loop(volatile struct ipc_client_state *ics)
+channel_loop(volatile struct ipc_client_state *ics, struct ipc_message_channel *imc, bool tracking)
 {
-	U_TRACE_SET_THREAD_NAME("IPC Client");
-
-	IPC_INFO(ics->server, "Client %u connected", ics->client_state.id);
-
 	// Claim the client fd.
-	int epoll_fd = setup_epoll(ics);
+	int epoll_fd = setup_epoll(ics, imc->ipc_handle);
 	if (epoll_fd < 0) {
 		return;
 	}
@@ -180,13 +190,13 @@ client_loop(volatile struct ipc_client_state *ics)
 
 		// Detect clients disconnecting gracefully.
 		if (ret > 0 && (event.events & EPOLLHUP) != 0) {
-			IPC_INFO(ics->server, "Client disconnected.");
+			IPC_INFO(ics->server, "Client disconnected%s.", tracking ? " (tracking channel)" : "");
 			break;
 		}
 
 		// Peek the first 4 bytes to get the command type
 		enum ipc_command cmd;
-		ssize_t len = recv(ics->imc.ipc_handle, &cmd, sizeof(cmd), MSG_PEEK);
+		ssize_t len = recv(imc->ipc_handle, &cmd, sizeof(cmd), MSG_PEEK);
 		if (len != sizeof(cmd)) {
 			IPC_ERROR(ics->server, "Invalid command received.");
 			break;
@@ -198,10 +208,13 @@ client_loop(volatile struct ipc_client_state *ics)
 			break;
 		}
 
-		// Read the whole command now that we know its size
-		uint8_t buf[IPC_BUF_SIZE] = {0};
+		/*
+		 * Read the whole command now that we know its size, not zeroed
+		 * as only the cmd_size bytes checked below are ever used.
+		 */
+		uint8_t buf[IPC_BUF_SIZE];
 
-		len = recv(ics->imc.ipc_handle, &buf, cmd_size, 0);
+		len = recv(imc->ipc_handle, &buf, cmd_size, 0);
 		if (len != (ssize_t)cmd_size) {
 			IPC_ERROR(ics->server, "Invalid packet received, disconnecting client.");
 			break;
@@ -211,7 +224,12 @@ client_loop(volatile struct ipc_client_state *ics)
 		ipc_command_t *ipc_command = (ipc_command_t *)buf;
 
 		IPC_TRACE_BEGIN(ipc_dispatch);
-		xrt_result_t result = ipc_dispatch(ics, ipc_command);
+		xrt_result_t result;
+		if (tracking) {
+			result = ipc_dispatch_tracking(ics, imc, ipc_command);
+		} else {
+			result = ipc_dispatch(ics, ipc_command);
+		}
 		IPC_TRACE_END(ipc_dispatch);
 
 		if (result != XRT_SUCCESS) {
@@ -222,11 +240,53 @@ client_loop(volatile struct ipc_client_state *ics)
 
 	close(epoll_fd);
 	epoll_fd = -1;
+}
+
+static void
+client_loop(volatile struct ipc_client_state *ics)
+{
+	U_TRACE_SET_THREAD_NAME("IPC Client");
+
+	IPC_INFO(ics->server, "Client %u connected", ics->client_state.id);
+
+	// Cast away volatile.
+	channel_loop(ics, (struct ipc_message_channel *)&ics->imc, false);
 
 	// Following code is same for all platforms.
 	common_shutdown(ics);
 }
 
+static void *
+tracking_thread(void *_ics)
+{
+	volatile struct ipc_client_state *ics = (volatile struct ipc_client_state *)_ics;
+
+	U_TRACE_SET_THREAD_NAME("IPC Client Tracking");
+
+	// Cast away volatile.
+	channel_loop(ics, (struct ipc_message_channel *)&ics->tracking.imc, true);
+
+	// The main channel thread cleans up.
+	return NULL;
+}
+
+static void
+stop_tracking_channel(volatile struct ipc_client_state *ics)
+{
+	if (ics->tracking.thread_started) {
+		// Wakes the thread up and makes it see a disconnect.
+		shutdown(ics->tracking.imc.ipc_handle, SHUT_RDWR);
+
+		// Cast away volatile.
+		os_thread_join((struct os_thread *)&ics->tracking.thread);
+		os_thread_destroy((struct os_thread *)&ics->tracking.thread);
+		ics->tracking.thread_started = false;
+	}
+
+	// Cast away volatile.
+	ipc_message_channel_close((struct ipc_message_channel *)&ics->tracking.imc);
+}
+
 #else // XRT_OS_WINDOWS
 
 static void
@@ -241,6 +301,13 @@ pipe_print_get_last_error(volatile struct ipc_client_state *ics, const char *fun
 	}
 }
 
+static void
+stop_tracking_channel(volatile struct ipc_client_state *ics)
+{
+	// Never started on Windows, see ipc_server_client_attach_tracking_channel.
+	ipc_message_channel_close((struct ipc_message_channel *)&ics->tracking.imc);
+}
+
 static void
 client_loop(volatile struct ipc_client_state *ics)
 {
@@ -249,7 +316,8 @@ client_loop(volatile struct ipc_client_state *ics)
 	IPC_INFO(ics->server, "Client connected");
 
 	while (ics->server->running) {
-		uint8_t buf[IPC_BUF_SIZE] = {0};
+		// Not zeroed, the message length is checked against the command size below.
+		uint8_t buf[IPC_BUF_SIZE];
 		DWORD len = 0;
 		BOOL bret = false;
 
@@ -347,6 +415,36 @@ ipc_server_client_destroy_session_and_compositor(volatile struct ipc_client_stat
 	xrt_session_destroy((struct xrt_session **)&ics->xs);
 }
 
+xrt_result_t
+ipc_server_client_attach_tracking_channel(volatile struct ipc_client_state *ics, xrt_ipc_handle_t ipc_handle)
+{
+#ifdef XRT_OS_WINDOWS
+	//! @todo Not needed yet, the client never asks for one on Windows.
+	xrt_ipc_handle_close(ipc_handle);
+	return XRT_ERROR_NOT_IMPLEMENTED;
+#else
+	if (ics->tracking.thread_started) {
+		IPC_ERROR(ics->server, "Client already has a tracking channel!");
+		xrt_ipc_handle_close(ipc_handle);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	ics->tracking.imc.ipc_handle = ipc_handle;
+	ics->tracking.imc.log_level = ics->server->log_level;
+
+	int ret = os_thread_start((struct os_thread *)&ics->tracking.thread, tracking_thread, (void *)ics);
+	if (ret != 0) {
+		IPC_ERROR(ics->server, "Failed to start tracking channel thread '%i'!", ret);
+		ipc_message_channel_close((struct ipc_message_channel *)&ics->tracking.imc);
+		return XRT_ERROR_THREADING_INIT_FAILURE;
+	}
+
+	ics->tracking.thread_started = true;
+
+	return XRT_SUCCESS;
+#endif
+}
+
 void *
 ipc_server_client_thread(void *_ics)
 {
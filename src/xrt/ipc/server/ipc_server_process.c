@@ -30,6 +30,7 @@
 #include "util/u_git_tag.h"
 
 #include "shared/ipc_shmem.h"
+#include "shared/ipc_pose_ring.h"
 #include "server/ipc_server.h"
 #include "server/ipc_server_interface.h"
 
@@ -43,6 +44,7 @@
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
+#include <inttypes.h>
 
 #if defined(XRT_OS_WINDOWS)
 #include <timeapi.h>
@@ -57,6 +59,12 @@
 
 DEBUG_GET_ONCE_BOOL_OPTION(exit_on_disconnect, "IPC_EXIT_ON_DISCONNECT", false)
 DEBUG_GET_ONCE_LOG_OPTION(ipc_log, "IPC_LOG", U_LOGGING_INFO)
+DEBUG_GET_ONCE_NUM_OPTION(pose_publish_rate, "IPC_POSE_PUBLISH_RATE", 0)
+DEBUG_GET_ONCE_NUM_OPTION(pose_max_prediction_ms, "IPC_POSE_MAX_PREDICTION_MS", 20)
+DEBUG_GET_ONCE_NUM_OPTION(max_clients, "IPC_MAX_CLIENTS", IPC_DEFAULT_MAX_CLIENTS)
+
+//! Used if the system compositor doesn't say how many layers it supports.
+#define DEFAULT_LAYER_CAPACITY 16
 
 
 /*
@@ -194,6 +202,9 @@ teardown_all(struct ipc_server *s)
 {
 	u_var_remove_root(s);
 
+	// Stop sampling the devices before they go away.
+	os_thread_helper_destroy(&s->pose_publisher);
+
 	xrt_syscomp_destroy(&s->xsysc);
 
 	teardown_idevs(s);
@@ -208,7 +219,15 @@ teardown_all(struct ipc_server *s)
 
 	u_process_destroy(s->process);
 
-	ipc_shmem_destroy(&s->ism_handle, (void **)&s->ism, sizeof(struct ipc_shared_memory));
+	ipc_shmem_destroy(&s->ism_handle, (void **)&s->ism, s->ism_size);
+
+	for (uint32_t i = 0; s->threads != NULL && i < s->max_clients; i++) {
+		// Cast away volatile.
+		os_mutex_destroy((struct os_mutex *)&s->threads[i].ics.space_mutex);
+	}
+
+	free(s->threads);
+	s->threads = NULL;
 
 	// Destroyed last.
 	os_mutex_destroy(&s->global_state.lock);
@@ -284,7 +303,17 @@ handle_binding(struct ipc_shared_memory *ism,
 static int
 init_shm(struct ipc_server *s)
 {
-	const size_t size = sizeof(struct ipc_shared_memory);
+	uint32_t layer_capacity = DEFAULT_LAYER_CAPACITY;
+	if (s->xsysc != NULL && s->xsysc->info.max_layers > 0) {
+		layer_capacity = s->xsysc->info.max_layers;
+	}
+
+	// The slots go after the fixed part, each client gets its own slots.
+	const size_t slot_offset = (sizeof(struct ipc_shared_memory) + 63) & ~(size_t)63;
+	const size_t slot_stride = ipc_layer_slot_size(layer_capacity);
+	const uint32_t slot_count = s->max_clients * IPC_SLOTS_PER_CLIENT;
+	const size_t size = slot_offset + slot_stride * slot_count;
+
 	xrt_shmem_handle_t handle;
 	xrt_result_t result = ipc_shmem_create(size, &handle, (void **)&s->ism);
 	if (result != XRT_SUCCESS) {
@@ -293,6 +322,11 @@ init_shm(struct ipc_server *s)
 
 	// we have a filehandle, we will pass this to our client
 	s->ism_handle = handle;
+	s->ism_size = size;
+	s->slots.offset = slot_offset;
+	s->slots.stride = slot_stride;
+	s->slots.count = slot_count;
+	s->slots.layer_capacity = layer_capacity;
 
 
 	/*
@@ -304,6 +338,16 @@ init_shm(struct ipc_server *s)
 	uint32_t count = 0;
 	struct ipc_shared_memory *ism = s->ism;
 
+	ism->layout_version = IPC_SHARED_MEMORY_LAYOUT_VERSION;
+	ism->size = size;
+	ism->slots.offset = slot_offset;
+	ism->slots.stride = slot_stride;
+	ism->slots.count = slot_count;
+	ism->slots.layer_capacity = layer_capacity;
+
+	IPC_INFO(s, "Shared memory is %zu bytes, %u layer slots with room for %u layers each.", size, slot_count,
+	         layer_capacity);
+
 	ism->startup_timestamp = os_monotonic_get_ns();
 
 	// Setup the tracking origins.
@@ -356,6 +400,7 @@ init_shm(struct ipc_server *s)
 		isdev->body_tracking_supported = xdev->body_tracking_supported;
 		isdev->stage_supported = xdev->stage_supported;
 		isdev->battery_status_supported = xdev->battery_status_supported;
+		isdev->io_active = s->idevs[i].io_active;
 
 		// Is this a HMD?
 		if (xdev->hmd != NULL) {
@@ -409,6 +454,17 @@ init_shm(struct ipc_server *s)
 			ism->inputs[input_index++] = xdev->inputs[k];
 		}
 
+		// Assign the first pose inputs to pose rings, published if enabled.
+		uint32_t ring_index = 0;
+		for (size_t k = 0; k < xdev->input_count && ring_index < IPC_SHARED_POSE_RINGS_PER_DEVICE; k++) {
+			enum xrt_input_name name = xdev->inputs[k].name;
+			if (XRT_GET_INPUT_TYPE(name) != XRT_INPUT_TYPE_POSE) {
+				continue;
+			}
+
+			ism->pose_rings[count - 1][ring_index++].name = name;
+		}
+
 		// Setup the 'offsets' and number of inputs.
 		if (input_start != input_index) {
 			isdev->input_count = input_index - input_start;
@@ -439,12 +495,89 @@ init_shm(struct ipc_server *s)
 	ism->roles.hand_tracking.left = find_xdev_index(s, s->xsysd->static_roles.hand_tracking.left);
 	ism->roles.hand_tracking.right = find_xdev_index(s, s->xsysd->static_roles.hand_tracking.right);
 
+	// Clients only use the pose rings if this is non-zero.
+	if (s->pose_publish_period_ns > 0) {
+		ism->pose_ring_max_prediction_ns = U_TIME_1MS_IN_NS * debug_get_num_option_pose_max_prediction_ms();
+	}
+
 	// Fill out git version info.
 	snprintf(s->ism->u_git_tag, IPC_VERSION_NAME_LEN, "%s", u_git_tag);
 
 	return 0;
 }
 
+static void *
+pose_publisher_thread(void *ptr)
+{
+	struct ipc_server *s = (struct ipc_server *)ptr;
+	struct ipc_shared_memory *ism = s->ism;
+
+	U_TRACE_SET_THREAD_NAME("IPC Pose Publisher");
+	os_thread_helper_name(&s->pose_publisher, "IPC Pose Publisher");
+
+	while (os_thread_helper_is_running(&s->pose_publisher)) {
+		int64_t now_ns = os_monotonic_get_ns();
+
+		for (uint32_t i = 0; i < ism->isdev_count; i++) {
+			struct xrt_device *xdev = s->idevs[i].xdev;
+			if (xdev == NULL) {
+				continue;
+			}
+
+			for (uint32_t k = 0; k < IPC_SHARED_POSE_RINGS_PER_DEVICE; k++) {
+				struct ipc_shared_pose_ring *ring = &ism->pose_rings[i][k];
+				if (ring->name == 0) {
+					break;
+				}
+
+				struct xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+				xrt_device_get_tracked_pose(xdev, ring->name, now_ns, &relation);
+				ipc_pose_ring_push(ring, now_ns, &relation);
+			}
+		}
+
+		int64_t spent_ns = os_monotonic_get_ns() - now_ns;
+		if (spent_ns < s->pose_publish_period_ns) {
+			os_nanosleep(s->pose_publish_period_ns - spent_ns);
+		}
+	}
+
+	return NULL;
+}
+
+static int
+init_pose_publisher(struct ipc_server *s)
+{
+	if (s->pose_publish_period_ns <= 0) {
+		IPC_INFO(s, "Not publishing poses to shared memory.");
+		return 0;
+	}
+
+	int ret = os_thread_helper_start(&s->pose_publisher, pose_publisher_thread, s);
+	if (ret != 0) {
+		IPC_ERROR(s, "Failed to start pose publisher thread!");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+init_client_locks(struct ipc_server *s)
+{
+	for (uint32_t i = 0; i < s->max_clients; i++) {
+		// Cast away volatile.
+		if (os_mutex_init((struct os_mutex *)&s->threads[i].ics.space_mutex) != 0) {
+			while (i-- > 0) {
+				os_mutex_destroy((struct os_mutex *)&s->threads[i].ics.space_mutex);
+			}
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static void
 init_server_state(struct ipc_server *s)
 {
@@ -452,9 +585,8 @@ init_server_state(struct ipc_server *s)
 
 	s->global_state.active_client_index = -1; // we start off with no active client.
 	s->global_state.last_active_client_index = -1;
-	s->current_slot_index = 0;
 
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 		ics->server = s;
 		ics->server_thread_index = -1;
@@ -478,6 +610,42 @@ init_all(struct ipc_server *s, enum u_logging_level log_level)
 		return ret;
 	}
 
+	ret = os_thread_helper_init(&s->pose_publisher);
+	if (ret < 0) {
+		IPC_ERROR(s, "Pose publisher thread helper failed to init!");
+		os_mutex_destroy(&s->global_state.lock);
+		return ret;
+	}
+
+	int64_t pose_publish_rate = debug_get_num_option_pose_publish_rate();
+	if (pose_publish_rate > 0) {
+		s->pose_publish_period_ns = U_TIME_1S_IN_NS / pose_publish_rate;
+	}
+
+	int64_t max_clients = debug_get_num_option_max_clients();
+	if (max_clients < 1 || max_clients > IPC_MAX_CLIENTS) {
+		IPC_WARN(s, "IPC_MAX_CLIENTS=%" PRIi64 " out of range, clamping to [1, %d]", max_clients,
+		         IPC_MAX_CLIENTS);
+		max_clients = max_clients < 1 ? 1 : IPC_MAX_CLIENTS;
+	}
+	s->max_clients = (uint32_t)max_clients;
+	s->threads = U_TYPED_ARRAY_CALLOC(struct ipc_thread, s->max_clients);
+	if (s->threads == NULL) {
+		IPC_ERROR(s, "Failed to allocate the client threads!");
+		teardown_all(s);
+		return -1;
+	}
+
+	ret = init_client_locks(s);
+	if (ret < 0) {
+		IPC_ERROR(s, "Failed to init the client locks!");
+		// Do not destroy the locks in teardown_all.
+		free(s->threads);
+		s->threads = NULL;
+		teardown_all(s);
+		return ret;
+	}
+
 	s->process = u_process_create_if_not_running();
 
 	if (!s->process) {
@@ -525,6 +693,12 @@ init_all(struct ipc_server *s, enum u_logging_level log_level)
 		return ret;
 	}
 
+	ret = init_pose_publisher(s);
+	if (ret < 0) {
+		teardown_all(s);
+		return ret;
+	}
+
 	ret = ipc_server_mainloop_init(&s->ml);
 	if (ret < 0) {
 		IPC_ERROR(s, "Failed to init ipc main loop!");
@@ -630,7 +804,7 @@ handle_focused_client_events(volatile struct ipc_client_state *ics, int active_i
 static void
 flush_state_to_all_clients_locked(struct ipc_server *s)
 {
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
 		// Not running?
@@ -675,7 +849,7 @@ update_server_state_locked(struct ipc_server *s)
 	int fallback_active_application = -1;
 
 	// do we have a fallback application?
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 		if (ics->client_state.session_overlay == false && ics->server_thread_index >= 0 &&
 		    ics->client_state.session_active) {
@@ -715,7 +889,7 @@ find_client_locked(struct ipc_server *s, uint32_t client_id)
 		return NULL;
 	}
 
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
 		// Is this the client we are looking for?
@@ -791,6 +965,9 @@ toggle_io_client_locked(struct ipc_server *s, uint32_t client_id)
 
 	ics->io_active = !ics->io_active;
 
+	// Let the client know so it stops using the pose rings.
+	s->ism->client_io_active[ics->server_thread_index] = ics->io_active;
+
 	return XRT_SUCCESS;
 }
 
@@ -914,7 +1091,7 @@ ipc_server_handle_client_connected(struct ipc_server *vs, xrt_ipc_handle_t ipc_h
 
 	// find the next free thread in our array (server_thread_index is -1)
 	// and have it handle this connection
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < vs->max_clients; i++) {
 		volatile struct ipc_client_state *_cs = &vs->threads[i].ics;
 		if (_cs->server_thread_index < 0) {
 			ics = _cs;
@@ -962,9 +1139,11 @@ ipc_server_handle_client_connected(struct ipc_server *vs, xrt_ipc_handle_t ipc_h
 	// Set state.
 	ics->client_state.id = id;
 	ics->imc.ipc_handle = ipc_handle;
+	ics->tracking.imc.ipc_handle = XRT_IPC_HANDLE_INVALID;
 	ics->server = vs;
 	ics->server_thread_index = cs_index;
 	ics->io_active = true;
+	vs->ism->client_io_active[cs_index] = true;
 
 	os_thread_start(&it->thread, ipc_server_client_thread, (void *)ics);
 
@@ -0,0 +1,162 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Seqlock protected pose rings living in the shared memory.
+ * @ingroup ipc_shared
+ */
+
+#include "os/os_time.h"
+
+#include "util/u_misc.h"
+
+#include "math/m_space.h"
+#include "math/m_predict.h"
+
+#include "shared/ipc_pose_ring.h"
+
+#include <string.h>
+
+
+/*!
+ * How many times a reader tries to get a consistent copy before giving up.
+ */
+#define IPC_POSE_RING_READ_ATTEMPTS 8
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static inline const struct ipc_shared_pose_sample *
+get_sample(const struct ipc_shared_pose_sample *samples, uint64_t sample_count, uint64_t index)
+{
+	// index 0 is the oldest sample still in the ring.
+	uint64_t oldest = sample_count > IPC_SHARED_POSE_RING_SIZE ? sample_count - IPC_SHARED_POSE_RING_SIZE : 0;
+	return &samples[(oldest + index) % IPC_SHARED_POSE_RING_SIZE];
+}
+
+static bool
+read_consistent(const struct ipc_shared_pose_ring *ring,
+                struct ipc_shared_pose_sample samples[IPC_SHARED_POSE_RING_SIZE],
+                uint64_t *out_sample_count)
+{
+	for (uint32_t attempt = 0; attempt < IPC_POSE_RING_READ_ATTEMPTS; attempt++) {
+		int32_t before = ring->seq;
+		if ((before & 1) != 0) {
+			// Writer is in the middle of an update.
+			continue;
+		}
+
+		xrt_atomic_full_barrier();
+
+		uint64_t sample_count = ring->sample_count;
+		memcpy(samples, ring->samples, sizeof(ring->samples));
+
+		xrt_atomic_full_barrier();
+
+		if (before == ring->seq) {
+			*out_sample_count = sample_count;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+void
+ipc_pose_ring_push(struct ipc_shared_pose_ring *ring, int64_t timestamp_ns, const struct xrt_space_relation *relation)
+{
+	uint64_t sample_count = ring->sample_count;
+
+	// Everything depends on the samples being in order.
+	if (sample_count > 0 &&
+	    ring->samples[(sample_count - 1) % IPC_SHARED_POSE_RING_SIZE].timestamp_ns >= timestamp_ns) {
+		return;
+	}
+
+	xrt_atomic_s32_inc_return(&ring->seq); // Odd, readers back off.
+	xrt_atomic_full_barrier();
+
+	struct ipc_shared_pose_sample *sample = &ring->samples[sample_count % IPC_SHARED_POSE_RING_SIZE];
+	sample->timestamp_ns = timestamp_ns;
+	sample->relation = *relation;
+	ring->sample_count = sample_count + 1;
+
+	xrt_atomic_full_barrier();
+	xrt_atomic_s32_inc_return(&ring->seq); // Even, consistent again.
+}
+
+bool
+ipc_pose_ring_get(const struct ipc_shared_pose_ring *ring,
+                  int64_t max_prediction_ns,
+                  int64_t at_timestamp_ns,
+                  struct xrt_space_relation *out_relation)
+{
+	struct ipc_shared_pose_sample samples[IPC_SHARED_POSE_RING_SIZE];
+	uint64_t sample_count = 0;
+
+	if (at_timestamp_ns <= 0 || !read_consistent(ring, samples, &sample_count) || sample_count == 0) {
+		return false;
+	}
+
+	uint32_t count = sample_count > IPC_SHARED_POSE_RING_SIZE ? IPC_SHARED_POSE_RING_SIZE : (uint32_t)sample_count;
+	const struct ipc_shared_pose_sample *oldest = get_sample(samples, sample_count, 0);
+	const struct ipc_shared_pose_sample *latest = get_sample(samples, sample_count, count - 1);
+
+	// Too old, the service has better data.
+	if (at_timestamp_ns < oldest->timestamp_ns) {
+		return false;
+	}
+
+	// Newer than we have, predict if not too far out.
+	if (at_timestamp_ns >= latest->timestamp_ns) {
+		int64_t diff_ns = at_timestamp_ns - latest->timestamp_ns;
+		if (diff_ns > max_prediction_ns) {
+			return false;
+		}
+
+		m_predict_relation(&latest->relation, time_ns_to_s(diff_ns), out_relation);
+		return true;
+	}
+
+	// Few samples, a linear search is fine.
+	for (uint32_t i = 1; i < count; i++) {
+		const struct ipc_shared_pose_sample *after = get_sample(samples, sample_count, i);
+		if (after->timestamp_ns < at_timestamp_ns) {
+			continue;
+		}
+
+		const struct ipc_shared_pose_sample *before = get_sample(samples, sample_count, i - 1);
+		if (after->timestamp_ns == at_timestamp_ns) {
+			*out_relation = after->relation;
+			return true;
+		}
+
+		int64_t diff_before = at_timestamp_ns - before->timestamp_ns;
+		int64_t diff_total = after->timestamp_ns - before->timestamp_ns;
+		float t = (float)diff_before / (float)diff_total;
+
+		enum xrt_space_relation_flags flags = (enum xrt_space_relation_flags)(
+		    before->relation.relation_flags & after->relation.relation_flags);
+
+		struct xrt_space_relation a = before->relation;
+		struct xrt_space_relation b = after->relation;
+		U_ZERO(out_relation);
+		m_space_relation_interpolate(&a, &b, t, flags, out_relation);
+		return true;
+	}
+
+	// Only reached if the oldest sample is the exact match.
+	*out_relation = oldest->relation;
+	return true;
+}
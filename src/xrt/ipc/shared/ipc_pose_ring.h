@@ -0,0 +1,71 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Seqlock protected pose rings living in the shared memory.
+ * @ingroup ipc_shared
+ */
+
+#pragma once
+
+#include "shared/ipc_protocol.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Push a new sample into the ring, only the service may call this and only
+ * from one thread. Samples older than the latest one are dropped.
+ *
+ * @public @memberof ipc_shared_pose_ring
+ * @ingroup ipc_shared
+ */
+void
+ipc_pose_ring_push(struct ipc_shared_pose_ring *ring, int64_t timestamp_ns, const struct xrt_space_relation *relation);
+
+/*!
+ * Interpolate or predict the pose at @p at_timestamp_ns from the ring without
+ * taking any locks or making any calls to the service. Returns false if the
+ * ring is empty, if the timestamp is before the oldest sample or further than
+ * @p max_prediction_ns after the latest one, or if the service kept writing
+ * while we were trying to read; the caller should then ask the service.
+ *
+ * @public @memberof ipc_shared_pose_ring
+ * @ingroup ipc_shared
+ */
+bool
+ipc_pose_ring_get(const struct ipc_shared_pose_ring *ring,
+                  int64_t max_prediction_ns,
+                  int64_t at_timestamp_ns,
+                  struct xrt_space_relation *out_relation);
+
+/*!
+ * Find the ring for the given device and pose input, returns NULL if the
+ * service doesn't publish that input.
+ *
+ * @ingroup ipc_shared
+ */
+static inline const struct ipc_shared_pose_ring *
+ipc_pose_ring_find(const struct ipc_shared_memory *ism, uint32_t device_id, enum xrt_input_name name)
+{
+	if (ism->pose_ring_max_prediction_ns <= 0 || device_id >= XRT_SYSTEM_MAX_DEVICES) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < IPC_SHARED_POSE_RINGS_PER_DEVICE; i++) {
+		const struct ipc_shared_pose_ring *ring = &ism->pose_rings[device_id][i];
+		if (ring->name == name) {
+			return ring;
+		}
+	}
+
+	return NULL;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
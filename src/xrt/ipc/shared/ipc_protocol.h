@@ -29,20 +29,28 @@
 
 
 #define IPC_CRED_SIZE 1    // auth not implemented
-#define IPC_BUF_SIZE 512   // must be >= largest message length in bytes
+#define IPC_BUF_SIZE 4096  // must be >= largest message length in bytes
 #define IPC_MAX_VIEWS 8    // max views we will return configs for
 #define IPC_MAX_FORMATS 32 // max formats our server-side compositor supports
 #define IPC_MAX_DEVICES 8  // max number of devices we will map using shared mem
-#define IPC_MAX_LAYERS 16
-#define IPC_MAX_SLOTS 128
-#define IPC_MAX_CLIENTS 8
+#define IPC_MAX_CLIENTS 64        // max clients the service can be configured for
+#define IPC_DEFAULT_MAX_CLIENTS 32 // clients allowed if the service isn't configured
+#define IPC_SLOTS_PER_CLIENT 2     // layer slots each client gets in shared memory
 #define IPC_MAX_RAW_VIEWS 32 // Max views that we can get, artificial limit.
 #define IPC_EVENT_QUEUE_SIZE 32
+#define IPC_MAX_LOCATE_SPACES 64 // max spaces located per space_locate_spaces call
+#define IPC_MAX_DISTORTION_GRID_SIZE 129 // max points along each axis per device_compute_distortion_grid call
 
 #define IPC_SHARED_MAX_INPUTS 1024
 #define IPC_SHARED_MAX_OUTPUTS 128
 #define IPC_SHARED_MAX_BINDINGS 64
 
+#define IPC_SHARED_POSE_RING_SIZE 16       // samples kept per pose ring
+#define IPC_SHARED_POSE_RINGS_PER_DEVICE 4 // pose inputs published per device
+
+// bump when changing the layout of the shared memory
+#define IPC_SHARED_MEMORY_LAYOUT_VERSION 2
+
 // example: v21.0.0-560-g586d33b5
 #define IPC_VERSION_NAME_LEN 64
 
@@ -138,6 +146,51 @@ struct ipc_shared_device
 	bool form_factor_check_supported;
 	bool stage_supported;
 	bool battery_status_supported;
+
+	//! Mirrors the IO state of the device in the service, see @ref ipc_pose_ring_find.
+	bool io_active;
+};
+
+/*!
+ * A single timestamped pose in a @ref ipc_shared_pose_ring.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_pose_sample
+{
+	int64_t timestamp_ns;
+	struct xrt_space_relation relation;
+};
+
+/*!
+ * Ring of recently sampled poses for one pose input of a device, written by
+ * the service and read lock-free by the clients. Protected by a seqlock: the
+ * writer makes @p seq odd while it is updating the ring, readers retry if
+ * @p seq was odd or changed while they were copying.
+ *
+ * The samples are not copies of the device's relation history, drivers keep
+ * that private, instead the service asks the device for its pose at the
+ * current time every publish period T (IPC_POSE_PUBLISH_RATE). Readers
+ * interpolate between two samples or predict from the latest one for at
+ * most Δ = T + IPC_POSE_MAX_PREDICTION_MS with its velocities. On top of
+ * the device's own error that is at most a·T²/8 for interpolation and
+ * a·Δ²/2 for prediction, where a is the (angular) acceleration of the
+ * tracked object; at 1000Hz and 20ms that is about 1mm for 5m/s².
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_pose_ring
+{
+	//! Sequence counter, odd while the service is writing.
+	xrt_atomic_s32_t seq;
+
+	//! Which pose input this ring holds, zero if not in use.
+	enum xrt_input_name name;
+
+	//! Total number of samples pushed, latest is at (count - 1) % size.
+	uint64_t sample_count;
+
+	struct ipc_shared_pose_sample samples[IPC_SHARED_POSE_RING_SIZE];
 };
 
 /*!
@@ -167,7 +220,8 @@ struct ipc_layer_entry
 };
 
 /*!
- * Render state for a single client, including all layers.
+ * Render state for a single client, including all layers. The size of the
+ * slots is picked by the service, see @ref ipc_shared_memory::slots.
  *
  * @ingroup ipc
  */
@@ -175,7 +229,9 @@ struct ipc_layer_slot
 {
 	struct xrt_layer_frame_data data;
 	uint32_t layer_count;
-	struct ipc_layer_entry layers[IPC_MAX_LAYERS];
+
+	//! Room for @ref ipc_shared_memory::slots layer_capacity layers.
+	struct ipc_layer_entry layers[];
 };
 
 /*!
@@ -195,6 +251,15 @@ struct ipc_layer_slot
  */
 struct ipc_shared_memory
 {
+	/*!
+	 * Must be @ref IPC_SHARED_MEMORY_LAYOUT_VERSION, checked by clients
+	 * before looking at anything else.
+	 */
+	uint32_t layout_version;
+
+	//! Size in bytes of the whole shared memory, this struct and the regions after it.
+	uint64_t size;
+
 	/*!
 	 * The git revision of the service, used by clients to detect version mismatches.
 	 */
@@ -277,11 +342,77 @@ struct ipc_shared_memory
 	struct xrt_binding_input_pair input_pairs[IPC_SHARED_MAX_INPUTS];
 	struct xrt_binding_output_pair output_pairs[IPC_SHARED_MAX_OUTPUTS];
 
-	struct ipc_layer_slot slots[IPC_MAX_SLOTS];
+	/*!
+	 * The layer slots live after this struct, each client gets
+	 * @ref IPC_SLOTS_PER_CLIENT of them when connecting. Use
+	 * @ref ipc_shared_memory_get_slot to get to a slot.
+	 */
+	struct
+	{
+		//! Offset in bytes from the start of the shared memory.
+		uint64_t offset;
+
+		//! Size in bytes of a single slot, including its layers.
+		uint64_t stride;
+
+		//! Total number of slots.
+		uint32_t count;
+
+		//! How many layers each slot has room for.
+		uint32_t layer_capacity;
+	} slots;
+
+	/*!
+	 * How far past the latest sample in a pose ring clients may predict
+	 * on their own, zero if the service doesn't publish poses.
+	 */
+	int64_t pose_ring_max_prediction_ns;
+
+	/*!
+	 * Mirrors the IO state of each client in the service, indexed by the
+	 * client index given out by instance_get_shm_fd. Clients must not
+	 * answer from the pose rings while their IO is disabled.
+	 */
+	bool client_io_active[IPC_MAX_CLIENTS];
+
+	/*!
+	 * Poses published by the service, indexed by device id and then by
+	 * pose input, see @ref ipc_pose_ring_get.
+	 */
+	struct ipc_shared_pose_ring pose_rings[XRT_SYSTEM_MAX_DEVICES][IPC_SHARED_POSE_RINGS_PER_DEVICE];
 
 	uint64_t startup_timestamp;
 };
 
+/*!
+ * Size in bytes of a layer slot with room for @p layer_capacity layers,
+ * rounded up so that slots don't share cache lines.
+ *
+ * @ingroup ipc
+ */
+static inline size_t
+ipc_layer_slot_size(uint32_t layer_capacity)
+{
+	size_t size = sizeof(struct ipc_layer_slot) + sizeof(struct ipc_layer_entry) * layer_capacity;
+
+	return (size + 63) & ~(size_t)63;
+}
+
+/*!
+ * Get the layer slot @p slot_id, the caller must have checked that it is
+ * less than @ref ipc_shared_memory::slots count. Only for clients, the
+ * service doesn't trust the layout in the shared memory.
+ *
+ * @ingroup ipc
+ */
+static inline struct ipc_layer_slot *
+ipc_shared_memory_get_slot(struct ipc_shared_memory *ism, uint32_t slot_id)
+{
+	uint8_t *ptr = (uint8_t *)ism + ism->slots.offset + ism->slots.stride * slot_id;
+
+	return (struct ipc_layer_slot *)ptr;
+}
+
 /*!
  * Initial info from a client when it connects.
  */
@@ -327,6 +458,29 @@ struct ipc_arg_swapchain_from_native
 	uint32_t sizes[XRT_MAX_SWAPCHAIN_IMAGES];
 };
 
+/*!
+ * Arguments for xrt_space_overseer::locate_spaces, fixed size so that the
+ * call is a single message each way.
+ */
+struct ipc_space_locate_spaces_info
+{
+	uint32_t space_count;
+
+	//! The ids of the spaces, UINT32_MAX for NULL spaces.
+	uint32_t space_ids[IPC_MAX_LOCATE_SPACES];
+
+	struct xrt_pose offsets[IPC_MAX_LOCATE_SPACES];
+};
+
+/*!
+ * Results of xrt_space_overseer::locate_spaces, only the first
+ * @ref ipc_space_locate_spaces_info::space_count are valid.
+ */
+struct ipc_space_locate_spaces_relations
+{
+	struct xrt_space_relation relations[IPC_MAX_LOCATE_SPACES];
+};
+
 /*!
  * Arguments for xrt_device::get_view_poses with two views.
  */
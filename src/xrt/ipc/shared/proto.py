@@ -65,14 +65,29 @@ def write_call_definition(f, call):
     write_msg_struct(f, call, '\t')
     write_reply_struct(f, call, '\t')
 
+    imc = '&ipc_c->imc'
+    mutex = '&ipc_c->mutex'
+    if call.tracking_channel:
+        imc = '_imc'
+        mutex = '_mutex'
+        f.write("""
+\t// Use the tracking channel if we have one, don't wait behind frame calls
+\tstruct ipc_message_channel *_imc = &ipc_c->imc;
+\tstruct os_mutex *_mutex = &ipc_c->mutex;
+\tif (ipc_c->tracking.enabled) {
+\t\t_imc = &ipc_c->tracking.imc;
+\t\t_mutex = &ipc_c->tracking.mutex;
+\t}
+""")
+
     f.write("""
 \t// Other threads must not read/write the fd while we wait for reply
-\tos_mutex_lock(&ipc_c->mutex);
-""")
-    cleanup = "os_mutex_unlock(&ipc_c->mutex);"
+\tos_mutex_lock(%s);
+""" % mutex)
+    cleanup = "os_mutex_unlock(%s);" % mutex
 
     # Prepare initial sending
-    write_msg_send(f, 'xrt_result_t ret', indent="\t")
+    write_msg_send(f, 'xrt_result_t ret', indent="\t", imc=imc)
     write_result_handler(f, 'ret', cleanup, indent="\t")
 
     if call.in_handles:
@@ -84,7 +99,7 @@ def write_call_definition(f, call):
             'ret',
             'ipc_receive',
             (
-                '&ipc_c->imc',
+                imc,
                 '&_sync',
                 'sizeof(_sync)'
                 ),
@@ -104,7 +119,7 @@ def write_call_definition(f, call):
             'ret',
             'ipc_send_handles_' + call.in_handles.stem,
             (
-                '&ipc_c->imc',
+                imc,
                 "&_handle_msg",
                 "sizeof(_handle_msg)",
                 call.in_handles.arg_name,
@@ -117,7 +132,7 @@ def write_call_definition(f, call):
 
     f.write("\n\t// Await the reply")
     func = 'ipc_receive'
-    args = ['&ipc_c->imc', '&_reply', 'sizeof(_reply)']
+    args = [imc, '&_reply', 'sizeof(_reply)']
     if call.out_handles:
         func += '_handles_' + call.out_handles.stem
         args.extend(call.out_handles.arg_names)
@@ -263,6 +278,129 @@ def generate_client_h(file, p):
     f.close()
 
 
+def write_dispatch_case(f, call, imc):
+    """Write the case for a single call in a dispatch function."""
+    f.write("\tcase " + call.id + ": {\n")
+
+    f.write("\t\tIPC_TRACE(ics->server, \"Dispatching " + call.name +
+            "\");\n\n")
+
+    if call.needs_msg_struct:
+        f.write(
+            "\t\tstruct ipc_{}_msg *msg = ".format(call.name))
+        f.write("(struct ipc_{}_msg *)ipc_command;\n".format(call.name))
+
+    if call.varlen:
+        f.write("\t\t// No return arguments")
+    elif call.out_args:
+        f.write("\t\tstruct ipc_%s_reply reply = {0};\n" % call.name)
+    else:
+        f.write("\t\tstruct ipc_result_reply reply = {0};\n")
+
+    if call.in_handles:
+        # We need to fetch these handles separately
+        f.write("\t\tstruct ipc_result_reply _sync = {XRT_SUCCESS};\n")
+        f.write("\t\t%s in_%s[XRT_MAX_IPC_HANDLES] = {0};\n" % (
+            call.in_handles.typename, call.in_handles.arg_name))
+        f.write("\t\tstruct ipc_command_msg _handle_msg = {0};\n")
+    if call.out_handles:
+        f.write("\t\t%s %s[XRT_MAX_IPC_HANDLES] = {0};\n" % (
+            call.out_handles.typename, call.out_handles.arg_name))
+        f.write("\t\t%s %s = {0};\n" % (
+            call.out_handles.count_arg_type,
+            call.out_handles.count_arg_name))
+    f.write("\n")
+
+    if call.in_handles:
+        # Validate the number of handles.
+        f.write("\t\tif (msg->%s > XRT_MAX_IPC_HANDLES) {\n" % (call.in_handles.count_arg_name))
+        f.write("\t\t\treturn XRT_ERROR_IPC_FAILURE;\n")
+        f.write("\t\t}\n")
+
+        # Let the client know we are ready to receive the handles.
+        write_invocation(
+            f,
+            'xrt_result_t sync_result',
+            'ipc_send',
+            (
+                imc,
+                "&_sync",
+                "sizeof(_sync)"
+            ),
+            indent="\t\t"
+        )
+        f.write(";")
+        write_result_handler(f, "sync_result",
+                             indent="\t\t")
+        write_invocation(
+            f,
+            'xrt_result_t receive_handle_result',
+            'ipc_receive_handles_' + call.in_handles.stem,
+            (
+                imc,
+                "&_handle_msg",
+                "sizeof(_handle_msg)",
+                "in_" + call.in_handles.arg_name,
+                "msg->"+call.in_handles.count_arg_name
+            ),
+            indent="\t\t"
+        )
+        f.write(";")
+        write_result_handler(f, "receive_handle_result",
+                             indent="\t\t")
+        f.write("\t\tif (_handle_msg.cmd != %s) {\n" % str(call.id))
+        f.write("\t\t\treturn XRT_ERROR_IPC_FAILURE;\n")
+        f.write("\t\t}\n")
+
+    # Write call to ipc_handle_CALLNAME
+    args = ["ics"]
+
+    # Always provide in arguments.
+    for arg in call.in_args:
+        args.append(("&msg->" + arg.name)
+                    if arg.is_aggregate
+                    else ("msg->" + arg.name))
+
+    # No reply arguments on varlen.
+    if not call.varlen:
+        args.extend("&reply." + arg.name for arg in call.out_args)
+
+    if call.out_handles:
+        args.extend(("XRT_MAX_IPC_HANDLES",
+                     call.out_handles.arg_name,
+                     "&" + call.out_handles.count_arg_name))
+
+    if call.in_handles:
+        args.extend(("&in_%s[0]" % call.in_handles.arg_name,
+                     "msg->"+call.in_handles.count_arg_name))
+
+    # Should we put the return in the reply or return it?
+    return_target = 'reply.result'
+    if call.varlen:
+        return_target = 'xrt_result_t xret'
+
+    write_invocation(f, return_target, 'ipc_handle_' +
+                     call.name, args, indent="\t\t")
+    f.write(";\n")
+
+    # TODO do we check reply.result and
+    # error out before replying if it's not success?
+
+    if not call.varlen:
+        func = 'ipc_send'
+        args = [imc,
+                "&reply",
+                "sizeof(reply)"]
+        if call.out_handles:
+            func += '_handles_' + call.out_handles.stem
+            args.extend(call.out_handles.arg_names)
+        write_invocation(f, 'xrt_result_t xret', func, args, indent="\t\t")
+        f.write(";")
+
+    f.write("\n\t\treturn xret;\n")
+    f.write("\t}\n")
+
+
 def generate_server_c(file, p):
     """Generate IPC server stub/dispatch source."""
     f = open(file, "w")
@@ -287,127 +425,29 @@ ipc_dispatch(volatile struct ipc_client_state *ics, ipc_command_t *ipc_command)
 ''')
 
     for call in p.calls:
-        f.write("\tcase " + call.id + ": {\n")
-
-        f.write("\t\tIPC_TRACE(ics->server, \"Dispatching " + call.name +
-                "\");\n\n")
-
-        if call.needs_msg_struct:
-            f.write(
-                "\t\tstruct ipc_{}_msg *msg = ".format(call.name))
-            f.write("(struct ipc_{}_msg *)ipc_command;\n".format(call.name))
-
-        if call.varlen:
-            f.write("\t\t// No return arguments")
-        elif call.out_args:
-            f.write("\t\tstruct ipc_%s_reply reply = {0};\n" % call.name)
-        else:
-            f.write("\t\tstruct ipc_result_reply reply = {0};\n")
-
-        if call.in_handles:
-            # We need to fetch these handles separately
-            f.write("\t\tstruct ipc_result_reply _sync = {XRT_SUCCESS};\n")
-            f.write("\t\t%s in_%s[XRT_MAX_IPC_HANDLES] = {0};\n" % (
-                call.in_handles.typename, call.in_handles.arg_name))
-            f.write("\t\tstruct ipc_command_msg _handle_msg = {0};\n")
-        if call.out_handles:
-            f.write("\t\t%s %s[XRT_MAX_IPC_HANDLES] = {0};\n" % (
-                call.out_handles.typename, call.out_handles.arg_name))
-            f.write("\t\t%s %s = {0};\n" % (
-                call.out_handles.count_arg_type,
-                call.out_handles.count_arg_name))
-        f.write("\n")
-
-        if call.in_handles:
-            # Validate the number of handles.
-            f.write("\t\tif (msg->%s > XRT_MAX_IPC_HANDLES) {\n" % (call.in_handles.count_arg_name))
-            f.write("\t\t\treturn XRT_ERROR_IPC_FAILURE;\n")
-            f.write("\t\t}\n")
-
-            # Let the client know we are ready to receive the handles.
-            write_invocation(
-                f,
-                'xrt_result_t sync_result',
-                'ipc_send',
-                (
-                    "(struct ipc_message_channel *)&ics->imc",
-                    "&_sync",
-                    "sizeof(_sync)"
-                ),
-                indent="\t\t"
-            )
-            f.write(";")
-            write_result_handler(f, "sync_result",
-                                 indent="\t\t")
-            write_invocation(
-                f,
-                'xrt_result_t receive_handle_result',
-                'ipc_receive_handles_' + call.in_handles.stem,
-                (
-                    "(struct ipc_message_channel *)&ics->imc",
-                    "&_handle_msg",
-                    "sizeof(_handle_msg)",
-                    "in_" + call.in_handles.arg_name,
-                    "msg->"+call.in_handles.count_arg_name
-                ),
-                indent="\t\t"
-            )
-            f.write(";")
-            write_result_handler(f, "receive_handle_result",
-                                 indent="\t\t")
-            f.write("\t\tif (_handle_msg.cmd != %s) {\n" % str(call.id))
-            f.write("\t\t\treturn XRT_ERROR_IPC_FAILURE;\n")
-            f.write("\t\t}\n")
-
-        # Write call to ipc_handle_CALLNAME
-        args = ["ics"]
-
-        # Always provide in arguments.
-        for arg in call.in_args:
-            args.append(("&msg->" + arg.name)
-                        if arg.is_aggregate
-                        else ("msg->" + arg.name))
-
-        # No reply arguments on varlen.
-        if not call.varlen:
-            args.extend("&reply." + arg.name for arg in call.out_args)
-
-        if call.out_handles:
-            args.extend(("XRT_MAX_IPC_HANDLES",
-                         call.out_handles.arg_name,
-                         "&" + call.out_handles.count_arg_name))
-
-        if call.in_handles:
-            args.extend(("&in_%s[0]" % call.in_handles.arg_name,
-                         "msg->"+call.in_handles.count_arg_name))
+        write_dispatch_case(f, call, "(struct ipc_message_channel *)&ics->imc")
+    f.write('''\tdefault:
+\t\tU_LOG_E("UNHANDLED IPC MESSAGE! %d", *ipc_command);
+\t\treturn XRT_ERROR_IPC_FAILURE;
+\t}
+}
 
-        # Should we put the return in the reply or return it?
-        return_target = 'reply.result'
-        if call.varlen:
-            return_target = 'xrt_result_t xret'
+''')
 
-        write_invocation(f, return_target, 'ipc_handle_' +
-                         call.name, args, indent="\t\t")
-        f.write(";\n")
+    f.write('''
+xrt_result_t
+ipc_dispatch_tracking(volatile struct ipc_client_state *ics,
+                      struct ipc_message_channel *imc,
+                      ipc_command_t *ipc_command)
+{
+\tswitch (*ipc_command) {
+''')
 
-        # TODO do we check reply.result and
-        # error out before replying if it's not success?
-
-        if not call.varlen:
-            func = 'ipc_send'
-            args = ["(struct ipc_message_channel *)&ics->imc",
-                    "&reply",
-                    "sizeof(reply)"]
-            if call.out_handles:
-                func += '_handles_' + call.out_handles.stem
-                args.extend(call.out_handles.arg_names)
-            write_invocation(f, 'xrt_result_t xret', func, args, indent="\t\t")
-            f.write(";")
-
-        f.write("\n\t\treturn xret;\n")
-        f.write("\t}\n")
+    for call in p.calls:
+        if call.tracking_channel:
+            write_dispatch_case(f, call, "imc")
     f.write('''\tdefault:
-\t\tU_LOG_E("UNHANDLED IPC MESSAGE! %d", *ipc_command);
+\t\tU_LOG_E("IPC MESSAGE %d NOT ALLOWED ON TRACKING CHANNEL!", *ipc_command);
 \t\treturn XRT_ERROR_IPC_FAILURE;
 \t}
 }
@@ -472,6 +512,18 @@ def generate_server_header(file, p):
     )
     f.write(";\n")
 
+    write_decl(
+        f,
+        "xrt_result_t",
+        "ipc_dispatch_tracking",
+        [
+            "volatile struct ipc_client_state *ics",
+            "struct ipc_message_channel *imc",
+            "ipc_command_t *ipc_command"
+        ]
+    )
+    f.write(";\n")
+
     write_decl(
         f,
         "size_t",
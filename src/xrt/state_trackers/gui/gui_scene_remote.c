@@ -9,6 +9,8 @@
 
 #include "xrt/xrt_config_drivers.h"
 
+#include "os/os_time.h"
+
 #include "util/u_misc.h"
 #include "util/u_logging.h"
 
@@ -40,6 +42,9 @@ struct gui_remote
 	struct r_remote_data reset;
 	struct r_remote_data data;
 
+	//! Sequence number of the last packet sent on this connection.
+	uint64_t sequence;
+
 	// Was the left trigger pushed last frame?
 	bool left_trigger_was_pressed_last_frame;
 
@@ -369,6 +374,10 @@ on_connected(struct gui_remote *gr, struct gui_program *p)
 		render_cheat_menu(gr, p);
 	}
 
+	gr->data.header = R_HEADER_VALUE;
+	gr->data.timestamp_ns = (int64_t)os_monotonic_get_ns();
+	gr->data.sequence = ++gr->sequence;
+
 	r_remote_connection_write_one(&gr->rc, &gr->data);
 }
 
@@ -391,6 +400,7 @@ on_not_connected(struct gui_remote *gr, struct gui_program *p)
 		return;
 	}
 
+	gr->sequence = 0;
 	r_remote_connection_init(&gr->rc, gr->address, gr->port);
 	r_remote_connection_read_one(&gr->rc, &gr->reset);
 	r_remote_connection_read_one(&gr->rc, &gr->data);
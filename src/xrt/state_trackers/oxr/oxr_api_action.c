@@ -227,15 +227,13 @@ oxr_xrSuggestInteractionProfileBindings(XrInstance instance,
 	bool has_dpad = inst->extensions.EXT_dpad_binding;
 
 	struct profile_template *interaction_profile_template = NULL;
-	for (uint32_t i = 0; i < ARRAY_SIZE(profile_templates); i++) {
-		if (ip == profile_templates[i].path_cache) {
-			subpath_fn = profile_templates[i].subpath_fn;
-			dpad_path_fn = profile_templates[i].dpad_path_fn;
-			dpad_emulator_fn = profile_templates[i].dpad_emulator_fn;
-			ext_verify_fn = profile_templates[i].ext_verify_fn;
-			interaction_profile_template = &profile_templates[i];
-			break;
-		}
+	uint32_t known_index = 0;
+	if (oxr_path_get_known_index(inst, ip, &known_index) && oxr_bindings_known_path_profiles[known_index] >= 0) {
+		interaction_profile_template = &profile_templates[oxr_bindings_known_path_profiles[known_index]];
+		subpath_fn = interaction_profile_template->subpath_fn;
+		dpad_path_fn = interaction_profile_template->dpad_path_fn;
+		dpad_emulator_fn = interaction_profile_template->dpad_emulator_fn;
+		ext_verify_fn = interaction_profile_template->ext_verify_fn;
 	}
 
 	if (interaction_profile_template == NULL) {
@@ -299,7 +299,13 @@ locate_spaces(XrSession session, const XrSpacesLocateInfo *locateInfo, XrSpaceLo
 
 
 	uint32_t space_count = locateInfo->spaceCount;
-	struct oxr_space **spaces = U_TYPED_ARRAY_CALLOC(struct oxr_space *, space_count);
+
+	// Only allocate if there are a lot of spaces.
+	struct oxr_space *spaces_stack[OXR_SPACES_LOCATE_STACK_COUNT];
+	struct oxr_space **spaces = spaces_stack;
+	if (space_count > OXR_SPACES_LOCATE_STACK_COUNT) {
+		spaces = U_TYPED_ARRAY_CALLOC(struct oxr_space *, space_count);
+	}
 
 	XrResult res;
 	for (uint32_t i = 0; i < space_count; i++) {
@@ -313,7 +319,9 @@ locate_spaces(XrSession session, const XrSpacesLocateInfo *locateInfo, XrSpaceLo
 		res = oxr_spaces_locate(&log, spaces, space_count, baseSpc, locateInfo->time, spaceLocations);
 	}
 
-	free(spaces);
+	if (spaces != spaces_stack) {
+		free(spaces);
+	}
 
 	return res;
 }
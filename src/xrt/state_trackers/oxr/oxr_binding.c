@@ -24,23 +24,16 @@
 static void
 setup_paths(struct oxr_logger *log,
             struct oxr_instance *inst,
-            const char **src_paths,
+            const uint32_t *src_path_indices,
+            uint32_t src_path_count,
             XrPath **dest_paths,
             uint32_t *dest_path_count)
 {
-	uint32_t count = 0;
-	while (src_paths[count] != NULL) {
-		assert(count != UINT32_MAX);
-		count++;
-	}
-
-	*dest_path_count = count;
-	*dest_paths = U_TYPED_ARRAY_CALLOC(XrPath, count);
+	*dest_path_count = src_path_count;
+	*dest_paths = U_TYPED_ARRAY_CALLOC(XrPath, src_path_count);
 
-	for (size_t x = 0; x < *dest_path_count; x++) {
-		const char *str = src_paths[x];
-		size_t len = strlen(str);
-		oxr_path_get_or_create(log, inst, str, len, &(*dest_paths)[x]);
+	for (uint32_t x = 0; x < src_path_count; x++) {
+		(*dest_paths)[x] = oxr_path_get_known(inst, src_path_indices[x]);
 	}
 }
 
@@ -113,24 +106,20 @@ interaction_profile_find_or_create_in_instance(struct oxr_logger *log,
 		return true;
 	}
 
-	struct profile_template *templ = NULL;
-
-	for (size_t x = 0; x < OXR_BINDINGS_PROFILE_TEMPLATE_COUNT; x++) {
-		XrPath t_path = XR_NULL_PATH;
-
-		oxr_path_get_or_create(log, inst, profile_templates[x].path, strlen(profile_templates[x].path),
-		                       &t_path);
-		if (t_path == path) {
-			templ = &profile_templates[x];
-			break;
-		}
+	// All profile paths are known paths, no need to look at any strings.
+	uint32_t index = 0;
+	int16_t templ_index = -1;
+	if (oxr_path_get_known_index(inst, path, &index)) {
+		templ_index = oxr_bindings_known_path_profiles[index];
 	}
 
-	if (templ == NULL) {
+	if (templ_index < 0) {
 		*out_p = NULL;
 		return false;
 	}
 
+	struct profile_template *templ = &profile_templates[templ_index];
+
 	struct oxr_interaction_profile *p = U_TYPED_CALLOC(struct oxr_interaction_profile);
 
 	p->xname = templ->name;
@@ -145,19 +134,13 @@ interaction_profile_find_or_create_in_instance(struct oxr_logger *log,
 		struct binding_template *t = &templ->bindings[x];
 		struct oxr_binding *b = &p->bindings[x];
 
-		XrPath subaction_path;
-		XrResult r =
-		    oxr_path_get_or_create(log, inst, t->subaction_path, strlen(t->subaction_path), &subaction_path);
-		if (r != XR_SUCCESS) {
-			oxr_log(log, "Couldn't get subaction path %s\n", t->subaction_path);
-		}
-
+		XrPath subaction_path = oxr_path_get_known(inst, t->subaction_path_index);
 		if (!get_subaction_path_from_path(log, inst, subaction_path, &b->subaction_path)) {
 			oxr_log(log, "Invalid subaction path %s\n", t->subaction_path);
 		}
 
 		b->localized_name = t->localized_name;
-		setup_paths(log, inst, t->paths, &b->paths, &b->path_count);
+		setup_paths(log, inst, t->path_indices, t->path_count, &b->paths, &b->path_count);
 		b->input = t->input;
 		b->dpad_activate = t->dpad_activate;
 		b->output = t->output;
@@ -167,18 +150,12 @@ interaction_profile_find_or_create_in_instance(struct oxr_logger *log,
 		struct dpad_emulation *t = &templ->dpads[x];
 		struct oxr_dpad_emulation *d = &p->dpads[x];
 
-		XrPath subaction_path;
-		XrResult r =
-		    oxr_path_get_or_create(log, inst, t->subaction_path, strlen(t->subaction_path), &subaction_path);
-		if (r != XR_SUCCESS) {
-			oxr_log(log, "Couldn't get subaction path %s\n", t->subaction_path);
-		}
-
+		XrPath subaction_path = oxr_path_get_known(inst, t->subaction_path_index);
 		if (!get_subaction_path_from_path(log, inst, subaction_path, &d->subaction_path)) {
 			oxr_log(log, "Invalid subaction path %s\n", t->subaction_path);
 		}
 
-		setup_paths(log, inst, t->paths, &d->paths, &d->path_count);
+		setup_paths(log, inst, t->path_indices, t->path_count, &d->paths, &d->path_count);
 		d->position = t->position;
 		d->activate = t->activate;
 	}
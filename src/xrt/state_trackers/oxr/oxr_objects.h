@@ -332,6 +332,24 @@ oxr_path_get_or_create(
 XrResult
 oxr_path_only_get(struct oxr_logger *log, struct oxr_instance *inst, const char *str, size_t length, XrPath *out_path);
 
+/*!
+ * Get the path for the given index into @ref oxr_bindings_known_paths, these
+ * paths are always created with the instance so this never fails.
+ *
+ * @public @memberof oxr_instance
+ */
+XrPath
+oxr_path_get_known(struct oxr_instance *inst, uint32_t index);
+
+/*!
+ * Get the index into @ref oxr_bindings_known_paths of the given path,
+ * returns false if it is not one of the known paths.
+ *
+ * @public @memberof oxr_instance
+ */
+bool
+oxr_path_get_known_index(struct oxr_instance *inst, XrPath path, uint32_t *out_index);
+
 /*!
  * Get a pointer and length of the internal string.
  *
@@ -907,6 +925,12 @@ XrResult
 oxr_space_locate(
     struct oxr_logger *log, struct oxr_space *spc, struct oxr_space *baseSpc, XrTime time, XrSpaceLocation *location);
 
+/*!
+ * Number of spaces that @ref oxr_spaces_locate and xrLocateSpaces handle
+ * without any heap allocations, more spaces than this are still fine.
+ */
+#define OXR_SPACES_LOCATE_STACK_COUNT 64
+
 XrResult
 oxr_spaces_locate(struct oxr_logger *log,
                   struct oxr_space **spcs,
@@ -1658,6 +1682,8 @@ struct oxr_instance
 	size_t path_array_length;
 	//! Number of paths in the array (0 is always null).
 	size_t path_num;
+	//! Single allocation holding all paths from @ref oxr_bindings_known_paths.
+	void *known_path_block;
 
 	// Event queue.
 	struct
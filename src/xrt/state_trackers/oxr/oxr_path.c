@@ -8,12 +8,15 @@
  */
 
 #include <stdio.h>
+#include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "math/m_api.h"
 #include "util/u_misc.h"
 
+#include "bindings/b_generated_bindings.h"
+
 #include "oxr_objects.h"
 #include "oxr_logger.h"
 
@@ -32,6 +35,13 @@ struct oxr_path
 };
 
 
+/*!
+ * The known paths are created first, right after XR_NULL_PATH, so the id of
+ * a known path is its index into @ref oxr_bindings_known_paths plus this.
+ */
+#define KNOWN_PATH_FIRST_ID ((XrPath)1)
+
+
 /*
  *
  * Helpers
@@ -134,6 +144,61 @@ oxr_allocate_path(
 	return XR_SUCCESS;
 }
 
+static inline size_t
+known_path_size(uint32_t index)
+{
+	size_t size = 0;
+
+	size += sizeof(struct oxr_path);                    // Main path object.
+	size += sizeof(struct u_hashset_item);              // Embedded hashset item.
+	size += oxr_bindings_known_path_lengths[index] + 1; // String and null terminator.
+
+	// Keep the next path aligned.
+	return (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+/*!
+ * Create all of the known paths in one allocation, they are not added to the
+ * hashset as @ref oxr_bindings_find_known_path is used to look them up.
+ */
+static XrResult
+oxr_create_known_paths(struct oxr_logger *log, struct oxr_instance *inst)
+{
+	size_t total = 0;
+	for (uint32_t i = 0; i < OXR_BINDINGS_KNOWN_PATH_COUNT; i++) {
+		total += known_path_size(i);
+	}
+
+	uint8_t *block = U_TYPED_ARRAY_CALLOC(uint8_t, total);
+	if (block == NULL) {
+		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to allocate known paths");
+	}
+
+	uint8_t *ptr = block;
+	for (uint32_t i = 0; i < OXR_BINDINGS_KNOWN_PATH_COUNT; i++) {
+		struct oxr_path *path = (struct oxr_path *)ptr;
+		struct u_hashset_item *item = get_item(path);
+		size_t length = oxr_bindings_known_path_lengths[i];
+
+		path->debug = OXR_XR_DEBUG_PATH;
+		item->hash = 0; // Not in the hashset.
+		item->length = length;
+
+		// Yes a const cast! D:
+		memcpy((char *)item->c_str, oxr_bindings_known_paths[i], length + 1);
+
+		oxr_ensure_array_length(log, inst, &path->id);
+		assert(path->id == KNOWN_PATH_FIRST_ID + i);
+		inst->path_array[path->id] = path;
+
+		ptr += known_path_size(i);
+	}
+
+	inst->known_path_block = block;
+
+	return XR_SUCCESS;
+}
+
 struct oxr_path *
 get_path_or_null(struct oxr_logger *log, const struct oxr_instance *inst, XrPath xr_path)
 {
@@ -174,9 +239,16 @@ oxr_path_get_or_create(
 {
 	struct u_hashset_item *item;
 	struct oxr_path *path = NULL;
+	uint32_t index;
 	XrResult ret;
 	int h_ret;
 
+	// Paths used by the bindings, no allocation needed.
+	if (oxr_bindings_find_known_path(str, length, &index)) {
+		*out_path = KNOWN_PATH_FIRST_ID + index;
+		return XR_SUCCESS;
+	}
+
 	// Look it up the instance path store.
 	h_ret = u_hashset_find_str(inst->path_store, str, length, &item);
 	if (h_ret == 0) {
@@ -199,8 +271,14 @@ XrResult
 oxr_path_only_get(struct oxr_logger *log, struct oxr_instance *inst, const char *str, size_t length, XrPath *out_path)
 {
 	struct u_hashset_item *item;
+	uint32_t index;
 	int h_ret;
 
+	if (oxr_bindings_find_known_path(str, length, &index)) {
+		*out_path = KNOWN_PATH_FIRST_ID + index;
+		return XR_SUCCESS;
+	}
+
 	// Look it up the instance path store.
 	h_ret = u_hashset_find_str(inst->path_store, str, length, &item);
 	if (h_ret == 0) {
@@ -212,6 +290,27 @@ oxr_path_only_get(struct oxr_logger *log, struct oxr_instance *inst, const char
 	return XR_SUCCESS;
 }
 
+XrPath
+oxr_path_get_known(struct oxr_instance *inst, uint32_t index)
+{
+	assert(index < OXR_BINDINGS_KNOWN_PATH_COUNT);
+	assert(inst->known_path_block != NULL);
+
+	return KNOWN_PATH_FIRST_ID + index;
+}
+
+bool
+oxr_path_get_known_index(struct oxr_instance *inst, XrPath xr_path, uint32_t *out_index)
+{
+	if (xr_path < KNOWN_PATH_FIRST_ID || xr_path >= KNOWN_PATH_FIRST_ID + OXR_BINDINGS_KNOWN_PATH_COUNT) {
+		return false;
+	}
+
+	*out_index = (uint32_t)(xr_path - KNOWN_PATH_FIRST_ID);
+
+	return true;
+}
+
 XrResult
 oxr_path_get_string(
     struct oxr_logger *log, const struct oxr_instance *inst, XrPath xr_path, const char **out_str, size_t *out_length)
@@ -243,12 +342,14 @@ oxr_path_init(struct oxr_logger *log, struct oxr_instance *inst)
 		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to create hashset");
 	}
 
-	size_t new_size = 64;
+	// Room for XR_NULL_PATH, all known paths and then some, in one go.
+	size_t new_size = 1 + OXR_BINDINGS_KNOWN_PATH_COUNT + 64;
+
 	U_ARRAY_REALLOC_OR_FREE(inst->path_array, struct oxr_path *, new_size);
 	inst->path_array_length = new_size;
 	inst->path_num = 1; // Reserve space for XR_NULL_PATH
 
-	return XR_SUCCESS;
+	return oxr_create_known_paths(log, inst);
 }
 
 void
@@ -262,6 +363,9 @@ oxr_path_destroy(struct oxr_logger *log, struct oxr_instance *inst)
 	inst->path_num = 0;
 	inst->path_array_length = 0;
 
+	free(inst->known_path_block);
+	inst->known_path_block = NULL;
+
 	if (inst->path_store == NULL) {
 		return;
 	}
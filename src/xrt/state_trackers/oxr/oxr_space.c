@@ -310,9 +310,24 @@ oxr_spaces_locate(struct oxr_logger *log,
 
 	struct xrt_space *xbase = NULL;
 
-	struct xrt_space **xspcs = U_TYPED_ARRAY_CALLOC(struct xrt_space *, spc_count);
-	struct xrt_pose *offsets = U_TYPED_ARRAY_CALLOC(struct xrt_pose, spc_count);
-
+	// Avoid allocating for the common case of not that many spaces.
+	struct xrt_space *xspcs_stack[OXR_SPACES_LOCATE_STACK_COUNT];
+	struct xrt_pose offsets_stack[OXR_SPACES_LOCATE_STACK_COUNT];
+	struct xrt_space_relation results_stack[OXR_SPACES_LOCATE_STACK_COUNT];
+	bool use_heap = spc_count > OXR_SPACES_LOCATE_STACK_COUNT;
+
+	struct xrt_space **xspcs = xspcs_stack;
+	struct xrt_pose *offsets = offsets_stack;
+	struct xrt_space_relation *results = results_stack;
+
+	if (use_heap) {
+		xspcs = U_TYPED_ARRAY_CALLOC(struct xrt_space *, spc_count);
+		offsets = U_TYPED_ARRAY_CALLOC(struct xrt_pose, spc_count);
+		results = U_TYPED_ARRAY_CALLOC(struct xrt_space_relation, spc_count);
+	} else {
+		// Zero initialized means relation flags == 0, see below.
+		memset(results, 0, sizeof(*results) * spc_count);
+	}
 
 	XrResult ret = XR_SUCCESS;
 
@@ -332,9 +347,7 @@ oxr_spaces_locate(struct oxr_logger *log,
 		ret = get_xrt_space(log, baseSpc, &xbase);
 	}
 
-	// Only fill this out if the above succeeded. Zero initialized means relation flags == 0.
-	struct xrt_space_relation *results = U_TYPED_ARRAY_CALLOC(struct xrt_space_relation, spc_count);
-
+	// Only fill out results if the above succeeded. Zero initialized means relation flags == 0.
 	if (ret == XR_SUCCESS) {
 		// Convert at_time to monotonic and give to device.
 		uint64_t at_timestamp_ns = time_state_ts_to_monotonic_ns(sys->inst->timekeeping, time);
@@ -427,7 +440,9 @@ oxr_spaces_locate(struct oxr_logger *log,
 		oxr_slog_cancel(&slog);
 	}
 
-	free_spaces(&xspcs, &offsets, &results);
+	if (use_heap) {
+		free_spaces(&xspcs, &offsets, &results);
+	}
 
 	if (ret != XR_SUCCESS) {
 		return ret;
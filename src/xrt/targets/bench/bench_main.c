@@ -0,0 +1,780 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Headless OpenXR client for benchmarking the service.
+ *
+ * Opens a number of headless sessions, each in its own process, and runs
+ * the calls an application makes every frame in a loop, printing how long
+ * they take. Meant to be used with the load devices of the simulated
+ * builder, see `SIMULATED_LOAD_DEVICES`.
+ *
+ * @ingroup xrt_iface
+ */
+
+#include "xrt/xrt_compiler.h"
+
+#include "os/os_time.h"
+
+#include "util/u_time.h"
+#include "util/u_live_stats.h"
+#include "util/u_pretty_print.h"
+
+#include <time.h>
+
+#define XR_USE_TIMESPEC
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader_negotiation.h>
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+#define P(...) fprintf(stderr, __VA_ARGS__)
+
+//! Used if no runtime is given on the command line, set by the build system.
+#ifndef BENCH_RUNTIME_PATH
+#define BENCH_RUNTIME_PATH "libopenxr_monado.so"
+#endif
+
+//! How far ahead of now poses are located when there is no display time.
+#define PREDICT_AHEAD_NS (U_TIME_1MS_IN_NS * 20)
+
+#define CHECK_XR(CALL, NAME)                                                                                           \
+	do {                                                                                                           \
+		XrResult _ret = CALL;                                                                                  \
+		if (XR_FAILED(_ret)) {                                                                                 \
+			P("[%u] %s failed: %d\n", b->index, NAME, (int)_ret);                                          \
+			return false;                                                                                  \
+		}                                                                                                      \
+	} while (false)
+
+#define GET_PROC(NAME)                                                                                                 \
+	do {                                                                                                           \
+		XrResult _ret = b->xrGetInstanceProcAddr(b->instance, #NAME, (PFN_xrVoidFunction *)&b->NAME);          \
+		if (XR_FAILED(_ret)) {                                                                                 \
+			P("[%u] Could not get '%s': %d\n", b->index, #NAME, (int)_ret);                                \
+			return false;                                                                                  \
+		}                                                                                                      \
+	} while (false)
+
+struct options
+{
+	const char *runtime_path;
+	uint32_t session_count;
+	uint32_t seconds;
+	uint32_t rate_hz;
+};
+
+/*!
+ * Everything for one session, each lives in its own process.
+ */
+struct bench
+{
+	uint32_t index;
+	const struct options *opts;
+
+	void *lib;
+
+	PFN_xrGetInstanceProcAddr xrGetInstanceProcAddr;
+	PFN_xrEnumerateInstanceExtensionProperties xrEnumerateInstanceExtensionProperties;
+	PFN_xrCreateInstance xrCreateInstance;
+	PFN_xrDestroyInstance xrDestroyInstance;
+	PFN_xrGetSystem xrGetSystem;
+	PFN_xrGetSystemProperties xrGetSystemProperties;
+	PFN_xrStringToPath xrStringToPath;
+	PFN_xrCreateSession xrCreateSession;
+	PFN_xrBeginSession xrBeginSession;
+	PFN_xrEndSession xrEndSession;
+	PFN_xrPollEvent xrPollEvent;
+	PFN_xrCreateReferenceSpace xrCreateReferenceSpace;
+	PFN_xrCreateActionSet xrCreateActionSet;
+	PFN_xrCreateAction xrCreateAction;
+	PFN_xrSuggestInteractionProfileBindings xrSuggestInteractionProfileBindings;
+	PFN_xrAttachSessionActionSets xrAttachSessionActionSets;
+	PFN_xrCreateActionSpace xrCreateActionSpace;
+	PFN_xrSyncActions xrSyncActions;
+	PFN_xrGetActionStateBoolean xrGetActionStateBoolean;
+	PFN_xrLocateSpaces xrLocateSpaces;
+	PFN_xrWaitFrame xrWaitFrame;
+	PFN_xrBeginFrame xrBeginFrame;
+	PFN_xrEndFrame xrEndFrame;
+	PFN_xrConvertTimespecTimeToTimeKHR xrConvertTimespecTimeToTimeKHR;
+	PFN_xrCreateHandTrackerEXT xrCreateHandTrackerEXT;
+	PFN_xrLocateHandJointsEXT xrLocateHandJointsEXT;
+
+	bool has_hand_tracking_ext;
+	bool has_hand_tracking;
+
+	XrInstance instance;
+	XrSystemId system_id;
+	XrSession session;
+	XrSpace local_space;
+	XrActionSet action_set;
+	XrAction select_action;
+	XrAction grip_action;
+	XrPath hand_paths[2];
+	XrSpace hand_spaces[2];
+	XrHandTrackerEXT hand_trackers[2];
+
+	bool running;
+	bool exit;
+
+	struct
+	{
+		struct u_live_stats_ns wait;
+		struct u_live_stats_ns begin;
+		struct u_live_stats_ns sync;
+		struct u_live_stats_ns locate;
+		struct u_live_stats_ns hands;
+		struct u_live_stats_ns end;
+		struct u_live_stats_ns frame;
+	} stats;
+};
+
+
+/*
+ *
+ * Setup functions.
+ *
+ */
+
+static bool
+load_runtime(struct bench *b)
+{
+	b->lib = dlopen(b->opts->runtime_path, RTLD_NOW | RTLD_LOCAL);
+	if (b->lib == NULL) {
+		P("[%u] Could not load '%s': %s\n", b->index, b->opts->runtime_path, dlerror());
+		return false;
+	}
+
+	PFN_xrNegotiateLoaderRuntimeInterface negotiate =
+	    (PFN_xrNegotiateLoaderRuntimeInterface)dlsym(b->lib, "xrNegotiateLoaderRuntimeInterface");
+	if (negotiate == NULL) {
+		P("[%u] '%s' is not a OpenXR runtime\n", b->index, b->opts->runtime_path);
+		return false;
+	}
+
+	XrNegotiateLoaderInfo loader_info = {
+	    .structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO,
+	    .structVersion = XR_LOADER_INFO_STRUCT_VERSION,
+	    .structSize = sizeof(XrNegotiateLoaderInfo),
+	    .minInterfaceVersion = 1,
+	    .maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION,
+	    .minApiVersion = XR_MAKE_VERSION(1, 0, 0),
+	    .maxApiVersion = XR_MAKE_VERSION(1, 0x3ff, 0xfff),
+	};
+
+	XrNegotiateRuntimeRequest runtime_request = {
+	    .structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST,
+	    .structVersion = XR_RUNTIME_INFO_STRUCT_VERSION,
+	    .structSize = sizeof(XrNegotiateRuntimeRequest),
+	};
+
+	CHECK_XR(negotiate(&loader_info, &runtime_request), "xrNegotiateLoaderRuntimeInterface");
+
+	b->xrGetInstanceProcAddr = runtime_request.getInstanceProcAddr;
+
+	// Global functions, instance is XR_NULL_HANDLE here.
+	GET_PROC(xrEnumerateInstanceExtensionProperties);
+	GET_PROC(xrCreateInstance);
+
+	return true;
+}
+
+static bool
+has_extension(const XrExtensionProperties *props, uint32_t count, const char *name)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		if (strcmp(props[i].extensionName, name) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+create_instance(struct bench *b)
+{
+	XrExtensionProperties props[128];
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(props); i++) {
+		props[i] = (XrExtensionProperties){.type = XR_TYPE_EXTENSION_PROPERTIES};
+	}
+
+	CHECK_XR(b->xrEnumerateInstanceExtensionProperties(NULL, ARRAY_SIZE(props), &count, props),
+	         "xrEnumerateInstanceExtensionProperties");
+
+	const char *required[] = {
+	    XR_MND_HEADLESS_EXTENSION_NAME,
+	    XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME,
+	};
+
+	const char *extensions[ARRAY_SIZE(required) + 1];
+	uint32_t extension_count = 0;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(required); i++) {
+		if (!has_extension(props, count, required[i])) {
+			P("[%u] Runtime does not support '%s'\n", b->index, required[i]);
+			return false;
+		}
+		extensions[extension_count++] = required[i];
+	}
+
+	b->has_hand_tracking_ext = has_extension(props, count, XR_EXT_HAND_TRACKING_EXTENSION_NAME);
+	if (b->has_hand_tracking_ext) {
+		extensions[extension_count++] = XR_EXT_HAND_TRACKING_EXTENSION_NAME;
+	}
+
+	XrInstanceCreateInfo create_info = {
+	    .type = XR_TYPE_INSTANCE_CREATE_INFO,
+	    .applicationInfo =
+	        {
+	            .applicationVersion = 1,
+	            .engineVersion = 1,
+	            .apiVersion = XR_MAKE_VERSION(1, 1, 0),
+	        },
+	    .enabledExtensionCount = extension_count,
+	    .enabledExtensionNames = extensions,
+	};
+	XrApplicationInfo *app_info = &create_info.applicationInfo;
+	snprintf(app_info->applicationName, XR_MAX_APPLICATION_NAME_SIZE, "monado-bench-%u", b->index);
+	snprintf(app_info->engineName, XR_MAX_ENGINE_NAME_SIZE, "monado-bench");
+
+	CHECK_XR(b->xrCreateInstance(&create_info, &b->instance), "xrCreateInstance");
+
+	GET_PROC(xrDestroyInstance);
+	GET_PROC(xrGetSystem);
+	GET_PROC(xrGetSystemProperties);
+	GET_PROC(xrStringToPath);
+	GET_PROC(xrCreateSession);
+	GET_PROC(xrBeginSession);
+	GET_PROC(xrEndSession);
+	GET_PROC(xrPollEvent);
+	GET_PROC(xrCreateReferenceSpace);
+	GET_PROC(xrCreateActionSet);
+	GET_PROC(xrCreateAction);
+	GET_PROC(xrSuggestInteractionProfileBindings);
+	GET_PROC(xrAttachSessionActionSets);
+	GET_PROC(xrCreateActionSpace);
+	GET_PROC(xrSyncActions);
+	GET_PROC(xrGetActionStateBoolean);
+	GET_PROC(xrLocateSpaces);
+	GET_PROC(xrWaitFrame);
+	GET_PROC(xrBeginFrame);
+	GET_PROC(xrEndFrame);
+	GET_PROC(xrConvertTimespecTimeToTimeKHR);
+	if (b->has_hand_tracking_ext) {
+		GET_PROC(xrCreateHandTrackerEXT);
+		GET_PROC(xrLocateHandJointsEXT);
+	}
+
+	return true;
+}
+
+static bool
+create_session(struct bench *b)
+{
+	XrSystemGetInfo system_info = {
+	    .type = XR_TYPE_SYSTEM_GET_INFO,
+	    .formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY,
+	};
+	CHECK_XR(b->xrGetSystem(b->instance, &system_info, &b->system_id), "xrGetSystem");
+
+	if (b->has_hand_tracking_ext) {
+		XrSystemHandTrackingPropertiesEXT hand_props = {.type = XR_TYPE_SYSTEM_HAND_TRACKING_PROPERTIES_EXT};
+		XrSystemProperties props = {.type = XR_TYPE_SYSTEM_PROPERTIES, .next = &hand_props};
+		CHECK_XR(b->xrGetSystemProperties(b->instance, b->system_id, &props), "xrGetSystemProperties");
+		b->has_hand_tracking = hand_props.supportsHandTracking;
+	}
+
+	// No graphics binding, XR_MND_headless is enabled.
+	XrSessionCreateInfo session_info = {
+	    .type = XR_TYPE_SESSION_CREATE_INFO,
+	    .systemId = b->system_id,
+	};
+	CHECK_XR(b->xrCreateSession(b->instance, &session_info, &b->session), "xrCreateSession");
+
+	XrReferenceSpaceCreateInfo space_info = {
+	    .type = XR_TYPE_REFERENCE_SPACE_CREATE_INFO,
+	    .referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL,
+	    .poseInReferenceSpace = {.orientation = {0, 0, 0, 1}},
+	};
+	CHECK_XR(b->xrCreateReferenceSpace(b->session, &space_info, &b->local_space), "xrCreateReferenceSpace");
+
+	return true;
+}
+
+static bool
+create_actions(struct bench *b)
+{
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/left", &b->hand_paths[0]), "xrStringToPath");
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/right", &b->hand_paths[1]), "xrStringToPath");
+
+	XrActionSetCreateInfo set_info = {.type = XR_TYPE_ACTION_SET_CREATE_INFO};
+	snprintf(set_info.actionSetName, XR_MAX_ACTION_SET_NAME_SIZE, "bench");
+	snprintf(set_info.localizedActionSetName, XR_MAX_LOCALIZED_ACTION_SET_NAME_SIZE, "Bench");
+	CHECK_XR(b->xrCreateActionSet(b->instance, &set_info, &b->action_set), "xrCreateActionSet");
+
+	XrActionCreateInfo select_info = {
+	    .type = XR_TYPE_ACTION_CREATE_INFO,
+	    .actionType = XR_ACTION_TYPE_BOOLEAN_INPUT,
+	    .countSubactionPaths = 2,
+	    .subactionPaths = b->hand_paths,
+	};
+	snprintf(select_info.actionName, XR_MAX_ACTION_NAME_SIZE, "select");
+	snprintf(select_info.localizedActionName, XR_MAX_LOCALIZED_ACTION_NAME_SIZE, "Select");
+	CHECK_XR(b->xrCreateAction(b->action_set, &select_info, &b->select_action), "xrCreateAction");
+
+	XrActionCreateInfo grip_info = {
+	    .type = XR_TYPE_ACTION_CREATE_INFO,
+	    .actionType = XR_ACTION_TYPE_POSE_INPUT,
+	    .countSubactionPaths = 2,
+	    .subactionPaths = b->hand_paths,
+	};
+	snprintf(grip_info.actionName, XR_MAX_ACTION_NAME_SIZE, "grip");
+	snprintf(grip_info.localizedActionName, XR_MAX_LOCALIZED_ACTION_NAME_SIZE, "Grip");
+	CHECK_XR(b->xrCreateAction(b->action_set, &grip_info, &b->grip_action), "xrCreateAction");
+
+	XrPath profile;
+	XrPath select_paths[2];
+	XrPath grip_paths[2];
+	CHECK_XR(b->xrStringToPath(b->instance, "/interaction_profiles/khr/simple_controller", &profile),
+	         "xrStringToPath");
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/left/input/select/click", &select_paths[0]),
+	         "xrStringToPath");
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/right/input/select/click", &select_paths[1]),
+	         "xrStringToPath");
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/left/input/grip/pose", &grip_paths[0]), "xrStringToPath");
+	CHECK_XR(b->xrStringToPath(b->instance, "/user/hand/right/input/grip/pose", &grip_paths[1]), "xrStringToPath");
+
+	XrActionSuggestedBinding bindings[] = {
+	    {b->select_action, select_paths[0]},
+	    {b->select_action, select_paths[1]},
+	    {b->grip_action, grip_paths[0]},
+	    {b->grip_action, grip_paths[1]},
+	};
+
+	XrInteractionProfileSuggestedBinding suggested = {
+	    .type = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING,
+	    .interactionProfile = profile,
+	    .countSuggestedBindings = ARRAY_SIZE(bindings),
+	    .suggestedBindings = bindings,
+	};
+	CHECK_XR(b->xrSuggestInteractionProfileBindings(b->instance, &suggested),
+	         "xrSuggestInteractionProfileBindings");
+
+	XrSessionActionSetsAttachInfo attach_info = {
+	    .type = XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO,
+	    .countActionSets = 1,
+	    .actionSets = &b->action_set,
+	};
+	CHECK_XR(b->xrAttachSessionActionSets(b->session, &attach_info), "xrAttachSessionActionSets");
+
+	for (uint32_t i = 0; i < 2; i++) {
+		XrActionSpaceCreateInfo space_info = {
+		    .type = XR_TYPE_ACTION_SPACE_CREATE_INFO,
+		    .action = b->grip_action,
+		    .subactionPath = b->hand_paths[i],
+		    .poseInActionSpace = {.orientation = {0, 0, 0, 1}},
+		};
+		CHECK_XR(b->xrCreateActionSpace(b->session, &space_info, &b->hand_spaces[i]), "xrCreateActionSpace");
+	}
+
+	if (!b->has_hand_tracking) {
+		return true;
+	}
+
+	for (uint32_t i = 0; i < 2; i++) {
+		XrHandTrackerCreateInfoEXT tracker_info = {
+		    .type = XR_TYPE_HAND_TRACKER_CREATE_INFO_EXT,
+		    .hand = i == 0 ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT,
+		    .handJointSet = XR_HAND_JOINT_SET_DEFAULT_EXT,
+		};
+		CHECK_XR(b->xrCreateHandTrackerEXT(b->session, &tracker_info, &b->hand_trackers[i]),
+		         "xrCreateHandTrackerEXT");
+	}
+
+	return true;
+}
+
+static void
+init_stats(struct bench *b)
+{
+	snprintf(b->stats.wait.name, sizeof(b->stats.wait.name), "xrWaitFrame");
+	snprintf(b->stats.begin.name, sizeof(b->stats.begin.name), "xrBeginFrame");
+	snprintf(b->stats.sync.name, sizeof(b->stats.sync.name), "xrSyncActions");
+	snprintf(b->stats.locate.name, sizeof(b->stats.locate.name), "xrLocateSpaces");
+	snprintf(b->stats.hands.name, sizeof(b->stats.hands.name), "xrLocateHandJ..");
+	snprintf(b->stats.end.name, sizeof(b->stats.end.name), "xrEndFrame");
+	snprintf(b->stats.frame.name, sizeof(b->stats.frame.name), "frame");
+}
+
+
+/*
+ *
+ * Frame loop functions.
+ *
+ */
+
+static bool
+handle_events(struct bench *b)
+{
+	XrEventDataBuffer event = {.type = XR_TYPE_EVENT_DATA_BUFFER};
+
+	while (b->xrPollEvent(b->instance, &event) == XR_SUCCESS) {
+		if (event.type != XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+			event = (XrEventDataBuffer){.type = XR_TYPE_EVENT_DATA_BUFFER};
+			continue;
+		}
+
+		const XrEventDataSessionStateChanged *changed = (const XrEventDataSessionStateChanged *)&event;
+
+		switch (changed->state) {
+		case XR_SESSION_STATE_READY: {
+			// Ignored for headless sessions.
+			XrSessionBeginInfo begin_info = {
+			    .type = XR_TYPE_SESSION_BEGIN_INFO,
+			    .primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+			};
+			CHECK_XR(b->xrBeginSession(b->session, &begin_info), "xrBeginSession");
+			b->running = true;
+		} break;
+		case XR_SESSION_STATE_STOPPING:
+			CHECK_XR(b->xrEndSession(b->session), "xrEndSession");
+			b->running = false;
+			break;
+		case XR_SESSION_STATE_EXITING:
+		case XR_SESSION_STATE_LOSS_PENDING: b->exit = true; break;
+		default: break;
+		}
+
+		event = (XrEventDataBuffer){.type = XR_TYPE_EVENT_DATA_BUFFER};
+	}
+
+	return true;
+}
+
+static bool
+get_time(struct bench *b, int64_t monotonic_ns, XrTime *out_time)
+{
+	struct timespec ts;
+	os_ns_to_timespec(monotonic_ns, &ts);
+
+	CHECK_XR(b->xrConvertTimespecTimeToTimeKHR(b->instance, &ts, out_time), "xrConvertTimespecTimeToTimeKHR");
+
+	return true;
+}
+
+/*!
+ * One frame of what an application does, each call is timed separately.
+ */
+static bool
+do_frame(struct bench *b)
+{
+	int64_t frame_start_ns = os_monotonic_get_ns();
+	int64_t t0, t1;
+
+	// Headless sessions don't get a predicted display time, make one up.
+	XrTime display_time;
+	if (!get_time(b, frame_start_ns + PREDICT_AHEAD_NS, &display_time)) {
+		return false;
+	}
+
+	XrFrameState frame_state = {.type = XR_TYPE_FRAME_STATE};
+	t0 = os_monotonic_get_ns();
+	CHECK_XR(b->xrWaitFrame(b->session, NULL, &frame_state), "xrWaitFrame");
+	t1 = os_monotonic_get_ns();
+	u_ls_ns_add(&b->stats.wait, t1 - t0);
+
+	if (frame_state.predictedDisplayTime > 0) {
+		display_time = frame_state.predictedDisplayTime;
+	}
+
+	t0 = os_monotonic_get_ns();
+	CHECK_XR(b->xrBeginFrame(b->session, NULL), "xrBeginFrame");
+	t1 = os_monotonic_get_ns();
+	u_ls_ns_add(&b->stats.begin, t1 - t0);
+
+	XrActiveActionSet active = {b->action_set, XR_NULL_PATH};
+	XrActionsSyncInfo sync_info = {
+	    .type = XR_TYPE_ACTIONS_SYNC_INFO,
+	    .countActiveActionSets = 1,
+	    .activeActionSets = &active,
+	};
+	t0 = os_monotonic_get_ns();
+	CHECK_XR(b->xrSyncActions(b->session, &sync_info), "xrSyncActions");
+	t1 = os_monotonic_get_ns();
+	u_ls_ns_add(&b->stats.sync, t1 - t0);
+
+	for (uint32_t i = 0; i < 2; i++) {
+		XrActionStateGetInfo get_info = {
+		    .type = XR_TYPE_ACTION_STATE_GET_INFO,
+		    .action = b->select_action,
+		    .subactionPath = b->hand_paths[i],
+		};
+		XrActionStateBoolean state = {.type = XR_TYPE_ACTION_STATE_BOOLEAN};
+		CHECK_XR(b->xrGetActionStateBoolean(b->session, &get_info, &state), "xrGetActionStateBoolean");
+	}
+
+	XrSpaceLocationData location_data[2] = {0};
+	XrSpaceLocations locations = {
+	    .type = XR_TYPE_SPACE_LOCATIONS,
+	    .locationCount = ARRAY_SIZE(location_data),
+	    .locations = location_data,
+	};
+	XrSpacesLocateInfo locate_info = {
+	    .type = XR_TYPE_SPACES_LOCATE_INFO,
+	    .baseSpace = b->local_space,
+	    .time = display_time,
+	    .spaceCount = ARRAY_SIZE(b->hand_spaces),
+	    .spaces = b->hand_spaces,
+	};
+	t0 = os_monotonic_get_ns();
+	CHECK_XR(b->xrLocateSpaces(b->session, &locate_info, &locations), "xrLocateSpaces");
+	t1 = os_monotonic_get_ns();
+	u_ls_ns_add(&b->stats.locate, t1 - t0);
+
+	if (b->has_hand_tracking) {
+		t0 = os_monotonic_get_ns();
+		for (uint32_t i = 0; i < 2; i++) {
+			XrHandJointLocationEXT joints[XR_HAND_JOINT_COUNT_EXT];
+			XrHandJointLocationsEXT joint_locations = {
+			    .type = XR_TYPE_HAND_JOINT_LOCATIONS_EXT,
+			    .jointCount = XR_HAND_JOINT_COUNT_EXT,
+			    .jointLocations = joints,
+			};
+			XrHandJointsLocateInfoEXT joints_info = {
+			    .type = XR_TYPE_HAND_JOINTS_LOCATE_INFO_EXT,
+			    .baseSpace = b->local_space,
+			    .time = display_time,
+			};
+			CHECK_XR(b->xrLocateHandJointsEXT(b->hand_trackers[i], &joints_info, &joint_locations),
+			         "xrLocateHandJointsEXT");
+		}
+		t1 = os_monotonic_get_ns();
+		u_ls_ns_add(&b->stats.hands, t1 - t0);
+	}
+
+	XrFrameEndInfo end_info = {
+	    .type = XR_TYPE_FRAME_END_INFO,
+	    .displayTime = display_time,
+	    .environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
+	    .layerCount = 0,
+	};
+	t0 = os_monotonic_get_ns();
+	CHECK_XR(b->xrEndFrame(b->session, &end_info), "xrEndFrame");
+	t1 = os_monotonic_get_ns();
+	u_ls_ns_add(&b->stats.end, t1 - t0);
+
+	u_ls_ns_add(&b->stats.frame, t1 - frame_start_ns);
+
+	return true;
+}
+
+static void
+print_and_reset(struct bench *b)
+{
+	struct u_pp_sink_stack_only sink;
+	u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+	u_pp(dg, "Session %u:\n", b->index);
+	u_ls_ns_print_percentiles_header(dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_percentiles_and_reset(&b->stats.wait, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_percentiles_and_reset(&b->stats.begin, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_percentiles_and_reset(&b->stats.sync, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_percentiles_and_reset(&b->stats.locate, dg);
+	u_pp(dg, "\n");
+	if (b->has_hand_tracking) {
+		u_ls_ns_print_percentiles_and_reset(&b->stats.hands, dg);
+		u_pp(dg, "\n");
+	}
+	u_ls_ns_print_percentiles_and_reset(&b->stats.end, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_percentiles_and_reset(&b->stats.frame, dg);
+	u_pp(dg, "\n");
+
+	// One write so the output of the sessions doesn't get mixed up.
+	fputs(sink.buffer, stdout);
+	fflush(stdout);
+}
+
+static bool
+run_loop(struct bench *b)
+{
+	int64_t period_ns = U_TIME_1S_IN_NS / b->opts->rate_hz;
+	int64_t start_ns = os_monotonic_get_ns();
+	int64_t stop_ns = start_ns + (int64_t)b->opts->seconds * U_TIME_1S_IN_NS;
+	int64_t next_print_ns = start_ns + U_TIME_1S_IN_NS;
+	int64_t next_frame_ns = start_ns;
+
+	while (!b->exit) {
+		if (!handle_events(b)) {
+			return false;
+		}
+
+		int64_t now_ns = os_monotonic_get_ns();
+		if (now_ns >= stop_ns) {
+			break;
+		}
+
+		if (!b->running) {
+			os_nanosleep(U_TIME_1MS_IN_NS * 10);
+			continue;
+		}
+
+		if (!do_frame(b)) {
+			return false;
+		}
+
+		now_ns = os_monotonic_get_ns();
+		if (now_ns >= next_print_ns) {
+			print_and_reset(b);
+			next_print_ns += U_TIME_1S_IN_NS;
+		}
+
+		// Pace ourselves, headless sessions don't block in xrWaitFrame.
+		next_frame_ns += period_ns;
+		if (next_frame_ns > now_ns) {
+			os_nanosleep(next_frame_ns - now_ns);
+		} else {
+			next_frame_ns = now_ns;
+		}
+	}
+
+	return true;
+}
+
+static int
+run_session(uint32_t index, const struct options *opts)
+{
+	struct bench b = {
+	    .index = index,
+	    .opts = opts,
+	};
+
+	init_stats(&b);
+
+	bool ok = load_runtime(&b) &&    //
+	          create_instance(&b) && //
+	          create_session(&b) &&  //
+	          create_actions(&b) &&  //
+	          run_loop(&b);
+
+	// Destroys all of the children.
+	if (b.instance != XR_NULL_HANDLE) {
+		b.xrDestroyInstance(b.instance);
+	}
+
+	if (b.lib != NULL) {
+		dlclose(b.lib);
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*
+ *
+ * Main functions.
+ *
+ */
+
+static int
+print_usage(const char *name)
+{
+	P("Usage: %s [options]\n", name);
+	P("\n");
+	P("Runs headless OpenXR sessions and prints how long the calls take.\n");
+	P("\n");
+	P("Options:\n");
+	P("  -s, --sessions N  Number of sessions, each in its own process (default 1).\n");
+	P("  -t, --time S      How many seconds to run for (default 10).\n");
+	P("  -r, --rate HZ     Frames per second for each session (default 90).\n");
+	P("  --runtime PATH    OpenXR runtime to load (default %s).\n", BENCH_RUNTIME_PATH);
+
+	return EXIT_FAILURE;
+}
+
+static bool
+parse_uint(const char *str, uint32_t *out_value)
+{
+	char *end = NULL;
+	long value = strtol(str, &end, 10);
+	if (end == str || *end != '\0' || value <= 0 || value > 100000) {
+		return false;
+	}
+
+	*out_value = (uint32_t)value;
+
+	return true;
+}
+
+int
+main(int argc, const char **argv)
+{
+	struct options opts = {
+	    .runtime_path = BENCH_RUNTIME_PATH,
+	    .session_count = 1,
+	    .seconds = 10,
+	    .rate_hz = 90,
+	};
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		bool ok = value != NULL;
+
+		if (strcmp(arg, "-s") == 0 || strcmp(arg, "--sessions") == 0) {
+			ok = ok && parse_uint(value, &opts.session_count);
+		} else if (strcmp(arg, "-t") == 0 || strcmp(arg, "--time") == 0) {
+			ok = ok && parse_uint(value, &opts.seconds);
+		} else if (strcmp(arg, "-r") == 0 || strcmp(arg, "--rate") == 0) {
+			ok = ok && parse_uint(value, &opts.rate_hz);
+		} else if (strcmp(arg, "--runtime") == 0) {
+			opts.runtime_path = value;
+		} else {
+			ok = false;
+		}
+
+		if (!ok) {
+			return print_usage(argv[0]);
+		}
+		i++;
+	}
+
+	P("Running %u session(s) for %us at %uHz.\n", opts.session_count, opts.seconds, opts.rate_hz);
+
+	// Separate processes, like real applications, each gets its own connection.
+	for (uint32_t i = 0; i < opts.session_count; i++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			P("Failed to fork session %u!\n", i);
+			break;
+		}
+		if (pid == 0) {
+			return run_session(i, &opts);
+		}
+	}
+
+	int ret = EXIT_SUCCESS;
+	int status = 0;
+	while (wait(&status) > 0) {
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	return ret;
+}
@@ -13,9 +13,14 @@
 
 #include "xrt/xrt_instance.h"
 #include "xrt/xrt_prober.h"
+#include "xrt/xrt_config_have.h"
 #include "util/u_misc.h"
 #include "cli_common.h"
 
+#ifdef XRT_HAVE_OPENCV
+#include "tracking/t_tracking.h"
+#endif
+
 
 struct program
 {
@@ -138,12 +143,55 @@ do_exit(struct program *p, int ret)
 	return ret;
 }
 
+static int
+do_batch(const char *images_path, const char *calib_path)
+{
+#ifdef XRT_HAVE_OPENCV
+	// Use the same board settings as the calibration gui.
+	struct t_calibration_params params;
+	t_calibration_gui_params_load_or_default(&params);
+
+	printf(" :: Calibrating from '%s'\n", images_path);
+
+	struct t_stereo_camera_calibration *data = NULL;
+	int ret = t_calibration_stereo_batch(&params, images_path, &data);
+	if (ret != 0) {
+		fprintf(stderr, "Failed to calibrate from '%s'\n", images_path);
+		return ret;
+	}
+
+	bool saved = t_stereo_camera_calibration_save(calib_path, data);
+	t_stereo_camera_calibration_reference(&data, NULL);
+
+	if (!saved) {
+		fprintf(stderr, "Failed to save calibration to '%s'\n", calib_path);
+		return -1;
+	}
+
+	printf(" :: Saved calibration to '%s'\n", calib_path);
+
+	return 0;
+#else
+	fprintf(stderr, "Not compiled with XRT_HAVE_OPENCV, so can't calibrate from images!\n");
+	return -1;
+#endif
+}
+
 int
 cli_cmd_calibrate(int argc, const char **argv)
 {
 	struct program p = {0};
 	int ret;
 
+	// Offline calibration from a EuRoC dataset or directory of images.
+	if (argc == 4) {
+		return do_batch(argv[2], argv[3]);
+	}
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s %s [<images_path> <calibration_output.json>]\n", argv[0], argv[1]);
+		return 1;
+	}
+
 	printf(" :: Starting!\n");
 
 	// Init the prober and other things.
@@ -0,0 +1,45 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Converts a raw EuRoC recording into a regular EuRoC dataset.
+ */
+
+#include "xrt/xrt_compiler.h"
+#include "xrt/xrt_config_have.h"
+
+#include "cli_common.h"
+
+#ifdef XRT_HAVE_OPENCV
+#include "tracking/t_euroc_recorder.h"
+#endif
+
+#include <stdio.h>
+
+#define P(...) fprintf(stderr, __VA_ARGS__)
+
+int
+cli_cmd_euroc_convert(int argc, const char **argv)
+{
+#ifdef XRT_HAVE_OPENCV
+	if (argc < 3) {
+		P("Converts the data.raw files of a dataset recorded with EUROC_RECORDER_RAW=true into png files.\n");
+		P("Usage: %s %s <euroc_path>\n", argv[0], argv[1]);
+		return 1;
+	}
+
+	const char *path = argv[2];
+
+	if (!euroc_recorder_convert_raw(path)) {
+		P("Failed to convert all frames of '%s'!\n", path);
+		return 1;
+	}
+
+	P("Converted '%s'\n", path);
+
+	return 0;
+#else
+	P("Not compiled with XRT_HAVE_OPENCV, so can't convert EuRoC recordings!\n");
+	return 1;
+#endif
+}
@@ -20,6 +20,9 @@ cli_cmd_calibrate(int argc, const char **argv);
 int
 cli_cmd_calibration_dump(int argc, const char **argv);
 
+int
+cli_cmd_euroc_convert(int argc, const char **argv);
+
 int
 cli_cmd_info(int argc, const char **argv);
 
@@ -31,9 +31,12 @@ cli_print_help(int argc, const char **argv)
 	P("  test       - List found devices, for prober testing.\n");
 	P("  probe      - Just probe and then exit.\n");
 	P("  lighthouse - Control the power of lighthouses [on|off].\n");
-	P("  calibrate  - Calibrate a camera and save config (not implemented yet).\n");
+	P("  calibrate  - Calibrate a camera and save config, from images if given [<path> <output>].\n");
 	P("  calib-dump - Load and dump a calibration to stdout.\n");
 	P("  slambatch  - Runs a sequence of EuRoC datasets with the SLAM tracker.\n");
+#ifndef XRT_OS_WINDOWS
+	P("  euroc-convert - Convert a raw EuRoC recording into png files <path>.\n");
+#endif // !XRT_OS_WINDOWS
 
 	return 1;
 }
@@ -58,6 +61,9 @@ main(int argc, const char **argv)
 	if (strcmp(argv[1], "calibrate") == 0) {
 		return cli_cmd_calibrate(argc, argv);
 	}
+	if (strcmp(argv[1], "euroc-convert") == 0) {
+		return cli_cmd_euroc_convert(argc, argv);
+	}
 #endif // !XRT_OS_WINDOWS
 	if (strcmp(argv[1], "calib-dump") == 0) {
 		return cli_cmd_calibration_dump(argc, argv);
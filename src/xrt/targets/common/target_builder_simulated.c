@@ -30,6 +30,10 @@
 DEBUG_GET_ONCE_BOOL_OPTION(simulated_enabled, "SIMULATED_ENABLE", false)
 DEBUG_GET_ONCE_OPTION(simulated_left, "SIMULATED_LEFT", NULL)
 DEBUG_GET_ONCE_OPTION(simulated_right, "SIMULATED_RIGHT", NULL)
+DEBUG_GET_ONCE_NUM_OPTION(simulated_load_devices, "SIMULATED_LOAD_DEVICES", 0)
+DEBUG_GET_ONCE_NUM_OPTION(simulated_load_rate, "SIMULATED_LOAD_RATE_HZ", 1000)
+DEBUG_GET_ONCE_NUM_OPTION(simulated_load_toggle_rate, "SIMULATED_LOAD_TOGGLE_RATE_HZ", 10)
+DEBUG_GET_ONCE_BOOL_OPTION(simulated_load_hand_tracking, "SIMULATED_LOAD_HAND_TRACKING", true)
 
 
 /*
@@ -68,6 +72,53 @@ create_controller(const char *str,
 	return simulated_create_controller(name, type, center, origin);
 }
 
+/*!
+ * Adds the load generating devices, the first two get the controller and
+ * hand tracking roles so the OpenXR state tracker has to use them.
+ */
+static void
+create_load_devices(struct xrt_system_devices *xsysd,
+                    struct u_builder_roles_helper *ubrh,
+                    struct xrt_tracking_origin *origin,
+                    uint32_t count)
+{
+	int64_t rate = debug_get_num_option_simulated_load_rate();
+	int64_t toggle_rate = debug_get_num_option_simulated_load_toggle_rate();
+
+	struct simulated_load_config config = {
+	    .update_rate_hz = rate > 0 ? (uint32_t)rate : 1,
+	    .input_toggle_rate_hz = toggle_rate > 0 ? (uint32_t)toggle_rate : 0,
+	    .hand_tracking = debug_get_bool_option_simulated_load_hand_tracking(),
+	};
+
+	U_LOG_I("Creating %u load devices at %uHz.", count, config.update_rate_hz);
+
+	for (uint32_t i = 0; i < count; i++) {
+		enum xrt_hand hand = (i % 2) == 0 ? XRT_HAND_LEFT : XRT_HAND_RIGHT;
+
+		// Pairs in front of the user, each pair a bit further away.
+		struct xrt_pose center = XRT_POSE_IDENTITY;
+		center.position.x = (i % 2) == 0 ? -0.2f : 0.2f;
+		center.position.y = 1.3f;
+		center.position.z = -0.5f - 0.1f * (float)(i / 2);
+
+		struct xrt_device *xdev = simulated_create_load_device(&config, i, hand, &center, origin);
+		if (xdev == NULL) {
+			break;
+		}
+
+		xsysd->xdevs[xsysd->xdev_count++] = xdev;
+
+		if (i == 0) {
+			ubrh->left = xdev;
+			ubrh->hand_tracking.left = config.hand_tracking ? xdev : NULL;
+		} else if (i == 1) {
+			ubrh->right = xdev;
+			ubrh->hand_tracking.right = config.hand_tracking ? xdev : NULL;
+		}
+	}
+}
+
 
 /*
  *
@@ -107,6 +158,13 @@ simulated_open_system_impl(struct xrt_builder *xb,
 	const char *left_str = debug_get_option_simulated_left();
 	const char *right_str = debug_get_option_simulated_right();
 
+	// The load devices replace the controllers.
+	int64_t load_count = debug_get_num_option_simulated_load_devices();
+	if (load_count > 0) {
+		left_str = NULL;
+		right_str = NULL;
+	}
+
 	struct xrt_device *head = simulated_hmd_create(SIMULATED_MOVEMENT_WOBBLE, &head_center);
 	struct xrt_device *left = create_controller(left_str, left_type, &left_center, head->tracking_origin);
 	struct xrt_device *right = create_controller(right_str, right_type, &right_center, head->tracking_origin);
@@ -132,6 +190,13 @@ simulated_open_system_impl(struct xrt_builder *xb,
 	ubrh->left = left;
 	ubrh->right = right;
 
+	if (load_count > 0) {
+		// Only as many as there is room for.
+		uint32_t room = ARRAY_SIZE(xsysd->xdevs) - xsysd->xdev_count;
+		uint32_t count = load_count < room ? (uint32_t)load_count : room;
+		create_load_devices(xsysd, ubrh, head->tracking_origin, count);
+	}
+
 	return XRT_SUCCESS;
 }
 
@@ -0,0 +1,271 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Test the compute layer squasher cache, what it reuses and when.
+ */
+
+#include "catch_amalgamated.hpp"
+
+#include "util/u_limited_unique_id.h"
+#include "util/comp_render.h"
+#include "util/comp_swapchain.h"
+
+#include <memory>
+
+
+static const xrt_fov fov = {-0.7f, 0.7f, 0.7f, -0.7f};
+
+static const xrt_pose identity = XRT_POSE_IDENTITY;
+
+struct fake_swapchain
+{
+	std::unique_ptr<comp_swapchain> sc{new comp_swapchain{}};
+
+	fake_swapchain()
+	{
+		sc->base.base.image_count = 3;
+		for (uint32_t i = 0; i < 3; i++) {
+			release(i);
+		}
+	}
+
+	//! What comp_swapchain does when the app releases the image.
+	void
+	release(uint32_t index)
+	{
+		sc->images[index].generation = u_limited_unique_id_get();
+	}
+
+	xrt_swapchain *
+	xsc()
+	{
+		return &sc->base.base;
+	}
+};
+
+static comp_layer
+make_projection(fake_swapchain &left, fake_swapchain &right)
+{
+	comp_layer layer = {};
+	layer.sc_array[0] = left.xsc();
+	layer.sc_array[1] = right.xsc();
+	layer.data.type = XRT_LAYER_PROJECTION;
+	layer.data.view_count = 2;
+	for (uint32_t i = 0; i < 2; i++) {
+		layer.data.proj.v[i].fov = fov;
+		layer.data.proj.v[i].pose = identity;
+		layer.data.proj.v[i].sub.norm_rect = {0.0f, 0.0f, 1.0f, 1.0f};
+	}
+	return layer;
+}
+
+static comp_layer
+make_quad(fake_swapchain &sc, bool view_space)
+{
+	comp_layer layer = {};
+	layer.sc_array[0] = sc.xsc();
+	layer.data.type = XRT_LAYER_QUAD;
+	layer.data.flags = view_space ? XRT_LAYER_COMPOSITION_VIEW_SPACE_BIT : (enum xrt_layer_composition_flags)0;
+	layer.data.quad.visibility = XRT_LAYER_EYE_VISIBILITY_BOTH;
+	layer.data.quad.pose = identity;
+	layer.data.quad.pose.position.z = -1.0f;
+	layer.data.quad.size = {0.5f, 0.5f};
+	layer.data.quad.sub.norm_rect = {0.0f, 0.0f, 1.0f, 1.0f};
+	return layer;
+}
+
+static comp_render_dispatch_data
+make_data(const xrt_pose &world_pose)
+{
+	comp_render_dispatch_data data;
+	comp_render_cs_initial_init( //
+	    &data,                   // data
+	    VK_NULL_HANDLE,          // target_image
+	    VK_NULL_HANDLE,          // target_unorm_view
+	    false,                   // fast_path
+	    true);                   // do_timewarp
+
+	render_viewport_data viewport = {0, 0, 64, 64};
+	xrt_normalized_rect norm_rect = {0.0f, 0.0f, 1.0f, 1.0f};
+
+	for (uint32_t i = 0; i < 2; i++) {
+		comp_render_cs_add_view( //
+		    &data,               // data
+		    &world_pose,         // world_pose
+		    &identity,           // eye_pose
+		    &fov,                // fov
+		    &viewport,           // layer_viewport_data
+		    &norm_rect,          // layer_norm_rect
+		    VK_NULL_HANDLE,      // image
+		    VK_NULL_HANDLE,      // srgb_view
+		    VK_NULL_HANDLE,      // unorm_view
+		    &viewport);          // target_viewport_data
+	}
+
+	return data;
+}
+
+static comp_render_dispatch_data
+check(comp_render_cs_layer_cache &cache, const comp_layer *layers, uint32_t layer_count, const xrt_pose &world_pose)
+{
+	comp_render_dispatch_data data = make_data(world_pose);
+	comp_render_cs_layer_cache_check(&cache, layers, layer_count, &data);
+	return data;
+}
+
+
+TEST_CASE("comp_render_cs_layer_cache")
+{
+	auto cache = std::make_unique<comp_render_cs_layer_cache>();
+	comp_render_cs_layer_cache_invalidate(cache.get());
+
+	fake_swapchain proj_l, proj_r, hud0, hud1;
+
+	comp_layer layers[3] = {
+	    make_projection(proj_l, proj_r),
+	    make_quad(hud0, true),
+	    make_quad(hud1, true),
+	};
+
+	// First frame, nothing to reuse.
+	comp_render_dispatch_data data = check(*cache, layers, 3, identity);
+	CHECK_FALSE(data.cs.layers_cached);
+	CHECK(data.cs.group_count == 0);
+
+	SECTION("nothing changed")
+	{
+		layers[0].data.timestamp += 1000; // Doesn't change the result.
+
+		data = check(*cache, layers, 3, identity);
+		CHECK(data.cs.layers_cached);
+	}
+
+	SECTION("garbage in the unused part of the layer data is ignored")
+	{
+		layers[1].data.depth.d[1].near_z = 42.0f;
+		layers[2].data.depth.d[1].far_z = 42.0f;
+
+		data = check(*cache, layers, 3, identity);
+		CHECK(data.cs.layers_cached);
+	}
+
+	SECTION("only the changed layer is squashed")
+	{
+		// The app rendered a new frame, the HUD is static.
+		proj_l.release(1);
+		proj_r.release(1);
+		layers[0].data.proj.v[0].sub.image_index = 1;
+		layers[0].data.proj.v[1].sub.image_index = 1;
+
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_first == 1);
+		CHECK(data.cs.group_count == 2);
+		CHECK(data.cs.group_update);
+
+		// Same image index but released again, the group is reused as is.
+		proj_l.release(1);
+		proj_r.release(1);
+
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_first == 1);
+		CHECK(data.cs.group_count == 2);
+		CHECK_FALSE(data.cs.group_update);
+
+		// And then it all stays the same.
+		data = check(*cache, layers, 3, identity);
+		CHECK(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 2);
+
+		// A HUD quad moves, the group is no longer valid.
+		layers[2].data.quad.pose.position.x = 0.1f;
+		proj_l.release(1);
+		proj_r.release(1);
+
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 0);
+	}
+
+	SECTION("view space layers don't care about the head")
+	{
+		xrt_pose moved = identity;
+		moved.position.x = 0.1f;
+
+		proj_l.release(0);
+		proj_r.release(0);
+
+		data = check(*cache, layers, 3, moved);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_first == 1);
+		CHECK(data.cs.group_count == 2);
+	}
+
+	SECTION("world space layers do care about the head")
+	{
+		layers[1] = make_quad(hud0, false);
+		layers[2] = make_quad(hud1, false);
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+
+		// Small enough to still hit.
+		xrt_pose moved = identity;
+		moved.position.x = COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA / 2;
+
+		data = check(*cache, layers, 3, moved);
+		CHECK(data.cs.layers_cached);
+
+		// Compared to the pose it was squashed with, so drift adds up.
+		moved.position.x = COMP_RENDER_CS_LAYER_CACHE_MAX_POSITION_DELTA * 1.5f;
+
+		data = check(*cache, layers, 3, moved);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 0);
+	}
+
+	SECTION("new layer on top")
+	{
+		fake_swapchain hud2;
+		comp_layer more[4] = {layers[0], layers[1], layers[2], make_quad(hud2, true)};
+
+		data = check(*cache, more, 4, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_first == 0);
+		CHECK(data.cs.group_count == 3);
+		CHECK(data.cs.group_update);
+
+		data = check(*cache, more, 4, identity);
+		CHECK(data.cs.layers_cached);
+	}
+
+	SECTION("single unchanged layer is not grouped")
+	{
+		proj_l.release(0);
+		proj_r.release(0);
+		layers[2].data.quad.size.x = 1.0f;
+
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 0);
+	}
+
+	SECTION("invalidate")
+	{
+		comp_render_cs_layer_cache_invalidate(cache.get());
+
+		data = check(*cache, layers, 3, identity);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 0);
+	}
+
+	SECTION("timewarp toggled")
+	{
+		data = make_data(identity);
+		data.do_timewarp = false;
+		comp_render_cs_layer_cache_check(cache.get(), layers, 3, &data);
+		CHECK_FALSE(data.cs.layers_cached);
+		CHECK(data.cs.group_count == 0);
+	}
+}
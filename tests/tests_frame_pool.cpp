@@ -0,0 +1,106 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Test u_frame_pool recycling and lifetime.
+ */
+
+#include "util/u_frame_pool.h"
+
+#include "catch_amalgamated.hpp"
+
+
+TEST_CASE("u_frame_pool")
+{
+	struct u_frame_pool *pool = NULL;
+	REQUIRE(u_frame_pool_create(2, &pool) == 0);
+	REQUIRE(pool != NULL);
+
+	struct xrt_frame *a = NULL;
+	u_frame_pool_get(pool, XRT_FORMAT_R8G8B8, 64, 32, &a);
+	REQUIRE(a != NULL);
+	CHECK(a->width == 64);
+	CHECK(a->height == 32);
+	CHECK(a->format == XRT_FORMAT_R8G8B8);
+	CHECK(a->size >= 64 * 32 * 3);
+
+	SECTION("released frames are reused")
+	{
+		a->timestamp = 1234;
+		struct xrt_frame *first = a;
+		uint8_t *first_data = a->data;
+		xrt_frame_reference(&a, NULL);
+
+		u_frame_pool_get(pool, XRT_FORMAT_R8G8B8, 64, 32, &a);
+		CHECK(a == first);
+		CHECK(a->data == first_data);
+		CHECK(a->timestamp == 0);
+		CHECK(a->reference.count == 1);
+	}
+
+	SECTION("different size is not reused")
+	{
+		SECTION("while held")
+		{
+			struct xrt_frame *first = NULL;
+			xrt_frame_reference(&first, a);
+			xrt_frame_reference(&a, NULL);
+
+			u_frame_pool_get(pool, XRT_FORMAT_R8G8B8, 32, 32, &a);
+			REQUIRE(a != NULL);
+			CHECK(a != first);
+			CHECK(a->data != first->data);
+			CHECK(first->width == 64);
+
+			xrt_frame_reference(&first, NULL);
+		}
+
+		SECTION("after release")
+		{
+			// Back into the pool, cached for 64x32.
+			xrt_frame_reference(&a, NULL);
+
+			u_frame_pool_get(pool, XRT_FORMAT_R8G8B8, 32, 32, &a);
+			REQUIRE(a != NULL);
+
+			// A recycled 64x32 frame would have kept its stride and size.
+			CHECK(a->width == 32);
+			CHECK(a->stride == 32 * 3);
+			CHECK(a->size == 32 * 32 * 3);
+		}
+	}
+
+	SECTION("frames outlive the pool owner")
+	{
+		u_frame_pool_destroy(&pool);
+		CHECK(pool == NULL);
+
+		// Still usable, freed on release.
+		a->data[0] = 42;
+		CHECK(a->data[0] == 42);
+	}
+
+	SECTION("region of interest frames")
+	{
+		struct xrt_rect rect = {{32, 0}, {32, 32}};
+		struct xrt_frame *roi = NULL;
+		u_frame_pool_create_roi(pool, a, rect, &roi);
+		REQUIRE(roi != NULL);
+
+		CHECK(roi->width == 32);
+		CHECK(roi->data == a->data + 32 * 3);
+		CHECK(roi->owner == a);
+		CHECK(a->reference.count == 2);
+
+		struct xrt_frame *first = roi;
+		xrt_frame_reference(&roi, NULL);
+		CHECK(a->reference.count == 1);
+
+		u_frame_pool_create_roi(pool, a, rect, &roi);
+		CHECK(roi == first);
+		xrt_frame_reference(&roi, NULL);
+	}
+
+	xrt_frame_reference(&a, NULL);
+	u_frame_pool_destroy(&pool);
+}
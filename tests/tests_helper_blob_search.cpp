@@ -0,0 +1,101 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Checks that the fused remap and threshold matches OpenCV.
+ */
+
+#include "tracking/t_helper_blob_search.hpp"
+
+#include "catch_amalgamated.hpp"
+
+
+using xrt::auxiliary::tracking::HelperBlobSearch;
+
+static constexpr int width = 160;
+static constexpr int height = 120;
+
+/*!
+ * Barrel distortion plus a shift, so part of the map points outside of the
+ * source image and almost none of it lands on whole pixels.
+ */
+static void
+make_maps(cv::Mat &map_x, cv::Mat &map_y)
+{
+	map_x.create(height, width, CV_32FC1);
+	map_y.create(height, width, CV_32FC1);
+
+	const float cx = width / 2.0f + 3.3f;
+	const float cy = height / 2.0f - 2.7f;
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			float dx = (x - cx) / width;
+			float dy = (y - cy) / height;
+			float k = 1.0f + 0.35f * (dx * dx + dy * dy);
+
+			map_x.at<float>(y, x) = cx + dx * k * width * 1.07f + 0.123f;
+			map_y.at<float>(y, x) = cy + dy * k * height * 1.07f - 0.271f;
+		}
+	}
+}
+
+static cv::Mat
+make_grey()
+{
+	cv::Mat grey(height, width, CV_8UC1);
+
+	// Random values around the threshold, so most pixels test it.
+	cv::RNG rng(1337);
+	rng.fill(grey, cv::RNG::UNIFORM, HelperBlobSearch::threshold - 16, HelperBlobSearch::threshold + 16);
+
+	// Make sure both the threshold value and the one above it are there.
+	grey.at<uint8_t>(10, 10) = HelperBlobSearch::threshold;
+	grey.at<uint8_t>(10, 11) = HelperBlobSearch::threshold + 1;
+
+	return grey;
+}
+
+static cv::Mat
+reference(const cv::Mat &grey, const cv::Mat &map_x, const cv::Mat &map_y)
+{
+	cv::Mat remapped, expected;
+	cv::remap(grey, remapped, map_x, map_y, cv::INTER_NEAREST, cv::BORDER_CONSTANT, cv::Scalar(0));
+	cv::threshold(remapped, expected, HelperBlobSearch::threshold, 255, cv::THRESH_BINARY);
+	return expected;
+}
+
+
+TEST_CASE("HelperBlobSearch remap_threshold")
+{
+	cv::Mat map_x, map_y;
+	make_maps(map_x, map_y);
+
+	cv::Mat grey = make_grey();
+	cv::Mat expected = reference(grey, map_x, map_y);
+
+	HelperBlobSearch search;
+	search.init(map_x, map_y);
+
+	SECTION("full frame")
+	{
+		cv::Mat actual(height, width, CV_8UC1, cv::Scalar(1));
+		search.remap_threshold(grey, actual, cv::Rect(0, 0, width, height));
+
+		CHECK(cv::countNonZero(expected != actual) == 0);
+	}
+
+	SECTION("region")
+	{
+		const cv::Rect rect(17, 9, 63, 41);
+
+		// Only the region is written to.
+		cv::Mat actual(height, width, CV_8UC1, cv::Scalar(1));
+		search.remap_threshold(grey, actual, rect);
+
+		cv::Mat outside(height, width, CV_8UC1, cv::Scalar(1));
+		expected(rect).copyTo(outside(rect));
+
+		CHECK(cv::countNonZero(outside != actual) == 0);
+	}
+}
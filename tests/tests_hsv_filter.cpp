@@ -0,0 +1,169 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Checks that the HSV filter row kernels match @ref t_hsv_filter_sample.
+ */
+
+#include "util/u_frame.h"
+#include "util/u_pixel_convert.h"
+#include "tracking/t_tracking.h"
+
+#include "catch_amalgamated.hpp"
+
+
+/*
+ * Widths of the test frames, every V value fits in a row, and they are not a
+ * multiple of 16 so the scalar tail of the SIMD kernels is also used.
+ */
+static constexpr uint32_t yuv_width = 256 + 14;
+static constexpr uint32_t yuyv_width = 512 + 14;
+
+struct capture_sink
+{
+	struct xrt_frame_sink base = {};
+	struct xrt_frame *frame = nullptr;
+};
+
+static void
+capture_push_frame(struct xrt_frame_sink *xs, struct xrt_frame *xf)
+{
+	struct capture_sink *cs = (struct capture_sink *)xs;
+	xrt_frame_reference(&cs->frame, xf);
+}
+
+struct hsv_filter_fixture
+{
+	struct xrt_frame_context xfctx = {};
+	struct t_hsv_filter_params params = T_HSV_DEFAULT_PARAMS();
+	struct t_hsv_filter_optimized_table table = {};
+	capture_sink captures[4] = {};
+	struct xrt_frame_sink *sink = nullptr;
+
+	hsv_filter_fixture()
+	{
+		struct xrt_frame_sink *sinks[4];
+		for (uint32_t i = 0; i < 4; i++) {
+			captures[i].base.push_frame = capture_push_frame;
+			sinks[i] = &captures[i].base;
+		}
+
+		t_hsv_build_optimized_table(&params, &table);
+		t_hsv_filter_create(&xfctx, &params, sinks, &sink);
+	}
+
+	~hsv_filter_fixture()
+	{
+		release();
+		xrt_frame_context_destroy_nodes(&xfctx);
+	}
+
+	void
+	release()
+	{
+		for (auto &c : captures) {
+			xrt_frame_reference(&c.frame, NULL);
+		}
+	}
+
+	//! Are the four masks for pixel @p x in row @p row what the table says.
+	bool
+	check_pixel(uint32_t x, uint32_t row, uint8_t y, uint8_t u, uint8_t v)
+	{
+		uint8_t bits = t_hsv_filter_sample(&table, y, u, v);
+
+		for (uint32_t i = 0; i < 4; i++) {
+			uint8_t expected = (bits & (1 << i)) ? 0xff : 0x00;
+			if (captures[i].frame->data[row * captures[i].frame->stride + x] != expected) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+
+TEST_CASE("t_hsv_filter matches t_hsv_filter_sample")
+{
+	INFO("isa: " << u_pixel_convert_isa_str(u_pixel_convert_best_isa()));
+
+	hsv_filter_fixture f;
+	REQUIRE(f.sink != nullptr);
+
+	SECTION("YUV888, all values")
+	{
+		// One frame per Y value, one row per U value, all V values in a row.
+		struct xrt_frame *xf = NULL;
+		u_frame_create_one_off(XRT_FORMAT_YUV888, yuv_width, 256, &xf);
+		REQUIRE(xf != NULL);
+
+		bool all_equal = true;
+		for (uint32_t y = 0; y < 256; y++) {
+			for (uint32_t u = 0; u < 256; u++) {
+				uint8_t *row = xf->data + u * xf->stride;
+				for (uint32_t x = 0; x < yuv_width; x++) {
+					row[x * 3 + 0] = (uint8_t)y;
+					row[x * 3 + 1] = (uint8_t)u;
+					row[x * 3 + 2] = (uint8_t)(x * 7); // Wraps to all V values in the first 256.
+				}
+			}
+
+			xrt_sink_push_frame(f.sink, xf);
+			REQUIRE(f.captures[0].frame != NULL);
+
+			for (uint32_t u = 0; u < 256; u++) {
+				const uint8_t *row = xf->data + u * xf->stride;
+				for (uint32_t x = 0; x < yuv_width; x++) {
+					const uint8_t *s = row + x * 3;
+					all_equal = all_equal && f.check_pixel(x, u, s[0], s[1], s[2]);
+				}
+			}
+
+			f.release();
+		}
+
+		xrt_frame_reference(&xf, NULL);
+
+		CHECK(all_equal);
+	}
+
+	SECTION("YUYV422, all values")
+	{
+		// Even pixels get the frame's Y, odd pixels all of the other Y values.
+		struct xrt_frame *xf = NULL;
+		u_frame_create_one_off(XRT_FORMAT_YUYV422, yuyv_width, 256, &xf);
+		REQUIRE(xf != NULL);
+
+		bool all_equal = true;
+		for (uint32_t y = 0; y < 256; y++) {
+			for (uint32_t u = 0; u < 256; u++) {
+				uint8_t *row = xf->data + u * xf->stride;
+				for (uint32_t k = 0; k < yuyv_width / 2; k++) {
+					row[k * 4 + 0] = (uint8_t)y;
+					row[k * 4 + 1] = (uint8_t)u;
+					row[k * 4 + 2] = (uint8_t)(y + k);
+					row[k * 4 + 3] = (uint8_t)k;
+				}
+			}
+
+			xrt_sink_push_frame(f.sink, xf);
+			REQUIRE(f.captures[0].frame != NULL);
+
+			for (uint32_t u = 0; u < 256; u++) {
+				const uint8_t *row = xf->data + u * xf->stride;
+				for (uint32_t k = 0; k < yuyv_width / 2; k++) {
+					const uint8_t *s = row + k * 4;
+					all_equal = all_equal && f.check_pixel(k * 2 + 0, u, s[0], s[1], s[3]);
+					all_equal = all_equal && f.check_pixel(k * 2 + 1, u, s[2], s[1], s[3]);
+				}
+			}
+
+			f.release();
+		}
+
+		xrt_frame_reference(&xf, NULL);
+
+		CHECK(all_equal);
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Live stats tests.
+ */
+
+#include "util/u_live_stats.h"
+
+#include "catch_amalgamated.hpp"
+
+
+TEST_CASE("u_live_stats_percentiles")
+{
+	struct u_live_stats_ns uls = {};
+	uint64_t p50 = 1, p99 = 1, worst = 1;
+
+	SECTION("Empty")
+	{
+		u_ls_ns_get_percentiles_and_reset(&uls, &p50, &p99, &worst);
+		CHECK(p50 == 0);
+		CHECK(p99 == 0);
+		CHECK(worst == 0);
+	}
+
+	SECTION("Single value")
+	{
+		u_ls_ns_add(&uls, 42);
+		u_ls_ns_get_percentiles_and_reset(&uls, &p50, &p99, &worst);
+		CHECK(p50 == 42);
+		CHECK(p99 == 42);
+		CHECK(worst == 42);
+	}
+
+	SECTION("Hundred values in reverse")
+	{
+		for (uint64_t i = 100; i >= 1; i--) {
+			u_ls_ns_add(&uls, i);
+		}
+
+		u_ls_ns_get_percentiles_and_reset(&uls, &p50, &p99, &worst);
+		CHECK(p50 == 50);
+		CHECK(p99 == 99);
+		CHECK(worst == 100);
+		CHECK(uls.value_count == 0);
+	}
+
+	SECTION("Full")
+	{
+		bool full = false;
+		for (uint64_t i = 0; i < U_LIVE_STATS_VALUE_COUNT; i++) {
+			full = u_ls_ns_add(&uls, i * 10);
+		}
+		CHECK(full);
+
+		u_ls_ns_get_percentiles_and_reset(&uls, &p50, &p99, &worst);
+		CHECK(p50 == 5110);
+		CHECK(p99 == 10130);
+		CHECK(worst == 10230);
+	}
+}
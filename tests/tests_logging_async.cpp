@@ -0,0 +1,105 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Asynchronous logging tests.
+ */
+
+#include "util/u_logging.h"
+
+#include "catch_amalgamated.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static std::mutex g_mutex;
+static std::vector<std::string> g_messages;
+
+static void
+sink(const char *file,
+     int line,
+     const char *func,
+     enum u_logging_level level,
+     const char *format,
+     va_list args,
+     void *data)
+{
+	char buf[1024];
+	vsnprintf(buf, sizeof(buf), format, args);
+
+	std::lock_guard<std::mutex> lock(g_mutex);
+	g_messages.emplace_back(buf);
+}
+
+static std::vector<std::string>
+take_messages()
+{
+	u_log_flush();
+
+	std::lock_guard<std::mutex> lock(g_mutex);
+	std::vector<std::string> ret;
+	std::swap(ret, g_messages);
+	return ret;
+}
+
+static void
+set_env(const char *name, const char *value)
+{
+#ifdef _WIN32
+	_putenv_s(name, value);
+#else
+	setenv(name, value, 1);
+#endif
+}
+
+TEST_CASE("u_logging_async")
+{
+	// Must be set before the first message is logged.
+	set_env("XRT_LOG_ASYNC", "true");
+	set_env("XRT_LOG_ASYNC_RATE", "0");
+
+	u_log_set_sink(sink, NULL);
+
+	SECTION("repeated messages are suppressed")
+	{
+		for (int i = 0; i < 10; i++) {
+			U_LOG(U_LOGGING_INFO, "same");
+		}
+		U_LOG(U_LOGGING_INFO, "other");
+
+		std::vector<std::string> messages = take_messages();
+		REQUIRE(messages.size() == 3);
+		CHECK(messages[0] == "same");
+		CHECK(messages[1] == "Previous message repeated 9 times");
+		CHECK(messages[2] == "other");
+	}
+
+	SECTION("messages from several threads")
+	{
+		constexpr int thread_count = 4;
+		constexpr int message_count = 16;
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < thread_count; t++) {
+			threads.emplace_back([t] {
+				for (int i = 0; i < message_count; i++) {
+					U_LOG(U_LOGGING_INFO, "thread %i message %i", t, i);
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		// Fits in the queue, so nothing is dropped.
+		std::vector<std::string> messages = take_messages();
+		CHECK(messages.size() == thread_count * message_count);
+	}
+
+	u_log_set_sink(NULL, NULL);
+}
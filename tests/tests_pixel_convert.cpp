@@ -0,0 +1,138 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Checks that the SIMD pixel converters are bit-exact with the scalar ones.
+ */
+
+#include "util/u_pixel_convert.h"
+
+#include "catch_amalgamated.hpp"
+
+#include <random>
+#include <vector>
+
+
+static const uint32_t widths[] = {2, 14, 16, 18, 30, 32, 34, 62, 64, 66, 640, 1280};
+
+static std::vector<uint8_t>
+make_random(size_t size)
+{
+	std::mt19937 rng(1337);
+	std::uniform_int_distribution<int> dist(0, 255);
+
+	std::vector<uint8_t> data(size);
+	for (auto &v : data) {
+		v = (uint8_t)dist(rng);
+	}
+	return data;
+}
+
+static std::vector<enum u_pixel_convert_isa>
+get_simd_isas()
+{
+	std::vector<enum u_pixel_convert_isa> isas;
+	for (auto isa : {U_PIXEL_CONVERT_ISA_SSE41, U_PIXEL_CONVERT_ISA_AVX2, U_PIXEL_CONVERT_ISA_NEON}) {
+		if (u_pixel_convert_isa_supported(isa)) {
+			isas.push_back(isa);
+		}
+	}
+	return isas;
+}
+
+
+TEST_CASE("u_pixel_convert scalar")
+{
+	// Black, white and grey in limited range.
+	const uint8_t yuv[] = {16, 128, 128, 235, 128, 128, 126, 128, 128};
+	uint8_t rgb[9] = {};
+
+	u_pixel_convert_yuv888_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, yuv, rgb, 3);
+
+	CHECK(rgb[0] == 0);
+	CHECK(rgb[1] == 0);
+	CHECK(rgb[2] == 0);
+	CHECK(rgb[3] == 255);
+	CHECK(rgb[4] == 255);
+	CHECK(rgb[5] == 255);
+	CHECK(rgb[6] == 128);
+	CHECK(rgb[7] == 128);
+	CHECK(rgb[8] == 128);
+
+	CHECK(u_pixel_convert_best_isa() == u_pixel_convert_best_isa());
+	CHECK(u_pixel_convert_isa_supported(u_pixel_convert_best_isa()));
+}
+
+TEST_CASE("u_pixel_convert bit-exact")
+{
+	auto isas = get_simd_isas();
+	if (isas.empty()) {
+		SKIP("No SIMD kernels on this CPU");
+	}
+
+	for (auto isa : isas) {
+		INFO("isa: " << u_pixel_convert_isa_str(isa));
+
+		for (uint32_t width : widths) {
+			INFO("width: " << width);
+
+			std::vector<uint8_t> src0 = make_random(width * 3);
+			std::vector<uint8_t> src1 = make_random(width * 3 + 7);
+			std::vector<uint8_t> expected(width * 3, 0xAA);
+			std::vector<uint8_t> actual(width * 3, 0x55);
+
+			u_pixel_convert_yuyv422_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, src0.data(), expected.data(), width);
+			u_pixel_convert_yuyv422_to_r8g8b8(isa, src0.data(), actual.data(), width);
+			CHECK(expected == actual);
+
+			u_pixel_convert_uyvy422_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, src0.data(), expected.data(), width);
+			u_pixel_convert_uyvy422_to_r8g8b8(isa, src0.data(), actual.data(), width);
+			CHECK(expected == actual);
+
+			u_pixel_convert_yuv888_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, src0.data(), expected.data(), width);
+			u_pixel_convert_yuv888_to_r8g8b8(isa, src0.data(), actual.data(), width);
+			CHECK(expected == actual);
+
+			// Bayer rows are twice the width of the output.
+			std::vector<uint8_t> bayer0 = make_random(width * 2);
+			std::vector<uint8_t> bayer1(src1.begin(), src1.begin() + width * 2);
+			u_pixel_convert_bayer_gr8_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, bayer0.data(), bayer1.data(),
+			                                    expected.data(), width);
+			u_pixel_convert_bayer_gr8_to_r8g8b8(isa, bayer0.data(), bayer1.data(), actual.data(), width);
+			CHECK(expected == actual);
+		}
+	}
+}
+
+TEST_CASE("u_pixel_convert bit-exact all YUV values")
+{
+	auto isas = get_simd_isas();
+	if (isas.empty()) {
+		SKIP("No SIMD kernels on this CPU");
+	}
+
+	// Every U and V combination for one Y value per row.
+	constexpr uint32_t width = 256 * 256;
+	std::vector<uint8_t> src(width * 3);
+	std::vector<uint8_t> expected(width * 3);
+	std::vector<uint8_t> actual(width * 3);
+
+	for (auto isa : isas) {
+		INFO("isa: " << u_pixel_convert_isa_str(isa));
+
+		bool all_equal = true;
+		for (uint32_t y = 0; y < 256; y++) {
+			for (uint32_t i = 0; i < width; i++) {
+				src[i * 3 + 0] = (uint8_t)y;
+				src[i * 3 + 1] = (uint8_t)(i >> 8);
+				src[i * 3 + 2] = (uint8_t)(i & 0xff);
+			}
+
+			u_pixel_convert_yuv888_to_r8g8b8(U_PIXEL_CONVERT_ISA_SCALAR, src.data(), expected.data(), width);
+			u_pixel_convert_yuv888_to_r8g8b8(isa, src.data(), actual.data(), width);
+			all_equal = all_equal && expected == actual;
+		}
+
+		CHECK(all_equal);
+	}
+}
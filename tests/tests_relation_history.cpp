@@ -0,0 +1,298 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Relation history tests, including concurrent readers.
+ */
+
+#include "math/m_relation_history.h"
+
+#include "catch_amalgamated.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using xrt::auxiliary::math::RelationHistory;
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+/*!
+ * Position x is the timestamp in seconds, so any interpolated value can be
+ * checked against the timestamp it was asked for.
+ */
+static struct xrt_space_relation
+make_relation(int64_t timestamp_ns)
+{
+	struct xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+	relation.pose = XRT_POSE_IDENTITY;
+	relation.pose.position.x = (float)((double)timestamp_ns / 1e9);
+	relation.relation_flags = (enum xrt_space_relation_flags)( //
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |              //
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT);                 //
+	return relation;
+}
+
+struct contention_result
+{
+	uint64_t reads;
+	uint64_t bad_reads;
+	std::chrono::nanoseconds max_push;
+};
+
+/*!
+ * One producer pushing every @p push_interval while @p reader_count threads
+ * call get as fast as they can on timestamps within the history.
+ */
+static contention_result
+run_contention(uint32_t reader_count, uint32_t push_count, std::chrono::nanoseconds push_interval)
+{
+	constexpr int64_t kStepNs = 1000000; // 1 kHz
+
+	RelationHistory rh;
+	std::atomic<int64_t> latest_ns{0};
+	std::atomic<bool> running{true};
+	std::atomic<uint64_t> reads{0};
+	std::atomic<uint64_t> bad_reads{0};
+	std::atomic<uint32_t> started{0};
+
+	std::vector<std::thread> readers;
+	for (uint32_t i = 0; i < reader_count; i++) {
+		readers.emplace_back([&, i] {
+			uint64_t local_reads = 0;
+			uint64_t local_bad = 0;
+			int64_t offset = i * 137;
+			started++;
+
+			while (running.load(std::memory_order_relaxed)) {
+				int64_t latest = latest_ns.load(std::memory_order_acquire);
+				if (latest < 2 * kStepNs) {
+					continue;
+				}
+
+				// Somewhere in the last 100 entries, rarely exactly on one.
+				int64_t at = latest - 1 - ((offset + (int64_t)local_reads * 7919) % (100 * kStepNs));
+
+				struct xrt_space_relation out = {};
+				auto result = rh.get(at, &out);
+				local_reads++;
+
+				if (result != M_RELATION_HISTORY_RESULT_INTERPOLATED &&
+				    result != M_RELATION_HISTORY_RESULT_EXACT) {
+					continue;
+				}
+
+				float expected = (float)((double)at / 1e9);
+				if (std::abs(out.pose.position.x - expected) > 1e-4f) {
+					local_bad++;
+				}
+			}
+
+			reads += local_reads;
+			bad_reads += local_bad;
+		});
+	}
+
+	while (started.load() < reader_count) {
+		std::this_thread::yield();
+	}
+
+	std::chrono::nanoseconds max_push{0};
+	auto next = std::chrono::steady_clock::now();
+	for (uint32_t i = 1; i <= push_count; i++) {
+		int64_t ts = (int64_t)i * kStepNs;
+		struct xrt_space_relation relation = make_relation(ts);
+
+		auto before = std::chrono::steady_clock::now();
+		rh.push(relation, ts);
+		auto took = std::chrono::steady_clock::now() - before;
+		max_push = std::max(max_push, std::chrono::duration_cast<std::chrono::nanoseconds>(took));
+
+		latest_ns.store(ts, std::memory_order_release);
+
+		if (push_interval.count() > 0) {
+			next += push_interval;
+			std::this_thread::sleep_until(next);
+		}
+	}
+
+	running = false;
+	for (auto &t : readers) {
+		t.join();
+	}
+
+	return {reads.load(), bad_reads.load(), max_push};
+}
+
+
+/*
+ *
+ * Tests.
+ *
+ */
+
+TEST_CASE("m_relation_history")
+{
+	RelationHistory rh;
+
+	CHECK(rh.size() == 0);
+
+	struct xrt_space_relation out = {};
+	CHECK(rh.get(1000, &out) == M_RELATION_HISTORY_RESULT_INVALID);
+
+	for (int64_t ts = 1000; ts <= 5000; ts += 1000) {
+		CHECK(rh.push(make_relation(ts * 1000000), ts * 1000000));
+	}
+	CHECK(rh.size() == 5);
+
+	SECTION("non-monotonic pushes are rejected")
+	{
+		CHECK_FALSE(rh.push(make_relation(5000000000), 5000000000));
+		CHECK_FALSE(rh.push(make_relation(1000000000), 1000000000));
+		CHECK(rh.size() == 5);
+	}
+
+	SECTION("get")
+	{
+		CHECK(rh.get(0, &out) == M_RELATION_HISTORY_RESULT_INVALID);
+
+		CHECK(rh.get(2000000000, &out) == M_RELATION_HISTORY_RESULT_EXACT);
+		CHECK(out.pose.position.x == Catch::Approx(2.0f));
+
+		CHECK(rh.get(2500000000, &out) == M_RELATION_HISTORY_RESULT_INTERPOLATED);
+		CHECK(out.pose.position.x == Catch::Approx(2.5f));
+
+		CHECK(rh.get(6000000000, &out) == M_RELATION_HISTORY_RESULT_PREDICTED);
+		CHECK(rh.get(500000000, &out) == M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED);
+	}
+
+	SECTION("latest and clear")
+	{
+		int64_t latest_ns = 0;
+		CHECK(rh.get_latest(&latest_ns, &out));
+		CHECK(latest_ns == 5000000000);
+
+		rh.clear();
+		CHECK(rh.size() == 0);
+		CHECK_FALSE(rh.get_latest(&latest_ns, &out));
+		CHECK(rh.get(2000000000, &out) == M_RELATION_HISTORY_RESULT_INVALID);
+
+		// Older timestamps are fine after a clear.
+		CHECK(rh.push(make_relation(1000000000), 1000000000));
+		CHECK(rh.size() == 1);
+	}
+
+	SECTION("wraps around")
+	{
+		for (int64_t ts = 6000; ts < 6000 + 5000; ts++) {
+			CHECK(rh.push(make_relation(ts * 1000000), ts * 1000000));
+		}
+		CHECK(rh.size() == 4096);
+
+		CHECK(rh.get(10000500000, &out) == M_RELATION_HISTORY_RESULT_INTERPOLATED);
+		CHECK(out.pose.position.x == Catch::Approx(10.0005f));
+	}
+}
+
+TEST_CASE("m_relation_history concurrent readers")
+{
+	// Push as fast as possible to make readers get lapped as often as possible.
+	contention_result res = run_contention(4, 200000, 0ns);
+
+	CHECK(res.reads > 0);
+	CHECK(res.bad_reads == 0);
+}
+
+TEST_CASE("m_relation_history concurrent get_latest and clear")
+{
+	constexpr uint32_t kReaderCount = 4;
+	constexpr uint32_t kPushCount = 200000;
+	constexpr uint32_t kClearInterval = 1000;
+	constexpr int64_t kStepNs = 1000000;
+
+	RelationHistory rh;
+	std::atomic<bool> running{true};
+	std::atomic<uint32_t> started{0};
+	std::atomic<uint64_t> reads{0};
+	std::atomic<uint64_t> bad_reads{0};
+
+	std::vector<std::thread> readers;
+	for (uint32_t i = 0; i < kReaderCount; i++) {
+		readers.emplace_back([&] {
+			uint64_t local_reads = 0;
+			uint64_t local_bad = 0;
+			int64_t last_ns = 0;
+			started++;
+
+			while (running.load(std::memory_order_relaxed)) {
+				struct xrt_space_relation out = {};
+				int64_t latest_ns = 0;
+				if (!rh.get_latest(&latest_ns, &out)) {
+					continue; // Just cleared.
+				}
+				local_reads++;
+
+				// Torn entry, or going back in time even though timestamps only increase.
+				float expected = (float)((double)latest_ns / 1e9);
+				if (out.pose.position.x != expected || latest_ns < last_ns) {
+					local_bad++;
+				}
+				last_ns = latest_ns;
+
+				if (rh.size() > 4096) {
+					local_bad++;
+				}
+			}
+
+			reads += local_reads;
+			bad_reads += local_bad;
+		});
+	}
+
+	while (started.load() < kReaderCount) {
+		std::this_thread::yield();
+	}
+
+	for (uint32_t i = 1; i <= kPushCount; i++) {
+		int64_t ts = (int64_t)i * kStepNs;
+		rh.push(make_relation(ts), ts);
+
+		if (i % kClearInterval == 0) {
+			rh.clear();
+		}
+	}
+
+	running = false;
+	for (auto &t : readers) {
+		t.join();
+	}
+
+	CHECK(reads.load() > 0);
+	CHECK(bad_reads.load() == 0);
+}
+
+/*!
+ * Microbenchmark, hidden by default, run with `tests_relation_history "[benchmark]"`.
+ */
+TEST_CASE("m_relation_history contention", "[.][benchmark]")
+{
+	constexpr uint32_t kPushCount = 1000; // One second at 1 kHz.
+
+	for (uint32_t reader_count : {0u, 1u, 2u, 4u, 8u, 16u}) {
+		contention_result res = run_contention(reader_count, kPushCount, 1ms);
+
+		printf("readers: %2u, reads/s: %10.0f, max push: %8.3f us\n", reader_count, (double)res.reads,
+		       (double)res.max_push.count() / 1000.0);
+
+		CHECK(res.bad_reads == 0);
+	}
+}
@@ -0,0 +1,123 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Test u_space_overseer locating functions.
+ */
+
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_space.h"
+
+#include "util/u_space_overseer.h"
+
+#include "catch_amalgamated.hpp"
+
+
+/*
+ *
+ * Counting device.
+ *
+ */
+
+struct counting_device
+{
+	struct xrt_device base;
+	uint32_t call_count;
+};
+
+static void
+counting_get_tracked_pose(struct xrt_device *xdev,
+                          enum xrt_input_name name,
+                          int64_t at_timestamp_ns,
+                          struct xrt_space_relation *out_relation)
+{
+	struct counting_device *cd = (struct counting_device *)xdev;
+	cd->call_count++;
+
+	*out_relation = XRT_SPACE_RELATION_ZERO;
+	out_relation->pose = XRT_POSE_IDENTITY;
+	out_relation->relation_flags = (enum xrt_space_relation_flags)( //
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |                 //
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT);                    //
+
+	// Grip is one meter above the aim pose, which is at the origin.
+	if (name == XRT_INPUT_SIMPLE_GRIP_POSE) {
+		out_relation->pose.position.y = 1.0f;
+	}
+}
+
+
+/*
+ *
+ * Tests.
+ *
+ */
+
+TEST_CASE("u_space_overseer")
+{
+	struct counting_device cd = {};
+	cd.base.get_tracked_pose = counting_get_tracked_pose;
+	struct xrt_device *xdev = &cd.base;
+
+	struct u_space_overseer *uso = u_space_overseer_create(NULL);
+	struct xrt_space_overseer *xso = (struct xrt_space_overseer *)uso;
+
+	struct xrt_space *device_space = NULL;
+	u_space_overseer_create_null_space(uso, xso->semantic.root, &device_space);
+	u_space_overseer_link_space_to_device(uso, device_space, xdev);
+
+	struct xrt_space *base = NULL;
+	struct xrt_space *target = NULL;
+	REQUIRE(u_space_overseer_create_pose_space(uso, xdev, XRT_INPUT_SIMPLE_AIM_POSE, &base) == XRT_SUCCESS);
+	REQUIRE(u_space_overseer_create_pose_space(uso, xdev, XRT_INPUT_SIMPLE_GRIP_POSE, &target) ==
+	        XRT_SUCCESS);
+
+	SECTION("locate_spaces fetches each device pose once")
+	{
+		constexpr uint32_t kCount = 4;
+		struct xrt_space *spaces[kCount];
+		struct xrt_pose offsets[kCount];
+		struct xrt_space_relation relations[kCount] = {};
+
+		for (uint32_t i = 0; i < kCount; i++) {
+			spaces[i] = target;
+			offsets[i] = XRT_POSE_IDENTITY;
+			offsets[i].position.x = (float)i; // Different offsets so they are all located.
+		}
+
+		const struct xrt_pose ident = XRT_POSE_IDENTITY;
+		xrt_result_t xret = xrt_space_overseer_locate_spaces( //
+		    xso, base, &ident, 1000, spaces, kCount, offsets, relations);
+		REQUIRE(xret == XRT_SUCCESS);
+
+		// One call for the base and one for the target.
+		CHECK(cd.call_count == 2);
+
+		for (uint32_t i = 0; i < kCount; i++) {
+			CHECK(relations[i].relation_flags != XRT_SPACE_RELATION_BITMASK_NONE);
+			CHECK(relations[i].pose.position.x == Catch::Approx((float)i));
+			CHECK(relations[i].pose.position.y == Catch::Approx(1.0f));
+		}
+	}
+
+	SECTION("NULL spaces are not located")
+	{
+		struct xrt_space *spaces[2] = {target, NULL};
+		struct xrt_pose offsets[2] = {XRT_POSE_IDENTITY, XRT_POSE_IDENTITY};
+		struct xrt_space_relation relations[2] = {};
+		relations[1].relation_flags = XRT_SPACE_RELATION_POSITION_VALID_BIT;
+
+		const struct xrt_pose ident = XRT_POSE_IDENTITY;
+		xrt_result_t xret = xrt_space_overseer_locate_spaces( //
+		    xso, base, &ident, 1000, spaces, 2, offsets, relations);
+		REQUIRE(xret == XRT_SUCCESS);
+
+		CHECK(relations[0].relation_flags != XRT_SPACE_RELATION_BITMASK_NONE);
+		CHECK(relations[1].relation_flags == XRT_SPACE_RELATION_BITMASK_NONE);
+	}
+
+	xrt_space_reference(&target, NULL);
+	xrt_space_reference(&base, NULL);
+	xrt_space_reference(&device_space, NULL);
+	xrt_space_overseer_destroy(&xso);
+}
@@ -0,0 +1,228 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Test validation of on-disk Vulkan pipeline cache data.
+ */
+
+#include "xrt/xrt_config_os.h"
+
+#include "vk/vk_helpers.h"
+
+#include "catch_amalgamated.hpp"
+
+#include "vktest_init_bundle.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+
+static VkPhysicalDeviceProperties
+make_props()
+{
+	VkPhysicalDeviceProperties pdp = {};
+	pdp.vendorID = 0x10005;
+	pdp.deviceID = 0x1234;
+	pdp.driverVersion = 42;
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		pdp.pipelineCacheUUID[i] = (uint8_t)i;
+	}
+	return pdp;
+}
+
+static std::vector<uint8_t>
+make_data(const VkPhysicalDeviceProperties &pdp, size_t extra)
+{
+	VkPipelineCacheHeaderVersionOne header = {};
+	header.headerSize = sizeof(header);
+	header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+	header.vendorID = pdp.vendorID;
+	header.deviceID = pdp.deviceID;
+	memcpy(header.pipelineCacheUUID, pdp.pipelineCacheUUID, VK_UUID_SIZE);
+
+	std::vector<uint8_t> data(sizeof(header) + extra, 0xab);
+	memcpy(data.data(), &header, sizeof(header));
+	return data;
+}
+
+TEST_CASE("vk_pipeline_cache_data_is_compatible")
+{
+	VkPhysicalDeviceProperties pdp = make_props();
+	std::vector<uint8_t> data = make_data(pdp, 128);
+
+	CHECK(vk_pipeline_cache_data_is_compatible(&pdp, data.data(), data.size()));
+
+	SECTION("truncated or missing data")
+	{
+		CHECK_FALSE(vk_pipeline_cache_data_is_compatible(&pdp, NULL, 0));
+		CHECK_FALSE(vk_pipeline_cache_data_is_compatible(&pdp, data.data(), 16));
+	}
+
+	SECTION("different device")
+	{
+		VkPhysicalDeviceProperties other = pdp;
+		other.deviceID++;
+		CHECK_FALSE(vk_pipeline_cache_data_is_compatible(&other, data.data(), data.size()));
+	}
+
+	SECTION("different driver build")
+	{
+		VkPhysicalDeviceProperties other = pdp;
+		other.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 0xff;
+		CHECK_FALSE(vk_pipeline_cache_data_is_compatible(&other, data.data(), data.size()));
+	}
+
+	SECTION("bad header")
+	{
+		VkPipelineCacheHeaderVersionOne header;
+		memcpy(&header, data.data(), sizeof(header));
+		header.headerSize = (uint32_t)data.size() + 1;
+		memcpy(data.data(), &header, sizeof(header));
+		CHECK_FALSE(vk_pipeline_cache_data_is_compatible(&pdp, data.data(), data.size()));
+	}
+}
+
+#ifdef XRT_OS_LINUX
+
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t>
+read_file(const fs::path &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void
+write_file(const fs::path &path, const std::vector<uint8_t> &data)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write((const char *)data.data(), (std::streamsize)data.size());
+}
+
+//! The files saved under @p name, there should only ever be one per device.
+static std::vector<fs::path>
+find_files(const fs::path &dir, const std::string &name)
+{
+	std::vector<fs::path> ret;
+	std::error_code ec;
+	for (const auto &entry : fs::directory_iterator(dir, ec)) {
+		std::string file_name = entry.path().filename().string();
+		if (file_name.rfind(name + "_", 0) == 0 && entry.path().extension() == ".bin") {
+			ret.push_back(entry.path());
+		}
+	}
+	return ret;
+}
+
+//! Points the cache directory to a fresh temporary directory, keeps the user's cache out of this.
+struct TempCacheHome
+{
+	fs::path path;
+
+	TempCacheHome()
+	{
+		char tmpl[] = "/tmp/monado_test_pipeline_cache_XXXXXX";
+		if (mkdtemp(tmpl) != NULL) {
+			path = tmpl;
+			setenv("XDG_CACHE_HOME", tmpl, 1);
+		}
+	}
+
+	~TempCacheHome()
+	{
+		if (!path.empty()) {
+			unsetenv("XDG_CACHE_HOME");
+			fs::remove_all(path);
+		}
+	}
+};
+
+static void
+save_and_destroy(struct vk_bundle *vk, VkPipelineCache &cache, const char *name)
+{
+	vk_save_pipeline_cache_to_disk(vk, cache, name);
+	vk->vkDestroyPipelineCache(vk->device, cache, NULL);
+	cache = VK_NULL_HANDLE;
+}
+
+TEST_CASE("vk_pipeline_cache_round_trip")
+{
+	TempCacheHome cache_home;
+	REQUIRE_FALSE(cache_home.path.empty());
+	const fs::path dir = cache_home.path / "monado" / "pipeline_cache";
+
+	unique_vk_bundle vk = makeVkBundle();
+	if (!vktest_init_bundle(vk.get())) {
+		SKIP("No Vulkan device, is there an ICD installed?");
+	}
+
+	VkPhysicalDeviceProperties pdp;
+	vk->vkGetPhysicalDeviceProperties(vk->physical_device, &pdp);
+
+	const char *name = "test";
+	VkPipelineCache cache = VK_NULL_HANDLE;
+
+	// Nothing on disk yet, gives an empty cache.
+	REQUIRE(vk_create_pipeline_cache_from_disk(vk.get(), name, &cache) == VK_SUCCESS);
+	REQUIRE(cache != VK_NULL_HANDLE);
+	save_and_destroy(vk.get(), cache, name);
+
+	std::vector<fs::path> files = find_files(dir, name);
+	REQUIRE(files.size() == 1);
+	const fs::path path = files[0];
+
+	std::vector<uint8_t> saved = read_file(path);
+	CHECK(vk_pipeline_cache_data_is_compatible(&pdp, saved.data(), saved.size()));
+
+	SECTION("reload")
+	{
+		REQUIRE(vk_create_pipeline_cache_from_disk(vk.get(), name, &cache) == VK_SUCCESS);
+		REQUIRE(cache != VK_NULL_HANDLE);
+		save_and_destroy(vk.get(), cache, name);
+
+		// Same data back, and no temporary files left behind.
+		CHECK(read_file(path) == saved);
+		CHECK(find_files(dir, name).size() == 1);
+		CHECK(std::distance(fs::directory_iterator(dir), fs::directory_iterator()) == 1);
+	}
+
+	SECTION("corrupt or mismatched files are ignored")
+	{
+		std::vector<uint8_t> bad;
+
+		SECTION("garbage")
+		{
+			bad = std::vector<uint8_t>(256, 0xab);
+		}
+
+		SECTION("truncated")
+		{
+			bad = std::vector<uint8_t>(saved.begin(), saved.begin() + 8);
+		}
+
+		SECTION("other driver build")
+		{
+			VkPhysicalDeviceProperties other = pdp;
+			other.pipelineCacheUUID[0] ^= 0xff;
+			bad = make_data(other, 64);
+		}
+
+		write_file(path, bad);
+		REQUIRE_FALSE(vk_pipeline_cache_data_is_compatible(&pdp, bad.data(), bad.size()));
+
+		// Still get a working cache, and saving replaces the bad file.
+		REQUIRE(vk_create_pipeline_cache_from_disk(vk.get(), name, &cache) == VK_SUCCESS);
+		REQUIRE(cache != VK_NULL_HANDLE);
+		save_and_destroy(vk.get(), cache, name);
+
+		std::vector<uint8_t> fixed = read_file(path);
+		CHECK(vk_pipeline_cache_data_is_compatible(&pdp, fixed.data(), fixed.size()));
+	}
+}
+
+#endif // XRT_OS_LINUX
@@ -10,8 +10,11 @@
 
 #include "catch_amalgamated.hpp"
 
+#include <atomic>
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -130,3 +133,144 @@ TEST_CASE("TaskCollection")
 		CHECK(calledA[2]);
 	}
 }
+
+namespace {
+
+struct counter_task
+{
+	std::atomic<uint32_t> *counter;
+	uint32_t spin;
+};
+
+void
+counter_func(void *ptr)
+{
+	auto *t = static_cast<counter_task *>(ptr);
+
+	// Busy work, volatile so it isn't optimised away.
+	volatile uint32_t x = 0;
+	for (uint32_t i = 0; i < t->spin; i++) {
+		x = x + i;
+	}
+
+	t->counter->fetch_add(1, std::memory_order_relaxed);
+}
+
+/*!
+ * Push @p task_count tasks in batches of @p batch_size, waiting on the group
+ * after every batch, returns the number of tasks run.
+ */
+uint32_t
+run_batches(u_worker_group *group, uint32_t task_count, uint32_t batch_size, uint32_t spin)
+{
+	std::atomic<uint32_t> counter{0};
+	std::vector<counter_task> tasks(batch_size, counter_task{&counter, spin});
+
+	for (uint32_t done = 0; done < task_count; done += batch_size) {
+		for (uint32_t i = 0; i < batch_size; i++) {
+			u_worker_group_push(group, counter_func, &tasks[i]);
+		}
+		u_worker_group_wait_all(group);
+	}
+
+	return counter.load();
+}
+
+} // namespace
+
+TEST_CASE("u_worker_group many tasks")
+{
+	u_worker_thread_pool *pool = u_worker_thread_pool_create(3, 4, "Test");
+	REQUIRE(pool != nullptr);
+
+	SECTION("More tasks than fit in the queue")
+	{
+		u_worker_group *group = u_worker_group_create(pool);
+		CHECK(run_batches(group, 4096, 1024, 0) == 4096);
+		u_worker_group_reference(&group, nullptr);
+	}
+
+	SECTION("Groups pushed to from several threads")
+	{
+		constexpr uint32_t kThreadCount = 4;
+		uint32_t results[kThreadCount] = {};
+
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < kThreadCount; i++) {
+			threads.emplace_back([&, i] {
+				u_worker_group *group = u_worker_group_create(pool);
+				results[i] = run_batches(group, 20000, 16, 100);
+				u_worker_group_reference(&group, nullptr);
+			});
+		}
+
+		for (auto &t : threads) {
+			t.join();
+		}
+
+		for (uint32_t r : results) {
+			CHECK(r == 20000);
+		}
+	}
+
+	u_worker_thread_pool_reference(&pool, nullptr);
+}
+
+TEST_CASE("u_worker_group destroyed right after the last task")
+{
+	u_worker_thread_pool *pool = u_worker_thread_pool_create(3, 4, "Test");
+	REQUIRE(pool != nullptr);
+
+	// The worker finishing the last task races with the group being freed.
+	std::atomic<uint32_t> counter{0};
+	counter_task task{&counter, 0};
+	for (uint32_t i = 0; i < 2000; i++) {
+		u_worker_group *group = u_worker_group_create(pool);
+		u_worker_group_push(group, counter_func, &task);
+		u_worker_group_push(group, counter_func, &task);
+		u_worker_group_reference(&group, nullptr);
+	}
+
+	CHECK(counter.load() == 4000);
+
+	u_worker_thread_pool_reference(&pool, nullptr);
+}
+
+/*!
+ * Throughput benchmark, hidden by default, run with `tests_worker "[benchmark]"`.
+ */
+TEST_CASE("u_worker_group throughput", "[.][benchmark]")
+{
+	struct config
+	{
+		const char *name;
+		uint32_t task_count;
+		uint32_t batch_size;
+		uint32_t spin;
+	};
+
+	const config configs[] = {
+	    {"tiny tasks", 200000, 64, 0},
+	    {"small tasks", 100000, 16, 1000},
+	    {"large tasks", 64, 4, 2000000},
+	};
+
+	for (uint32_t thread_count : {2u, 4u, 8u}) {
+		u_worker_thread_pool *pool = u_worker_thread_pool_create(thread_count - 1, thread_count, "Bench");
+		u_worker_group *group = u_worker_group_create(pool);
+
+		for (const config &c : configs) {
+			auto start = std::chrono::steady_clock::now();
+			uint32_t count = run_batches(group, c.task_count, c.batch_size, c.spin);
+			auto end = std::chrono::steady_clock::now();
+
+			double secs = std::chrono::duration<double>(end - start).count();
+			printf("threads: %u, %-12s tasks/s: %12.0f\n", thread_count, c.name, (double)count / secs);
+
+			CHECK(count == c.task_count);
+		}
+
+		u_worker_group_reference(&group, nullptr);
+		u_worker_thread_pool_reference(&pool, nullptr);
+	}
+}